@@ -0,0 +1,280 @@
+/***********************************************************
+ * blitbench.c
+ * Compares the way show_status() draws the rows of sticks,
+ * plot_ram_rows() in plot.c (a loop up each column, or in the
+ * rotated orientations a lookup table and one OR per display line
+ * for each row), with drawing them a pixel at a time:
+ *  - as it was done before plot.c, a plot_ram_pixel() call for
+ *    each stick, with the orientation switch, the add and the
+ *    % 8 of the 8x8 module's mapping (only for the default
+ *    single 8x8 board)
+ *  - a pixel at a time through the display.h mappings, turned
+ *    to each orientation, which is what drawing in any
+ *    orientation would cost without the table
+ * Every position drawn is checked to come out the same each
+ * way, then each is timed over the same random positions.
+ * The times are host CPU cycles (the time stamp counter, on
+ * x86) per call, so they show the saving as a ratio rather than
+ * as Cortex-M0 cycles; DO_PROFILE measures plot_ram_rows() on
+ * the board itself.
+ *
+ * Build it for the same board as the firmware, for example
+ *   make blitbench SIMDEFS="-DDISPLAY_PANEL_COLS=16"
+ *
+ * usage: blitbench [-n positions] [-r seed]
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "nim.h"
+#include "display.h"
+#include "plot.h"
+
+/********* definitions *****************/
+#define REPEATS 200
+#define OLD_BOARD ((DISPLAY_PANELS==1) && (DISPLAY_PANEL_COLS==8))
+
+/******** global variables **************/
+// the firmware globals plot.c uses
+uint16_t display_ram[DISPLAY_LINES];
+unsigned char rows;
+
+unsigned char (*positions)[MAXROWS];
+unsigned char* position_rows;
+int num_positions=10000;
+volatile uint16_t sink;
+
+/****************************************
+ * stand-ins and the ways it was done before
+ ****************************************/
+
+void
+display_ram_blank(void)
+{
+  memset(display_ram, 0, sizeof(display_ram));
+}
+
+#if OLD_BOARD
+/* old_plot_ram_pixel
+ * plot_ram_pixel() as it was, for the 8x8 module
+ */
+static void
+old_plot_ram_pixel(int x, int y)
+{
+  switch(0) // ORIENTATION
+  {
+  case 0:
+    x=8-x-1;
+    break;
+  default:
+    break;
+  }
+  x = x+7; // fixes an unusual mapping in the 8x8 display matrix
+  x = x%8; //
+
+  display_ram[y] |= 1<<x; // place the pixel into the local display ram
+}
+
+static void
+old_plot_ram_rows(unsigned char* rows_arr)
+{
+  unsigned char i, j;
+  display_ram_blank();
+  for (i=0; i<rows; i++)
+  {
+    if (rows_arr[i]>0)
+    {
+      for (j=0; j<rows_arr[i]; j++)
+      {
+        old_plot_ram_pixel((int)i*2, (int)j);
+      }
+    }
+  }
+}
+
+#endif
+
+/* pixel_plot_ram_rows
+ * a pixel at a time, turned to display_orientation
+ */
+static void
+pixel_plot_ram_rows(unsigned char* rows_arr)
+{
+  int i, j, x, y;
+
+  display_ram_blank();
+  for (i=0; i<rows; i++)
+  {
+    for (j=0; (j<rows_arr[i]) && (j<PLOT_STICKS); j++)
+    {
+      switch(display_orientation)
+      {
+      case PLOT_0:
+        x=2*i;
+        y=j;
+        break;
+      case PLOT_90:
+        x=j;
+        y=DISPLAY_HEIGHT-1-2*i;
+        break;
+      case PLOT_180:
+        x=DISPLAY_WIDTH-1-2*i;
+        y=DISPLAY_HEIGHT-1-j;
+        break;
+      default:
+        x=DISPLAY_WIDTH-1-j;
+        y=2*i;
+        break;
+      }
+      if ((x>=0) && (x<DISPLAY_WIDTH) && (y>=0) && (y<DISPLAY_HEIGHT))
+        display_ram[DISPLAY_LINE(x, y)] |= (uint16_t)(1U<<DISPLAY_BIT(x));
+    }
+  }
+}
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static uint64_t
+cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return(__builtin_ia32_rdtsc());
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((uint64_t)ts.tv_sec*1000000000ULL+(uint64_t)ts.tv_nsec);
+#endif
+}
+
+/* make_positions
+ * random positions, as the levels deal them: 3 to 5 rows of 0 to
+ * 9 sticks. On the single 8x8 panel, only what it can show: up to
+ * 4 rows of 8 (the old code has no clipping, and went past the end
+ * of display_ram with more)
+ */
+static void
+make_positions(unsigned long seed)
+{
+  int p, i;
+
+  srand(seed);
+  positions=calloc(num_positions, sizeof(*positions));
+  position_rows=calloc(num_positions, 1);
+  for (p=0; p<num_positions; p++)
+  {
+    position_rows[p]=(unsigned char)(3+rand()%(OLD_BOARD ? 2 : 3));
+    for (i=0; i<MAXROWS; i++)
+    {
+      positions[p][i]=(unsigned char)(rand()%(OLD_BOARD ? 9 : 10));
+    }
+  }
+}
+
+/* check
+ * draws every position both ways, returns the number that differ
+ */
+static int
+check(void (*ref)(unsigned char*))
+{
+  uint16_t want[DISPLAY_LINES];
+  int p, bad=0;
+
+  for (p=0; p<num_positions; p++)
+  {
+    rows=position_rows[p];
+    ref(positions[p]);
+    memcpy(want, display_ram, sizeof(want));
+    plot_ram_rows(positions[p]);
+    if (memcmp(want, display_ram, sizeof(want))!=0)
+      bad++;
+  }
+  return(bad);
+}
+
+/* time_it
+ * cycles per call, drawing each position REPEATS times
+ */
+static double
+time_it(void (*fn)(unsigned char*))
+{
+  uint64_t t0, t1;
+  int p, k;
+
+  t0=cycles();
+  for (k=0; k<REPEATS; k++)
+  {
+    for (p=0; p<num_positions; p++)
+    {
+      rows=position_rows[p];
+      fn(positions[p]);
+      sink^=display_ram[p % DISPLAY_LINES];
+    }
+  }
+  t1=cycles();
+  return((double)(t1-t0)/((double)REPEATS*num_positions));
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  int c, bad=0;
+  unsigned long seed=1;
+  unsigned char o;
+  double pixel, plot;
+#if OLD_BOARD
+  double before;
+#endif
+
+  while ((c=getopt(argc, argv, "n:r:"))!=-1)
+  {
+    switch(c)
+    {
+      case 'n':
+        num_positions=atoi(optarg);
+        break;
+      case 'r':
+        seed=strtoul(optarg, NULL, 0);
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n positions] [-r seed]\n", argv[0]);
+        return(2);
+    }
+  }
+  if (num_positions<1)
+    num_positions=1;
+  make_positions(seed);
+
+  printf("board: %d panel(s) of %dx8, %dx%d, %d positions\n",
+         DISPLAY_PANELS, DISPLAY_PANEL_COLS, DISPLAY_WIDTH, DISPLAY_HEIGHT, num_positions);
+#if OLD_BOARD
+  display_orientation=PLOT_0;
+  bad+=check(old_plot_ram_rows);
+  before=time_it(old_plot_ram_rows);
+  plot=time_it(plot_ram_rows);
+  printf("as before, a pixel at a time:  %6.1f cycles per show_status\n", before);
+  printf("plot.c:                        %6.1f cycles per show_status (%.1fx)\n", plot, before/plot);
+#endif
+  for (o=0; o<PLOT_ORIENTATIONS; o++)
+  {
+    display_orientation=o;
+    bad+=check(pixel_plot_ram_rows);
+    pixel=time_it(pixel_plot_ram_rows);
+    plot=time_it(plot_ram_rows);
+    printf("%3d degrees: a pixel at a time %6.1f, plot.c %6.1f cycles per show_status (%.1fx)\n",
+           o*90, pixel, plot, pixel/plot);
+  }
+  printf("%d positions drawn differently\n", bad);
+  return(bad ? 1 : 0);
+}
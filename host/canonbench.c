@@ -0,0 +1,262 @@
+/***********************************************************
+ * canonbench.c
+ * Checks and times the rank of a position up to the order of its
+ * rows (pocket-nim/canon.c):
+ *  - every rank of 1 to 8 rows of up to 15 sticks (fewer where
+ *    they would not fit) unranked and ranked back, checked to come
+ *    out sorted and in range, and ranked again with the rows
+ *    shuffled
+ *  - the time for canon_rank() and canon_unrank() on random rows,
+ *    against the plain way: an insertion sort, and a linear search
+ *    down each column of C(n, j)
+ *  - the size of a table with an entry per position, in order and
+ *    up to the order of the rows, for the device's boards and more
+ *
+ * usage: canonbench [-n positions] [-r seed]
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "canon.h"
+
+/********* definitions *****************/
+#define CHECK_MAX 15
+#define POOL 4096 // positions, used in turn so that they stay in the cache
+
+/*************** types ***********************/
+typedef struct
+{
+  unsigned char rows, max;
+  const char* what;
+} board_t;
+
+/******** global variables **************/
+const board_t boards[]=
+{
+  {2, 8, "the Wythoff level"},
+  {3, 5, "level 1"},
+  {4, 7, "levels 2 and 3"},
+  {4, 8, "level 4"},
+  {5, 9, "level 5"},
+  {5, 15, "5 rows to 15"},
+  {8, 15, "8 rows to 15"},
+};
+int num_positions=10000000;
+uint32_t binom[CANON_SPAN][CANON_MAX_ROWS+1];
+volatile uint32_t sink;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static double
+now_s(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec+ts.tv_nsec/1e9);
+}
+
+/* plain_rank
+ * the rank the plain way, with an insertion sort
+ */
+static uint32_t
+plain_rank(const unsigned char* sticks, int rows)
+{
+  unsigned char s[CANON_MAX_ROWS], v;
+  uint32_t rank=0;
+  int i, j;
+
+  for (i=0; i<rows; i++)
+  {
+    v=sticks[i];
+    for (j=i; (j>0) && (s[j-1]>v); j--)
+      s[j]=s[j-1];
+    s[j]=v;
+  }
+  for (i=0; i<rows; i++)
+    rank+=binom[s[i]+i][i+1];
+  return(rank);
+}
+
+/* plain_unrank
+ * back from the rank, searching down each column in turn
+ */
+static void
+plain_unrank(uint32_t rank, int rows, int max, unsigned char* sticks)
+{
+  int i, c=max+rows;
+
+  for (i=rows-1; i>=0; i--)
+  {
+    for (c--; binom[c][i+1]>rank; c--)
+      ;
+    rank-=binom[c][i+1];
+    sticks[i]=(unsigned char)(c-i);
+  }
+}
+
+/* check_all
+ * every rank of rows rows of up to max, there and back. Returns the
+ * number of mistakes
+ */
+static int
+check_all(int rows, int max)
+{
+  unsigned char s[CANON_MAX_ROWS], t;
+  uint32_t r, n=canon_count((unsigned char)rows, (unsigned char)max);
+  int i, j, bad=0;
+
+  if (n!=binom[max+rows][rows])
+    bad++;
+  for (r=0; r<n; r++)
+  {
+    canon_unrank(r, (unsigned char)rows, s);
+    for (i=0; i<rows; i++)
+    {
+      if ((s[i]>max) || ((i>0) && (s[i]<s[i-1])))
+        bad++;
+    }
+    if (canon_rank(s, (unsigned char)rows)!=r)
+      bad++;
+    for (i=rows-1; i>0; i--)
+    {
+      j=rand()%(i+1);
+      t=s[i];
+      s[i]=s[j];
+      s[j]=t;
+    }
+    if ((canon_rank(s, (unsigned char)rows)!=r) || (plain_rank(s, rows)!=r))
+      bad++;
+  }
+  return(bad);
+}
+
+/* bench
+ * times rank and unrank on random rows, both ways. Returns the number
+ * of times they don't agree
+ */
+static int
+bench(int rows, int max, double* ns)
+{
+  unsigned char* pos;
+  unsigned char s[CANON_MAX_ROWS];
+  uint32_t* ranks;
+  uint32_t n=canon_count((unsigned char)rows, (unsigned char)max);
+  int p, i, bad=0;
+  double t0;
+
+  pos=malloc(POOL*CANON_MAX_ROWS);
+  ranks=malloc(POOL*sizeof(uint32_t));
+  for (p=0; p<POOL; p++)
+  {
+    for (i=0; i<rows; i++)
+      pos[p*CANON_MAX_ROWS+i]=(unsigned char)(rand()%(max+1));
+    ranks[p]=(uint32_t)rand()%n;
+  }
+  t0=now_s();
+  for (p=0; p<num_positions; p++)
+    sink+=canon_rank(pos+(p%POOL)*CANON_MAX_ROWS, (unsigned char)rows);
+  ns[0]=(now_s()-t0)*1e9/num_positions;
+  t0=now_s();
+  for (p=0; p<num_positions; p++)
+    sink+=plain_rank(pos+(p%POOL)*CANON_MAX_ROWS, rows);
+  ns[1]=(now_s()-t0)*1e9/num_positions;
+  t0=now_s();
+  for (p=0; p<num_positions; p++)
+  {
+    canon_unrank(ranks[p%POOL], (unsigned char)rows, s);
+    sink+=s[0];
+  }
+  ns[2]=(now_s()-t0)*1e9/num_positions;
+  t0=now_s();
+  for (p=0; p<num_positions; p++)
+  {
+    plain_unrank(ranks[p%POOL], rows, max, s);
+    sink+=s[0];
+  }
+  ns[3]=(now_s()-t0)*1e9/num_positions;
+  for (p=0; p<POOL; p++)
+  {
+    if (canon_rank(pos+p*CANON_MAX_ROWS, (unsigned char)rows)!=plain_rank(pos+p*CANON_MAX_ROWS, rows))
+      bad++;
+  }
+  free(pos);
+  free(ranks);
+  return(bad);
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  int c, rows, max, bad, failed=0;
+  unsigned long seed=1;
+  unsigned b;
+  double ordered, ns[4];
+  uint32_t n;
+
+  while ((c=getopt(argc, argv, "n:r:"))!=-1)
+  {
+    switch(c)
+    {
+      case 'n':
+        num_positions=atoi(optarg);
+        break;
+      case 'r':
+        seed=strtoul(optarg, NULL, 0);
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n positions] [-r seed]\n", argv[0]);
+        return(2);
+    }
+  }
+  if (num_positions<1)
+    num_positions=1;
+  srand(seed);
+  for (c=0; c<CANON_SPAN; c++)
+  {
+    binom[c][0]=1;
+    for (rows=1; (rows<=CANON_MAX_ROWS) && (rows<=c); rows++)
+      binom[c][rows]=binom[c-1][rows-1]+((rows<c) ? binom[c-1][rows] : 0);
+  }
+
+  for (rows=1; rows<=CANON_MAX_ROWS; rows++)
+  {
+    max=(CANON_FITS(rows, CHECK_MAX)) ? CHECK_MAX : CANON_SPAN-1-rows;
+    bad=check_all(rows, max);
+    printf("%d rows of up to %d: all %u ranks there and back, %d wrong\n", rows, max,
+           canon_count((unsigned char)rows, (unsigned char)max), bad);
+    failed+=(bad!=0);
+  }
+
+  printf("\n                        rank ns        unrank ns\n");
+  printf("  rows  max           canon  plain     canon  plain\n");
+  for (b=0; b<sizeof(boards)/sizeof(boards[0]); b++)
+  {
+    bad=bench(boards[b].rows, boards[b].max, ns);
+    printf("  %4d  %3d          %6.1f %6.1f    %6.1f %6.1f\n", boards[b].rows, boards[b].max,
+           ns[0], ns[1], ns[2], ns[3]);
+    failed+=(bad!=0);
+  }
+
+  printf("\n  board          in order  up to order  smaller by\n");
+  for (b=0; b<sizeof(boards)/sizeof(boards[0]); b++)
+  {
+    for (ordered=1, c=0; c<boards[b].rows; c++)
+      ordered*=boards[b].max+1;
+    n=canon_count(boards[b].rows, boards[b].max);
+    printf("  %d rows to %2d  %10.0f  %11u  %9.1fx  (%s)\n", boards[b].rows, boards[b].max, ordered, n,
+           ordered/n, boards[b].what);
+  }
+  return(failed ? 1 : 0);
+}
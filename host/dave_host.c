@@ -0,0 +1,465 @@
+/***********************************************************
+ * dave_host.c
+ * Host stand-ins for the DAVE APPs that pocket-nim uses:
+ * DIGITAL_IO for the buttons and LED, I2C_MASTER for the
+ * display and PWM_CCU4 for the buzzer.
+ *
+ * The I2C bus is timed against the virtual clock: each byte
+ * takes 9 bit times at the configured baud rate, and a transfer
+ * is "busy" until its last bit has gone out. The bytes are
+ * passed on to the HT16K33 model straight away, and the end of
+ * transmit/receive callback runs (as an interrupt) when the last
+ * bit has gone.
+ *
+ * Faults can be injected on the bus (-X n): every nth transfer
+ * goes wrong, alternately
+ *  - with a NACK of the address. The NACK flag is set and the
+ *    transfer never finishes, as with the DAVE APP when there is
+ *    no NACK callback, until it is aborted
+ *  - with the slave holding SDA low, as if it had been reset part
+ *    way through a read. Nothing is flagged, and no transfer gets
+ *    anywhere until SCL has been clocked (as a GPIO) enough times
+ *    for the slave to let go
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <DAVE.h>
+#include "keyscan.h"
+#include "i2cq.h"
+#include "sim.h"
+
+/********* definitions *****************/
+#define BUTTON_PINS 0x3fU // P0.0-P0.5, active low with pull-ups
+#define LED_PIN 8
+#define SDA_PIN 10 // P2.10
+#define SCL_PIN 11 // P2.11
+
+/******** global variables **************/
+XMC_GPIO_PORT_t sim_port0;
+const DIGITAL_IO_t button1={&sim_port0, 0};
+const DIGITAL_IO_t button2={&sim_port0, 1};
+const DIGITAL_IO_t button3={&sim_port0, 2};
+const DIGITAL_IO_t button4={&sim_port0, 3};
+const DIGITAL_IO_t button5={&sim_port0, 4};
+const DIGITAL_IO_t button_computer={&sim_port0, 5};
+const DIGITAL_IO_t led2={&sim_port0, LED_PIN};
+
+XMC_GPIO_PORT_t sim_port2={(1U<<SDA_PIN) | (1U<<SCL_PIN), (1U<<SDA_PIN) | (1U<<SCL_PIN)};
+
+I2C_MASTER_t i2c_bus={400000U, i2cq_tx_done, i2cq_rx_done};
+PWM_CCU4_t pwm1;
+
+uint64_t i2c_busy_until=0; // ns
+uint64_t i2c_busy_ns=0;    // total time the bus was in use
+unsigned long i2c_transfers=0;
+unsigned long i2c_bytes=0;
+unsigned long i2c_nacks=0;
+uint64_t i2c_frame_ns=0;   // bus time taken by display frames
+
+uint64_t i2c_event_ns=0;   // when the callback is due, 0 if none
+void (*i2c_event)(void)=NULL;
+
+unsigned long i2c_fault_every=0; // -X
+int i2c_hung=0;            // the transfer won't finish until it is aborted
+uint32_t i2c_flags=0;
+int i2c_sda_stuck=0;       // SCL clocks before the slave lets go of SDA
+uint32_t i2c_gpio_pins=0;  // pins of port 2 taken over as GPIOs
+int i2c_scl=1, i2c_sda=1;  // the levels on the bus
+unsigned long i2c_faults_nack=0;
+unsigned long i2c_faults_sda=0;
+unsigned long i2c_inits=0;
+unsigned long i2c_recovery_clocks=0;
+unsigned long tones=0;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* i2c_occupy
+ * queues bits on the bus behind whatever is still going out
+ */
+static void
+i2c_occupy(const I2C_MASTER_t* handle, unsigned int bits)
+{
+  uint64_t t;
+  uint64_t start=(i2c_busy_until>sim_now_ns) ? i2c_busy_until : sim_now_ns;
+
+  t=(uint64_t)bits*1000000000ULL/handle->baudrate;
+  i2c_busy_until=start+t;
+  i2c_busy_ns+=t;
+}
+
+/* i2c_pins
+ * follows SCL and SDA while they are GPIOs, for bus recovery: each
+ * rising edge of SCL is a clock for a slave that is holding SDA low,
+ * and SDA rising while SCL is high is a stop condition
+ */
+static void
+i2c_pins(void)
+{
+  int scl=(i2c_gpio_pins & (1U<<SCL_PIN)) ? (int)((sim_port2.OUT>>SCL_PIN) & 1) : 1;
+  int sda=(i2c_gpio_pins & (1U<<SDA_PIN)) ? (int)((sim_port2.OUT>>SDA_PIN) & 1) : 1;
+
+  if (scl && !i2c_scl)
+  {
+    i2c_recovery_clocks++;
+    if (i2c_sda_stuck)
+      i2c_sda_stuck--;
+  }
+  if (i2c_sda_stuck)
+    sda=0;
+  if (scl && i2c_scl && sda && !i2c_sda)
+    ht16k33_sim_stop();
+  i2c_scl=scl;
+  i2c_sda=sda;
+  sim_port2.IN=(sim_port2.IN & ~((1U<<SCL_PIN) | (1U<<SDA_PIN))) |
+               ((uint32_t)scl<<SCL_PIN) | ((uint32_t)sda<<SDA_PIN);
+}
+
+/* i2c_start
+ * start condition and address byte (8 bit form, as the firmware uses).
+ * Returns 0 if the transfer has hung.
+ */
+static int
+i2c_start(const I2C_MASTER_t* handle, uint32_t address, int read)
+{
+  i2c_transfers++;
+  if (!i2c_hung && !i2c_sda_stuck && i2c_fault_every && ((i2c_transfers % i2c_fault_every)==0))
+  {
+    if ((i2c_faults_nack+i2c_faults_sda) & 1)
+    {
+      i2c_faults_sda++;
+      i2c_sda_stuck=1+(int)(i2c_faults_sda % 9);
+      i2c_pins();
+    }
+    else
+    {
+      i2c_faults_nack++;
+      i2c_flags|=XMC_I2C_CH_STATUS_FLAG_NACK_RECEIVED;
+      i2c_hung=1;
+    }
+    if (sim_verbose)
+      printf("[%8.3f ms] i2c: fault injected, %s\n", sim_now_ns/1e6, i2c_hung ? "NACK" : "SDA held low");
+  }
+  if (i2c_sda_stuck)
+    i2c_hung=1;
+  if (i2c_hung)
+    return(0);
+  i2c_occupy(handle, 1+9);
+  if (!ht16k33_sim_start((uint8_t)(address>>1), read))
+    i2c_nacks++;
+  return(1);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+DAVE_STATUS_t
+DAVE_Init(void)
+{
+  sim_port0.IN=BUTTON_PINS;
+  sim_port0.OUT=0;
+  return(DAVE_STATUS_SUCCESS);
+}
+
+void
+initialise_monitor_handles(void)
+{
+}
+
+/* sim_set_button
+ * presses (down=1) or releases button idx, 0-4 for the
+ * rows and 5 for the computer button. With DO_KEYSCAN the
+ * buttons are on the HT16K33 key matrix instead of the pins.
+ */
+void
+sim_set_button(int idx, int down)
+{
+#ifdef DO_KEYSCAN
+  ht16k33_sim_key(idx, down);
+#else
+  if (down)
+    sim_port0.IN&=~(1U<<idx);
+  else
+    sim_port0.IN|=(1U<<idx);
+#endif
+}
+
+/* sim_set_int
+ * the HT16K33 ROW15/INT pin, wired to the button 1 input
+ */
+void
+sim_set_int(int high)
+{
+  if (high)
+    sim_port0.IN|=(1U<<button1.gpio_pin);
+  else
+    sim_port0.IN&=~(1U<<button1.gpio_pin);
+}
+
+/*************** DIGITAL_IO ***************/
+uint32_t
+DIGITAL_IO_GetInput(const DIGITAL_IO_t *const handler)
+{
+  return((handler->gpio_port->IN>>handler->gpio_pin) & 0x01U);
+}
+
+void
+DIGITAL_IO_SetOutputHigh(const DIGITAL_IO_t *const handler)
+{
+  handler->gpio_port->OUT|=(1U<<handler->gpio_pin);
+}
+
+void
+DIGITAL_IO_SetOutputLow(const DIGITAL_IO_t *const handler)
+{
+  handler->gpio_port->OUT&=~(1U<<handler->gpio_pin);
+}
+
+void
+DIGITAL_IO_ToggleOutput(const DIGITAL_IO_t *const handler)
+{
+  handler->gpio_port->OUT^=(1U<<handler->gpio_pin);
+}
+
+/*************** XMC_GPIO ***************/
+void
+XMC_GPIO_SetMode(XMC_GPIO_PORT_t *const port, const uint8_t pin, const XMC_GPIO_MODE_t mode)
+{
+  if (port!=&sim_port2)
+    return;
+  if (mode==XMC_GPIO_MODE_OUTPUT_OPEN_DRAIN)
+    i2c_gpio_pins|=(1U<<pin);
+  else
+    i2c_gpio_pins&=~(1U<<pin);
+  i2c_pins();
+}
+
+void
+XMC_GPIO_SetOutputHigh(XMC_GPIO_PORT_t *const port, const uint8_t pin)
+{
+  port->OUT|=(1U<<pin);
+  if (port==&sim_port2)
+    i2c_pins();
+}
+
+void
+XMC_GPIO_SetOutputLow(XMC_GPIO_PORT_t *const port, const uint8_t pin)
+{
+  port->OUT&=~(1U<<pin);
+  if (port==&sim_port2)
+    i2c_pins();
+}
+
+uint32_t
+XMC_GPIO_GetInput(XMC_GPIO_PORT_t *const port, const uint8_t pin)
+{
+  return((port->IN>>pin) & 0x01U);
+}
+
+/*************** I2C_MASTER ***************/
+/* I2C_MASTER_Init
+ * gives the pins back to the USIC
+ */
+I2C_MASTER_STATUS_t
+I2C_MASTER_Init(const I2C_MASTER_t *const handle)
+{
+  (void)handle;
+  i2c_inits++;
+  i2c_gpio_pins=0;
+  i2c_pins();
+  return(I2C_MASTER_STATUS_SUCCESS);
+}
+
+I2C_MASTER_STATUS_t
+I2C_MASTER_Transmit(I2C_MASTER_t *handle, bool send_start, const uint32_t address,
+                    uint8_t *data, const uint32_t size, bool send_stop)
+{
+  uint32_t i;
+  unsigned long frames=ht16k33_frames;
+  uint64_t start=(i2c_busy_until>sim_now_ns) ? i2c_busy_until : sim_now_ns;
+
+  if (send_start)
+    i2c_start(handle, address, 0);
+  if (i2c_hung)
+    return(I2C_MASTER_STATUS_SUCCESS);
+  for (i=0; i<size; i++)
+  {
+    I2C_MASTER_TransmitByte(handle, data[i]);
+  }
+  if (send_stop)
+    I2C_MASTER_SendStop(handle);
+  if (ht16k33_frames!=frames)
+    i2c_frame_ns+=i2c_busy_until-start;
+  i2c_event_ns=i2c_busy_until;
+  i2c_event=handle->tx_cbhandler;
+  return(I2C_MASTER_STATUS_SUCCESS);
+}
+
+I2C_MASTER_STATUS_t
+I2C_MASTER_Receive(I2C_MASTER_t *handle, bool send_start, const uint32_t address,
+                   uint8_t *data, const uint32_t count, bool send_stop, bool send_nack)
+{
+  uint32_t i;
+
+  (void)send_nack;
+  if (send_start)
+    i2c_start(handle, address, 1);
+  if (i2c_hung)
+    return(I2C_MASTER_STATUS_SUCCESS);
+  for (i=0; i<count; i++)
+  {
+    i2c_occupy(handle, 9);
+    i2c_bytes++;
+    data[i]=ht16k33_sim_read();
+  }
+  if (send_stop)
+    I2C_MASTER_SendStop(handle);
+  i2c_event_ns=i2c_busy_until;
+  i2c_event=handle->rx_cbhandler;
+  return(I2C_MASTER_STATUS_SUCCESS);
+}
+
+void
+I2C_MASTER_SendStart(const I2C_MASTER_t *const handle, uint32_t address, XMC_I2C_CH_CMD_t cmd)
+{
+  i2c_start(handle, address, cmd==XMC_I2C_CH_CMD_READ);
+}
+
+void
+I2C_MASTER_SendRepeatedStart(const I2C_MASTER_t *const handle, uint32_t address, XMC_I2C_CH_CMD_t cmd)
+{
+  i2c_start(handle, address, cmd==XMC_I2C_CH_CMD_READ);
+}
+
+void
+I2C_MASTER_TransmitByte(const I2C_MASTER_t *const handle, uint8_t byte)
+{
+  if (i2c_hung)
+    return;
+  i2c_occupy(handle, 9);
+  i2c_bytes++;
+  ht16k33_sim_write(byte);
+}
+
+void
+I2C_MASTER_SendStop(const I2C_MASTER_t *const handle)
+{
+  if (i2c_hung)
+    return;
+  i2c_occupy(handle, 1);
+  ht16k33_sim_stop();
+}
+
+/* I2C_MASTER_IsTxBusy
+ * busy until the last bit has gone out, or for good if the transfer
+ * has hung. Nothing in the firmware spins on this any more (see
+ * i2cq.c), so it doesn't move the clock on.
+ */
+bool
+I2C_MASTER_IsTxBusy(I2C_MASTER_t *const handle)
+{
+  (void)handle;
+  return(i2c_hung || (i2c_busy_until>sim_now_ns));
+}
+
+bool
+I2C_MASTER_IsRxBusy(I2C_MASTER_t *const handle)
+{
+  return(I2C_MASTER_IsTxBusy(handle));
+}
+
+I2C_MASTER_STATUS_t
+I2C_MASTER_AbortTransmit(const I2C_MASTER_t *const handle)
+{
+  (void)handle;
+  i2c_hung=0;
+  i2c_event_ns=0;
+  return(I2C_MASTER_STATUS_SUCCESS);
+}
+
+I2C_MASTER_STATUS_t
+I2C_MASTER_AbortReceive(const I2C_MASTER_t *const handle)
+{
+  (void)handle;
+  i2c_hung=0;
+  i2c_event_ns=0;
+  return(I2C_MASTER_STATUS_SUCCESS);
+}
+
+uint32_t
+I2C_MASTER_GetFlagStatus(const I2C_MASTER_t *handle, uint32_t flagtype)
+{
+  (void)handle;
+  return(i2c_flags & flagtype);
+}
+
+void
+I2C_MASTER_ClearFlag(const I2C_MASTER_t *handle, uint32_t flagtype)
+{
+  (void)handle;
+  i2c_flags&=~flagtype;
+}
+
+/* i2c_sim_event_due
+ * when the next end of transfer callback is due, or 0
+ */
+uint64_t
+i2c_sim_event_due(void)
+{
+  return(i2c_event_ns);
+}
+
+/* i2c_sim_event
+ * runs the end of transfer callback. Called by sim.c, as an interrupt
+ */
+void
+i2c_sim_event(void)
+{
+  void (*fn)(void)=i2c_event;
+
+  i2c_event_ns=0;
+  i2c_event=NULL;
+  if (fn!=NULL)
+    fn();
+}
+
+/*************** PWM_CCU4 ***************/
+void
+PWM_CCU4_Start(PWM_CCU4_t *const handle_ptr)
+{
+  handle_ptr->running=true;
+  tones++;
+}
+
+void
+PWM_CCU4_Stop(PWM_CCU4_t *const handle_ptr)
+{
+  handle_ptr->running=false;
+}
+
+PWM_CCU4_STATUS_t
+PWM_CCU4_SetFreq(PWM_CCU4_t *const handle_ptr, uint32_t pwm_freq_hz)
+{
+  handle_ptr->frequency=pwm_freq_hz;
+  return(PWM_CCU4_STATUS_SUCCESS);
+}
+
+void
+dave_host_report(void)
+{
+  printf("i2c: %lu transfers, %lu bytes, %lu nacks, bus busy %.1f ms (%.1f%%) at %lu baud\n",
+         i2c_transfers, i2c_bytes, i2c_nacks, i2c_busy_ns/1e6,
+         sim_now_ns ? 100.0*i2c_busy_ns/sim_now_ns : 0.0, (unsigned long)i2c_bus.baudrate);
+  if (ht16k33_frames)
+    printf("i2c: a display RAM write takes %.0f us on the bus on average, enough for %.0f a second\n",
+           i2c_frame_ns/1e3/ht16k33_frames, 1e9*ht16k33_frames/i2c_frame_ns);
+  if (i2c_fault_every)
+    printf("i2c: %lu faults injected (%lu NACKs, %lu with SDA held low), %lu re-inits, %lu recovery clocks\n",
+           i2c_faults_nack+i2c_faults_sda, i2c_faults_nack, i2c_faults_sda, i2c_inits,
+           i2c_recovery_clocks);
+  printf("tones: %lu\n", tones);
+}
@@ -0,0 +1,262 @@
+/***********************************************************
+ * distbench.c
+ * A tournament between the ways the computer can play Nim on the
+ * device's boards, as pocket-nim plays it (the last stick loses):
+ *  - tables: distance_choose() (pocket-nim/distance.c), the
+ *    quickest win or the slowest loss, from distance_data.h
+ *  - any win: nimk_choose() with k=1 (pocket-nim/nimk.c), which
+ *    like computer_choose() takes a winning move with no thought
+ *    for how long the game will last, and when it has none takes
+ *    a stick from the longest row
+ *  - random: a random number of sticks from a random row, like the
+ *    sim's auto-player
+ * Each pairing plays the given number of games, taking turns to go
+ * first, from the level's rows (random on levels 4 and 5). It
+ * prints how often the first engine won, and how long the games
+ * were, the ones it won and the ones it lost.
+ *
+ * Every move from the tables is checked against nimk_lost(), and
+ * the time for a move both ways is taken on random positions of
+ * level 5.
+ *
+ * usage: distbench [-n games] [-m moves] [-r seed]
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "nim.h"
+#include "nimk.h"
+#include "distance.h"
+#include "distance_data.h"
+
+/********* definitions *****************/
+#define TABLES 0
+#define ANY_WIN 1
+#define RANDOM 2
+#define POOL 4096
+
+/*************** types ***********************/
+typedef struct
+{
+  const char* name;
+  unsigned char rows;
+  unsigned char fixed[DISTANCE_ROWS]; // or 0s for random rows of 1 to 8
+} board_t;
+
+/******** global variables **************/
+const board_t boards[]=
+{
+  {"level 1", 3, {1, 3, 5}},
+  {"levels 2, 3", 4, {1, 3, 5, 7}},
+  {"level 4", 4, {0}},
+  {"level 5", 5, {0}},
+};
+const char* engine_names[]={"tables", "any win", "random"};
+const int pairings[][2]={{TABLES, RANDOM}, {ANY_WIN, RANDOM}, {TABLES, ANY_WIN}};
+int num_games=20000;
+int num_moves=1000000;
+int bad=0;
+volatile unsigned sink;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static double
+now_s(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec+ts.tv_nsec/1e9);
+}
+
+/* lost
+ * nimk_lost() for the device's rows
+ */
+static int
+lost(const unsigned char* sticks, int rows)
+{
+  uint32_t heaps[DISTANCE_ROWS];
+  int i;
+
+  for (i=0; i<rows; i++)
+    heaps[i]=sticks[i];
+  return(nimk_lost(heaps, (unsigned char)rows, 1, 1));
+}
+
+/* move
+ * one move by an engine
+ */
+static void
+move(int engine, unsigned char* sticks, int rows)
+{
+  uint32_t heaps[DISTANCE_ROWS], after[DISTANCE_ROWS];
+  unsigned char row, left;
+  int i, won;
+
+  switch (engine)
+  {
+    case TABLES:
+      won=distance_choose(sticks, (unsigned char)rows, &row, &left);
+      if (won!=!lost(sticks, rows))
+        bad++;
+      sticks[row]=left;
+      if (won && !lost(sticks, rows))
+        bad++;
+      break;
+    case ANY_WIN:
+      for (i=0; i<rows; i++)
+        heaps[i]=sticks[i];
+      nimk_choose(heaps, (unsigned char)rows, 1, 1, after);
+      for (i=0; i<rows; i++)
+        sticks[i]=(unsigned char)after[i];
+      break;
+    default:
+      do
+      {
+        row=(unsigned char)(rand()%rows);
+      } while (sticks[row]==0);
+      sticks[row]-=(unsigned char)(1+rand()%sticks[row]);
+      break;
+  }
+}
+
+/* play
+ * a game between two engines, e[first] going first. Returns the one
+ * that won, with the number of moves in *moves
+ */
+static int
+play(const board_t* b, const int* e, int first, int* moves)
+{
+  unsigned char sticks[DISTANCE_ROWS];
+  int i, total=0, turn=first;
+
+  for (i=0; i<b->rows; i++)
+  {
+    sticks[i]=b->fixed[i] ? b->fixed[i] : (unsigned char)(1+rand()%8);
+    total+=sticks[i];
+  }
+  *moves=0;
+  for (;;)
+  {
+    move(e[turn], sticks, b->rows);
+    (*moves)++;
+    for (total=0, i=0; i<b->rows; i++)
+      total+=sticks[i];
+    if (total==0)
+      return(1-turn); // took the last stick
+    turn=1-turn;
+  }
+}
+
+/* time_moves
+ * the time for a move both ways, on random positions of level 5
+ */
+static void
+time_moves(void)
+{
+  unsigned char* pos;
+  uint32_t heaps[DISTANCE_ROWS], after[DISTANCE_ROWS];
+  unsigned char row, left;
+  int p, i;
+  double t0, table_ns, any_ns;
+
+  pos=malloc(POOL*DISTANCE_ROWS);
+  for (p=0; p<POOL*DISTANCE_ROWS; p++)
+    pos[p]=(unsigned char)(rand()%9);
+  t0=now_s();
+  for (p=0; p<num_moves; p++)
+  {
+    distance_choose(pos+(p%POOL)*DISTANCE_ROWS, DISTANCE_ROWS, &row, &left);
+    sink+=row;
+  }
+  table_ns=(now_s()-t0)*1e9/num_moves;
+  t0=now_s();
+  for (p=0; p<num_moves; p++)
+  {
+    for (i=0; i<DISTANCE_ROWS; i++)
+      heaps[i]=pos[(p%POOL)*DISTANCE_ROWS+i];
+    nimk_choose(heaps, DISTANCE_ROWS, 1, 1, after);
+    sink+=after[0];
+  }
+  any_ns=(now_s()-t0)*1e9/num_moves;
+  printf("a move on 5 rows of up to 8: tables %.1f ns (%d lookups at most), any win %.1f ns\n",
+         table_ns, 5*8, any_ns);
+  free(pos);
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  const board_t* b;
+  unsigned long seed=1;
+  unsigned i, p;
+  int c, g, winner, moves, won, won_moves, lost_moves, all_moves;
+
+  while ((c=getopt(argc, argv, "n:m:r:"))!=-1)
+  {
+    switch(c)
+    {
+      case 'n':
+        num_games=atoi(optarg);
+        break;
+      case 'm':
+        num_moves=atoi(optarg);
+        break;
+      case 'r':
+        seed=strtoul(optarg, NULL, 0);
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n games] [-m moves] [-r seed]\n", argv[0]);
+        return(2);
+    }
+  }
+  if (num_games<2)
+    num_games=2;
+  if (num_moves<1)
+    num_moves=1;
+  srand(seed);
+
+  printf("%d games a pairing, misere (the last stick loses), tables of %d bytes\n", num_games,
+         DISTANCE_POSITIONS);
+  printf("  board        engine   against   won %%  moves  when won  when lost\n");
+  for (i=0; i<sizeof(boards)/sizeof(boards[0]); i++)
+  {
+    b=&boards[i];
+    for (p=0; p<sizeof(pairings)/sizeof(pairings[0]); p++)
+    {
+      won=won_moves=lost_moves=all_moves=0;
+      for (g=0; g<num_games; g++)
+      {
+        winner=play(b, pairings[p], g & 1, &moves);
+        all_moves+=moves;
+        if (winner==0)
+        {
+          won++;
+          won_moves+=moves;
+        }
+        else
+        {
+          lost_moves+=moves;
+        }
+      }
+      printf("  %-11s  %-7s  %-7s  %6.1f  %5.2f  %8.2f  %9.2f\n", (p==0) ? b->name : "",
+             engine_names[pairings[p][0]], engine_names[pairings[p][1]], won*100.0/num_games,
+             (double)all_moves/num_games, won ? (double)won_moves/won : 0.0,
+             (won<num_games) ? (double)lost_moves/(num_games-won) : 0.0);
+    }
+  }
+  time_moves();
+  printf("moves from the tables against nimk_lost(): %d wrong\n", bad);
+  return(bad ? 1 : 0);
+}
@@ -0,0 +1,262 @@
+/***********************************************************
+ * flash_sim.c
+ * A model of the XMC1100 flash for the host simulation,
+ * behind the XMCLib flash calls (include/xmc_flash.h).
+ *
+ * It models what matters to code that stores data in flash:
+ *  - erased flash reads as zero, and a 16 byte block may only
+ *    be written once between erases (a second write is counted
+ *    as a protocol error and leaves the block corrupt)
+ *  - erase and write take time, during which the CPU is stalled,
+ *    and the interrupts with it: the tick runs late and loses
+ *    the ticks in between
+ *  - each page survives a limited number of erases, after which
+ *    writes to it fail verification
+ * The timings and endurance are nominal figures; check them
+ * against the data sheet for anything critical.
+ *
+ * The image, with the erase counts, can be kept in a file (-F)
+ * so that runs of the simulation see what earlier ones stored,
+ * like power cycles of the real thing.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <DAVE.h>
+#include <xmc_flash.h>
+#include "sim.h"
+
+/********* definitions *****************/
+#define FLASH_SIZE 0x10000U
+#define FLASH_PAGES (FLASH_SIZE/XMC_FLASH_BYTES_PER_PAGE)
+#define FLASH_FILE_MAGIC 0x484c4646 // "FFLH"
+
+/******** global variables **************/
+uint8_t flash_mem[FLASH_SIZE];
+uint32_t flash_erases[FLASH_PAGES];
+uint32_t flash_status=0;
+
+uint64_t flash_erase_ns=7000000ULL; // per page
+uint64_t flash_write_ns=110000ULL;  // per block
+uint32_t flash_endurance=50000;     // erase cycles per page
+
+unsigned long flash_pages_erased=0;
+unsigned long flash_blocks_written=0;
+unsigned long flash_blocks_read=0;
+unsigned long flash_protocol_errors=0;
+unsigned long flash_verify_errors=0;
+uint64_t flash_busy_ns=0;
+const char* flash_file=NULL;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* flash_offset
+ * converts a firmware flash address to an offset into flash_mem.
+ * Returns FLASH_SIZE if it is outside the flash.
+ */
+static uint32_t
+flash_offset(const uint32_t* address, uint32_t len)
+{
+  uint32_t a=(uint32_t)(uintptr_t)address;
+  if ((a<XMC_FLASH_BASE) || (a-XMC_FLASH_BASE+len>FLASH_SIZE))
+  {
+    fprintf(stderr, "flash: access outside flash at 0x%08x\n", a);
+    return(FLASH_SIZE);
+  }
+  return(a-XMC_FLASH_BASE);
+}
+
+static int
+is_blank(const uint8_t* p, uint32_t len)
+{
+  uint32_t i;
+  for (i=0; i<len; i++)
+  {
+    if (p[i]!=0)
+      return(0);
+  }
+  return(1);
+}
+
+/* flash_busy
+ * the CPU waits for the flash, and the interrupts with it (see
+ * sim_stall)
+ */
+static void
+flash_busy(uint64_t ns)
+{
+  flash_busy_ns+=ns;
+  sim_stall(ns);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+void
+XMC_FLASH_ClearStatus(void)
+{
+  flash_status=0;
+}
+
+uint32_t
+XMC_FLASH_GetStatus(void)
+{
+  return(flash_status);
+}
+
+bool
+XMC_FLASH_IsBusy(void)
+{
+  return(false); // the operations below only return once they are done
+}
+
+void
+XMC_FLASH_ErasePages(uint32_t *address, uint32_t num_pages)
+{
+  uint32_t off=flash_offset(address, num_pages*XMC_FLASH_BYTES_PER_PAGE);
+  uint32_t page;
+
+  if ((off==FLASH_SIZE) || (off % XMC_FLASH_BYTES_PER_PAGE))
+  {
+    flash_status|=XMC_FLASH_STATUS_WRITE_PROTOCOL_ERROR;
+    return;
+  }
+  for (page=off/XMC_FLASH_BYTES_PER_PAGE; num_pages>0; page++, num_pages--)
+  {
+    memset(&flash_mem[page*XMC_FLASH_BYTES_PER_PAGE], 0, XMC_FLASH_BYTES_PER_PAGE);
+    flash_erases[page]++;
+    flash_pages_erased++;
+    flash_busy(flash_erase_ns);
+    if (sim_verbose)
+      printf("[%8.3f ms] flash: erased page at 0x%08x (%u erases)\n", sim_now_ns/1e6,
+             XMC_FLASH_BASE+page*XMC_FLASH_BYTES_PER_PAGE, flash_erases[page]);
+  }
+}
+
+void
+XMC_FLASH_WriteBlocks(uint32_t *address, const uint32_t *data, uint32_t num_blocks, bool verify)
+{
+  uint32_t off=flash_offset(address, num_blocks*XMC_FLASH_BYTES_PER_BLOCK);
+  uint8_t* p;
+  uint32_t page;
+  uint32_t i;
+
+  flash_status&=~(uint32_t)(XMC_FLASH_STATUS_VERIFY_ERROR | XMC_FLASH_STATUS_ECC1_READ_ERROR);
+  if ((off==FLASH_SIZE) || (off % XMC_FLASH_BYTES_PER_BLOCK))
+  {
+    flash_status|=XMC_FLASH_STATUS_WRITE_PROTOCOL_ERROR;
+    return;
+  }
+  for (; num_blocks>0; num_blocks--, off+=XMC_FLASH_BYTES_PER_BLOCK, data+=XMC_FLASH_WORDS_PER_BLOCK)
+  {
+    p=&flash_mem[off];
+    page=off/XMC_FLASH_BYTES_PER_PAGE;
+    flash_blocks_written++;
+    flash_busy(flash_write_ns);
+    if (!is_blank(p, XMC_FLASH_BYTES_PER_BLOCK))
+    {
+      // programming can only set bits, and the ECC no longer matches
+      flash_protocol_errors++;
+      for (i=0; i<XMC_FLASH_BYTES_PER_BLOCK; i++)
+        p[i]|=((const uint8_t*)data)[i];
+      flash_status|=XMC_FLASH_STATUS_VERIFY_ERROR;
+      continue;
+    }
+    memcpy(p, data, XMC_FLASH_BYTES_PER_BLOCK);
+    if (flash_erases[page]>flash_endurance)
+    {
+      // worn out: the cells no longer hold what was written
+      p[flash_erases[page] % XMC_FLASH_BYTES_PER_BLOCK]^=0x10;
+      flash_verify_errors++;
+      if (verify)
+        flash_status|=XMC_FLASH_STATUS_VERIFY_ERROR;
+    }
+  }
+}
+
+void
+XMC_FLASH_ReadBlocks(uint32_t *address, uint32_t *data, uint32_t num_blocks)
+{
+  uint32_t off=flash_offset(address, num_blocks*XMC_FLASH_BYTES_PER_BLOCK);
+  if (off==FLASH_SIZE)
+  {
+    memset(data, 0, num_blocks*XMC_FLASH_BYTES_PER_BLOCK);
+    return;
+  }
+  memcpy(data, &flash_mem[off], num_blocks*XMC_FLASH_BYTES_PER_BLOCK);
+  flash_blocks_read+=num_blocks;
+}
+
+/* flash_sim_load
+ * loads the flash image and erase counts kept by an earlier run.
+ * A missing file is a factory fresh part.
+ */
+void
+flash_sim_load(const char* path)
+{
+  FILE* fp;
+  uint32_t magic=0;
+
+  flash_file=path;
+  fp=fopen(path, "rb");
+  if (fp==NULL)
+    return;
+  if ((fread(&magic, sizeof(magic), 1, fp)!=1) || (magic!=FLASH_FILE_MAGIC) ||
+      (fread(flash_mem, 1, FLASH_SIZE, fp)!=FLASH_SIZE) ||
+      (fread(flash_erases, sizeof(flash_erases), 1, fp)!=1))
+  {
+    fprintf(stderr, "flash: %s is not a flash image, starting blank\n", path);
+    memset(flash_mem, 0, sizeof(flash_mem));
+    memset(flash_erases, 0, sizeof(flash_erases));
+  }
+  fclose(fp);
+}
+
+/* flash_sim_report
+ * prints the activity and the wear of the pages that have been
+ * erased, and saves the image if there is a file for it
+ */
+void
+flash_sim_report(void)
+{
+  FILE* fp;
+  uint32_t magic=FLASH_FILE_MAGIC;
+  uint32_t i, lo=0xffffffffUL, hi=0, used=0;
+  uint64_t total=0;
+
+  for (i=0; i<FLASH_PAGES; i++)
+  {
+    if (flash_erases[i]==0)
+      continue;
+    used++;
+    total+=flash_erases[i];
+    if (flash_erases[i]<lo)
+      lo=flash_erases[i];
+    if (flash_erases[i]>hi)
+      hi=flash_erases[i];
+  }
+  printf("flash: %lu pages erased, %lu blocks written, %lu read, busy %.1f ms, "
+         "%lu protocol errors, %lu worn writes\n",
+         flash_pages_erased, flash_blocks_written, flash_blocks_read, flash_busy_ns/1e6,
+         flash_protocol_errors, flash_verify_errors);
+  if (used)
+    printf("flash: wear over %u erased pages: min %u, max %u, mean %.1f erases (endurance %u)\n",
+           used, lo, hi, (double)total/used, flash_endurance);
+  if (flash_file==NULL)
+    return;
+  fp=fopen(flash_file, "wb");
+  if (fp==NULL)
+  {
+    perror(flash_file);
+    return;
+  }
+  fwrite(&magic, sizeof(magic), 1, fp);
+  fwrite(flash_mem, 1, FLASH_SIZE, fp);
+  fwrite(flash_erases, sizeof(flash_erases), 1, fp);
+  fclose(fp);
+}
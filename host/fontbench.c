@@ -0,0 +1,247 @@
+/***********************************************************
+ * fontbench.c
+ * Reports the flash the font takes, packed as font_data.h has
+ * it (see pocket-nim/font.h), against the old alpha_bitmap[]
+ * of 7 bytes a glyph, and times getting the glyphs out:
+ *  - a row at a time with FONT_ROW, a load and a shift, as
+ *    scroll_slice() does
+ *  - a byte a row, from a 7 byte a glyph table of the same
+ *    glyphs, as alpha_bitmap[] was
+ *  - a bit at a time, which is what the packing would cost
+ *    without FONT_ROW
+ * The glyphs are pulled out each way and checked to be the
+ * same, then each is timed over random text. A glyph is
+ * looked up in font_ranges as font_glyph() in main.c does, and
+ * its 7 rows read. The times are host CPU cycles (the time
+ * stamp counter, on x86) per glyph, so they show the cost as a
+ * ratio rather than as Cortex-M0 cycles.
+ *
+ * usage: fontbench [-n characters] [-r seed]
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "font_data.h"
+
+/********* definitions *****************/
+#define REPEATS 200
+// the font before font_data.h, alpha_bitmap[] in main.c
+#define OLD_GLYPHS 59
+#define OLD_BYTES (OLD_GLYPHS*FONT_HEIGHT)
+
+/******** global variables **************/
+uint8_t byte_table[FONT_GLYPHS*FONT_HEIGHT];
+char* text;
+int num_chars=10000;
+volatile uint8_t sink;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static uint64_t
+cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return(__builtin_ia32_rdtsc());
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((uint64_t)ts.tv_sec*1000000000ULL+(uint64_t)ts.tv_nsec);
+#endif
+}
+
+/* glyph_of
+ * the glyph number for c, as font_glyph() in main.c finds it
+ */
+static unsigned int
+glyph_of(char c)
+{
+  unsigned char code=(unsigned char)c;
+  unsigned char i;
+
+  for (;;)
+  {
+    for (i=0; i<FONT_RANGES; i++)
+    {
+      if ((code>=font_ranges[i].first) && (code<=font_ranges[i].last))
+        return((unsigned int)(font_ranges[i].glyph+code-font_ranges[i].first));
+    }
+    if (code==(unsigned char)FONT_MISSING)
+      return(0);
+    code=(unsigned char)FONT_MISSING;
+  }
+}
+
+/* bit_row
+ * row y of glyph g, a bit at a time
+ */
+static uint8_t
+bit_row(unsigned int g, int y)
+{
+  unsigned int b=g*FONT_BITS+y*FONT_WIDTH;
+  uint8_t row=0;
+  int x;
+
+  for (x=0; x<FONT_WIDTH; x++, b++)
+  {
+    if (font_bits[b>>3] & (1<<(b & 7)))
+      row|=(uint8_t)(1<<x);
+  }
+  return(row);
+}
+
+static uint8_t
+decode_packed(char c)
+{
+  unsigned int idx=glyph_of(c)*FONT_BITS;
+  uint8_t acc=0;
+  int y;
+
+  for (y=0; y<FONT_HEIGHT; y++)
+    acc^=FONT_ROW(idx, y);
+  return(acc);
+}
+
+static uint8_t
+decode_bytes(char c)
+{
+  unsigned int idx=glyph_of(c)*FONT_HEIGHT;
+  uint8_t acc=0;
+  int y;
+
+  for (y=0; y<FONT_HEIGHT; y++)
+    acc^=byte_table[idx+y];
+  return(acc);
+}
+
+static uint8_t
+decode_bits(char c)
+{
+  unsigned int g=glyph_of(c);
+  uint8_t acc=0;
+  int y;
+
+  for (y=0; y<FONT_HEIGHT; y++)
+    acc^=bit_row(g, y);
+  return(acc);
+}
+
+/* check
+ * makes the byte table a bit at a time, and returns the number of
+ * glyphs FONT_ROW gets out differently
+ */
+static int
+check(void)
+{
+  unsigned int g;
+  int y, bad=0;
+
+  for (g=0; g<FONT_GLYPHS; g++)
+  {
+    for (y=0; y<FONT_HEIGHT; y++)
+    {
+      byte_table[g*FONT_HEIGHT+y]=bit_row(g, y);
+      if (FONT_ROW(g*FONT_BITS, y)!=byte_table[g*FONT_HEIGHT+y])
+      {
+        bad++;
+        break;
+      }
+    }
+  }
+  return(bad);
+}
+
+/* make_text
+ * random characters, mostly ones the font has
+ */
+static void
+make_text(unsigned long seed)
+{
+  int i;
+
+  srand(seed);
+  text=malloc(num_chars);
+  for (i=0; i<num_chars; i++)
+  {
+    text[i]=(char)(rand()%8 ? 0x20+rand()%0x5f : rand()%256);
+  }
+}
+
+/* time_it
+ * cycles per glyph, over the text REPEATS times
+ */
+static double
+time_it(uint8_t (*fn)(char))
+{
+  uint64_t t0, t1;
+  int i, k;
+
+  t0=cycles();
+  for (k=0; k<REPEATS; k++)
+  {
+    for (i=0; i<num_chars; i++)
+    {
+      sink^=fn(text[i]);
+    }
+  }
+  t1=cycles();
+  return((double)(t1-t0)/((double)REPEATS*num_chars));
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  int c, bad, packed_bytes;
+  unsigned long seed=1;
+  double packed, bytes, bits;
+
+  while ((c=getopt(argc, argv, "n:r:"))!=-1)
+  {
+    switch(c)
+    {
+      case 'n':
+        num_chars=atoi(optarg);
+        break;
+      case 'r':
+        seed=strtoul(optarg, NULL, 0);
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n characters] [-r seed]\n", argv[0]);
+        return(2);
+    }
+  }
+  if (num_chars<1)
+    num_chars=1;
+  make_text(seed);
+  bad=check();
+
+  packed_bytes=(int)(sizeof(font_bits)+sizeof(font_ranges));
+  printf("flash: old font %d glyphs in %d bytes (%.2f a glyph)\n",
+         OLD_GLYPHS, OLD_BYTES, (double)OLD_BYTES/OLD_GLYPHS);
+  printf("       packed   %d glyphs in %d bytes (%.2f a glyph), %d of glyphs and %d of %d ranges\n",
+         FONT_GLYPHS, packed_bytes, (double)packed_bytes/FONT_GLYPHS,
+         (int)sizeof(font_bits), (int)sizeof(font_ranges), FONT_RANGES);
+  printf("       %d glyphs at 7 bytes each would be %d bytes\n",
+         FONT_GLYPHS, FONT_GLYPHS*FONT_HEIGHT);
+
+  bytes=time_it(decode_bytes);
+  packed=time_it(decode_packed);
+  bits=time_it(decode_bits);
+  printf("decode, %d characters:\n", num_chars);
+  printf("  a byte a row (7 a glyph):  %6.1f cycles per glyph\n", bytes);
+  printf("  packed, FONT_ROW:          %6.1f cycles per glyph\n", packed);
+  printf("  packed, a bit at a time:   %6.1f cycles per glyph\n", bits);
+  printf("%d glyphs decoded differently\n", bad);
+  return(bad ? 1 : 0);
+}
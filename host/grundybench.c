@@ -0,0 +1,212 @@
+/***********************************************************
+ * grundybench.c
+ * Builds the Grundy value tables of some octal games with
+ * grundy.c, and times it and the moves made from them:
+ *  - the table to length n (10^6 by default), with the time, how
+ *    many values were worked out from the moves before the period
+ *    was found, and the period
+ *  - the first values checked against working every one out from
+ *    the moves, without looking for a period
+ *  - grundy_choose() on random positions of 3 to 5 rows up to n
+ *    long, with every winning move checked to leave a position
+ *    worth 0
+ * The games are Kayles (0.77), Dawson's chess (0.137), Dawson's
+ * Kayles (0.07), and the subtraction games {1,2,3} and {1,3,4},
+ * or those given with -g.
+ *
+ * usage: grundybench [-g rule]... [-n length] [-m moves] [-c check] [-r seed]
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "grundy.h"
+
+/********* definitions *****************/
+#define MAX_GAMES 16
+#define MAX_PERIOD 4096
+#define MAX_ROWS 5
+
+/******** global variables **************/
+const char* default_rules[]={"0.77", "0.137", "0.07", "{1,2,3}", "{1,3,4}"};
+const char* rules[MAX_GAMES];
+int num_rules=0;
+uint32_t length=1000000;
+int num_moves=100000;
+uint32_t check_len=3000;
+uint32_t last_break[MAX_PERIOD+1];
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static double
+now_s(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec+ts.tv_nsec/1e9);
+}
+
+/* check
+ * works the first values out again from the moves alone, and returns
+ * how many differ from the table, and the time it took in secs
+ */
+static uint32_t
+check(const char* rule, grundy_game_t* game, double* secs)
+{
+  grundy_game_t plain;
+  uint8_t* g;
+  uint32_t n, bad=0, len=check_len;
+  double t0;
+
+  if (len>length)
+    len=length;
+  g=malloc(len);
+  grundy_init(&plain, rule, g, len, NULL, 0);
+  t0=now_s();
+  grundy_extend(&plain, len-1);
+  *secs=now_s()-t0;
+  for (n=0; n<plain.known; n++)
+  {
+    if (g[n]!=grundy_value(game, n))
+      bad++;
+  }
+  free(g);
+  return(bad);
+}
+
+/* play
+ * random positions, and the computer's move in each. Returns the
+ * number of winning moves that didn't leave a position worth 0
+ */
+static int
+play(grundy_game_t* game, double* us, int* wins)
+{
+  uint32_t (*pos)[MAX_ROWS];
+  unsigned char* rows;
+  uint32_t after[MAX_ROWS+1];
+  grundy_move_t move;
+  int p, i, bad=0;
+  double t0;
+
+  pos=malloc(num_moves*sizeof(*pos));
+  rows=malloc(num_moves);
+  for (p=0; p<num_moves; p++)
+  {
+    rows[p]=(unsigned char)(3+rand()%3);
+    for (i=0; i<MAX_ROWS; i++)
+      pos[p][i]=1+(uint32_t)(((uint64_t)rand()*RAND_MAX+rand())%length);
+  }
+  *wins=0;
+  t0=now_s();
+  for (p=0; p<num_moves; p++)
+  {
+    *wins+=grundy_choose(game, pos[p], rows[p], &move);
+  }
+  *us=(now_s()-t0)*1e6/num_moves;
+  // ..and again, checking them
+  for (p=0; p<num_moves; p++)
+  {
+    if (!grundy_choose(game, pos[p], rows[p], &move))
+      continue;
+    memcpy(after, pos[p], sizeof(pos[p]));
+    after[move.row]=move.left;
+    after[rows[p]]=move.right;
+    if ((move.left+move.right+move.take!=pos[p][move.row]) ||
+        (grundy_sum(game, after, (unsigned char)(rows[p]+1))!=0))
+      bad++;
+  }
+  free(pos);
+  free(rows);
+  return(bad);
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  grundy_game_t game;
+  uint8_t* g;
+  int c, r, wins, bad, failed=0;
+  uint32_t mismatched;
+  unsigned long seed=1;
+  double t0, build, plain, us;
+
+  while ((c=getopt(argc, argv, "g:n:m:c:r:"))!=-1)
+  {
+    switch(c)
+    {
+      case 'g':
+        if (num_rules<MAX_GAMES)
+          rules[num_rules++]=optarg;
+        break;
+      case 'n':
+        length=(uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'm':
+        num_moves=atoi(optarg);
+        break;
+      case 'c':
+        check_len=(uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'r':
+        seed=strtoul(optarg, NULL, 0);
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-g rule]... [-n length] [-m moves] [-c check] [-r seed]\n", argv[0]);
+        return(2);
+    }
+  }
+  if (num_rules==0)
+  {
+    for (r=0; r<(int)(sizeof(default_rules)/sizeof(default_rules[0])); r++)
+      rules[num_rules++]=default_rules[r];
+  }
+  if (length<2)
+    length=2;
+  if (num_moves<1)
+    num_moves=1;
+  srand(seed);
+  g=malloc(length);
+
+  for (r=0; r<num_rules; r++)
+  {
+    if (!grundy_init(&game, rules[r], g, length, last_break, MAX_PERIOD))
+    {
+      fprintf(stderr, "%s: can't read the rule\n", rules[r]);
+      return(2);
+    }
+    t0=now_s();
+    grundy_extend(&game, length-1);
+    build=now_s()-t0;
+    printf("%-8s table to %lu in %.3f s, %lu from the moves, ", rules[r],
+           (unsigned long)game.known, build, (unsigned long)game.computed);
+    if (game.period)
+      printf("period %lu from %lu\n", (unsigned long)game.period, (unsigned long)game.preperiod);
+    else
+      printf("no period up to %d found\n", MAX_PERIOD);
+    mismatched=check(rules[r], &game, &plain);
+    if (game.known<length)
+    {
+      printf("         the values got too large at %lu, no moves tried\n", (unsigned long)game.known);
+      failed+=(mismatched!=0);
+      continue;
+    }
+    bad=play(&game, &us, &wins);
+    printf("         %d moves, %.2f us each, %d winning, %d wrong\n", num_moves, us, wins, bad);
+    printf("         %lu of the first %lu values differ from working them all out (%.3f s)\n",
+           (unsigned long)mismatched, (unsigned long)(check_len<length ? check_len : length), plain);
+    failed+=(bad!=0) || (mismatched!=0);
+  }
+  free(g);
+  return(failed ? 1 : 0);
+}
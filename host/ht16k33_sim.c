@@ -0,0 +1,324 @@
+/***********************************************************
+ * ht16k33_sim.c
+ * A model of the HT16K33 LED drivers on the I2C bus, for the
+ * host simulation. There is one for each panel of the board
+ * the firmware is built for (see display.h), at addresses
+ * 0x70 up. Each decodes the commands the firmware sends and
+ * keeps its 16 byte display RAM. Each transfer that writes
+ * display RAM is counted, and the whole board is printed
+ * (optionally) whenever what it shows changes.
+ *
+ * The first chip also models the key matrix (used with DO_KEYSCAN): the keys
+ * are scanned every KEY_SCAN_NS, a key's bit is set in the key
+ * data RAM once it is seen pressed on two scans in a row, and
+ * the INT flag (and the ROW15/INT pin, if enabled) is set while
+ * there is key data. Reading the key data clears it and INT. The
+ * scan period is a nominal figure.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "display.h"
+#include "sim.h"
+
+/********* definitions *****************/
+#define HT16K33_ADDR 0x70 // 7 bit address, 0xe0 on the wire
+#define KEY_SCAN_NS 20000000ULL
+#define RATE_WINDOW_NS 100000000ULL // for the peak frame rate
+#define KEY_LINES 3
+#define PTR_DISPLAY 0
+#define PTR_KEYS 1
+#define PTR_INT 2
+
+/********* types ***********************/
+typedef struct
+{
+  uint8_t ram[16];
+  uint8_t osc_on;
+  uint8_t display_on;
+  uint8_t blink;
+  uint8_t brightness;
+  uint8_t pointer;     // display RAM address for the next data byte
+  uint8_t first_byte;  // the next byte written is a command
+  uint8_t ram_written; // the current transfer wrote display RAM
+  uint8_t selected;
+  uint8_t read_area;   // what reads return: PTR_DISPLAY, PTR_KEYS or PTR_INT
+  uint8_t key_pointer;
+  uint8_t keys_read;   // the current transfer read key data
+  uint8_t int_pin;     // ROW15/INT is the INT output
+  uint8_t int_high;    // ..active high
+  uint16_t raw[KEY_LINES];      // keys held right now
+  uint16_t last_scan[KEY_LINES];
+  uint16_t key_ram[KEY_LINES];
+  uint8_t int_flag;
+} ht16k33_t;
+
+/******** global variables **************/
+ht16k33_t ht16k33_chip[DISPLAY_PANELS];
+ht16k33_t* ht16k33_cur=&ht16k33_chip[0]; // the one addressed in this transfer
+unsigned long ht16k33_frames=0;   // transfers that wrote display RAM
+unsigned long ht16k33_changed=0;  // ..and actually changed what is shown
+uint64_t ht16k33_window=0;        // the RATE_WINDOW_NS window frames are being counted in
+unsigned long ht16k33_window_frames=0;
+unsigned long ht16k33_peak_frames=0;
+uint8_t ht16k33_shown[DISPLAY_PANELS][16];
+uint64_t ht16k33_next_scan=KEY_SCAN_NS;
+unsigned long ht16k33_key_reads=0;
+unsigned long ht16k33_key_presses=0; // keys newly seen by a scan
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* print_frame
+ * draws the board from the display RAM of each chip, undoing the
+ * pixel mapping of plot_ram_pixel() so that the rows of sticks
+ * stand upright with row 1 on the left.
+ */
+static void
+print_frame(void)
+{
+  int x, y, bit;
+  const uint8_t* ram;
+
+  printf("[%8.3f ms] display\n", sim_now_ns/1e6);
+  for (y=DISPLAY_HEIGHT-1; y>=0; y--)
+  {
+    printf("  ");
+    for (x=0; x<DISPLAY_WIDTH; x++)
+    {
+      ram=ht16k33_chip[DISPLAY_PANEL(x, y)].ram;
+      bit=DISPLAY_BIT(x);
+      putchar((ram[(y%8)*2+bit/8] & (1<<(bit%8))) ? '#' : '.');
+    }
+    putchar('\n');
+  }
+}
+
+/* update_int
+ * drives the ROW15/INT pin from the INT flag
+ */
+static void
+update_int(void)
+{
+  ht16k33_t* h=&ht16k33_chip[0];
+
+  if (h->int_pin)
+    sim_set_int(h->int_flag ? h->int_high : !h->int_high);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* ht16k33_sim_start
+ * a start condition and address byte. Returns 1 if the
+ * device acknowledges.
+ */
+int
+ht16k33_sim_start(uint8_t addr7, int read)
+{
+  if ((addr7<HT16K33_ADDR) || (addr7>=HT16K33_ADDR+DISPLAY_PANELS))
+  {
+    ht16k33_cur->selected=0;
+    return(0);
+  }
+  ht16k33_cur=&ht16k33_chip[addr7-HT16K33_ADDR];
+  ht16k33_cur->selected=1;
+  ht16k33_cur->first_byte=!read;
+  ht16k33_cur->ram_written=0;
+  return(1);
+}
+
+/* ht16k33_sim_write
+ * a data byte written to the device
+ */
+void
+ht16k33_sim_write(uint8_t byte)
+{
+  ht16k33_t* h=ht16k33_cur;
+
+  if (!h->selected)
+    return;
+  if (!h->first_byte)
+  {
+    h->ram[h->pointer & 0x0f]=byte;
+    h->pointer=(h->pointer+1) & 0x0f;
+    h->ram_written=1;
+    return;
+  }
+  h->first_byte=0;
+  switch(byte & 0xf0)
+  {
+    case 0x00: // display data address pointer
+      h->pointer=byte & 0x0f;
+      h->read_area=PTR_DISPLAY;
+      break;
+    case 0x40: // key data address pointer
+      h->key_pointer=byte & 0x07;
+      h->read_area=PTR_KEYS;
+      break;
+    case 0x60: // INT flag address pointer
+      h->read_area=PTR_INT;
+      break;
+    case 0xa0: // ROW/INT set
+      h->int_pin=byte & 0x01;
+      h->int_high=(byte>>1) & 0x01;
+      update_int();
+      break;
+    case 0x20: // system setup
+      h->osc_on=byte & 0x01;
+      break;
+    case 0x80: // display setup
+      h->display_on=byte & 0x01;
+      h->blink=(byte>>1) & 0x03;
+      break;
+    case 0xe0: // dimming
+      h->brightness=byte & 0x0f;
+      break;
+    default:
+      break;
+  }
+}
+
+/* ht16k33_sim_read
+ * a data byte read from the device
+ */
+uint8_t
+ht16k33_sim_read(void)
+{
+  ht16k33_t* h=ht16k33_cur;
+  uint8_t byte=0xff;
+  uint8_t p;
+
+  if (!h->selected)
+    return(0xff);
+  switch(h->read_area)
+  {
+    case PTR_DISPLAY:
+      byte=h->ram[h->pointer & 0x0f];
+      h->pointer=(h->pointer+1) & 0x0f;
+      break;
+    case PTR_KEYS:
+      p=h->key_pointer;
+      if (p<2*KEY_LINES)
+        byte=(p & 1) ? (h->key_ram[p/2]>>8) : (h->key_ram[p/2] & 0xff);
+      h->key_pointer=(p+1) & 0x07;
+      h->keys_read=1;
+      break;
+    case PTR_INT:
+      byte=h->int_flag ? 0xff : 0x00;
+      break;
+    default:
+      break;
+  }
+  return(byte);
+}
+
+/* ht16k33_sim_stop
+ * a stop condition. This is where a frame is complete.
+ */
+void
+ht16k33_sim_stop(void)
+{
+  ht16k33_t* h=ht16k33_cur;
+  int p;
+
+  if (h->selected && h->ram_written)
+  {
+    ht16k33_frames++;
+    if (sim_now_ns/RATE_WINDOW_NS!=ht16k33_window)
+    {
+      ht16k33_window=sim_now_ns/RATE_WINDOW_NS;
+      ht16k33_window_frames=0;
+    }
+    if (++ht16k33_window_frames>ht16k33_peak_frames)
+      ht16k33_peak_frames=ht16k33_window_frames;
+    p=(int)(h-ht16k33_chip);
+    if (memcmp(ht16k33_shown[p], h->ram, sizeof(h->ram))!=0)
+    {
+      ht16k33_changed++;
+      memcpy(ht16k33_shown[p], h->ram, sizeof(h->ram));
+      if (sim_show_display)
+        print_frame();
+    }
+  }
+  if (h->selected && h->keys_read)
+  {
+    // the key data has been read out
+    ht16k33_key_reads++;
+    memset(h->key_ram, 0, sizeof(h->key_ram));
+    h->int_flag=0;
+    h->keys_read=0;
+    update_int();
+  }
+  h->selected=0;
+}
+
+void
+ht16k33_sim_report(void)
+{
+  int p, osc=0, on=0;
+
+  for (p=0; p<DISPLAY_PANELS; p++)
+  {
+    osc+=ht16k33_chip[p].osc_on;
+    on+=ht16k33_chip[p].display_on;
+  }
+  printf("display: %lu display RAM writes, %lu changed what was shown, osc on %d/%d, display on %d/%d, brightness %u/16\n",
+         ht16k33_frames, ht16k33_changed, osc, DISPLAY_PANELS, on, DISPLAY_PANELS,
+         ht16k33_chip[0].brightness+1);
+  printf("display: peak of %lu writes/s, over %llu ms\n",
+         ht16k33_peak_frames*(unsigned long)(1000000000ULL/RATE_WINDOW_NS),
+         (unsigned long long)(RATE_WINDOW_NS/1000000ULL));
+}
+
+/* ht16k33_sim_key
+ * presses (down=1) or releases key n: ROW n%13 on line K(1+n/13)
+ */
+void
+ht16k33_sim_key(int n, int down)
+{
+  if (down)
+    ht16k33_chip[0].raw[n/13]|=(uint16_t)(1U<<(n%13));
+  else
+    ht16k33_chip[0].raw[n/13]&=(uint16_t)~(1U<<(n%13));
+}
+
+/* ht16k33_sim_tick
+ * runs the key scans that are due. The scan only runs while the
+ * oscillator is on.
+ */
+void
+ht16k33_sim_tick(void)
+{
+  ht16k33_t* h=&ht16k33_chip[0];
+  int i;
+  uint16_t seen;
+
+  while (sim_now_ns>=ht16k33_next_scan)
+  {
+    ht16k33_next_scan+=KEY_SCAN_NS;
+    if (!h->osc_on)
+      continue;
+    for (i=0; i<KEY_LINES; i++)
+    {
+      seen=h->raw[i] & h->last_scan[i]; // two scans in a row
+      ht16k33_key_presses+=__builtin_popcount(seen & ~h->key_ram[i]);
+      h->key_ram[i]|=seen;
+      h->last_scan[i]=h->raw[i];
+      if (h->key_ram[i])
+        h->int_flag=1;
+    }
+    update_int();
+  }
+}
+
+void
+ht16k33_sim_key_report(void)
+{
+  printf("keys: INT %s, %lu key data reads, %lu presses debounced\n",
+         ht16k33_chip[0].int_pin ? "enabled" : "not enabled", ht16k33_key_reads, ht16k33_key_presses);
+}
@@ -0,0 +1,211 @@
+/***********************************************************
+ * DAVE.h (host simulation)
+ *
+ * Stands in for the DAVE generated headers when the firmware
+ * is compiled natively for the host simulation. It provides just
+ * the parts of the DAVE APPs, XMCLib and CMSIS that the pocket-nim
+ * sources use, implemented by host/dave_host.c and host/sim.c
+ * against a virtual clock.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef _DAVE_H_
+#define _DAVE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*************** simulation hooks ***************/
+// busy-wait loops in the firmware call IDLE_WAIT (see nim.h), which
+// lets virtual time move on to the next SysTick
+void sim_idle(void);
+#define IDLE_WAIT() sim_idle()
+
+// only the firmware's waits take virtual time, not its code, so a
+// cycle count taken around some code (cycles_now) is always 0. The
+// firmware's reports leave those counts out
+#define SIM_HOST
+
+/*************** DAVE ***************/
+typedef enum DAVE_STATUS
+{
+  DAVE_STATUS_SUCCESS = 0,
+  DAVE_STATUS_FAILURE
+} DAVE_STATUS_t;
+
+DAVE_STATUS_t DAVE_Init(void);
+
+#define XMC_DEBUG(...) ((void)0)
+
+/*************** CMSIS core ***************/
+typedef struct
+{
+  uint32_t CTRL;
+  uint32_t LOAD;
+  uint32_t VAL;
+  uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct
+{
+  uint32_t CPUID;
+  uint32_t ICSR;
+} SCB_Type;
+
+#define SCB_ICSR_PENDSTSET_Msk (1UL << 26)
+
+// these are refreshed from the virtual clock each time they are used
+SysTick_Type* sim_systick(void);
+SCB_Type* sim_scb(void);
+#define SysTick (sim_systick())
+#define SCB (sim_scb())
+
+extern int sim_in_isr;
+extern uint32_t sim_primask;
+static inline uint32_t __get_PRIMASK(void) { return sim_primask; }
+static inline void __set_PRIMASK(uint32_t m) { sim_primask=m; }
+static inline void __disable_irq(void) { sim_primask=1; }
+static inline void __enable_irq(void) { sim_primask=0; }
+static inline uint32_t __get_IPSR(void) { return sim_in_isr ? 15U : 0U; }
+static inline void __NOP(void) { }
+
+/*************** GPIO / DIGITAL_IO ***************/
+typedef struct
+{
+  volatile uint32_t OUT;
+  volatile uint32_t IN;
+} XMC_GPIO_PORT_t;
+
+typedef struct DIGITAL_IO
+{
+  XMC_GPIO_PORT_t *const gpio_port;
+  const uint8_t gpio_pin;
+} DIGITAL_IO_t;
+
+extern const DIGITAL_IO_t button1;
+extern const DIGITAL_IO_t button2;
+extern const DIGITAL_IO_t button3;
+extern const DIGITAL_IO_t button4;
+extern const DIGITAL_IO_t button5;
+extern const DIGITAL_IO_t button_computer;
+extern const DIGITAL_IO_t led2;
+
+// the I2C pins, P2.10 (SDA) and P2.11 (SCL), as plain GPIOs
+typedef enum XMC_GPIO_MODE
+{
+  XMC_GPIO_MODE_INPUT_TRISTATE = 0x00U,
+  XMC_GPIO_MODE_OUTPUT_OPEN_DRAIN = 0xc0U,
+  XMC_GPIO_MODE_OUTPUT_OPEN_DRAIN_ALT6 = 0xf0U,
+  XMC_GPIO_MODE_OUTPUT_OPEN_DRAIN_ALT7 = 0xf8U
+} XMC_GPIO_MODE_t;
+
+extern XMC_GPIO_PORT_t sim_port2;
+#define XMC_GPIO_PORT2 (&sim_port2)
+
+void XMC_GPIO_SetMode(XMC_GPIO_PORT_t *const port, const uint8_t pin, const XMC_GPIO_MODE_t mode);
+void XMC_GPIO_SetOutputHigh(XMC_GPIO_PORT_t *const port, const uint8_t pin);
+void XMC_GPIO_SetOutputLow(XMC_GPIO_PORT_t *const port, const uint8_t pin);
+uint32_t XMC_GPIO_GetInput(XMC_GPIO_PORT_t *const port, const uint8_t pin);
+
+uint32_t DIGITAL_IO_GetInput(const DIGITAL_IO_t *const handler);
+void DIGITAL_IO_SetOutputHigh(const DIGITAL_IO_t *const handler);
+void DIGITAL_IO_SetOutputLow(const DIGITAL_IO_t *const handler);
+void DIGITAL_IO_ToggleOutput(const DIGITAL_IO_t *const handler);
+
+/*************** SYSTIMER ***************/
+#define SYSTIMER_SYSTICK_CLOCK (32000000U)
+#define SYSTIMER_TICK_PERIOD_US (1000U)
+#define SYSTIMER_CFG_MAX_TMR (8U)
+
+typedef enum SYSTIMER_MODE
+{
+  SYSTIMER_MODE_ONE_SHOT = 0U,
+  SYSTIMER_MODE_PERIODIC
+} SYSTIMER_MODE_t;
+
+typedef enum SYSTIMER_STATUS
+{
+  SYSTIMER_STATUS_SUCCESS = 0U,
+  SYSTIMER_STATUS_FAILURE
+} SYSTIMER_STATUS_t;
+
+typedef void (*SYSTIMER_CALLBACK_t)(void *args);
+
+uint32_t SYSTIMER_CreateTimer(uint32_t period, SYSTIMER_MODE_t mode, SYSTIMER_CALLBACK_t callback, void *args);
+SYSTIMER_STATUS_t SYSTIMER_StartTimer(uint32_t id);
+SYSTIMER_STATUS_t SYSTIMER_StopTimer(uint32_t id);
+SYSTIMER_STATUS_t SYSTIMER_RestartTimer(uint32_t id, uint32_t microsec);
+uint32_t SYSTIMER_GetTime(void);
+uint32_t SYSTIMER_GetTickCount(void);
+
+/*************** I2C_MASTER ***************/
+typedef enum I2C_MASTER_STATUS
+{
+  I2C_MASTER_STATUS_SUCCESS = 0U,
+  I2C_MASTER_STATUS_FAILURE,
+  I2C_MASTER_STATUS_BUSY
+} I2C_MASTER_STATUS_t;
+
+typedef enum XMC_I2C_CH_CMD
+{
+  XMC_I2C_CH_CMD_WRITE,
+  XMC_I2C_CH_CMD_READ
+} XMC_I2C_CH_CMD_t;
+
+typedef enum XMC_I2C_CH_STATUS_FLAG
+{
+  XMC_I2C_CH_STATUS_FLAG_WRONG_TDF_CODE_FOUND = 0x0002U,
+  XMC_I2C_CH_STATUS_FLAG_NACK_RECEIVED = 0x0020U,
+  XMC_I2C_CH_STATUS_FLAG_ARBITRATION_LOST = 0x0040U,
+  XMC_I2C_CH_STATUS_FLAG_ERROR = 0x0100U
+} XMC_I2C_CH_STATUS_FLAG_t;
+
+// the settings from i2c_master_conf.c, with the end of transmit and
+// receive callbacks
+typedef struct I2C_MASTER
+{
+  uint32_t baudrate;
+  void (*tx_cbhandler)(void);
+  void (*rx_cbhandler)(void);
+} I2C_MASTER_t;
+
+extern I2C_MASTER_t i2c_bus;
+
+I2C_MASTER_STATUS_t I2C_MASTER_Init(const I2C_MASTER_t *const handle);
+I2C_MASTER_STATUS_t I2C_MASTER_Transmit(I2C_MASTER_t *handle, bool send_start, const uint32_t address,
+                                        uint8_t *data, const uint32_t size, bool send_stop);
+I2C_MASTER_STATUS_t I2C_MASTER_Receive(I2C_MASTER_t *handle, bool send_start, const uint32_t address,
+                                       uint8_t *data, const uint32_t count, bool send_stop, bool send_nack);
+void I2C_MASTER_SendStart(const I2C_MASTER_t *const handle, uint32_t address, XMC_I2C_CH_CMD_t cmd);
+void I2C_MASTER_SendRepeatedStart(const I2C_MASTER_t *const handle, uint32_t address, XMC_I2C_CH_CMD_t cmd);
+void I2C_MASTER_TransmitByte(const I2C_MASTER_t *const handle, uint8_t byte);
+void I2C_MASTER_SendStop(const I2C_MASTER_t *const handle);
+bool I2C_MASTER_IsTxBusy(I2C_MASTER_t *const handle);
+bool I2C_MASTER_IsRxBusy(I2C_MASTER_t *const handle);
+I2C_MASTER_STATUS_t I2C_MASTER_AbortTransmit(const I2C_MASTER_t *const handle);
+I2C_MASTER_STATUS_t I2C_MASTER_AbortReceive(const I2C_MASTER_t *const handle);
+uint32_t I2C_MASTER_GetFlagStatus(const I2C_MASTER_t *handle, uint32_t flagtype);
+void I2C_MASTER_ClearFlag(const I2C_MASTER_t *handle, uint32_t flagtype);
+
+/*************** PWM_CCU4 ***************/
+typedef enum PWM_CCU4_STATUS
+{
+  PWM_CCU4_STATUS_SUCCESS = 0U,
+  PWM_CCU4_STATUS_FAILURE
+} PWM_CCU4_STATUS_t;
+
+typedef struct PWM_CCU4
+{
+  uint32_t frequency;
+  bool running;
+} PWM_CCU4_t;
+
+extern PWM_CCU4_t pwm1;
+
+void PWM_CCU4_Start(PWM_CCU4_t *const handle_ptr);
+void PWM_CCU4_Stop(PWM_CCU4_t *const handle_ptr);
+PWM_CCU4_STATUS_t PWM_CCU4_SetFreq(PWM_CCU4_t *const handle_ptr, uint32_t pwm_freq_hz);
+
+#endif /* _DAVE_H_ */
@@ -0,0 +1,46 @@
+/***********************************************************
+ * xmc_flash.h (host simulation)
+ *
+ * The parts of the XMCLib flash driver that pocket-nim uses,
+ * implemented by host/flash_sim.c against a model of the
+ * XMC1100 flash.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef XMC_FLASH_H
+#define XMC_FLASH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define XMC_FLASH_PAGES_PER_SECTOR (16U)
+#define XMC_FLASH_BLOCKS_PER_PAGE  (16U)
+#define XMC_FLASH_BYTES_PER_SECTOR (4096U)
+#define XMC_FLASH_BYTES_PER_PAGE   (256U)
+#define XMC_FLASH_BYTES_PER_BLOCK  (16U)
+#define XMC_FLASH_WORDS_PER_SECTOR (1024U)
+#define XMC_FLASH_WORDS_PER_PAGE   (64U)
+#define XMC_FLASH_WORDS_PER_BLOCK  (4U)
+#define XMC_FLASH_BASE             (0x10001000U)
+
+// the NVMSTATUS bits
+typedef enum XMC_FLASH_STATUS
+{
+  XMC_FLASH_STATUS_OK                   = 0U,
+  XMC_FLASH_STATUS_BUSY                 = 0x0001U,
+  XMC_FLASH_STATUS_SLEEP_MODE           = 0x0002U,
+  XMC_FLASH_STATUS_VERIFY_ERROR         = 0x000cU,
+  XMC_FLASH_STATUS_ECC1_READ_ERROR      = 0x0010U,
+  XMC_FLASH_STATUS_ECC2_READ_ERROR      = 0x0020U,
+  XMC_FLASH_STATUS_WRITE_PROTOCOL_ERROR = 0x0040U
+} XMC_FLASH_STATUS_t;
+
+void XMC_FLASH_ClearStatus(void);
+uint32_t XMC_FLASH_GetStatus(void);
+bool XMC_FLASH_IsBusy(void);
+void XMC_FLASH_ErasePages(uint32_t *address, uint32_t num_pages);
+void XMC_FLASH_WriteBlocks(uint32_t *address, const uint32_t *data, uint32_t num_blocks, bool verify);
+void XMC_FLASH_ReadBlocks(uint32_t *address, uint32_t *data, uint32_t num_blocks);
+
+#endif /* XMC_FLASH_H */
@@ -0,0 +1,285 @@
+/***********************************************************
+ * mkanim.c
+ * Makes pocket-nim/anim_data.h from an animation source file
+ * such as pocket-nim/anim.txt (see there for the format, and
+ * anim.h for how the frames are coded).
+ *
+ * Each frame is coded against the one before it, as whichever
+ * of ANIM_SAME, ANIM_DELTA and ANIM_RLE is smallest. The flash
+ * each animation takes is printed on stderr, with what it
+ * would take with every frame stored whole.
+ *
+ * usage: mkanim anim.txt > anim_data.h
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include "anim.h"
+
+/********* definitions *****************/
+#define MAX_ANIMS 32
+#define MAX_BYTES 1024
+#define MAX_LINE 256
+#define WHOLE_FRAME (2+ANIM_LINES) // a duration, an op and the lines
+
+/********* types ***********************/
+typedef struct
+{
+  char name[32];
+  uint8_t data[MAX_BYTES];
+  int bytes;
+  int frames;
+} anim_src_t;
+
+/******** global variables **************/
+anim_src_t anims[MAX_ANIMS];
+int num_anims=0;
+
+const char* path;
+int line_no=0;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static void
+fail(const char* why)
+{
+  fprintf(stderr, "%s:%d: %s\n", path, line_no, why);
+  exit(1);
+}
+
+static void
+put(anim_src_t* a, uint8_t b)
+{
+  if (a->bytes>=MAX_BYTES-1)
+    fail("the animation is too long");
+  a->data[a->bytes++]=b;
+}
+
+/* put_frame
+ * codes canvas against last, the smallest way
+ */
+static void
+put_frame(anim_src_t* a, int duration, uint8_t mode, const uint8_t* last, const uint8_t* canvas)
+{
+  uint8_t changed=0;
+  int y, n, delta=1, rle=0;
+
+  for (y=0; y<ANIM_LINES; y++)
+  {
+    if (canvas[y]!=last[y])
+    {
+      changed|=(uint8_t)(1<<y);
+      delta++;
+    }
+  }
+  for (y=0; y<ANIM_LINES; y+=n)
+  {
+    for (n=1; (y+n<ANIM_LINES) && (canvas[y+n]==canvas[y]); n++)
+      ;
+    rle+=2;
+  }
+  put(a, (uint8_t)duration);
+  a->frames++;
+  if (changed==0)
+  {
+    put(a, mode | ANIM_SAME);
+  }
+  else if (delta<=rle)
+  {
+    put(a, mode | ANIM_DELTA);
+    put(a, changed);
+    for (y=0; y<ANIM_LINES; y++)
+    {
+      if (changed & (1<<y))
+        put(a, canvas[y]);
+    }
+  }
+  else
+  {
+    put(a, mode | ANIM_RLE);
+    for (y=0; y<ANIM_LINES; y+=n)
+    {
+      for (n=1; (y+n<ANIM_LINES) && (canvas[y+n]==canvas[y]); n++)
+        ;
+      put(a, (uint8_t)n);
+      put(a, canvas[y]);
+    }
+  }
+}
+
+static uint8_t
+mode_of(const char* s)
+{
+  if (strcmp(s, "show")==0)
+    return(ANIM_SHOW);
+  if (strcmp(s, "new")==0)
+    return(ANIM_NEW);
+  if (strcmp(s, "old")==0)
+    return(ANIM_OLD);
+  if (strcmp(s, "wipe")==0)
+    return(ANIM_WIPE);
+  fail("the mode is show, new, old or wipe");
+  return(0);
+}
+
+/* load
+ * reads the animation source file. A frame's lines are held until the
+ * next frame (or animation) starts, since they are optional
+ */
+static void
+load(void)
+{
+  FILE* fp;
+  char line[MAX_LINE], mode_name[16];
+  anim_src_t* a=NULL;
+  uint8_t last[ANIM_LINES], canvas[ANIM_LINES];
+  uint8_t mode=0;
+  int duration=0, row=0, x;
+
+  fp=fopen(path, "r");
+  if (fp==NULL)
+  {
+    perror(path);
+    exit(1);
+  }
+  for (;;)
+  {
+    if (fgets(line, sizeof(line), fp)==NULL)
+      line[0]='\0';
+    else
+      line_no++;
+    line[strcspn(line, "\r\n")]='\0';
+    if (line[0]==';')
+      continue;
+    if ((line[0]=='\0') && !feof(fp))
+      continue;
+    if ((line[0]=='\0') || (strncmp(line, "frame ", 6)==0) || (strncmp(line, "anim ", 5)==0))
+    {
+      // the frame before is complete
+      if (duration>0)
+      {
+        if ((row!=0) && (row!=ANIM_LINES))
+          fail("the frame before is short of lines");
+        put_frame(a, duration, mode, last, canvas);
+        memcpy(last, canvas, sizeof(last));
+        duration=0;
+      }
+      if (line[0]=='\0')
+        break;
+    }
+    if (strncmp(line, "anim ", 5)==0)
+    {
+      if (num_anims>=MAX_ANIMS)
+        fail("too many animations");
+      if (a!=NULL)
+        put(a, 0);
+      a=&anims[num_anims++];
+      memset(a, 0, sizeof(*a));
+      if ((sscanf(line+5, "%31s", a->name)!=1) || !isalpha((unsigned char)a->name[0]))
+        fail("expected anim <name>");
+      memset(last, 0, sizeof(last));
+      memset(canvas, 0, sizeof(canvas));
+      continue;
+    }
+    if (strncmp(line, "frame ", 6)==0)
+    {
+      if (a==NULL)
+        fail("a frame outside an animation");
+      if (sscanf(line+6, "%d %15s", &duration, mode_name)!=2)
+        fail("expected frame <duration> <mode>");
+      if ((duration<1) || (duration>255))
+        fail("the duration must be 1-255 frame periods");
+      mode=mode_of(mode_name);
+      row=0;
+      continue;
+    }
+    if ((duration==0) || (row>=ANIM_LINES))
+      fail("a line of pixels outside a frame");
+    if (strlen(line)!=8)
+      fail("a line must be 8 pixels");
+    if (row==0)
+      memset(canvas, 0, sizeof(canvas));
+    for (x=0; x<8; x++)
+    {
+      if (line[x]=='#')
+        canvas[ANIM_LINES-1-row]|=(uint8_t)(0x80>>x);
+      else if (line[x]!='.')
+        fail("pixels are '#' or '.'");
+    }
+    row++;
+  }
+  if (a!=NULL)
+    put(a, 0);
+  fclose(fp);
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  int i, b, c, total=0, whole=0;
+
+  if (argc!=2)
+  {
+    fprintf(stderr, "usage: %s anim.txt > anim_data.h\n", argv[0]);
+    return(2);
+  }
+  path=argv[1];
+  load();
+
+  printf("/***********************************************************\n"
+         " * anim_data.h\n"
+         " * Made by host/mkanim from %s. Don't edit it,\n"
+         " * edit that and run mkanim again (cd host; make anim).\n"
+         " * See anim.h for the format. The tables are only for\n"
+         " * anim.c, which defines ANIM_TABLES.\n"
+         " *\n"
+         " * Free for all non-commercial use\n"
+         " ***********************************************************/\n\n",
+         strrchr(path, '/') ? strrchr(path, '/')+1 : path);
+  printf("#ifndef ANIM_DATA_H_\n#define ANIM_DATA_H_\n\n#include \"anim.h\"\n\n");
+  for (i=0; i<num_anims; i++)
+  {
+    printf("#define ANIM_");
+    for (c=0; anims[i].name[c]; c++)
+      putchar(toupper((unsigned char)anims[i].name[c]));
+    printf(" %d\n", i);
+  }
+  printf("#define ANIM_COUNT %d\n\n#ifdef ANIM_TABLES\n", num_anims);
+  for (i=0; i<num_anims; i++)
+  {
+    printf("static const uint8_t anim_%s_data[%d]={\n", anims[i].name, anims[i].bytes);
+    for (b=0; b<anims[i].bytes; b++)
+    {
+      printf("%s0x%02x,%s", (b%12==0) ? "  " : "", anims[i].data[b],
+             ((b%12==11) || (b==anims[i].bytes-1)) ? "\n" : " ");
+    }
+    printf("};\n");
+  }
+  printf("static const anim_t anim_list[ANIM_COUNT]={\n");
+  for (i=0; i<num_anims; i++)
+  {
+    printf("  {anim_%s_data, %d, %d, \"%s\"},\n", anims[i].name, anims[i].bytes, anims[i].frames, anims[i].name);
+  }
+  printf("};\n#endif /* ANIM_TABLES */\n\n#endif /* ANIM_DATA_H_ */\n");
+
+  for (i=0; i<num_anims; i++)
+  {
+    fprintf(stderr, "anim: %-8s %3d frames in %4d bytes (%4d stored whole)\n", anims[i].name,
+            anims[i].frames, anims[i].bytes, anims[i].frames*WHOLE_FRAME+1);
+    total+=anims[i].bytes;
+    whole+=anims[i].frames*WHOLE_FRAME+1;
+  }
+  fprintf(stderr, "anim: %d animations in %d bytes (%d stored whole)\n", num_anims, total, whole);
+  return(0);
+}
@@ -0,0 +1,105 @@
+/***********************************************************
+ * mkdistance.c
+ * Makes pocket-nim/distance_data.h: the number of moves left with
+ * best play from every position of misere Nim up to rows rows of
+ * max sticks (see pocket-nim/distance.h), indexed by the rank up
+ * to the order of the rows. They are worked out with the
+ * retrograde solver (retro.c), and checked to be even just for the
+ * won positions. The flash they take is printed on stderr.
+ *
+ * usage: mkdistance [rows [max]] > distance_data.h
+ *   5 rows of up to 9 sticks by default, which covers every level
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "retro.h"
+#include "retronim.h"
+#include "canon.h"
+
+/********* definitions *****************/
+#define DEFAULT_ROWS 5
+#define DEFAULT_MAX 9
+#define FIRMWARE_ROWS 5 // CANON_MAX_ROWS in the firmware
+#define RESULT_FILE "distance.retro"
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  retronim_t nim;
+  retro_game_t game;
+  retro_header_t header;
+  const uint32_t* word;
+  size_t len;
+  uint32_t pos, w;
+  int bad=0;
+
+  nim.rows=DEFAULT_ROWS;
+  nim.max=DEFAULT_MAX;
+  nim.k=1;
+  if (argc>1)
+    nim.rows=atoi(argv[1]);
+  if (argc>2)
+    nim.max=atoi(argv[2]);
+  if ((nim.rows<1) || (nim.rows>FIRMWARE_ROWS) || (nim.max<1) || !CANON_FITS(nim.rows, nim.max))
+  {
+    fprintf(stderr, "usage: %s [rows [max]], rows up to %d and rows+max below %d\n", argv[0], FIRMWARE_ROWS,
+            CANON_SPAN);
+    return(2);
+  }
+  retronim_game(&game, &nim, 1);
+  if (retro_solve(&game, RESULT_FILE, 1, NULL)!=0)
+    return(1);
+  word=retro_map(RESULT_FILE, &header, &len);
+  unlink(RESULT_FILE);
+  if (word==NULL)
+  {
+    fprintf(stderr, "%s: can't read back %s\n", argv[0], RESULT_FILE);
+    return(1);
+  }
+  for (pos=0; pos<header.positions; pos++)
+  {
+    w=word[pos];
+    if ((RETRO_DIST(w)>0xff) || (RETRO_IS_WON(w)!=((RETRO_DIST(w) & 1)==0)))
+      bad++;
+  }
+  if (bad)
+  {
+    fprintf(stderr, "%s: %d positions don't fit the table\n", argv[0], bad);
+    return(1);
+  }
+
+  printf("/***********************************************************\n");
+  printf(" * distance_data.h\n");
+  printf(" * Made by host/mkdistance. Don't edit it, run mkdistance again\n");
+  printf(" * (cd host; make distance). See distance.h for what the table\n");
+  printf(" * is. It is only for distance.c, which defines DISTANCE_TABLES.\n");
+  printf(" *\n");
+  printf(" * Free for all non-commercial use\n");
+  printf(" ***********************************************************/\n\n");
+  printf("#ifndef DISTANCE_DATA_H_\n#define DISTANCE_DATA_H_\n\n");
+  printf("#define DISTANCE_ROWS %d\n", nim.rows);
+  printf("#define DISTANCE_MAX %d\n", nim.max);
+  printf("#define DISTANCE_POSITIONS %llu\n\n", (unsigned long long)header.positions);
+  printf("#ifdef DISTANCE_TABLES\n");
+  printf("static const uint8_t distance_table[DISTANCE_POSITIONS]={");
+  for (pos=0; pos<header.positions; pos++)
+  {
+    printf("%s%s%2u%s", (pos%16==0) ? "\n" : "", (pos%16==0) ? "  " : " ", (unsigned)RETRO_DIST(word[pos]),
+           (pos+1<header.positions) ? "," : "");
+  }
+  printf("\n};\n");
+  printf("#endif /* DISTANCE_TABLES */\n\n");
+  printf("#endif /* DISTANCE_DATA_H_ */\n");
+  fprintf(stderr, "distance: %d rows of up to %d sticks, %llu bytes of flash, longest game %u moves\n",
+          nim.rows, nim.max, (unsigned long long)header.positions, header.max_dist);
+  retro_unmap(word, len);
+  return(0);
+}
@@ -0,0 +1,183 @@
+/***********************************************************
+ * mkfont.c
+ * Makes pocket-nim/font_data.h from a font source file such
+ * as pocket-nim/font5x7.txt (see there for the format, and
+ * font.h for how the glyphs are packed).
+ *
+ * The glyphs are sorted by code, and each run of consecutive
+ * codes becomes a font_ranges entry. The flash the tables take
+ * is printed on stderr.
+ *
+ * usage: mkfont font.txt > font_data.h
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "font.h"
+
+/********* definitions *****************/
+#define MAX_GLYPHS 256
+#define MAX_LINE 256
+
+/********* types ***********************/
+typedef struct
+{
+  int code;
+  char name[32];
+  uint8_t rows[FONT_HEIGHT]; // bottom row first, leftmost pixel in bit 4
+} glyph_t;
+
+/******** global variables **************/
+glyph_t glyphs[MAX_GLYPHS];
+int num_glyphs=0;
+uint8_t bits[(MAX_GLYPHS*FONT_BITS)/8+2];
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static int
+by_code(const void* a, const void* b)
+{
+  return(((const glyph_t*)a)->code-((const glyph_t*)b)->code);
+}
+
+static void
+fail(const char* path, int line, const char* why)
+{
+  fprintf(stderr, "%s:%d: %s\n", path, line, why);
+  exit(1);
+}
+
+/* load
+ * reads the font source file
+ */
+static void
+load(const char* path)
+{
+  FILE* fp;
+  char line[MAX_LINE];
+  glyph_t* g=NULL;
+  int row=FONT_HEIGHT, n=0, x, i;
+
+  fp=fopen(path, "r");
+  if (fp==NULL)
+  {
+    perror(path);
+    exit(1);
+  }
+  while (fgets(line, sizeof(line), fp)!=NULL)
+  {
+    n++;
+    line[strcspn(line, "\r\n")]='\0';
+    if ((line[0]==';') || (line[0]=='\0'))
+      continue;
+    if (strncmp(line, "char ", 5)==0)
+    {
+      if (row<FONT_HEIGHT)
+        fail(path, n, "the glyph before is short of rows");
+      if (num_glyphs>=MAX_GLYPHS)
+        fail(path, n, "too many glyphs");
+      g=&glyphs[num_glyphs++];
+      memset(g, 0, sizeof(*g));
+      if (sscanf(line+5, "%i %31[^\n]", &g->code, g->name)<1)
+        fail(path, n, "expected char <code> [name]");
+      if ((g->code<0) || (g->code>255))
+        fail(path, n, "the code must be 0-255");
+      for (i=0; i<num_glyphs-1; i++)
+      {
+        if (glyphs[i].code==g->code)
+          fail(path, n, "the code has a glyph already");
+      }
+      row=0;
+      continue;
+    }
+    if ((g==NULL) || (row>=FONT_HEIGHT))
+      fail(path, n, "a row of pixels outside a glyph");
+    if (strlen(line)!=FONT_WIDTH)
+      fail(path, n, "a row must be 5 pixels");
+    for (x=0; x<FONT_WIDTH; x++)
+    {
+      if (line[x]=='#')
+        g->rows[FONT_HEIGHT-1-row]|=(uint8_t)(1<<(FONT_WIDTH-1-x));
+      else if (line[x]!='.')
+        fail(path, n, "pixels are '#' or '.'");
+    }
+    row++;
+  }
+  if (row<FONT_HEIGHT)
+    fail(path, n, "the last glyph is short of rows");
+  fclose(fp);
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  int i, y, b, r, runs=0;
+  int bytes;
+
+  if (argc!=2)
+  {
+    fprintf(stderr, "usage: %s font.txt > font_data.h\n", argv[0]);
+    return(2);
+  }
+  load(argv[1]);
+  qsort(glyphs, num_glyphs, sizeof(glyphs[0]), by_code);
+
+  // pack the rows, FONT_WIDTH bits at a time
+  memset(bits, 0, sizeof(bits));
+  for (i=0; i<num_glyphs; i++)
+  {
+    for (y=0; y<FONT_HEIGHT; y++)
+    {
+      for (b=0; b<FONT_WIDTH; b++)
+      {
+        r=i*FONT_BITS+y*FONT_WIDTH+b;
+        if (glyphs[i].rows[y] & (1<<b))
+          bits[r>>3]|=(uint8_t)(1<<(r & 7));
+      }
+    }
+  }
+  bytes=(num_glyphs*FONT_BITS+7)/8+1; // and a byte for FONT_ROW to read past the end
+
+  printf("/***********************************************************\n"
+         " * font_data.h\n"
+         " * Made by host/mkfont from %s. Don't edit it,\n"
+         " * edit that and run mkfont again (cd host; make font).\n"
+         " * See font.h for the format.\n"
+         " *\n"
+         " * Free for all non-commercial use\n"
+         " ***********************************************************/\n\n",
+         strrchr(argv[1], '/') ? strrchr(argv[1], '/')+1 : argv[1]);
+  printf("#ifndef FONT_DATA_H_\n#define FONT_DATA_H_\n\n#include \"font.h\"\n\n");
+  printf("#define FONT_GLYPHS %d\n\n", num_glyphs);
+
+  printf("static const font_range_t font_ranges[]={\n");
+  for (i=0; i<num_glyphs; i=r)
+  {
+    for (r=i+1; (r<num_glyphs) && (glyphs[r].code==glyphs[r-1].code+1); r++)
+      ;
+    printf("  {0x%02x, 0x%02x, %d},\n", glyphs[i].code, glyphs[r-1].code, i);
+    runs++;
+  }
+  printf("};\n#define FONT_RANGES %d\n\n", runs);
+
+  printf("static const uint8_t font_bits[%d]={\n", bytes);
+  for (i=0; i<bytes; i++)
+  {
+    printf("%s0x%02x,%s", (i%12==0) ? "  " : "", bits[i], ((i%12==11) || (i==bytes-1)) ? "\n" : " ");
+  }
+  printf("};\n\n#endif /* FONT_DATA_H_ */\n");
+
+  fprintf(stderr, "font: %d glyphs in %d runs, %d bytes of glyphs and %d of ranges (%d bytes as 7 a glyph)\n",
+          num_glyphs, runs, bytes, runs*(int)sizeof(font_range_t), num_glyphs*FONT_HEIGHT);
+  return(0);
+}
@@ -0,0 +1,415 @@
+/***********************************************************
+ * mkmistake.c
+ * Makes pocket-nim/mistake_data.h: how often the computer makes a
+ * mistake on each level (see pocket-nim/mistake.h), tuned by
+ * self-play so that a model player wins a target share of games.
+ *
+ * The model player takes a winning move (if there is one) skill%
+ * of the time, and otherwise a random number of sticks from a
+ * random row. It goes first, on the level's rows as setup_game()
+ * deals them. The computer plays as computer_play() does: the move
+ * of the distance table (distance.c) from DISTANCE_LEVEL up, or of
+ * the firmware's own classic_choose() (classic.c), unless a draw
+ * like random_num()'s makes it a mistake by mistake_make().
+ *
+ * Each level's threshold is found by a binary search, every try
+ * playing the same games (the same seeds), as the win rate goes up
+ * with the threshold. The table goes to stdout, and a report on
+ * stderr: the win rate with the threshold and with no mistakes,
+ * and, for comparison, with the weakening this replaces on levels 1
+ * and 2 (up to two random_num() draws a row with more than one
+ * stick, for a chance above WEAKNESS each), with the draws a move
+ * that cost. Last, the host ns a computer move takes, over the
+ * positions it met: the engine's move, then the draw, with no
+ * mistake or with one.
+ *
+ * usage: mkmistake [-n games] [-s skill] [-r seed] [target% ...] > mistake_data.h
+ *   the targets are for levels 1 up, by default 60 40 0 0 0: levels 1
+ *   and 2 had the old weakening, and the rest play their best
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "nim.h"
+#include "nimk.h"
+#include "distance.h"
+#include "classic.h"
+#include "mistake.h"
+
+/********* definitions *****************/
+#define LEVELS 5 // as setup_game() deals them
+#define WEAKNESS 200U // as it was in main.c
+#define OLD_WEAK_LEVELS 2
+#define NO_MISTAKES -1
+#define OLD_MODEL -2
+#define MAX_SEEN 100000 // positions kept for timing
+#define TIMING_REPS 20
+
+/******** global variables **************/
+int targets[LEVELS+1]={0, 60, 40, 0, 0, 0};
+int num_games=20000;
+int skill=50;
+unsigned long seed=1;
+unsigned short randreg=1;
+unsigned long draws;  // random_num() calls by the computer
+unsigned long computer_moves;
+unsigned char seen[MAX_SEEN][MAXROWS]; // positions the computer met
+int num_seen, seen_rows, seeing;
+volatile unsigned int sink;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* random_num
+ * as in main.c
+ */
+unsigned char
+random_num(void)
+{
+  char i;
+
+  draws++;
+  for (i=0; i<=7; i++)
+  {
+    randreg ^= randreg>>7;
+    randreg ^= randreg<<9;
+    randreg ^= randreg>>13;
+  }
+  return(unsigned char)(randreg & 0xff);
+}
+
+/* deal
+ * the rows for a level, as setup_game() deals them (for a display
+ * 8 high)
+ */
+static int
+deal(int lvl, unsigned char* sticks)
+{
+  int i, rows;
+
+  if (lvl>=4)
+  {
+    rows=(lvl==5) ? 5 : 4;
+    for (i=0; i<rows; i++)
+      sticks[i]=(unsigned char)(1+rand()%8);
+    return(rows);
+  }
+  rows=(lvl==1) ? 3 : 4;
+  for (i=0; i<rows; i++)
+    sticks[i]=(unsigned char)(2*i+1);
+  return(rows);
+}
+
+/* engine
+ * the firmware's move, as computer_choose() makes it
+ */
+static void
+engine(int lvl, const unsigned char* sticks, int rows, unsigned char* row, unsigned char* left)
+{
+  if ((lvl>=DISTANCE_LEVEL) && distance_fits(sticks, (unsigned char)rows))
+    distance_choose(sticks, (unsigned char)rows, row, left);
+  else
+    classic_choose(sticks, (unsigned char)rows, row, left);
+}
+
+/* winning
+ * the model player's move, if it can win: leaves sticks as after,
+ * returns 1 if it wins
+ */
+static int
+winning(int lvl, const unsigned char* sticks, int rows, unsigned char* after)
+{
+  uint32_t heaps[MAXROWS], left[MAXROWS];
+  unsigned char row, n;
+  int i, won;
+
+  memcpy(after, sticks, rows);
+  if ((lvl>=DISTANCE_LEVEL) && distance_fits(sticks, (unsigned char)rows))
+  {
+    won=distance_choose(sticks, (unsigned char)rows, &row, &n);
+    after[row]=n;
+    return(won);
+  }
+  for (i=0; i<rows; i++)
+    heaps[i]=sticks[i];
+  won=nimk_choose(heaps, (unsigned char)rows, 1, 1, left);
+  for (i=0; i<rows; i++)
+    after[i]=(unsigned char)left[i];
+  return(won);
+}
+
+/* old_weak
+ * the weakening that mistake_make() replaces: each row of more than
+ * one stick draws, and above WEAKNESS is a candidate to take one
+ * from, the more so if a second draw is above 128. The last of the
+ * best is taken. Only where the xor of the rows is not 0, where
+ * computer_choose() got that far
+ */
+static int
+old_weak(const unsigned char* sticks, int rows, unsigned char* row)
+{
+  int i, q, best=0;
+  unsigned char x=0;
+
+  for (i=0; i<rows; i++)
+    x^=sticks[i];
+  if (x==0)
+    return(0);
+  for (i=0; i<rows; i++)
+  {
+    if ((sticks[i]>1) && (random_num()>WEAKNESS))
+    {
+      q=1+(random_num()>128U);
+      if (q>=best)
+      {
+        best=q;
+        *row=(unsigned char)i;
+      }
+    }
+  }
+  return(best>0);
+}
+
+/* computer
+ * the computer's move, with mistakes by threshold, or NO_MISTAKES,
+ * or the OLD_MODEL
+ */
+static void
+computer(int lvl, unsigned char* sticks, int rows, int threshold)
+{
+  unsigned char row, left;
+
+  computer_moves++;
+  if (seeing && (num_seen<MAX_SEEN))
+  {
+    memcpy(seen[num_seen++], sticks, rows);
+    seen_rows=rows;
+  }
+  if ((threshold==OLD_MODEL) && (lvl<=OLD_WEAK_LEVELS) && old_weak(sticks, rows, &row))
+  {
+    sticks[row]--;
+    return;
+  }
+  engine(lvl, sticks, rows, &row, &left);
+  if (threshold>0)
+    mistake_make(sticks, (unsigned char)rows, random_num(), (unsigned char)threshold, &row, &left);
+  if (row!=NO_MOVE)
+    sticks[row]=left;
+}
+
+/* player
+ * the model player's move
+ */
+static void
+player(int lvl, unsigned char* sticks, int rows, int total)
+{
+  unsigned char after[MAXROWS];
+  int r, t;
+
+  if ((rand()%100<skill) && winning(lvl, sticks, rows, after))
+  {
+    memcpy(sticks, after, rows);
+    return;
+  }
+  do
+  {
+    r=rand()%rows;
+  } while (sticks[r]==0);
+  t=1+rand()%sticks[r];
+  if (t==total)
+    t--; // taking the last stick is never the thing to do
+  if (t==0)
+    t=1;
+  sticks[r]-=(unsigned char)t;
+}
+
+/* win_rate
+ * the player's share of num_games games on a level, in percent
+ */
+static double
+win_rate(int lvl, int threshold)
+{
+  unsigned char sticks[MAXROWS];
+  int g, i, rows, total, turn, wins=0;
+
+  srand(seed);
+  randreg=1;
+  for (g=0; g<num_games; g++)
+  {
+    rows=deal(lvl, sticks);
+    for (turn=0; ; turn^=1)
+    {
+      for (total=0, i=0; i<rows; i++)
+        total+=sticks[i];
+      if (total<=1)
+        break; // the side to move has lost
+      if (turn==0)
+        player(lvl, sticks, rows, total);
+      else
+        computer(lvl, sticks, rows, threshold);
+    }
+    // turn is the loser, unless it was left none
+    wins+=((turn==1)==(total==1));
+  }
+  return(wins*100.0/num_games);
+}
+
+/* now_s
+ */
+static double
+now_s(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec+ts.tv_nsec*1e-9);
+}
+
+/* time_moves
+ * the host ns a move over the positions seen: the engine's move,
+ * then a draw at threshold (1 for no mistake, 255 for one)
+ */
+static double
+time_moves(int lvl, int threshold)
+{
+  unsigned char row, left;
+  double t0;
+  int i, rep;
+
+  t0=now_s();
+  for (rep=0; rep<TIMING_REPS; rep++)
+  {
+    for (i=0; i<num_seen; i++)
+    {
+      if (threshold==0)
+        engine(lvl, seen[i], seen_rows, &row, &left);
+      else
+        mistake_make(seen[i], (unsigned char)seen_rows, random_num(), (unsigned char)threshold, &row, &left);
+      sink+=row+left;
+    }
+  }
+  return((now_s()-t0)*1e9/((double)TIMING_REPS*num_seen));
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  double rate[LEVELS+1], base[LEVELS+1], r, r_lo;
+  int threshold[LEVELS+1];
+  int c, lvl, lo, hi, mid;
+
+  while ((c=getopt(argc, argv, "n:s:r:"))!=-1)
+  {
+    switch(c)
+    {
+      case 'n':
+        num_games=atoi(optarg);
+        break;
+      case 's':
+        skill=atoi(optarg);
+        break;
+      case 'r':
+        seed=strtoul(optarg, NULL, 0);
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n games] [-s skill] [-r seed] [target%% ...] > mistake_data.h\n", argv[0]);
+        return(2);
+    }
+  }
+  for (lvl=1; (lvl<=LEVELS) && (optind<argc); lvl++)
+    targets[lvl]=atoi(argv[optind++]);
+  if (num_games<1)
+    num_games=1;
+
+  fprintf(stderr, "mistake: %d games a try, a player who finds the winning move %d%% of the time\n",
+          num_games, skill);
+  for (lvl=1; lvl<=LEVELS; lvl++)
+  {
+    base[lvl]=win_rate(lvl, NO_MISTAKES);
+    // the lowest threshold that reaches the target, or the one below if that is nearer
+    lo=0;
+    hi=255;
+    if (base[lvl]>=targets[lvl])
+      hi=0;
+    while (lo<hi)
+    {
+      mid=(lo+hi)/2;
+      if (win_rate(lvl, mid)>=targets[lvl])
+        hi=mid;
+      else
+        lo=mid+1;
+    }
+    r=win_rate(lvl, hi);
+    if (hi>0)
+    {
+      r_lo=win_rate(lvl, hi-1);
+      if (targets[lvl]-r_lo<r-targets[lvl])
+      {
+        hi--;
+        r=r_lo;
+      }
+    }
+    threshold[lvl]=hi;
+    rate[lvl]=r;
+  }
+
+  printf("/***********************************************************\n");
+  printf(" * mistake_data.h\n");
+  printf(" * Made by host/mkmistake. Don't edit it, run mkmistake again\n");
+  printf(" * (cd host; make mistake). See mistake.h for what the table\n");
+  printf(" * is. It is only for mistake.c, which defines MISTAKE_TABLES.\n");
+  printf(" *\n");
+  printf(" * Tuned over %d games a level, with a model player who finds\n", num_games);
+  printf(" * the winning move %d%% of the time:\n", skill);
+  for (lvl=1; lvl<=LEVELS; lvl++)
+  {
+    printf(" *   level %d: wins %4.1f%% (target %d%%, %4.1f%% with no mistakes)\n", lvl, rate[lvl],
+           targets[lvl], base[lvl]);
+  }
+  printf(" *\n");
+  printf(" * Free for all non-commercial use\n");
+  printf(" ***********************************************************/\n\n");
+  printf("#ifndef MISTAKE_DATA_H_\n#define MISTAKE_DATA_H_\n\n");
+  printf("#define MISTAKE_LEVELS %d\n\n", LEVELS);
+  printf("#ifdef MISTAKE_TABLES\n");
+  printf("// out of 256, by level\n");
+  printf("static const uint8_t mistake_thresholds[MISTAKE_LEVELS+1]={0");
+  for (lvl=1; lvl<=LEVELS; lvl++)
+    printf(", %d", threshold[lvl]);
+  printf("};\n");
+  printf("#endif /* MISTAKE_TABLES */\n\n");
+  printf("#endif /* MISTAKE_DATA_H_ */\n");
+
+  fprintf(stderr, "level  threshold  player wins  target  no mistakes  draws a move   as it was: wins  draws a move\n");
+  for (lvl=1; lvl<=LEVELS; lvl++)
+  {
+    draws=computer_moves=0;
+    win_rate(lvl, threshold[lvl]);
+    fprintf(stderr, "  %d   %4d/256   %9.1f%%  %5d%%  %10.1f%%  %12.2f", lvl, threshold[lvl], rate[lvl],
+            targets[lvl], base[lvl], computer_moves ? (double)draws/computer_moves : 0.0);
+    draws=computer_moves=0;
+    r=win_rate(lvl, OLD_MODEL);
+    fprintf(stderr, "  %15.1f%%  %12.2f\n", r, computer_moves ? (double)draws/computer_moves : 0.0);
+  }
+  fprintf(stderr, "host ns a computer move: the engine's move, and then the draw with no mistake / with one\n");
+  for (lvl=1; lvl<=LEVELS; lvl++)
+  {
+    num_seen=0;
+    seeing=1;
+    win_rate(lvl, NO_MISTAKES);
+    seeing=0;
+    fprintf(stderr, "  %d   %7.1f  + %5.1f / %5.1f   (%d positions)\n", lvl, time_moves(lvl, 0), time_moves(lvl, 1),
+            time_moves(lvl, 255), num_seen);
+  }
+  return(0);
+}
@@ -0,0 +1,77 @@
+/***********************************************************
+ * mkwythoff.c
+ * Makes pocket-nim/wythoff_data.h: the cold pair tables for
+ * Wythoff's game (see pocket-nim/wythoff.h), worked out with
+ * the exact floor(n*phi) in wythoff64.c, for the misere game
+ * pocket-nim plays. The flash they take is printed on stderr.
+ *
+ * usage: mkwythoff [max_pile] > wythoff_data.h
+ *   max_pile is the longest row the tables cover, 32 by
+ *   default, and at most 150 so that the partners fit a byte
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "wythoff64.h"
+
+/********* definitions *****************/
+#define DEFAULT_MAX_PILE 32
+#define LIMIT_MAX_PILE 150 // partner(150) is 242
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static void
+put_table(const char* name, int max_pile, uint64_t (*f)(uint64_t, int))
+{
+  int v;
+
+  printf("static const uint8_t %s[WYTHOFF_MAX_PILE+1]={", name);
+  for (v=0; v<=max_pile; v++)
+  {
+    printf("%s%s%3u%s", (v%12==0) ? "\n" : "", (v%12==0) ? "  " : " ", (unsigned)f((uint64_t)v, 1),
+           (v<max_pile) ? "," : "");
+  }
+  printf("\n};\n");
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  int max_pile=DEFAULT_MAX_PILE;
+
+  if (argc>1)
+    max_pile=atoi(argv[1]);
+  if ((max_pile<2) || (max_pile>LIMIT_MAX_PILE))
+  {
+    fprintf(stderr, "usage: %s [max_pile], from 2 to %d\n", argv[0], LIMIT_MAX_PILE);
+    return(2);
+  }
+
+  printf("/***********************************************************\n");
+  printf(" * wythoff_data.h\n");
+  printf(" * Made by host/mkwythoff. Don't edit it, run mkwythoff again\n");
+  printf(" * (cd host; make wythoff). See wythoff.h for what the tables\n");
+  printf(" * are. They are only for wythoff.c, which defines\n");
+  printf(" * WYTHOFF_TABLES.\n");
+  printf(" *\n");
+  printf(" * Free for all non-commercial use\n");
+  printf(" ***********************************************************/\n\n");
+  printf("#ifndef WYTHOFF_DATA_H_\n#define WYTHOFF_DATA_H_\n\n");
+  printf("#define WYTHOFF_MAX_PILE %d\n\n", max_pile);
+  printf("#ifdef WYTHOFF_TABLES\n");
+  put_table("wythoff_partner", max_pile, wythoff_partner);
+  put_table("wythoff_gap", max_pile, wythoff_gap);
+  printf("#endif /* WYTHOFF_TABLES */\n\n");
+  printf("#endif /* WYTHOFF_DATA_H_ */\n");
+  fprintf(stderr, "wythoff: rows up to %d, %d bytes of flash\n", max_pile, 2*(max_pile+1));
+  return(0);
+}
@@ -0,0 +1,495 @@
+/***********************************************************
+ * movereplay.c
+ * Replays games logged as the move stream of movelog.h, from the
+ * device (gamelog_moves) or from sim -M, checking every move:
+ *  - the stream: the header, rows and sticks that exist, no more
+ *    rows a move than the rules allow (two rows only for the same
+ *    number in Wythoff's game), and a winner that fits how the game
+ *    ended
+ *  - blunders: a move that throws away a won position, found with
+ *    nimk_lost() (for Nim, kept up to date a row at a time) or
+ *    wythoff_cold()
+ * and reports them by level and side, with the replay speed. A bad
+ * game stops its file, as where the next game starts isn't known.
+ *
+ * With -g it first makes up a corpus of games by self-play through
+ * the firmware's writer (movelog.c), on the boards of levels 1 to 5
+ * and of Wythoff's game (as level 6): a random user, who sometimes
+ * passes, against the engine, which on levels 1 and 2 plays a
+ * random move one turn in four. -w writes the corpus out.
+ *
+ * usage: movereplay [-g games] [-k rows] [-r seed] [-w out.bin] [-v] [file ...]
+ *   -k  let levels 4 and 5 of the made up games take from up to
+ *       this many rows a move (Nim_k), rather than 1
+ *   -v  list every blunder
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "nim.h"
+#include "gamelog.h"
+#include "movelog.h"
+#include "nimk.h"
+#include "wythoff.h"
+
+/********* definitions *****************/
+#define MAX_LEVEL 7
+#define MIN_REPLAY_S 0.5 // replay the corpus again until it takes this long, for the time
+#define USER 0
+#define COMPUTER 1
+
+/*************** types ***********************/
+typedef struct
+{
+  unsigned long games, moves, passes, player_wins, abandoned;
+  unsigned long chances[2];  // moves made from a won position, by side
+  unsigned long blunders[2]; // ..that left one won for the other side
+} level_stats_t;
+
+/******** global variables **************/
+level_stats_t stats[MAX_LEVEL+1];
+unsigned long bad_games=0;
+int verbose=0;
+int gen_games=0;
+int gen_k=1;
+unsigned long gen_seed=1;
+const char* out_file=NULL;
+uint8_t* corpus=NULL;
+size_t corpus_len=0, corpus_size=0;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static double
+now_s(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec+ts.tv_nsec/1e9);
+}
+
+/* lost
+ * whether the player to move loses, by the rules in the header
+ */
+static int
+lost(const unsigned char* sticks, int rows, int rules)
+{
+  uint32_t heaps[MOVELOG_MAX_ROWS];
+  int i;
+
+  if (rules==MOVELOG_WYTHOFF)
+    return(wythoff_cold(sticks));
+  for (i=0; i<rows; i++)
+    heaps[i]=sticks[i];
+  return(nimk_lost(heaps, (unsigned char)rows, (unsigned char)rules, 1));
+}
+
+/* replay_game
+ * checks the game at p, of up to len bytes. Returns its length, or
+ * 0 if it is bad. Counts it in stats if count is set
+ */
+static size_t
+replay_game(const uint8_t* p, size_t len, int count)
+{
+  unsigned char sticks[MOVELOG_MAX_ROWS];
+  const uint8_t* start=p;
+  const uint8_t* end=p+len;
+  level_stats_t* st;
+  unsigned x=0, big=0, ones=0, used;
+  int level, rows, rules, i, side=USER, won, n, total=0, winner;
+  uint8_t b;
+
+  if ((len<MOVELOG_HEADER_BYTES) || (p[0]!=MOVELOG_MAGIC))
+    return(0);
+  level=p[1];
+  rows=p[4] & 0x0f;
+  rules=p[4]>>4;
+  if ((level>MAX_LEVEL) || (rows<1) || (rows>MOVELOG_MAX_ROWS) ||
+      ((rules==MOVELOG_WYTHOFF) ? (rows!=2) : (rules>rows)))
+    return(0);
+  for (i=0; i<rows; i++)
+  {
+    sticks[i]=(p[5+i/2]>>((i & 1)*4)) & 0x0f;
+    total+=sticks[i];
+    x^=sticks[i];
+    big+=(sticks[i]>1);
+    ones+=(sticks[i]==1);
+  }
+  st=&stats[level];
+  p+=MOVELOG_HEADER_BYTES;
+  for (;;)
+  {
+    if (p==end)
+      return(0);
+    b=*p++;
+    if (MOVELOG_TAKEN(b)==0)
+    {
+      if (b==MOVELOG_PASS)
+      {
+        if ((side!=USER) || (total<=1))
+          return(0); // only the user passes
+        if (count)
+          st->passes++;
+        side=COMPUTER;
+        continue;
+      }
+      winner=MOVELOG_WINNER(b);
+      if ((b & MOVELOG_MORE) || (winner>GAMELOG_COMPUTER))
+        return(0);
+      // someone left one stick (and side is the other one), or it was given up
+      if ((winner!=GAMELOG_ABANDONED) &&
+          ((total!=1) || (winner!=((side==COMPUTER) ? GAMELOG_PLAYER : GAMELOG_COMPUTER))))
+        return(0);
+      if (count)
+      {
+        st->games++;
+        st->player_wins+=(winner==GAMELOG_PLAYER);
+        st->abandoned+=(winner==GAMELOG_ABANDONED);
+      }
+      return((size_t)(p-start));
+    }
+    if (total<=1)
+      return(0); // the game was over
+    // the position before the move
+    if (rules==1)
+      won=big ? (x!=0) : ((ones & 1)==0);
+    else
+      won=!lost(sticks, rows, rules);
+    used=0;
+    n=0;
+    for (;;)
+    {
+      i=MOVELOG_ROW(b);
+      if ((i>=rows) || (used & (1U<<i)) || (MOVELOG_TAKEN(b)>sticks[i]))
+        return(0);
+      used|=1U<<i;
+      n++;
+      x^=sticks[i];
+      big-=(sticks[i]>1);
+      ones-=(sticks[i]==1);
+      sticks[i]-=MOVELOG_TAKEN(b);
+      total-=MOVELOG_TAKEN(b);
+      x^=sticks[i];
+      big+=(sticks[i]>1);
+      ones+=(sticks[i]==1);
+      if (!(b & MOVELOG_MORE))
+        break;
+      if ((p==end) || (MOVELOG_TAKEN(*p)==0))
+        return(0);
+      if ((rules==MOVELOG_WYTHOFF) && (MOVELOG_TAKEN(*p)!=MOVELOG_TAKEN(b)))
+        return(0);
+      b=*p++;
+    }
+    if (n>((rules==MOVELOG_WYTHOFF) ? 2 : rules))
+      return(0);
+    if (total==0)
+      return(0); // the firmware never takes the last stick
+    if (count)
+    {
+      st->moves++;
+      if (won)
+      {
+        st->chances[side]++;
+        if ((rules==1) ? (big ? (x!=0) : ((ones & 1)==0)) : !lost(sticks, rows, rules))
+        {
+          st->blunders[side]++;
+          if (verbose)
+            printf("  blunder by the %s on level %d, move %lu of the level\n",
+                   (side==USER) ? "user" : "computer", level, st->moves);
+        }
+      }
+    }
+    side=1-side;
+  }
+}
+
+/* replay
+ * checks every game in a buffer, up to the first bad one, whose offset
+ * goes in *bad_at (or -1). Returns the bytes checked
+ */
+static unsigned long
+replay(const uint8_t* buf, size_t len, int count, long* bad_at)
+{
+  size_t pos=0, n;
+
+  *bad_at=-1;
+  while (pos<len)
+  {
+    n=replay_game(buf+pos, len-pos, count);
+    if (n==0)
+    {
+      *bad_at=(long)pos;
+      if (count)
+        bad_games++;
+      break;
+    }
+    pos+=n;
+  }
+  return((unsigned long)pos);
+}
+
+/* corpus_flush
+ * the writer's flush function for the made up games
+ */
+static void
+corpus_flush(const uint8_t* buf, uint16_t len)
+{
+  if (corpus_len+len>corpus_size)
+  {
+    corpus_size=2*corpus_size+len;
+    corpus=realloc(corpus, corpus_size);
+  }
+  memcpy(corpus+corpus_len, buf, len);
+  corpus_len+=len;
+}
+
+/* random_move
+ * a random number of sticks from up to k random rows, never the last
+ * stick
+ */
+static void
+random_move(unsigned char* s, int rows, int k, int wythoff, int total)
+{
+  int r, t, n, most;
+
+  if (wythoff && (s[0]>0) && (s[1]>0) && (rand()%3==0))
+  {
+    most=(s[0]<s[1]) ? s[0] : s[1];
+    t=1+rand()%most;
+    if (2*t<total)
+    {
+      s[0]-=t;
+      s[1]-=t;
+      return;
+    }
+  }
+  n=1+rand()%k;
+  do
+  {
+    do
+    {
+      r=rand()%rows;
+    } while (s[r]==0);
+    t=1+rand()%s[r];
+    if (t==total)
+      t--;
+    s[r]-=t;
+    total-=t;
+  } while ((--n>0) && (total>1));
+}
+
+/* engine_move
+ * the firmware's move, as computer_play() would make it
+ */
+static void
+engine_move(unsigned char* s, int rows, int k, int wythoff)
+{
+  uint32_t heaps[MOVELOG_MAX_ROWS], after[MOVELOG_MAX_ROWS];
+  unsigned char pair[2];
+  int i;
+
+  if (wythoff)
+  {
+    wythoff_choose(s, pair);
+    s[0]=pair[0];
+    s[1]=pair[1];
+    return;
+  }
+  for (i=0; i<rows; i++)
+    heaps[i]=s[i];
+  nimk_choose(heaps, (unsigned char)rows, (unsigned char)k, 1, after);
+  for (i=0; i<rows; i++)
+    s[i]=(unsigned char)after[i];
+}
+
+/* generate
+ * makes up the corpus for -g
+ */
+static void
+generate(void)
+{
+  movelog_writer_t w;
+  uint8_t buf[256];
+  unsigned char s[MOVELOG_MAX_ROWS];
+  int g, i, lvl, rows, k, wythoff, total, side;
+
+  srand(gen_seed);
+  movelog_open(&w, buf, sizeof(buf), corpus_flush);
+  for (g=0; g<gen_games; g++)
+  {
+    lvl=1+g%6; // level 6 stands for Wythoff's game
+    wythoff=(lvl==6);
+    rows=(lvl==1) ? 3 : (lvl==5) ? 5 : wythoff ? 2 : 4;
+    k=((lvl==4) || (lvl==5)) ? gen_k : 1;
+    for (total=0, i=0; i<rows; i++)
+    {
+      s[i]=(lvl<=3) ? (unsigned char)(2*i+1) : (unsigned char)(1+rand()%8);
+      total+=s[i];
+    }
+    movelog_start(&w, (uint8_t)lvl, (uint16_t)rand(), wythoff ? MOVELOG_WYTHOFF : (uint8_t)k, s, (uint8_t)rows);
+    side=USER;
+    while (total>1)
+    {
+      if ((side==USER) && (rand()%8==0))
+        ; // a pass
+      else if ((side==USER) || ((lvl<=2) && (rand()%4==0)))
+        random_move(s, rows, k, wythoff, total);
+      else
+        engine_move(s, rows, k, wythoff);
+      movelog_move(&w, s);
+      for (total=0, i=0; i<rows; i++)
+        total+=s[i];
+      side=1-side;
+    }
+    movelog_end(&w, (side==COMPUTER) ? GAMELOG_PLAYER : GAMELOG_COMPUTER);
+  }
+  movelog_flush(&w);
+}
+
+/* load
+ * adds a file to the corpus
+ */
+static int
+load(const char* path)
+{
+  FILE* fp;
+  uint8_t buf[4096];
+  size_t n;
+
+  fp=fopen(path, "rb");
+  if (fp==NULL)
+  {
+    perror(path);
+    return(-1);
+  }
+  while ((n=fread(buf, 1, sizeof(buf), fp))>0)
+    corpus_flush(buf, (uint16_t)n);
+  fclose(fp);
+  return(0);
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  level_stats_t* st;
+  FILE* fp;
+  unsigned long moves=0, games=0, bytes, passes;
+  long bad_at;
+  double t0, t;
+  int c, i, runs;
+
+  while ((c=getopt(argc, argv, "g:k:r:w:v"))!=-1)
+  {
+    switch(c)
+    {
+      case 'g':
+        gen_games=atoi(optarg);
+        break;
+      case 'k':
+        gen_k=atoi(optarg);
+        break;
+      case 'r':
+        gen_seed=strtoul(optarg, NULL, 0);
+        break;
+      case 'w':
+        out_file=optarg;
+        break;
+      case 'v':
+        verbose=1;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-g games] [-k rows] [-r seed] [-w out.bin] [-v] [file ...]\n", argv[0]);
+        return(2);
+    }
+  }
+  if ((gen_k<1) || (gen_k>4))
+    gen_k=1;
+  if ((gen_games==0) && (optind==argc))
+    gen_games=100000;
+  if (gen_games>0)
+    generate();
+  if (out_file!=NULL)
+  {
+    fp=fopen(out_file, "wb");
+    if (fp==NULL)
+    {
+      perror(out_file);
+      return(1);
+    }
+    fwrite(corpus, 1, corpus_len, fp);
+    fclose(fp);
+  }
+  // the files are checked one by one, so that a bad game only stops its own
+  bytes=corpus_len;
+  for (i=optind; i<argc; i++)
+  {
+    size_t was=corpus_len;
+
+    if (load(argv[i])!=0)
+      return(1);
+    replay(corpus+was, corpus_len-was, 1, &bad_at);
+    if (bad_at>=0)
+    {
+      printf("%s: bad game at byte %ld\n", argv[i], bad_at);
+      corpus_len=was+(size_t)bad_at;
+    }
+  }
+  if (gen_games>0)
+  {
+    replay(corpus, bytes, 1, &bad_at);
+    if (bad_at>=0)
+    {
+      printf("made up games: bad game at byte %ld\n", bad_at);
+      return(1);
+    }
+  }
+
+  printf("level   games  player wins  abandoned    moves  passes  user blunders     computer blunders\n");
+  passes=0;
+  for (i=0; i<=MAX_LEVEL; i++)
+  {
+    st=&stats[i];
+    if (st->games==0)
+      continue;
+    printf("  %d  %8lu  %10.1f%%  %9lu  %7lu  %6lu  %6lu/%-7lu %4.1f%%  %6lu/%-7lu %4.1f%%\n", i, st->games,
+           st->player_wins*100.0/st->games, st->abandoned, st->moves, st->passes,
+           st->blunders[USER], st->chances[USER],
+           st->chances[USER] ? st->blunders[USER]*100.0/st->chances[USER] : 0.0,
+           st->blunders[COMPUTER], st->chances[COMPUTER],
+           st->chances[COMPUTER] ? st->blunders[COMPUTER]*100.0/st->chances[COMPUTER] : 0.0);
+    games+=st->games;
+    moves+=st->moves;
+    passes+=st->passes;
+  }
+  printf("(blunders: moves that left a won position for the other side, of those made from one)\n");
+  printf("%lu games, %lu moves and %lu passes in %lu bytes, %.2f bytes a turn with the headers, %lu bad games\n",
+         games, moves, passes, (unsigned long)corpus_len,
+         (moves+passes) ? (double)corpus_len/(moves+passes) : 0.0, bad_games);
+
+  // the time, replaying the good games again without counting
+  if (moves>0)
+  {
+    runs=0;
+    t0=now_s();
+    do
+    {
+      replay(corpus, corpus_len, 0, &bad_at);
+      runs++;
+      t=now_s()-t0;
+    } while (t<MIN_REPLAY_S);
+    printf("replay: %.1f million moves a second (%d runs of the corpus in %.2f s)\n",
+           moves*(double)runs/t/1e6, runs, t);
+  }
+  return(bad_games ? 1 : 0);
+}
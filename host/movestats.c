@@ -0,0 +1,763 @@
+/***********************************************************
+ * movestats.c
+ * Mines logs of games in the move stream of movelog.h (from the
+ * device, sim -M or movereplay -w) for:
+ *  - how often the player wins at each level
+ *  - how the user's moves rate against the engine. From a won
+ *    position a move is the best (as quick a win as there is),
+ *    slower (still wins), or a blunder (leaves a won position for
+ *    the computer). From a lost position, it is the best if it puts
+ *    off the end as long as it can. How long is only known for
+ *    Nim of up to DISTANCE_ROWS rows of DISTANCE_MAX sticks, from
+ *    the firmware's distance table (distance.h); otherwise winning
+ *    moves all count as the best, from nimk_lost() or wythoff_cold()
+ *  - the won positions the user blunders from most
+ *  - the first moves that lose the most games
+ *
+ * Each file is mapped, and split into a chunk per thread. The stream
+ * has nothing to sync on, so a thread starts at the first place in
+ * its chunk that looks like the start of a game (an end marker, then
+ * a header that checks out), and carries on past the end of its
+ * chunk to finish its last game. If that doesn't land where the next
+ * thread started, the next thread's chunk is done again from there.
+ * Each thread counts into its own tables, with no locks, and they
+ * are added up at the end. A bad game is counted, and the thread
+ * syncs again after it.
+ *
+ * Positions and moves are kept up to the order of the rows (sorted,
+ * a nibble a row).
+ *
+ * usage: movestats [-j threads] [-n lines] file ...
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "nim.h"
+#include "gamelog.h"
+#include "movelog.h"
+#include "nimk.h"
+#include "wythoff.h"
+#include "distance.h"
+#include "distance_data.h"
+
+/********* definitions *****************/
+#define MAX_LEVEL 7
+#define MAX_THREADS 64
+#define USER 0
+#define COMPUTER 1
+#define DIRECT_SIZE 100000 // positions of 5 rows of up to 9, as decimal digits
+#define MIN_FACED 20       // times a position must be met to be listed
+#define IS_END(b) (((b) & 0x8f)==0 && ((b)>>4)>=1 && ((b)>>4)<=GAMELOG_COMPUTER+1)
+
+// moves, by how they rate
+#define BEST 0
+#define SLOWER 1
+#define BLUNDER 2
+#define LOST_BEST 3
+#define LOST_OTHER 4
+#define RATINGS 5
+
+/*************** types ***********************/
+typedef struct
+{
+  uint64_t games, player_wins, abandoned, moves, passes;
+  uint64_t rated[2][RATINGS]; // moves by side and how they rate
+} level_stats_t;
+
+// an open addressed hash of counts, keyed by position or move
+typedef struct
+{
+  uint64_t key;
+  uint32_t a, b;
+} tally_t;
+
+typedef struct
+{
+  tally_t* t;
+  size_t size, used; // size a power of 2
+} table_t;
+
+typedef struct
+{
+  const uint8_t* buf;
+  size_t len;
+  size_t from, limit; // the chunk
+  size_t start;       // where the first game taken was
+  size_t next;        // where the game after the last one taken starts
+  level_stats_t stats[MAX_LEVEL+1];
+  uint64_t bad;
+  table_t positions;  // won positions the user met: a faced, b blundered
+  uint32_t* exact;    // ..the same for Nim that the distance table covers, by rows and direct[] index
+  table_t first;      // first moves: a played, b lost
+} work_t;
+
+/******** global variables **************/
+unsigned char direct[DIRECT_SIZE]; // distance to the end, indexed by the rows as digits
+const uint32_t place[DISTANCE_ROWS]={1, 10, 100, 1000, 10000};
+level_stats_t totals[MAX_LEVEL+1];
+uint64_t total_bad=0;
+table_t all_positions, all_first;
+work_t work[MAX_THREADS];
+int num_threads=0;
+int num_lines=10;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static double
+now_s(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec+ts.tv_nsec/1e9);
+}
+
+/* tally
+ * the counts for a key (never 0), added if it is new
+ */
+static tally_t*
+tally(table_t* tb, uint64_t key)
+{
+  tally_t* old;
+  size_t i, n;
+
+  if (2*(tb->used+1)>tb->size)
+  {
+    old=tb->t;
+    n=tb->size;
+    tb->size=n ? 2*n : 1024;
+    tb->t=calloc(tb->size, sizeof(tally_t));
+    tb->used=0;
+    for (i=0; i<n; i++)
+    {
+      if (old[i].key)
+        *tally(tb, old[i].key)=old[i];
+    }
+    free(old);
+  }
+  i=(size_t)((key*0x9e3779b97f4a7c15ULL)>>32) & (tb->size-1);
+  while (tb->t[i].key && (tb->t[i].key!=key))
+    i=(i+1) & (tb->size-1);
+  if (tb->t[i].key==0)
+  {
+    tb->t[i].key=key;
+    tb->used++;
+  }
+  return(&tb->t[i]);
+}
+
+/* merge
+ * adds one table's counts to another, and frees it
+ */
+static void
+merge(table_t* to, table_t* from)
+{
+  tally_t* t;
+  size_t i;
+
+  for (i=0; i<from->size; i++)
+  {
+    if (from->t[i].key==0)
+      continue;
+    t=tally(to, from->t[i].key);
+    t->a+=from->t[i].a;
+    t->b+=from->t[i].b;
+  }
+  free(from->t);
+  memset(from, 0, sizeof(*from));
+}
+
+/* digits
+ * the rows of a direct[] index
+ */
+static void
+digits(uint32_t idx, unsigned char* s)
+{
+  int i;
+
+  for (i=0; i<DISTANCE_ROWS; i++, idx/=10)
+    s[i]=(unsigned char)(idx%10);
+}
+
+/* sorted
+ * the rows up to their order: sorted, a nibble each, with the number
+ * of rows in the nibble above them
+ */
+static uint64_t
+sorted(const unsigned char* sticks, int rows)
+{
+  unsigned char s[MOVELOG_MAX_ROWS];
+  uint64_t key=0;
+  int i, j;
+  unsigned char v;
+
+  for (i=0; i<rows; i++)
+  {
+    v=sticks[i];
+    for (j=i; (j>0) && (s[j-1]>v); j--)
+      s[j]=s[j-1];
+    s[j]=v;
+  }
+  for (i=0; i<rows; i++)
+    key|=(uint64_t)s[i]<<(4*i);
+  return(key | ((uint64_t)rows<<(4*MOVELOG_MAX_ROWS)));
+}
+
+/* show
+ * prints rows kept by sorted()
+ */
+static void
+show(uint64_t key, char* out)
+{
+  int i, rows=(int)((key>>(4*MOVELOG_MAX_ROWS)) & 0x0f);
+
+  for (i=0; i<rows; i++)
+    out+=sprintf(out, "%s%u", i ? "," : "", (unsigned)((key>>(4*i)) & 0x0f));
+}
+
+/* lost
+ * whether the player to move loses, by the rules in the header
+ */
+static int
+lost(const unsigned char* sticks, int rows, int rules, unsigned x, unsigned big, unsigned ones)
+{
+  uint32_t heaps[MOVELOG_MAX_ROWS];
+  int i;
+
+  if (rules==1)
+    return(big ? (x==0) : (ones & 1));
+  if (rules==MOVELOG_WYTHOFF)
+    return(wythoff_cold(sticks));
+  for (i=0; i<rows; i++)
+    heaps[i]=sticks[i];
+  return(nimk_lost(heaps, (unsigned char)rows, (unsigned char)rules, 1));
+}
+
+/* header_ok
+ * whether a game could start at p
+ */
+static int
+header_ok(const uint8_t* p, size_t len)
+{
+  int rows, rules;
+
+  if ((len<MOVELOG_HEADER_BYTES+1) || (p[0]!=MOVELOG_MAGIC) || (p[1]>MAX_LEVEL))
+    return(0);
+  rows=p[4] & 0x0f;
+  rules=p[4]>>4;
+  return((rows>=1) && (rows<=MOVELOG_MAX_ROWS) && ((rules==MOVELOG_WYTHOFF) ? (rows==2) : (rules<=rows)));
+}
+
+/* find_game
+ * the first place from pos on that looks like the start of a game
+ */
+static size_t
+find_game(const uint8_t* buf, size_t len, size_t pos)
+{
+  if (pos==0)
+    return(0);
+  for (; pos<len; pos++)
+  {
+    if (IS_END(buf[pos-1]) && header_ok(buf+pos, len-pos))
+      return(pos);
+  }
+  return(len);
+}
+
+/* game
+ * counts the game at p, of up to len bytes, into w. Returns its
+ * length, or 0 if it is bad
+ */
+static size_t
+game(work_t* w, const uint8_t* p, size_t len)
+{
+  unsigned char sticks[MOVELOG_MAX_ROWS];
+  const uint8_t* start=p;
+  const uint8_t* end=p+len;
+  level_stats_t* st;
+  tally_t* t;
+  uint64_t before_key, first_key=0;
+  unsigned x=0, big=0, ones=0, used, idx=0, idx_before;
+  uint32_t* c;
+  int level, rows, rules, i, side=USER, won, n, total=0, winner, after_won, first=1;
+  int exact, d_before=0, d_after=0, slow, r;
+  uint8_t b;
+
+  if (!header_ok(p, len))
+    return(0);
+  level=p[1];
+  rows=p[4] & 0x0f;
+  rules=p[4]>>4;
+  exact=(rules==1) && (rows<=DISTANCE_ROWS);
+  for (i=0; i<rows; i++)
+  {
+    sticks[i]=(p[5+i/2]>>((i & 1)*4)) & 0x0f;
+    total+=sticks[i];
+    x^=sticks[i];
+    big+=(sticks[i]>1);
+    ones+=(sticks[i]==1);
+    if (sticks[i]>DISTANCE_MAX)
+      exact=0;
+    else if (i<DISTANCE_ROWS)
+      idx+=sticks[i]*place[i];
+  }
+  st=&w->stats[level];
+  p+=MOVELOG_HEADER_BYTES;
+  // whether the side to move wins is carried from move to move. A
+  // position in the distance table is won just when its distance is even
+  if (exact)
+  {
+    d_before=direct[idx];
+    won=!(d_before & 1);
+  }
+  else
+  {
+    won=!lost(sticks, rows, rules, x, big, ones);
+  }
+  for (;;)
+  {
+    if (p==end)
+      return(0);
+    b=*p++;
+    if (MOVELOG_TAKEN(b)==0)
+    {
+      if (b==MOVELOG_PASS)
+      {
+        if ((side!=USER) || (total<=1))
+          return(0);
+        st->passes++;
+        side=COMPUTER;
+        first=0;
+        continue;
+      }
+      winner=MOVELOG_WINNER(b);
+      if ((b & MOVELOG_MORE) || (winner>GAMELOG_COMPUTER) ||
+          ((winner!=GAMELOG_ABANDONED) &&
+           ((total!=1) || (winner!=((side==COMPUTER) ? GAMELOG_PLAYER : GAMELOG_COMPUTER)))))
+        return(0);
+      st->games++;
+      st->player_wins+=(winner==GAMELOG_PLAYER);
+      st->abandoned+=(winner==GAMELOG_ABANDONED);
+      if (first_key && (winner!=GAMELOG_ABANDONED))
+      {
+        t=tally(&w->first, first_key);
+        t->a++;
+        t->b+=(winner==GAMELOG_COMPUTER);
+      }
+      return((size_t)(p-start));
+    }
+    if (total<=1)
+      return(0);
+    idx_before=idx;
+    before_key=((side==USER) && (first || (won && !exact))) ? sorted(sticks, rows) : 0;
+    used=0;
+    n=0;
+    for (;;)
+    {
+      i=MOVELOG_ROW(b);
+      if ((i>=rows) || (used & (1U<<i)) || (MOVELOG_TAKEN(b)>sticks[i]))
+        return(0);
+      used|=1U<<i;
+      n++;
+      x^=sticks[i];
+      big-=(sticks[i]>1);
+      ones-=(sticks[i]==1);
+      sticks[i]-=MOVELOG_TAKEN(b);
+      total-=MOVELOG_TAKEN(b);
+      x^=sticks[i];
+      big+=(sticks[i]>1);
+      ones+=(sticks[i]==1);
+      if (exact)
+        idx-=MOVELOG_TAKEN(b)*place[i];
+      if (!(b & MOVELOG_MORE))
+        break;
+      if ((p==end) || (MOVELOG_TAKEN(*p)==0) ||
+          ((rules==MOVELOG_WYTHOFF) && (MOVELOG_TAKEN(*p)!=MOVELOG_TAKEN(b))))
+        return(0);
+      b=*p++;
+    }
+    if ((n>((rules==MOVELOG_WYTHOFF) ? 2 : rules)) || (total==0))
+      return(0);
+    st->moves++;
+    if (exact)
+    {
+      d_after=direct[idx];
+      after_won=!(d_after & 1);
+    }
+    else
+    {
+      after_won=!lost(sticks, rows, rules, x, big, ones);
+    }
+    // without branches where they can't be guessed, as moves of
+    // either rating come in any order
+    slow=exact & (d_after!=d_before-1);
+    r=won ? (after_won ? BLUNDER : BEST+slow) : LOST_BEST+slow;
+    st->rated[side][r]++;
+    if ((side==USER) && won)
+    {
+      if (exact)
+      {
+        c=&w->exact[2*((rows-1)*DIRECT_SIZE+idx_before)];
+        c[0]++;
+        c[1]+=after_won;
+      }
+      else
+      {
+        t=tally(&w->positions, before_key | ((uint64_t)rules<<60));
+        t->a++;
+        t->b+=after_won;
+      }
+    }
+    if (first && (side==USER))
+      first_key=(before_key<<32) | sorted(sticks, rows) | ((uint64_t)rules<<28);
+    first=0;
+    side=1-side;
+    won=after_won;
+    d_before=d_after;
+  }
+}
+
+/* run
+ * counts the games starting in w's chunk
+ */
+static void
+run(work_t* w, size_t from)
+{
+  size_t pos, n;
+
+  w->start=pos=find_game(w->buf, w->len, from);
+  while (pos<w->limit)
+  {
+    n=game(w, w->buf+pos, w->len-pos);
+    if (n==0)
+    {
+      w->bad++;
+      pos=find_game(w->buf, w->len, pos+1);
+      continue;
+    }
+    pos+=n;
+  }
+  w->next=pos;
+}
+
+static void*
+thread_main(void* arg)
+{
+  work_t* w=arg;
+
+  run(w, w->from);
+  return(NULL);
+}
+
+/* merge_exact
+ * adds a chunk's counts of the positions the distance table covers
+ * to the rest, up to the order of the rows
+ */
+static void
+merge_exact(work_t* w)
+{
+  unsigned char s[DISTANCE_ROWS];
+  uint32_t* c;
+  tally_t* t;
+  uint32_t idx;
+  int rows;
+
+  for (rows=1; rows<=DISTANCE_ROWS; rows++)
+  {
+    for (idx=0; idx<DIRECT_SIZE; idx++)
+    {
+      c=&w->exact[2*((rows-1)*DIRECT_SIZE+idx)];
+      if (c[0]==0)
+        continue;
+      digits(idx, s);
+      t=tally(&all_positions, sorted(s, rows) | (1ULL<<60));
+      t->a+=c[0];
+      t->b+=c[1];
+    }
+  }
+}
+
+/* clear
+ * empties the counts of a chunk
+ */
+static void
+clear(work_t* w)
+{
+  free(w->positions.t);
+  free(w->first.t);
+  free(w->exact);
+  // the pages are only mapped in when they are first counted into
+  w->exact=calloc(2*DISTANCE_ROWS*DIRECT_SIZE, sizeof(uint32_t));
+  memset(w->stats, 0, sizeof(w->stats));
+  memset(&w->positions, 0, sizeof(w->positions));
+  memset(&w->first, 0, sizeof(w->first));
+  w->bad=0;
+}
+
+/* analyse
+ * counts a mapped file, a chunk per thread. Returns the chunks done
+ * again
+ */
+static int
+analyse(const uint8_t* buf, size_t len)
+{
+  pthread_t tid[MAX_THREADS];
+  work_t* w;
+  int t, i, redone=0;
+
+  for (t=0; t<num_threads; t++)
+  {
+    w=&work[t];
+    clear(w);
+    w->buf=buf;
+    w->len=len;
+    w->from=len/num_threads*t;
+    w->limit=(t==num_threads-1) ? len : len/num_threads*(t+1);
+    pthread_create(&tid[t], NULL, thread_main, w);
+  }
+  for (t=0; t<num_threads; t++)
+    pthread_join(tid[t], NULL);
+  for (t=1; t<num_threads; t++)
+  {
+    w=&work[t];
+    if (w->start==work[t-1].next)
+      continue;
+    // synced on something that only looked like a game
+    clear(w);
+    run(w, work[t-1].next);
+    redone++;
+  }
+  for (t=0; t<num_threads; t++)
+  {
+    w=&work[t];
+    for (i=0; i<=MAX_LEVEL; i++)
+    {
+      level_stats_t* a=&totals[i];
+      level_stats_t* b=&w->stats[i];
+      int r;
+
+      a->games+=b->games;
+      a->player_wins+=b->player_wins;
+      a->abandoned+=b->abandoned;
+      a->moves+=b->moves;
+      a->passes+=b->passes;
+      for (r=0; r<RATINGS; r++)
+      {
+        a->rated[USER][r]+=b->rated[USER][r];
+        a->rated[COMPUTER][r]+=b->rated[COMPUTER][r];
+      }
+    }
+    total_bad+=w->bad;
+    merge_exact(w);
+    merge(&all_positions, &w->positions);
+    merge(&all_first, &w->first);
+  }
+  return(redone);
+}
+
+/* make_direct
+ * the distance table by the rows as decimal digits, so that a move
+ * only needs a subtraction to look up
+ */
+static void
+make_direct(void)
+{
+  unsigned char s[DISTANCE_ROWS];
+  uint32_t idx;
+
+  for (idx=0; idx<DIRECT_SIZE; idx++)
+  {
+    digits(idx, s);
+    direct[idx]=distance_to_end(s, DISTANCE_ROWS);
+  }
+}
+
+static int
+by_b(const void* p, const void* q)
+{
+  const tally_t* a=p;
+  const tally_t* b=q;
+
+  if (a->b!=b->b)
+    return((a->b<b->b) ? 1 : -1);
+  return((a->a<b->a) ? 1 : (a->a>b->a) ? -1 : 0);
+}
+
+/* top
+ * the entries of a table with the highest b (and at least min a), by b
+ */
+static int
+top(const table_t* tb, tally_t* out, int n, uint32_t min)
+{
+  tally_t* all;
+  size_t i, k=0;
+
+  all=malloc((tb->used+1)*sizeof(tally_t));
+  for (i=0; i<tb->size; i++)
+  {
+    if (tb->t[i].key && (tb->t[i].a>=min))
+      all[k++]=tb->t[i];
+  }
+  qsort(all, k, sizeof(tally_t), by_b);
+  if ((size_t)n>k)
+    n=(int)k;
+  memcpy(out, all, n*sizeof(tally_t));
+  free(all);
+  return(n);
+}
+
+static double
+pc(uint64_t a, uint64_t b)
+{
+  return(b ? a*100.0/b : 0.0);
+}
+
+/* report
+ * the summary tables
+ */
+static void
+report(void)
+{
+  level_stats_t* st;
+  tally_t* best;
+  uint64_t won, lost_moves, computer_won;
+  char a[32], b[32];
+  int i, n;
+
+  printf("level      games  player wins  abandoned  user moves  from won: best  slower  blunder"
+         "  from lost: best  computer blunders\n");
+  for (i=0; i<=MAX_LEVEL; i++)
+  {
+    st=&totals[i];
+    if (st->games==0)
+      continue;
+    won=st->rated[USER][BEST]+st->rated[USER][SLOWER]+st->rated[USER][BLUNDER];
+    lost_moves=st->rated[USER][LOST_BEST]+st->rated[USER][LOST_OTHER];
+    computer_won=st->rated[COMPUTER][BEST]+st->rated[COMPUTER][SLOWER]+st->rated[COMPUTER][BLUNDER];
+    printf("  %d  %10llu  %10.1f%%  %9llu  %10llu  %13.1f%%  %5.1f%%  %6.1f%%  %14.1f%%  %16.1f%%\n", i,
+           (unsigned long long)st->games, pc(st->player_wins, st->games),
+           (unsigned long long)st->abandoned, (unsigned long long)(won+lost_moves),
+           pc(st->rated[USER][BEST], won), pc(st->rated[USER][SLOWER], won), pc(st->rated[USER][BLUNDER], won),
+           pc(st->rated[USER][LOST_BEST], lost_moves), pc(st->rated[COMPUTER][BLUNDER], computer_won));
+  }
+  printf("(how long a game lasts is known for Nim of up to %d rows of %d sticks; elsewhere every"
+         " winning move, and every move from a lost position, is best)\n", DISTANCE_ROWS, DISTANCE_MAX);
+
+  best=malloc(num_lines*sizeof(tally_t));
+  n=top(&all_positions, best, num_lines, MIN_FACED);
+  printf("\nwon positions the user blunders from most (met at least %d times)\n", MIN_FACED);
+  printf("  rows                 rules      met   blunders\n");
+  for (i=0; i<n; i++)
+  {
+    show(best[i].key, a);
+    printf("  %-18s  %6s  %9u  %9u %5.1f%%\n", a,
+           (best[i].key>>60)==MOVELOG_WYTHOFF ? "wythoff" : ((best[i].key>>60)==1) ? "nim" : "nim_k",
+           best[i].a, best[i].b, pc(best[i].b, best[i].a));
+  }
+
+  n=top(&all_first, best, num_lines, 1);
+  printf("\nthe user's first moves that lose the most games\n");
+  printf("  from                 to                       played      lost\n");
+  for (i=0; i<n; i++)
+  {
+    show(best[i].key>>32, a);
+    show(best[i].key & ((1ULL<<28)-1), b);
+    printf("  %-18s   %-18s  %10u  %8u %5.1f%%\n", a, b, best[i].a, best[i].b, pc(best[i].b, best[i].a));
+  }
+  free(best);
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  struct stat sb;
+  const uint8_t* buf;
+  uint64_t bytes=0, games=0, moves=0;
+  double t0, t;
+  int c, i, fd, redone=0;
+
+  while ((c=getopt(argc, argv, "j:n:"))!=-1)
+  {
+    switch(c)
+    {
+      case 'j':
+        num_threads=atoi(optarg);
+        break;
+      case 'n':
+        num_lines=atoi(optarg);
+        break;
+      default:
+        optind=argc;
+        break;
+    }
+  }
+  if (optind>=argc)
+  {
+    fprintf(stderr, "usage: %s [-j threads] [-n lines] file ...\n", argv[0]);
+    return(2);
+  }
+  if (num_threads<1)
+    num_threads=(int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (num_threads<1)
+    num_threads=1;
+  if (num_threads>MAX_THREADS)
+    num_threads=MAX_THREADS;
+  if (num_lines<1)
+    num_lines=1;
+  make_direct();
+
+  t0=now_s();
+  for (i=optind; i<argc; i++)
+  {
+    fd=open(argv[i], O_RDONLY);
+    if ((fd<0) || (fstat(fd, &sb)!=0))
+    {
+      perror(argv[i]);
+      return(1);
+    }
+    if (sb.st_size==0)
+    {
+      close(fd);
+      continue;
+    }
+    buf=mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (buf==MAP_FAILED)
+    {
+      perror(argv[i]);
+      return(1);
+    }
+    madvise((void*)buf, (size_t)sb.st_size, MADV_SEQUENTIAL);
+    redone+=analyse(buf, (size_t)sb.st_size);
+    munmap((void*)buf, (size_t)sb.st_size);
+    bytes+=(uint64_t)sb.st_size;
+  }
+  t=now_s()-t0;
+
+  report();
+  for (i=0; i<=MAX_LEVEL; i++)
+  {
+    games+=totals[i].games;
+    moves+=totals[i].moves;
+  }
+  printf("\n%llu games, %llu moves in %.1f MB, %llu bad games\n", (unsigned long long)games,
+         (unsigned long long)moves, bytes/1e6, (unsigned long long)total_bad);
+  printf("%d threads, %d chunks done again: %.2f s, %.0f MB/s, %.1f million moves a second\n",
+         num_threads, redone, t, bytes/1e6/t, moves/t/1e6);
+  return(0);
+}
@@ -0,0 +1,327 @@
+/***********************************************************
+ * nimkbench.c
+ * Times and checks Moore's Nim_k (nimk.c), for k from 2 to 4 by
+ * default:
+ *  - every position of 4 rows of up to 7 sticks is solved by
+ *    searching the game tree, and nimk_lost() and nimk_choose()
+ *    checked against it
+ *  - random positions of 2 to 255 rows, up to 2^bits-1 sticks
+ *    each: the time for nimk_choose(), and for the column counts
+ *    bit-sliced (nimk_columns) against a row and a bit at a time.
+ *    Every move is checked to be legal and, if it was reported as
+ *    winning, to leave a lost position
+ * Misere play (the last stick loses) as on pocket-nim, or normal
+ * play with -N.
+ *
+ * usage: nimkbench [-k kmin] [-K kmax] [-n positions] [-b bits] [-r seed] [-N]
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "nimk.h"
+
+/********* definitions *****************/
+#define TREE_ROWS 4
+#define TREE_MAX 7
+#define TREE_SIZE 4096 // (TREE_MAX+1)^TREE_ROWS
+#define POOL_WORDS 16384
+
+/******** global variables **************/
+const unsigned char row_counts[]={2, 4, 8, 16, 32, 64, 128, 255};
+int kmin=2, kmax=4;
+int num_positions=20000;
+int bits=16;
+unsigned char misere=1;
+signed char tree[TREE_SIZE]; // -1 not known yet, 1 lost for the player to move, 0 won
+volatile uint32_t sink;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static double
+now_s(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec+ts.tv_nsec/1e9);
+}
+
+static uint32_t
+rand32(void)
+{
+  return(((uint32_t)rand()<<16) ^ (uint32_t)rand());
+}
+
+/* plain_lost
+ * the rule in nimk.h, counting each column a row at a time
+ */
+static int
+plain_lost(const uint32_t* heaps, int rows, int k)
+{
+  int r, col, n, big=0, ones=0;
+
+  for (r=0; r<rows; r++)
+  {
+    big+=(heaps[r]>1);
+    ones+=(heaps[r]==1);
+  }
+  if (misere && (big==0))
+    return((ones%(k+1))==1);
+  for (col=0; col<32; col++)
+  {
+    for (n=0, r=0; r<rows; r++)
+      n+=(heaps[r]>>col) & 1;
+    if (n%(k+1))
+      return(0);
+  }
+  return(1);
+}
+
+/* tree_lost
+ * solves a position of TREE_ROWS rows by trying every move
+ */
+static int
+tree_lost(const uint32_t* heaps, int k);
+
+/* tree_move
+ * tries every move from row r on, having taken from used rows so far.
+ * Returns 1 if one of them leaves a lost position
+ */
+static int
+tree_move(uint32_t* heaps, int k, int r, int used)
+{
+  uint32_t was;
+  int found=0;
+
+  if (r==TREE_ROWS)
+    return((used>0) && tree_lost(heaps, k));
+  if (tree_move(heaps, k, r+1, used))
+    return(1);
+  if (used==k)
+    return(0);
+  was=heaps[r];
+  for (heaps[r]=0; (heaps[r]<was) && !found; heaps[r]++)
+    found=tree_move(heaps, k, r+1, used+1);
+  heaps[r]=was;
+  return(found);
+}
+
+static int
+tree_lost(const uint32_t* heaps, int k)
+{
+  uint32_t copy[TREE_ROWS];
+  int r, idx=0, total=0;
+
+  for (r=0; r<TREE_ROWS; r++)
+  {
+    idx=idx*(TREE_MAX+1)+(int)heaps[r];
+    total+=heaps[r];
+  }
+  if (total==0)
+    return(!misere); // the last stick was just taken
+  if (tree[idx]<0)
+  {
+    memcpy(copy, heaps, sizeof(copy));
+    tree[idx]=(signed char)!tree_move(copy, k, 0, 0);
+  }
+  return(tree[idx]);
+}
+
+/* legal
+ * checks that after is a move from heaps: sticks taken from 1 to k
+ * rows, none added
+ */
+static int
+legal(const uint32_t* heaps, const uint32_t* after, int rows, int k)
+{
+  int r, changed=0;
+
+  for (r=0; r<rows; r++)
+  {
+    if (after[r]>heaps[r])
+      return(0);
+    changed+=(after[r]<heaps[r]);
+  }
+  return((changed>=1) && (changed<=k));
+}
+
+/* check_tree
+ * checks every position of the small game against the tree search.
+ * Returns the number of mistakes
+ */
+static int
+check_tree(int k, double* tree_s, double* nimk_s)
+{
+  uint32_t heaps[TREE_ROWS], after[TREE_ROWS];
+  int idx, r, n, lost, won, bad=0;
+  double t0;
+
+  memset(tree, -1, sizeof(tree));
+  t0=now_s();
+  for (idx=0; idx<TREE_SIZE; idx++)
+  {
+    for (n=idx, r=TREE_ROWS-1; r>=0; r--, n/=TREE_MAX+1)
+      heaps[r]=(uint32_t)(n%(TREE_MAX+1));
+    tree_lost(heaps, k);
+  }
+  *tree_s=now_s()-t0;
+  t0=now_s();
+  for (idx=0; idx<TREE_SIZE; idx++)
+  {
+    for (n=idx, r=TREE_ROWS-1; r>=0; r--, n/=TREE_MAX+1)
+      heaps[r]=(uint32_t)(n%(TREE_MAX+1));
+    sink+=nimk_choose(heaps, TREE_ROWS, (unsigned char)k, misere, after);
+  }
+  *nimk_s=now_s()-t0;
+  for (idx=1; idx<TREE_SIZE; idx++) // not the empty board, which has no move
+  {
+    for (n=idx, r=TREE_ROWS-1; r>=0; r--, n/=TREE_MAX+1)
+      heaps[r]=(uint32_t)(n%(TREE_MAX+1));
+    lost=tree_lost(heaps, k);
+    won=nimk_choose(heaps, TREE_ROWS, (unsigned char)k, misere, after);
+    if ((nimk_lost(heaps, TREE_ROWS, (unsigned char)k, misere)!=lost) || (won==lost) ||
+        !legal(heaps, after, TREE_ROWS, k) || (won && !tree_lost(after, k)))
+      bad++;
+  }
+  return(bad);
+}
+
+/* bench
+ * times and checks moves from random positions of the given number of
+ * rows. Returns the number of mistakes
+ */
+static int
+bench(int k, int rows, double* choose_us, double* sliced_ns, double* plain_ns, int* wins)
+{
+  uint32_t* pos;
+  uint32_t after[NIMK_MAX_ROWS], plane[NIMK_PLANES];
+  uint32_t mask=(bits>=32) ? 0xffffffffUL : ((1UL<<bits)-1);
+  int p, r, col, n, pool, bad=0;
+  double t0;
+
+  // a pool of positions that fits in the cache, used in turn
+  pool=POOL_WORDS/rows;
+  if (pool>num_positions)
+    pool=num_positions;
+  pos=malloc((size_t)pool*rows*sizeof(uint32_t));
+  for (p=0; p<pool*rows; p++)
+    pos[p]=rand32() & mask;
+
+  t0=now_s();
+  for (p=0; p<num_positions; p++)
+    nimk_choose(pos+(p%pool)*rows, (unsigned char)rows, (unsigned char)k, misere, after);
+  *choose_us=(now_s()-t0)*1e6/num_positions;
+
+  t0=now_s();
+  for (p=0; p<num_positions; p++)
+  {
+    nimk_columns(pos+(p%pool)*rows, (unsigned char)rows, plane);
+    sink+=plane[0];
+  }
+  *sliced_ns=(now_s()-t0)*1e9/num_positions;
+
+  t0=now_s();
+  for (p=0; p<num_positions; p++)
+  {
+    for (col=0; col<bits; col++)
+    {
+      for (n=0, r=0; r<rows; r++)
+        n+=(pos[(p%pool)*rows+r]>>col) & 1;
+      sink+=(uint32_t)n;
+    }
+  }
+  *plain_ns=(now_s()-t0)*1e9/num_positions;
+
+  *wins=0;
+  for (p=0; p<num_positions; p++)
+  {
+    if (nimk_choose(pos+(p%pool)*rows, (unsigned char)rows, (unsigned char)k, misere, after))
+    {
+      (*wins)++;
+      if (plain_lost(pos+(p%pool)*rows, rows, k) || !plain_lost(after, rows, k))
+        bad++;
+    }
+    else if (!plain_lost(pos+(p%pool)*rows, rows, k))
+    {
+      bad++;
+    }
+    if (!legal(pos+(p%pool)*rows, after, rows, k))
+      bad++;
+  }
+  free(pos);
+  return(bad);
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  int c, k, i, wins, bad, failed=0;
+  unsigned long seed=1;
+  double tree_s, nimk_s, choose_us, sliced_ns, plain_ns;
+
+  while ((c=getopt(argc, argv, "k:K:n:b:r:N"))!=-1)
+  {
+    switch(c)
+    {
+      case 'k':
+        kmin=atoi(optarg);
+        break;
+      case 'K':
+        kmax=atoi(optarg);
+        break;
+      case 'n':
+        num_positions=atoi(optarg);
+        break;
+      case 'b':
+        bits=atoi(optarg);
+        break;
+      case 'r':
+        seed=strtoul(optarg, NULL, 0);
+        break;
+      case 'N':
+        misere=0;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-k kmin] [-K kmax] [-n positions] [-b bits] [-r seed] [-N]\n", argv[0]);
+        return(2);
+    }
+  }
+  if (kmin<1)
+    kmin=1;
+  if (kmax>NIMK_MAX_K)
+    kmax=NIMK_MAX_K;
+  if (num_positions<1)
+    num_positions=1;
+  if ((bits<1) || (bits>32))
+    bits=16;
+  srand(seed);
+
+  printf("%s play, rows of up to %d bits\n", misere ? "misere" : "normal", bits);
+  for (k=kmin; k<=kmax; k++)
+  {
+    bad=check_tree(k, &tree_s, &nimk_s);
+    printf("k=%d: all %d positions of %d rows up to %d: tree search %.3f s, nimk_choose %.4f s, %d wrong\n",
+           k, TREE_SIZE, TREE_ROWS, TREE_MAX, tree_s, nimk_s, bad);
+    failed+=(bad!=0);
+    printf("  rows  move us  sliced ns  plain ns  winning  wrong\n");
+    for (i=0; i<(int)sizeof(row_counts); i++)
+    {
+      bad=bench(k, row_counts[i], &choose_us, &sliced_ns, &plain_ns, &wins);
+      printf("  %4d  %7.3f  %9.1f  %8.1f  %6.1f%%  %5d\n", row_counts[i], choose_us, sliced_ns, plain_ns,
+             wins*100.0/num_positions, bad);
+      failed+=(bad!=0);
+    }
+  }
+  return(failed ? 1 : 0);
+}
@@ -0,0 +1,455 @@
+/***********************************************************
+ * nimload.c
+ * Loads nimserver as a kiosk back-end would, with many sessions on
+ * a few connections, and reports the moves a second it keeps up and
+ * how long a move takes to come back.
+ *
+ * Each connection has its share of the sessions, and sends them a
+ * request each in turn, -b at a time, then waits for the replies
+ * before it sends the next lot. A session that has no game going
+ * opens one, and otherwise the user takes a random number of sticks
+ * from a random row. The sessions are all opened before the clock
+ * starts, and closed after it stops.
+ *
+ * The games won and lost are of those started with the clock going.
+ *
+ * The time of a request is from when its lot was sent to when its
+ * reply came back, in steps of HIST_STEP_NS up to HIST_MAX_NS.
+ *
+ * Run it with the server going, e.g.
+ *   ./nimserver & ./nimload -c 16 -s 100000 -b 64 -d 10
+ *
+ * usage: nimload [-c connections] [-s sessions] [-b batch] [-d seconds]
+ *                [-l level] [-r seed] [-p path]
+ *   level 0, the default, is a random level for each game
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "nimserver.h"
+
+/********* definitions *****************/
+#define MAX_CONNS 1024
+#define MAX_BATCH 512 // nimserver's CONN_BATCH
+#define HIST_STEP_NS 100
+#define HIST_MAX_NS 100000000
+#define HIST_SIZE (HIST_MAX_NS/HIST_STEP_NS+1)
+
+/*************** types ***********************/
+typedef struct
+{
+  uint32_t id;
+  uint8_t playing;
+  uint8_t timed;         // the game was opened with the clock going
+  uint8_t rows;
+  uint8_t sticks[NIMSRV_ROWS];
+} game_t;
+
+typedef struct
+{
+  int fd;
+  uint32_t first, count, next; // its sessions, and the next to send to
+  uint32_t sent, got;
+  uint64_t sent_ns;
+  uint32_t in_len;
+  uint32_t lot[MAX_BATCH];     // the session of each request in flight
+  uint8_t in[MAX_BATCH*sizeof(nimsrv_reply_t)];
+} conn_t;
+
+/******** global variables **************/
+int num_conns=16;
+uint32_t num_sessions=100000;
+uint32_t batch=64;
+double seconds=5;
+int level;
+uint32_t randreg=1;
+const char* path=NIMSRV_PATH;
+
+game_t* games;
+conn_t* conns;
+uint32_t opened;
+uint64_t t0;
+int timing, draining;
+uint64_t moves, new_games, won, lost, errors;
+uint32_t hist[HIST_SIZE];
+uint64_t timed, max_ns;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* now_ns
+ */
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((uint64_t)ts.tv_sec*1000000000ULL+ts.tv_nsec);
+}
+
+/* rnd
+ * xorshift32
+ */
+static uint32_t
+rnd(void)
+{
+  randreg ^= randreg<<13;
+  randreg ^= randreg>>17;
+  randreg ^= randreg<<5;
+  return(randreg);
+}
+
+/* send_all
+ */
+static void
+send_all(int fd, const void* buf, size_t len)
+{
+  const uint8_t* p=buf;
+  ssize_t n;
+
+  while (len>0)
+  {
+    n=write(fd, p, len);
+    if (n<0)
+    {
+      if (errno==EINTR)
+        continue;
+      perror("write");
+      exit(1);
+    }
+    p+=n;
+    len-=(size_t)n;
+  }
+}
+
+/* send_lot
+ * the next request for each of the next batch sessions
+ */
+static void
+send_lot(conn_t* c)
+{
+  nimsrv_request_t q[MAX_BATCH];
+  game_t* g;
+  uint32_t i, n;
+  int row;
+
+  n=(batch<c->count) ? batch : c->count;
+  memset(q, 0, n*sizeof(q[0]));
+  for (i=0; i<n; i++)
+  {
+    c->lot[i]=c->first+c->next;
+    g=&games[c->lot[i]];
+    if (++c->next==c->count)
+      c->next=0;
+    q[i].id=g->id;
+    if (!g->playing)
+    {
+      q[i].op=NIMSRV_OPEN;
+      q[i].arg=(uint8_t)(level ? (uint32_t)level : 1+rnd()%NIMSRV_LEVELS);
+      continue;
+    }
+    row=rnd()%g->rows;
+    while (g->sticks[row]==0)
+    {
+      if (++row==g->rows)
+        row=0;
+    }
+    q[i].op=NIMSRV_MOVE;
+    q[i].arg=(uint8_t)row;
+    q[i].arg2=(uint8_t)(1+rnd()%g->sticks[row]);
+  }
+  c->sent=n;
+  c->got=0;
+  c->sent_ns=now_ns();
+  send_all(c->fd, q, n*sizeof(q[0]));
+}
+
+/* took
+ * a reply, to the request the time of which is ns
+ */
+static void
+took(game_t* g, const nimsrv_reply_t* r, uint64_t ns)
+{
+  int was_playing=g->playing;
+
+  switch(r->status)
+  {
+    case NIMSRV_OK:
+      if (!was_playing)
+      {
+        if (g->id==NIMSRV_NEW)
+          opened++;
+        g->id=r->id;
+        g->playing=1;
+        g->timed=(uint8_t)timing;
+        new_games+=timing;
+      }
+      else
+        moves+=timing;
+      g->rows=r->rows;
+      memcpy(g->sticks, r->sticks, sizeof(g->sticks));
+      break;
+    case NIMSRV_WON:
+    case NIMSRV_LOST:
+      g->playing=0;
+      moves+=timing;
+      // only the games started with the clock going, so that the
+      // games finished are some of those started
+      if (r->status==NIMSRV_WON)
+        won+=g->timed && timing;
+      else
+        lost+=g->timed && timing;
+      break;
+    case NIMSRV_FULL:
+      fprintf(stderr, "the server has no room for %u sessions (nimserver -n)\n", num_sessions);
+      exit(1);
+    default:
+      errors++;
+      g->playing=0;
+      break;
+  }
+  if (!timing)
+    return;
+  timed++;
+  if (ns>max_ns)
+    max_ns=ns;
+  hist[(ns<HIST_MAX_NS) ? ns/HIST_STEP_NS : HIST_SIZE-1]++;
+}
+
+/* replies
+ * reads the replies there are on a connection, and sends the next
+ * lot once they are all in
+ */
+static void
+replies(conn_t* c)
+{
+  nimsrv_reply_t r;
+  uint64_t ns;
+  uint32_t off;
+  ssize_t n;
+
+  n=read(c->fd, c->in+c->in_len, sizeof(c->in)-c->in_len);
+  if (n<=0)
+  {
+    if ((n<0) && ((errno==EINTR) || (errno==EAGAIN)))
+      return;
+    fprintf(stderr, "the server has gone\n");
+    exit(1);
+  }
+  c->in_len+=(uint32_t)n;
+  ns=now_ns()-c->sent_ns;
+  for (off=0; off+sizeof(r)<=c->in_len; off+=sizeof(r))
+  {
+    memcpy(&r, c->in+off, sizeof(r));
+    took(&games[c->lot[c->got++]], &r, ns);
+  }
+  c->in_len-=off;
+  memmove(c->in, c->in+off, c->in_len);
+  if ((c->got==c->sent) && !draining)
+    send_lot(c);
+}
+
+/* percentile
+ * of the times, in microseconds
+ */
+static double
+percentile(double p)
+{
+  uint64_t want=(uint64_t)(p/100*timed), sum=0;
+  uint32_t i;
+
+  for (i=0; i<HIST_SIZE; i++)
+  {
+    sum+=hist[i];
+    if (sum>want)
+      break;
+  }
+  return((i+1)*HIST_STEP_NS/1000.0);
+}
+
+/* close_all
+ * closes each connection's sessions, a lot at a time
+ */
+static void
+close_all(conn_t* c)
+{
+  nimsrv_request_t q[MAX_BATCH];
+  nimsrv_reply_t r[MAX_BATCH];
+  uint32_t i, n, done;
+  size_t want;
+  ssize_t got;
+
+  memset(q, 0, sizeof(q));
+  for (done=0; done<c->count; done+=n)
+  {
+    n=c->count-done;
+    if (n>batch)
+      n=batch;
+    for (i=0; i<n; i++)
+    {
+      q[i].id=games[c->first+done+i].id;
+      q[i].op=NIMSRV_CLOSE;
+    }
+    send_all(c->fd, q, n*sizeof(q[0]));
+    for (want=n*sizeof(r[0]); want>0; want-=(size_t)got)
+    {
+      got=read(c->fd, r, (want<sizeof(r)) ? want : sizeof(r));
+      if (got<=0)
+        return;
+    }
+  }
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  struct sockaddr_un addr;
+  struct epoll_event ev, events[MAX_CONNS];
+  uint64_t t;
+  double elapsed;
+  uint32_t i, share;
+  int ep, n, opt;
+
+  while ((opt=getopt(argc, argv, "c:s:b:d:l:r:p:"))!=-1)
+  {
+    switch(opt)
+    {
+      case 'c':
+        num_conns=atoi(optarg);
+        break;
+      case 's':
+        num_sessions=(uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'b':
+        batch=(uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'd':
+        seconds=atof(optarg);
+        break;
+      case 'l':
+        level=atoi(optarg);
+        break;
+      case 'r':
+        randreg=(uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'p':
+        path=optarg;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-c connections] [-s sessions] [-b batch] [-d seconds]\n"
+                        "       [-l level] [-r seed] [-p path]\n", argv[0]);
+        return(2);
+    }
+  }
+  if ((num_conns<1) || (num_conns>MAX_CONNS))
+    num_conns=(num_conns<1) ? 1 : MAX_CONNS;
+  if (num_sessions<(uint32_t)num_conns)
+    num_sessions=num_conns;
+  if ((batch<1) || (batch>MAX_BATCH))
+    batch=(batch<1) ? 1 : MAX_BATCH;
+  if ((level<0) || (level>NIMSRV_LEVELS))
+    level=0;
+  if (randreg==0)
+    randreg=1;
+  if (strlen(path)>=sizeof(addr.sun_path))
+  {
+    fprintf(stderr, "%s: path too long\n", path);
+    return(1);
+  }
+
+  games=malloc(num_sessions*sizeof(game_t));
+  conns=calloc(num_conns, sizeof(conn_t));
+  if ((games==NULL) || (conns==NULL))
+  {
+    fprintf(stderr, "no room for %u sessions\n", num_sessions);
+    return(1);
+  }
+  for (i=0; i<num_sessions; i++)
+  {
+    games[i].id=NIMSRV_NEW;
+    games[i].playing=0;
+    games[i].timed=0;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family=AF_UNIX;
+  strcpy(addr.sun_path, path);
+  ep=epoll_create1(0);
+  share=num_sessions/num_conns;
+  for (n=0; n<num_conns; n++)
+  {
+    conns[n].fd=socket(AF_UNIX, SOCK_STREAM, 0);
+    if ((conns[n].fd<0) || (connect(conns[n].fd, (struct sockaddr*)&addr, sizeof(addr))<0))
+    {
+      perror(path);
+      return(1);
+    }
+    conns[n].first=n*share;
+    conns[n].count=(n==num_conns-1) ? num_sessions-n*share : share;
+    ev.events=EPOLLIN;
+    ev.data.ptr=&conns[n];
+    epoll_ctl(ep, EPOLL_CTL_ADD, conns[n].fd, &ev);
+  }
+
+  for (n=0; n<num_conns; n++)
+    send_lot(&conns[n]);
+  t=now_ns();
+  for (;;)
+  {
+    n=epoll_wait(ep, events, MAX_CONNS, 100);
+    if ((n<0) && (errno!=EINTR))
+    {
+      perror("epoll_wait");
+      return(1);
+    }
+    while (n-->0)
+      replies((conn_t*)events[n].data.ptr);
+    if (!timing && (opened==num_sessions))
+    {
+      t0=now_ns();
+      fprintf(stderr, "nimload: %u sessions opened in %.3f s, on %d connections, %u requests a lot\n",
+              num_sessions, (t0-t)/1e9, num_conns, batch);
+      timing=1;
+    }
+    if (timing && (now_ns()-t0>=seconds*1e9))
+      break;
+  }
+  elapsed=(now_ns()-t0)/1e9;
+
+  // let the last lots come back, then close the sessions
+  timing=0;
+  draining=1;
+  for (n=0; n<num_conns; n++)
+  {
+    while (conns[n].got<conns[n].sent)
+      replies(&conns[n]);
+  }
+  for (n=0; n<num_conns; n++)
+  {
+    close_all(&conns[n]);
+    close(conns[n].fd);
+  }
+
+  printf("moves: %llu in %.2f s, %.0f a second\n", (unsigned long long)moves, elapsed, moves/elapsed);
+  printf("games: %llu started, of which %llu won by the user and %llu lost; %llu errors\n",
+         (unsigned long long)new_games, (unsigned long long)won, (unsigned long long)lost,
+         (unsigned long long)errors);
+  printf("request times (us): p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f, of %llu\n",
+         percentile(50), percentile(90), percentile(99), percentile(99.9), max_ns/1000.0,
+         (unsigned long long)timed);
+  return(0);
+}
@@ -0,0 +1,558 @@
+/***********************************************************
+ * nimserver.c
+ * Hosts many games of Nim at once, for the kiosk back-end, on a
+ * Unix domain socket (see nimserver.h for the requests). nim_desktop
+ * plays one game through scanf; this plays up to -n at once, 100000
+ * by default.
+ *
+ * Each session is 8 bytes in an arena: the rows a nibble each, the
+ * session's random_num() register, the level and rows, and a count
+ * that changes when the slot is freed, so that an old id can't name
+ * a new session. Free slots are chained through the rows, and the
+ * arena is only touched as far as it has been used.
+ *
+ * One thread, with epoll. Each time round, every connection that is
+ * ready is read, then all the requests read are played as a batch,
+ * then the replies are written, a write a connection. A connection
+ * is only read when its last replies have all gone, and its buffers
+ * are sized so a full read of requests always has room for the
+ * replies.
+ *
+ * The computer plays as the firmware's computer_play() does for
+ * classic Nim: the move from the distance table (distance.h) from
+ * DISTANCE_LEVEL up, or from classic_choose() (classic.h), unless the
+ * session's draw makes it a mistake by mistake_make().
+ *
+ * On SIGINT or SIGTERM it reports the sessions, the moves and the
+ * batch sizes, and goes.
+ *
+ * usage: nimserver [-n sessions] [-p path]
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#define _GNU_SOURCE // accept4
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "nim.h"
+#include "classic.h"
+#include "distance.h"
+#include "mistake.h"
+#include "nimserver.h"
+
+/********* definitions *****************/
+#define ID_INDEX(id) ((id) & 0xffffff)
+#define ID_GEN(id) ((id)>>24)
+#define MAX_SESSIONS 0xfffffe // so no id is NIMSRV_NEW
+#define MAX_EVENTS 256
+#define CONN_BATCH 512 // requests a read
+#define CONN_IN (CONN_BATCH*sizeof(nimsrv_request_t))
+#define CONN_OUT (CONN_BATCH*sizeof(nimsrv_reply_t))
+#define MAX_FDS 65536
+#define NO_SLOT 0xffffffffU
+
+/*************** types ***********************/
+typedef struct
+{
+  uint32_t sticks;   // a nibble a row, row 0 low, or the next free slot
+  uint16_t randreg;  // the session's random_num() register
+  uint8_t state;     // level<<4 | rows, or 0 if free
+  uint8_t gen;       // changes when the slot is freed
+} session_t;
+
+typedef struct
+{
+  int fd;
+  uint32_t in_len;
+  uint32_t out_len, out_off;
+  uint8_t in[CONN_IN];
+  uint8_t out[CONN_OUT];
+} conn_t;
+
+/******** global variables **************/
+session_t* arena;
+uint32_t max_sessions=100000;
+uint32_t used;            // slots touched so far
+uint32_t free_slot=NO_SLOT;
+uint32_t open_sessions, peak_sessions;
+uint16_t seeds=1;
+conn_t* conns[MAX_FDS];
+volatile sig_atomic_t stop;
+
+uint64_t iterations, batches, requests, moves, games, max_batch;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* session_random
+ * random_num() of main.c, on a session's register
+ */
+static unsigned char
+session_random(session_t* s)
+{
+  char i;
+
+  for (i=0; i<=7; i++)
+  {
+    s->randreg ^= s->randreg>>7;
+    s->randreg ^= s->randreg<<9;
+    s->randreg ^= s->randreg>>13;
+  }
+  return(unsigned char)(s->randreg & 0xff);
+}
+
+/* unpack, pack
+ * a session's rows to and from a nibble each
+ */
+static void
+unpack(uint32_t packed, unsigned char* sticks, int rows)
+{
+  int i;
+
+  for (i=0; i<rows; i++)
+    sticks[i]=(packed>>(4*i)) & 0x0f;
+}
+
+static uint32_t
+pack(const unsigned char* sticks, int rows)
+{
+  uint32_t packed=0;
+  int i;
+
+  for (i=0; i<rows; i++)
+    packed|=(uint32_t)sticks[i]<<(4*i);
+  return(packed);
+}
+
+/* deal
+ * a new game on a level, as setup_game() deals it (for a display 8
+ * high)
+ */
+static void
+deal(session_t* s, int lvl)
+{
+  unsigned char sticks[NIMSRV_ROWS];
+  int i, rows;
+
+  if (lvl>=4)
+  {
+    rows=(lvl==5) ? 5 : 4;
+    for (i=0; i<rows; i++)
+      sticks[i]=(unsigned char)((session_random(s) & 0x07)+1);
+  }
+  else
+  {
+    rows=(lvl==1) ? 3 : 4;
+    for (i=0; i<rows; i++)
+      sticks[i]=(unsigned char)(2*i+1);
+  }
+  s->sticks=pack(sticks, rows);
+  s->state=(uint8_t)((lvl<<4) | rows);
+}
+
+/* computer
+ * the computer's move, into *row and *left
+ */
+static void
+computer(session_t* s, int lvl, const unsigned char* sticks, int rows, unsigned char* row, unsigned char* left)
+{
+  unsigned char threshold;
+
+  if ((lvl>=DISTANCE_LEVEL) && distance_fits(sticks, (unsigned char)rows))
+    distance_choose(sticks, (unsigned char)rows, row, left);
+  else
+    classic_choose(sticks, (unsigned char)rows, row, left);
+  threshold=mistake_threshold((unsigned char)lvl);
+  if (threshold>0)
+    mistake_make(sticks, (unsigned char)rows, session_random(s), threshold, row, left);
+}
+
+/* find
+ * the session an id names, or NULL
+ */
+static session_t*
+find(uint32_t id)
+{
+  uint32_t i=ID_INDEX(id);
+
+  if ((i>=used) || (arena[i].state==0) || (arena[i].gen!=ID_GEN(id)))
+    return(NULL);
+  return(&arena[i]);
+}
+
+/* session_open
+ * a new session, or NULL if there is no room
+ */
+static session_t*
+session_open(void)
+{
+  session_t* s;
+
+  if (free_slot!=NO_SLOT)
+  {
+    s=&arena[free_slot];
+    free_slot=s->sticks;
+  }
+  else if (used<max_sessions)
+    s=&arena[used++];
+  else
+    return(NULL);
+  s->randreg=seeds;
+  seeds=(uint16_t)(seeds*40503U+1); // any register but 0 will do
+  if (s->randreg==0)
+    s->randreg=1;
+  if (++open_sessions>peak_sessions)
+    peak_sessions=open_sessions;
+  return(s);
+}
+
+/* session_close
+ */
+static void
+session_close(session_t* s)
+{
+  s->state=0;
+  s->gen++;
+  s->sticks=free_slot;
+  free_slot=(uint32_t)(s-arena);
+  open_sessions--;
+}
+
+/* play
+ * a request, into its reply
+ */
+static void
+play(const nimsrv_request_t* q, nimsrv_reply_t* r)
+{
+  unsigned char sticks[NIMSRV_ROWS];
+  session_t* s=NULL;
+  int i, lvl, rows, total;
+
+  memset(r, 0, sizeof(*r));
+  r->id=q->id;
+  r->row=NO_MOVE;
+  if ((q->op!=NIMSRV_OPEN) || (q->id!=NIMSRV_NEW))
+  {
+    s=find(q->id);
+    if (s==NULL)
+    {
+      r->status=NIMSRV_GONE;
+      return;
+    }
+  }
+  switch(q->op)
+  {
+    case NIMSRV_OPEN:
+      if ((q->arg<1) || (q->arg>NIMSRV_LEVELS))
+      {
+        r->status=NIMSRV_BAD;
+        return;
+      }
+      if (s==NULL)
+      {
+        s=session_open();
+        if (s==NULL)
+        {
+          r->status=NIMSRV_FULL;
+          return;
+        }
+        r->id=((uint32_t)s->gen<<24) | (uint32_t)(s-arena);
+      }
+      deal(s, q->arg);
+      games++;
+      break;
+    case NIMSRV_MOVE:
+      lvl=s->state>>4;
+      rows=s->state & 0x0f;
+      unpack(s->sticks, sticks, rows);
+      for (total=0, i=0; i<rows; i++)
+        total+=sticks[i];
+      if ((total==0) || (q->arg>=rows) || (q->arg2>sticks[q->arg]))
+      {
+        r->status=NIMSRV_BAD;
+        break;
+      }
+      moves++;
+      sticks[q->arg]-=q->arg2;
+      total-=q->arg2;
+      if (total==0)
+      {
+        r->status=NIMSRV_LOST;
+      }
+      else
+      {
+        computer(s, lvl, sticks, rows, &r->row, &r->left);
+        if (r->row!=NO_MOVE)
+        {
+          total-=sticks[r->row]-r->left;
+          sticks[r->row]=r->left;
+        }
+        if (total==0)
+          r->status=NIMSRV_WON;
+      }
+      s->sticks=pack(sticks, rows);
+      break;
+    case NIMSRV_CLOSE:
+      session_close(s);
+      return;
+    default:
+      r->status=NIMSRV_BAD;
+      return;
+  }
+  r->rows=s->state & 0x0f;
+  unpack(s->sticks, r->sticks, r->rows);
+}
+
+/* conn_close
+ */
+static void
+conn_close(int ep, conn_t* c)
+{
+  epoll_ctl(ep, EPOLL_CTL_DEL, c->fd, NULL);
+  close(c->fd);
+  conns[c->fd]=NULL;
+  free(c);
+}
+
+/* conn_flush
+ * writes what it can of the replies. Returns 1 once they have all
+ * gone, 0 if some are left, or -1 if the connection has gone
+ */
+static int
+conn_flush(conn_t* c)
+{
+  ssize_t n;
+
+  while (c->out_off<c->out_len)
+  {
+    n=write(c->fd, c->out+c->out_off, c->out_len-c->out_off);
+    if (n<0)
+    {
+      if (errno==EINTR)
+        continue;
+      return((errno==EAGAIN) ? 0 : -1);
+    }
+    c->out_off+=(uint32_t)n;
+  }
+  c->out_off=c->out_len=0;
+  return(1);
+}
+
+/* conn_watch
+ * waits on a connection for requests, or for room for its replies
+ */
+static void
+conn_watch(int ep, conn_t* c, uint32_t events)
+{
+  struct epoll_event ev;
+
+  ev.events=events;
+  ev.data.fd=c->fd;
+  epoll_ctl(ep, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+/* accept_all
+ * takes on the connections waiting
+ */
+static void
+accept_all(int ep, int lfd)
+{
+  struct epoll_event ev;
+  conn_t* c;
+  int fd;
+
+  while ((fd=accept4(lfd, NULL, NULL, SOCK_NONBLOCK))>=0)
+  {
+    c=(fd<MAX_FDS) ? calloc(1, sizeof(conn_t)) : NULL;
+    if (c==NULL)
+    {
+      close(fd);
+      continue;
+    }
+    c->fd=fd;
+    conns[fd]=c;
+    ev.events=EPOLLIN;
+    ev.data.fd=fd;
+    epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+  }
+}
+
+/* on_signal
+ */
+static void
+on_signal(int sig)
+{
+  (void)sig;
+  stop=1;
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  struct sockaddr_un addr;
+  struct epoll_event ev, events[MAX_EVENTS];
+  conn_t* ready[MAX_EVENTS];
+  const char* path=NIMSRV_PATH;
+  nimsrv_request_t q;
+  conn_t* c;
+  ssize_t got;
+  uint32_t off, batch;
+  int ep, lfd, n, i, num_ready, opt;
+
+  while ((opt=getopt(argc, argv, "n:p:"))!=-1)
+  {
+    switch(opt)
+    {
+      case 'n':
+        max_sessions=(uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'p':
+        path=optarg;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n sessions] [-p path]\n", argv[0]);
+        return(2);
+    }
+  }
+  if ((max_sessions<1) || (max_sessions>MAX_SESSIONS))
+    max_sessions=MAX_SESSIONS;
+  if (strlen(path)>=sizeof(addr.sun_path))
+  {
+    fprintf(stderr, "%s: path too long\n", path);
+    return(1);
+  }
+  arena=calloc(max_sessions, sizeof(session_t));
+  if (arena==NULL)
+  {
+    fprintf(stderr, "no room for %u sessions\n", max_sessions);
+    return(1);
+  }
+
+  lfd=socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family=AF_UNIX;
+  strcpy(addr.sun_path, path);
+  unlink(path);
+  if ((lfd<0) || (bind(lfd, (struct sockaddr*)&addr, sizeof(addr))<0) || (listen(lfd, SOMAXCONN)<0))
+  {
+    perror(path);
+    return(1);
+  }
+  ep=epoll_create1(0);
+  ev.events=EPOLLIN;
+  ev.data.fd=lfd;
+  epoll_ctl(ep, EPOLL_CTL_ADD, lfd, &ev);
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+  signal(SIGPIPE, SIG_IGN);
+  fprintf(stderr, "nimserver: %s, up to %u sessions (%u bytes each)\n", path, max_sessions,
+          (unsigned)sizeof(session_t));
+
+  while (!stop)
+  {
+    n=epoll_wait(ep, events, MAX_EVENTS, -1);
+    if (n<0)
+    {
+      if (errno==EINTR)
+        continue;
+      perror("epoll_wait");
+      break;
+    }
+    iterations++;
+    // read everything that is ready
+    num_ready=0;
+    for (i=0; i<n; i++)
+    {
+      if (events[i].data.fd==lfd)
+      {
+        accept_all(ep, lfd);
+        continue;
+      }
+      c=conns[events[i].data.fd];
+      if (c==NULL)
+        continue;
+      if (c->out_len>0)
+      {
+        // waiting for room for the last replies
+        switch(conn_flush(c))
+        {
+          case 1:
+            conn_watch(ep, c, EPOLLIN);
+            break;
+          case -1:
+            conn_close(ep, c);
+            break;
+        }
+        continue;
+      }
+      got=read(c->fd, c->in+c->in_len, CONN_IN-c->in_len);
+      if ((got==0) || ((got<0) && (errno!=EAGAIN) && (errno!=EINTR)))
+      {
+        conn_close(ep, c);
+        continue;
+      }
+      if (got>0)
+      {
+        c->in_len+=(uint32_t)got;
+        ready[num_ready++]=c;
+      }
+    }
+    // play them as a batch
+    batch=0;
+    for (i=0; i<num_ready; i++)
+    {
+      c=ready[i];
+      for (off=0; off+sizeof(q)<=c->in_len; off+=sizeof(q))
+      {
+        memcpy(&q, c->in+off, sizeof(q));
+        play(&q, (nimsrv_reply_t*)(c->out+c->out_len));
+        c->out_len+=sizeof(nimsrv_reply_t);
+        batch++;
+      }
+      c->in_len-=off;
+      memmove(c->in, c->in+off, c->in_len);
+    }
+    if (batch>0)
+    {
+      batches++;
+      requests+=batch;
+      if (batch>max_batch)
+        max_batch=batch;
+    }
+    // and a write each for the replies
+    for (i=0; i<num_ready; i++)
+    {
+      c=ready[i];
+      switch(conn_flush(ready[i]))
+      {
+        case 0:
+          conn_watch(ep, c, EPOLLOUT);
+          break;
+        case -1:
+          conn_close(ep, c);
+          break;
+      }
+    }
+  }
+
+  unlink(path);
+  fprintf(stderr, "nimserver: %u sessions open (at most %u), %llu games, %llu moves\n", open_sessions,
+          peak_sessions, (unsigned long long)games, (unsigned long long)moves);
+  fprintf(stderr, "  %llu requests in %llu batches (%.1f a batch, at most %llu), %llu times round\n",
+          (unsigned long long)requests, (unsigned long long)batches,
+          batches ? (double)requests/batches : 0.0, (unsigned long long)max_batch,
+          (unsigned long long)iterations);
+  return(0);
+}
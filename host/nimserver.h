@@ -0,0 +1,73 @@
+/***********************************************************
+ * nimserver.h
+ * The wire format of nimserver, which hosts many games of Nim at
+ * once on a Unix domain socket, and of nimload, which loads it.
+ *
+ * A client sends fixed size requests and gets a reply to each, in
+ * order, on the same connection. Any number may be sent without
+ * waiting for the replies. Both are in the host's byte order, as
+ * the socket is local.
+ *
+ * A game is a session, named by the id that NIMSRV_OPEN gives it.
+ * Sessions belong to the server, not to the connection, so a kiosk
+ * can reconnect and carry on; they last until NIMSRV_CLOSE.
+ *   NIMSRV_OPEN   arg is the level, 1 to NIMSRV_LEVELS, and id is
+ *                 NIMSRV_NEW for a new session, or an open session to
+ *                 start a new game in. The rows are dealt as the
+ *                 firmware's setup_game() deals them
+ *   NIMSRV_MOVE   the user takes arg2 sticks from row arg (0 up), or
+ *                 none for a pass, and the computer replies to it
+ *   NIMSRV_CLOSE  frees the session
+ * The reply has the status, the computer's move (NO_MOVE if it made
+ * none) and the rows after it. The user goes first, and whoever
+ * takes the last stick loses.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef NIMSERVER_H_
+#define NIMSERVER_H_
+
+#include <stdint.h>
+
+/*************** definitions *****************/
+#define NIMSRV_PATH "/tmp/nimserver.sock"
+#define NIMSRV_ROWS 5     // MAXROWS
+#define NIMSRV_LEVELS 5
+#define NIMSRV_NEW 0xffffffffU
+
+// ops
+#define NIMSRV_OPEN 1
+#define NIMSRV_MOVE 2
+#define NIMSRV_CLOSE 3
+
+// status
+#define NIMSRV_OK 0       // the game goes on
+#define NIMSRV_WON 1      // by the user
+#define NIMSRV_LOST 2
+#define NIMSRV_BAD 3      // not a move, or not an op
+#define NIMSRV_GONE 4     // no such session
+#define NIMSRV_FULL 5     // no room for a session
+
+/*************** types ***********************/
+typedef struct
+{
+  uint32_t id;
+  uint8_t op;
+  uint8_t arg;
+  uint8_t arg2;
+  uint8_t pad;
+} nimsrv_request_t;
+
+typedef struct
+{
+  uint32_t id;
+  uint8_t status;
+  uint8_t row;            // the computer's move
+  uint8_t left;
+  uint8_t rows;
+  uint8_t sticks[NIMSRV_ROWS];
+  uint8_t pad[3];
+} nimsrv_reply_t;
+
+#endif /* NIMSERVER_H_ */
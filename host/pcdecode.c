@@ -0,0 +1,197 @@
+/***********************************************************
+ * pcdecode.c
+ *
+ * Symbolises the PC-sampling histogram recorded by the
+ * firmware when DO_PCSAMPLE is enabled (see
+ * pocket-nim/pcsample.h), or by the host simulation, and
+ * prints the share of samples per function.
+ *
+ * A histogram bin can straddle the end of one function and the
+ * start of the next. Its samples are then shared out in
+ * proportion to how many bytes of the bin each function covers.
+ *
+ * usage: pcdecode [-b] pcs.bin pocket-nim.elf|pocket-nim.map|sim
+ *   -b  also list the non-empty bins
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "symbols.h"
+
+/********* definitions *****************/
+// these must match pocket-nim/pcsample.h
+#define PCSAMPLE_MAGIC 0x53435050
+#define PCSAMPLE_HEADER_BYTES 32
+#define PCSAMPLE_CODE_SIZE 0x10000UL
+#define PCSAMPLE_RAM_SIZE 0x4000UL
+
+#define MAXFUNCS 512
+
+/********* types ***********************/
+typedef struct
+{
+  const char* name;
+  double samples;
+} func_samples_t;
+
+/******** global variables **************/
+symtab_t symtab;
+func_samples_t funcs[MAXFUNCS];
+int num_funcs=0;
+int list_bins=0;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static uint32_t
+get32(const unsigned char* p)
+{
+  return((uint32_t)p[0] | ((uint32_t)p[1]<<8) | ((uint32_t)p[2]<<16) | ((uint32_t)p[3]<<24));
+}
+
+static void
+add_samples(const char* name, double samples)
+{
+  int i;
+  for (i=0; i<num_funcs; i++)
+  {
+    if (strcmp(funcs[i].name, name)==0)
+    {
+      funcs[i].samples+=samples;
+      return;
+    }
+  }
+  if (num_funcs<MAXFUNCS)
+  {
+    funcs[num_funcs].name=name;
+    funcs[num_funcs].samples=samples;
+    num_funcs++;
+  }
+}
+
+/* share_bin
+ * shares the samples of the bin [start, start+len) between
+ * the functions it overlaps
+ */
+static void
+share_bin(uint32_t start, uint32_t len, unsigned int count)
+{
+  uint32_t end=start+len;
+  uint32_t covered=0;
+  uint32_t lo, hi;
+  int i;
+
+  if (list_bins)
+    printf("  0x%08x %6u ", start, count);
+  for (i=0; i<symtab.count; i++)
+  {
+    const symbol_t* s=&symtab.sym[i];
+    if ((s->size==0) || (s->addr>=end) || (s->addr+s->size<=start))
+      continue;
+    lo=(s->addr>start) ? s->addr : start;
+    hi=(s->addr+s->size<end) ? s->addr+s->size : end;
+    add_samples(s->name, (double)count*(hi-lo)/len);
+    covered+=hi-lo;
+    if (list_bins)
+      printf(" %s", s->name);
+  }
+  if (covered<len)
+    add_samples("?", (double)count*(len-covered)/len);
+  if (list_bins)
+    printf("\n");
+}
+
+static int
+compare_samples(const void* a, const void* b)
+{
+  const func_samples_t* fa=a;
+  const func_samples_t* fb=b;
+  if (fa->samples<fb->samples)
+    return(1);
+  return(-(fa->samples>fb->samples));
+}
+
+int
+main(int argc, char** argv)
+{
+  FILE* fp;
+  unsigned char header[PCSAMPLE_HEADER_BYTES];
+  uint16_t* bins;
+  uint32_t rate, shift, code_base, ram_base, samples, outside;
+  uint32_t i, code_bins, ram_bins, bin_bytes;
+  double in_bins=0;
+  int arg=1;
+
+  if ((argc>1) && (strcmp(argv[1], "-b")==0))
+  {
+    list_bins=1;
+    arg++;
+  }
+  if (argc-arg!=2)
+  {
+    fprintf(stderr, "usage: %s [-b] pcs.bin <pocket-nim.elf|pocket-nim.map|sim>\n", argv[0]);
+    return(1);
+  }
+  fp=fopen(argv[arg], "rb");
+  if (fp==NULL)
+  {
+    perror(argv[arg]);
+    return(1);
+  }
+  if (fread(header, 1, PCSAMPLE_HEADER_BYTES, fp)!=PCSAMPLE_HEADER_BYTES || get32(header)!=PCSAMPLE_MAGIC)
+  {
+    fprintf(stderr, "%s: not a PC sample buffer dump\n", argv[arg]);
+    return(1);
+  }
+  rate=get32(header+4);
+  shift=get32(header+8);
+  code_base=get32(header+12);
+  ram_base=get32(header+16);
+  samples=get32(header+20);
+  outside=get32(header+24);
+  bin_bytes=1U<<shift;
+  code_bins=PCSAMPLE_CODE_SIZE>>shift;
+  ram_bins=PCSAMPLE_RAM_SIZE>>shift;
+  bins=malloc((code_bins+ram_bins)*sizeof(uint16_t));
+  if (fread(bins, sizeof(uint16_t), code_bins+ram_bins, fp)!=code_bins+ram_bins)
+  {
+    fprintf(stderr, "%s: short read\n", argv[arg]);
+    return(1);
+  }
+  fclose(fp);
+  if (symtab_load(&symtab, argv[arg+1])!=0)
+    return(1);
+
+  if (list_bins)
+    printf("bins:\n");
+  for (i=0; i<code_bins+ram_bins; i++)
+  {
+    if (bins[i]==0)
+      continue;
+    in_bins+=bins[i];
+    if (i<code_bins)
+      share_bin(code_base+i*bin_bytes, bin_bytes, bins[i]);
+    else
+      share_bin(ram_base+(i-code_bins)*bin_bytes, bin_bytes, bins[i]);
+  }
+  if (list_bins)
+    printf("\n");
+
+  printf("%u samples at %u Hz (%.1f s), %u outside the image, %u byte bins\n\n",
+         samples, rate, rate ? (double)samples/rate : 0.0, outside, bin_bytes);
+  printf("%-32s %10s %7s\n", "function", "samples", "%");
+  qsort(funcs, num_funcs, sizeof(func_samples_t), compare_samples);
+  for (i=0; i<(uint32_t)num_funcs; i++)
+  {
+    printf("%-32s %10.1f %6.1f%%\n", funcs[i].name, funcs[i].samples,
+           in_bins ? 100.0*funcs[i].samples/in_bins : 0.0);
+  }
+  free(bins);
+  symtab_free(&symtab);
+  return(0);
+}
@@ -0,0 +1,148 @@
+/***********************************************************
+ * pcsample_host.c
+ * The DO_PCSAMPLE profiler for the host simulation. Instead
+ * of a CCU4 slice, a SIGPROF interval timer interrupts the
+ * simulation, and the handler takes the program counter from
+ * the signal context. The histogram has the same layout as on
+ * the target (pocket-nim/pcsample.h), with the code range set
+ * to the start of the simulation binary, so host/pcdecode reads
+ * either.
+ *
+ * The samples are of host CPU time. They show where the firmware
+ * code spends its effort on a PC, which is not the same as where
+ * it would spend it on the Cortex-M0, but the hot spots tend to agree.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <sys/time.h>
+#include <DAVE.h>
+#include "pcsample.h"
+#include "sim.h"
+
+#ifdef DO_PCSAMPLE
+
+/******** global variables **************/
+pcsample_buffer_t pcsample_buffer;
+
+/***** extern variables *******/
+extern char __executable_start[]; // provided by the linker
+extern const char* pcsample_file; // sim.c, -S option
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static void
+sigprof_handler(int sig, siginfo_t* info, void* context)
+{
+  ucontext_t* uc=(ucontext_t*)context;
+  (void)sig;
+  (void)info;
+#if defined(__x86_64__)
+  pcsample_count((uint32_t)uc->uc_mcontext.gregs[REG_RIP]);
+#elif defined(__aarch64__)
+  pcsample_count((uint32_t)uc->uc_mcontext.pc);
+#else
+  (void)uc;
+  pcsample_buffer.samples++;
+  pcsample_buffer.outside++;
+#endif
+}
+
+static void
+pcsample_write(void)
+{
+  FILE* fp;
+
+  pcsample_stop();
+  printf("pcsample: %u samples, %u outside the firmware image\n",
+         pcsample_buffer.samples, pcsample_buffer.outside);
+  if (pcsample_file==NULL)
+    return;
+  fp=fopen(pcsample_file, "wb");
+  if (fp==NULL)
+  {
+    perror(pcsample_file);
+    return;
+  }
+  fwrite(&pcsample_buffer, sizeof(pcsample_buffer), 1, fp);
+  fclose(fp);
+  printf("pcsample: histogram written to %s\n", pcsample_file);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+void
+pcsample_init(void)
+{
+  struct sigaction sa;
+  struct itimerval it;
+
+  memset(&pcsample_buffer, 0, sizeof(pcsample_buffer));
+  pcsample_buffer.magic=PCSAMPLE_MAGIC;
+  pcsample_buffer.rate_hz=PCSAMPLE_RATE_HZ;
+  pcsample_buffer.bin_shift=PCSAMPLE_BIN_SHIFT;
+  pcsample_buffer.code_base=(uint32_t)(uintptr_t)__executable_start;
+  pcsample_buffer.ram_base=0xffffffffUL-PCSAMPLE_RAM_SIZE; // no .ram_code on the host
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction=sigprof_handler;
+  sa.sa_flags=SA_SIGINFO | SA_RESTART;
+  sigaction(SIGPROF, &sa, NULL);
+  it.it_interval.tv_sec=0;
+  it.it_interval.tv_usec=1000000/PCSAMPLE_RATE_HZ;
+  it.it_value=it.it_interval;
+  setitimer(ITIMER_PROF, &it, NULL);
+  sim_at_finish(pcsample_write);
+}
+
+void
+pcsample_stop(void)
+{
+  struct itimerval it;
+  memset(&it, 0, sizeof(it));
+  setitimer(ITIMER_PROF, &it, NULL);
+}
+
+/* pcsample_count
+ * the same binning as pocket-nim/pcsample.c
+ */
+void
+pcsample_count(uint32_t pc)
+{
+  uint16_t* bin=0;
+  uint32_t offset;
+
+  pcsample_buffer.samples++;
+  offset=pc-pcsample_buffer.code_base;
+  if (offset<PCSAMPLE_CODE_SIZE)
+  {
+    bin=&pcsample_buffer.code_bins[offset>>PCSAMPLE_BIN_SHIFT];
+  }
+  else
+  {
+    offset=pc-pcsample_buffer.ram_base;
+    if (offset<PCSAMPLE_RAM_SIZE)
+    {
+      bin=&pcsample_buffer.ram_bins[offset>>PCSAMPLE_BIN_SHIFT];
+    }
+  }
+  if (bin==0)
+  {
+    pcsample_buffer.outside++;
+  }
+  else if (*bin!=0xffff)
+  {
+    (*bin)++;
+  }
+}
+
+#endif /* DO_PCSAMPLE */
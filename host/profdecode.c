@@ -0,0 +1,324 @@
+/***********************************************************
+ * profdecode.c
+ *
+ * Decodes the function entry/exit ring buffer recorded by
+ * the firmware when DO_PROFILE is enabled (see
+ * pocket-nim/profile.h), and prints per-function call
+ * counts with inclusive and exclusive time.
+ *
+ * Time spent in interrupts is subtracted from whatever the
+ * main loop was doing when the interrupt occurred, and the
+ * interrupt functions are reported under an [isr] root.
+ *
+ * usage: profdecode [-f] prof.bin pocket-nim.elf|pocket-nim.map
+ *   -f  print folded stacks (exclusive cycles per call stack)
+ *       instead of the table, for use with flamegraph.pl
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "symbols.h"
+
+/********* definitions *****************/
+// these must match pocket-nim/profile.h
+#define PROF_MAGIC 0x464f5250
+#define PROF_EXIT 0x00000001UL
+#define PROF_IN_ISR 0x00008000UL
+#define PROF_VAL_MASK 0x00007fffUL
+#define PROF_HEADER_BYTES 16
+
+#define MAXDEPTH 32
+#define MAXFUNCS 128
+#define MAXPATHS 512
+#define PATHLEN 512
+#define TICK_US 1000 // SYSTIMER tick period
+
+/********* types ***********************/
+typedef struct
+{
+  uint32_t fn;
+  uint64_t start;       // cycles at entry
+  uint64_t isr_start;   // total interrupt cycles at entry
+  uint64_t child;       // inclusive cycles of callees
+} frame_t;
+
+typedef struct
+{
+  uint32_t fn;
+  int isr;
+  unsigned long calls;
+  uint64_t incl;
+  uint64_t excl;
+  uint64_t max_incl;
+} func_stats_t;
+
+typedef struct
+{
+  char path[PATHLEN];
+  uint64_t cycles;
+} path_t;
+
+/******** global variables **************/
+symtab_t symtab;
+frame_t stack[2][MAXDEPTH]; // [0] is the main loop, [1] interrupts
+int depth[2]={0, 0};
+uint64_t isr_total=0;  // cycles spent in interrupts so far
+uint64_t isr_entered=0;
+func_stats_t funcs[MAXFUNCS];
+int num_funcs=0;
+path_t paths[MAXPATHS];
+int num_paths=0;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static uint32_t
+get32(const unsigned char* p)
+{
+  return((uint32_t)p[0] | ((uint32_t)p[1]<<8) | ((uint32_t)p[2]<<16) | ((uint32_t)p[3]<<24));
+}
+
+static const char*
+fn_name(uint32_t fn)
+{
+  static char buf[16];
+  const symbol_t* s=symtab_lookup(&symtab, fn);
+  if (s!=NULL)
+    return(s->name);
+  sprintf(buf, "0x%08x", fn);
+  return(buf);
+}
+
+static func_stats_t*
+find_func(uint32_t fn, int isr)
+{
+  int i;
+  for (i=0; i<num_funcs; i++)
+  {
+    if ((funcs[i].fn==fn) && (funcs[i].isr==isr))
+      return(&funcs[i]);
+  }
+  if (num_funcs>=MAXFUNCS)
+    return(NULL);
+  memset(&funcs[num_funcs], 0, sizeof(func_stats_t));
+  funcs[num_funcs].fn=fn;
+  funcs[num_funcs].isr=isr;
+  return(&funcs[num_funcs++]);
+}
+
+/* add_path
+ * accumulates exclusive cycles against the current call stack of ctx
+ */
+static void
+add_path(int ctx, uint64_t cycles)
+{
+  char path[PATHLEN];
+  int i;
+
+  strcpy(path, ctx ? "[isr]" : "main");
+  for (i=0; i<depth[ctx]; i++)
+  {
+    strncat(path, ";", PATHLEN-strlen(path)-1);
+    strncat(path, fn_name(stack[ctx][i].fn), PATHLEN-strlen(path)-1);
+  }
+  for (i=0; i<num_paths; i++)
+  {
+    if (strcmp(paths[i].path, path)==0)
+    {
+      paths[i].cycles+=cycles;
+      return;
+    }
+  }
+  if (num_paths<MAXPATHS)
+  {
+    strcpy(paths[num_paths].path, path);
+    paths[num_paths].cycles=cycles;
+    num_paths++;
+  }
+}
+
+/* pop_frame
+ * closes the top frame of ctx at time now
+ */
+static void
+pop_frame(int ctx, uint64_t now)
+{
+  frame_t* f=&stack[ctx][depth[ctx]-1];
+  func_stats_t* st;
+  uint64_t incl, excl;
+
+  incl=now-f->start;
+  if (ctx==0)
+  {
+    incl-=isr_total-f->isr_start; // don't charge interrupts to the main loop
+  }
+  excl=(incl>f->child) ? incl-f->child : 0;
+  add_path(ctx, excl);
+  st=find_func(f->fn, ctx);
+  if (st!=NULL)
+  {
+    st->calls++;
+    st->incl+=incl;
+    st->excl+=excl;
+    if (incl>st->max_incl)
+      st->max_incl=incl;
+  }
+  depth[ctx]--;
+  if (depth[ctx]>0)
+  {
+    stack[ctx][depth[ctx]-1].child+=incl;
+  }
+  else if (ctx==1)
+  {
+    isr_total+=now-isr_entered;
+  }
+}
+
+/* handle_record
+ * processes one entry or exit record at time now
+ */
+static void
+handle_record(uint32_t fn, int ctx, int is_exit, uint64_t now)
+{
+  int i;
+  frame_t* f;
+
+  if (!is_exit)
+  {
+    if (depth[ctx]>=MAXDEPTH)
+      return;
+    if ((ctx==1) && (depth[1]==0))
+      isr_entered=now;
+    f=&stack[ctx][depth[ctx]++];
+    f->fn=fn;
+    f->start=now;
+    f->isr_start=isr_total;
+    f->child=0;
+    return;
+  }
+  // an exit. The entry may have been overwritten in the ring buffer,
+  // in which case there is nothing to match it against
+  for (i=depth[ctx]-1; i>=0; i--)
+  {
+    if (stack[ctx][i].fn==fn)
+      break;
+  }
+  if (i<0)
+    return;
+  while (depth[ctx]>i)
+  {
+    pop_frame(ctx, now);
+  }
+}
+
+static int
+compare_excl(const void* a, const void* b)
+{
+  const func_stats_t* fa=a;
+  const func_stats_t* fb=b;
+  if (fa->excl<fb->excl)
+    return(1);
+  return(-(fa->excl>fb->excl));
+}
+
+int
+main(int argc, char** argv)
+{
+  FILE* fp;
+  unsigned char header[PROF_HEADER_BYTES];
+  unsigned char* recs;
+  uint32_t reload, head, count, nrec, capacity;
+  uint32_t i, idx, fn, stamp, tick16, last_tick16=0;
+  uint64_t tick_high=0, now, first=0, last=0;
+  double cycles_per_us;
+  int folded=0;
+  int arg=1;
+  long len;
+
+  if ((argc>1) && (strcmp(argv[1], "-f")==0))
+  {
+    folded=1;
+    arg++;
+  }
+  if (argc-arg!=2)
+  {
+    fprintf(stderr, "usage: %s [-f] prof.bin <pocket-nim.elf|pocket-nim.map>\n", argv[0]);
+    return(1);
+  }
+  fp=fopen(argv[arg], "rb");
+  if (fp==NULL)
+  {
+    perror(argv[arg]);
+    return(1);
+  }
+  if (fread(header, 1, PROF_HEADER_BYTES, fp)!=PROF_HEADER_BYTES || get32(header)!=PROF_MAGIC)
+  {
+    fprintf(stderr, "%s: not a profile buffer dump\n", argv[arg]);
+    return(1);
+  }
+  reload=get32(header+4);
+  head=get32(header+8);
+  count=get32(header+12);
+  fseek(fp, 0, SEEK_END);
+  len=ftell(fp)-PROF_HEADER_BYTES;
+  capacity=len/8;
+  recs=malloc(len);
+  fseek(fp, PROF_HEADER_BYTES, SEEK_SET);
+  if (fread(recs, 1, len, fp)!=(size_t)len)
+  {
+    fprintf(stderr, "%s: short read\n", argv[arg]);
+    return(1);
+  }
+  fclose(fp);
+  if (symtab_load(&symtab, argv[arg+1])!=0)
+    return(1);
+
+  // oldest record first. If the buffer has wrapped, that is the one at head
+  nrec=(count<capacity) ? count : capacity;
+  for (i=0; i<nrec; i++)
+  {
+    idx=(count<capacity) ? i : (head+i)%capacity;
+    fn=get32(recs+idx*8);
+    stamp=get32(recs+idx*8+4);
+    tick16=stamp>>16;
+    if ((i>0) && (tick16<last_tick16))
+      tick_high+=0x10000; // the 16 bit tick count has wrapped
+    last_tick16=tick16;
+    // SysTick counts down from reload to 0 once per tick
+    now=(tick_high+tick16)*(uint64_t)(reload+1)+(reload-(stamp & PROF_VAL_MASK));
+    if (i==0)
+      first=now;
+    last=now;
+    handle_record(fn & ~PROF_EXIT, (stamp & PROF_IN_ISR) ? 1 : 0, (fn & PROF_EXIT) ? 1 : 0, now);
+  }
+
+  if (folded)
+  {
+    for (i=0; i<(uint32_t)num_paths; i++)
+    {
+      printf("%s %llu\n", paths[i].path, (unsigned long long)paths[i].cycles);
+    }
+    return(0);
+  }
+
+  cycles_per_us=(double)(reload+1)/TICK_US;
+  printf("%u records (%u written), %.1f ms, %.0f MHz\n\n", nrec, count,
+         (last-first)/cycles_per_us/1000.0, cycles_per_us);
+  printf("%-24s %8s %12s %12s %10s %10s\n", "function", "calls", "incl cyc", "excl cyc", "avg us", "max us");
+  qsort(funcs, num_funcs, sizeof(func_stats_t), compare_excl);
+  for (i=0; i<(uint32_t)num_funcs; i++)
+  {
+    printf("%-18s%-6s %8lu %12llu %12llu %10.1f %10.1f\n", fn_name(funcs[i].fn),
+           funcs[i].isr ? " [isr]" : "", funcs[i].calls,
+           (unsigned long long)funcs[i].incl, (unsigned long long)funcs[i].excl,
+           funcs[i].incl/cycles_per_us/funcs[i].calls, funcs[i].max_incl/cycles_per_us);
+  }
+  free(recs);
+  symtab_free(&symtab);
+  return(0);
+}
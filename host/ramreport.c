@@ -0,0 +1,189 @@
+/***********************************************************
+ * ramreport.c
+ *
+ * Reads the linker map file of the pocket-nim firmware and
+ * reports how the 16 kbyte SRAM is used, with a breakdown
+ * of the functions that are placed in the .ram_code section
+ * (i.e. run from SRAM rather than flash).
+ *
+ * usage: ramreport pocket-nim/Debug/pocket-nim.map
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/********* definitions *****************/
+#define MAXLINE 512
+#define MAXSECTIONS 32
+#define MAXFUNCS 64
+#define NAMELEN 64
+
+/********* types ***********************/
+typedef struct
+{
+  char name[NAMELEN];
+  unsigned long addr;
+  unsigned long size;
+} region_t;
+
+/******** global variables **************/
+unsigned long sram_origin=0x20000000UL; // overwritten from the map file memory configuration
+unsigned long sram_length=0x4000UL;
+region_t sections[MAXSECTIONS]; // output sections located in SRAM
+int num_sections=0;
+region_t funcs[MAXFUNCS]; // input sections inside .ram_code
+int num_funcs=0;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* parse_addr_size
+ * reads the "0xaddress 0xsize" pair that the map file places either after
+ * the section name, or on the following line if the name is long.
+ * Returns 1 if found.
+ */
+int
+parse_addr_size(const char* text, unsigned long* addr, unsigned long* size)
+{
+  char rest[MAXLINE];
+  if (sscanf(text, " 0x%lx 0x%lx%[^\n]", addr, size, rest)>=2)
+    return(1);
+  return(0);
+}
+
+/* in_sram
+ * returns 1 if the address is within the SRAM region
+ */
+int
+in_sram(unsigned long addr)
+{
+  return((addr>=sram_origin) && (addr<sram_origin+sram_length));
+}
+
+/* read_map
+ * collects the SRAM output sections, and the input sections
+ * that make up .ram_code
+ */
+void
+read_map(FILE* fp)
+{
+  char line[MAXLINE];
+  char next[MAXLINE];
+  char name[NAMELEN];
+  char* text;
+  unsigned long addr, size;
+  int in_ram_code=0;
+  int have_next=0;
+
+  while (have_next || fgets(line, MAXLINE, fp))
+  {
+    if (have_next)
+    {
+      strcpy(line, next);
+      have_next=0;
+    }
+    if (strncmp(line, "SRAM ", 5)==0)
+    {
+      sscanf(line, "SRAM 0x%lx 0x%lx", &sram_origin, &sram_length);
+      continue;
+    }
+    // output sections start in the first column (e.g. ".data" or "Stack"),
+    // input sections are indented by one space
+    if ((line[0]=='.') || isalpha((unsigned char)line[0]) || ((line[0]==' ') && (line[1]=='.')))
+    {
+      if (sscanf(line, " %63s", name)!=1)
+        continue;
+      text=strstr(line, name)+strlen(name);
+      if (!parse_addr_size(text, &addr, &size))
+      {
+        // long names have the address and size on the next line
+        if (!fgets(next, MAXLINE, fp))
+          break;
+        if (!parse_addr_size(next, &addr, &size))
+        {
+          have_next=1;
+          continue;
+        }
+      }
+      if (line[0]!=' ') // an output section
+      {
+        in_ram_code=(strcmp(name, ".ram_code")==0);
+        if (in_sram(addr) && (num_sections<MAXSECTIONS))
+        {
+          strcpy(sections[num_sections].name, name);
+          sections[num_sections].addr=addr;
+          sections[num_sections].size=size;
+          num_sections++;
+        }
+      }
+      else if (in_ram_code && (size>0) && (num_funcs<MAXFUNCS))
+      {
+        // an input section. -ffunction-sections names these .text.<function>
+        if (strncmp(name, ".text.", 6)==0)
+          strcpy(funcs[num_funcs].name, name+6);
+        else
+          strcpy(funcs[num_funcs].name, name);
+        funcs[num_funcs].addr=addr;
+        funcs[num_funcs].size=size;
+        num_funcs++;
+      }
+    }
+  }
+}
+
+/* report
+ * prints the SRAM usage tables
+ */
+void
+report(void)
+{
+  int i;
+  unsigned long total=0;
+  unsigned long ram_code=0;
+
+  printf("SRAM 0x%08lx, %lu bytes\n\n", sram_origin, sram_length);
+  printf("%-16s %-10s %8s %7s\n", "section", "address", "bytes", "%SRAM");
+  for (i=0; i<num_sections; i++)
+  {
+    printf("%-16s 0x%08lx %8lu %6.1f%%\n", sections[i].name, sections[i].addr,
+           sections[i].size, 100.0*sections[i].size/sram_length);
+    total+=sections[i].size;
+  }
+  printf("%-16s %-10s %8lu %6.1f%%\n\n", "total", "", total, 100.0*total/sram_length);
+
+  printf(".ram_code contents\n");
+  printf("%-32s %-10s %8s\n", "function", "address", "bytes");
+  for (i=0; i<num_funcs; i++)
+  {
+    printf("%-32s 0x%08lx %8lu\n", funcs[i].name, funcs[i].addr, funcs[i].size);
+    ram_code+=funcs[i].size;
+  }
+  printf("%-32s %-10s %8lu (%.1f%% of SRAM)\n", "total", "", ram_code, 100.0*ram_code/sram_length);
+}
+
+int
+main(int argc, char** argv)
+{
+  FILE* fp;
+
+  if (argc!=2)
+  {
+    fprintf(stderr, "usage: %s <pocket-nim.map>\n", argv[0]);
+    return(1);
+  }
+  fp=fopen(argv[1], "r");
+  if (fp==NULL)
+  {
+    perror(argv[1]);
+    return(1);
+  }
+  read_map(fp);
+  fclose(fp);
+  report();
+  return(0);
+}
@@ -0,0 +1,395 @@
+/***********************************************************
+ * retro.c
+ * Retrograde analysis of a finite impartial game, shared out between
+ * threads. See retro.h.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "retro.h"
+
+/*************** definitions *****************/
+#define CHUNK 1024 // positions handed to a thread at a time
+
+/*************** types ***********************/
+typedef struct
+{
+  const retro_game_t* game;
+  uint32_t* word;       // one per position, in the mapped file
+  uint64_t* start;      // where each position's list of moves to it begins
+  uint32_t* from;       // the lists
+  int threads;
+  pthread_barrier_t barrier;
+  uint32_t level;
+  uint64_t resolved;    // at the level being worked out
+  int done;
+  int failed;
+  double t0, t1, t2;
+} solver_t;
+
+typedef struct
+{
+  solver_t* s;
+  int id;
+  uint64_t* to;         // the moves from a position
+  uint64_t* seen;       // to take out the same move listed twice
+  uint32_t* stamp;
+  uint32_t mask;
+  uint32_t pos_stamp;
+  uint64_t edges;
+} worker_t;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static double
+now_s(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec+ts.tv_nsec/1e9);
+}
+
+/* list_moves
+ * lists the moves from pos into w->to, each once, and returns how
+ * many. The ones already listed are kept in a small hash table, whose
+ * entries are cleared by moving on the stamp
+ */
+static unsigned
+list_moves(worker_t* w, uint64_t pos)
+{
+  unsigned n, i, kept=0;
+  uint32_t h;
+
+  n=w->s->game->moves(w->s->game, pos, w->to);
+  if (++w->pos_stamp==0)
+  {
+    memset(w->stamp, 0, (w->mask+1)*sizeof(uint32_t));
+    w->pos_stamp=1;
+  }
+  for (i=0; i<n; i++)
+  {
+    h=(uint32_t)((w->to[i]*0x9e3779b97f4a7c15ULL)>>32) & w->mask;
+    while ((w->stamp[h]==w->pos_stamp) && (w->seen[h]!=w->to[i]))
+      h=(h+1) & w->mask;
+    if (w->stamp[h]==w->pos_stamp)
+      continue;
+    w->stamp[h]=w->pos_stamp;
+    w->seen[h]=w->to[i];
+    w->to[kept++]=w->to[i];
+  }
+  return(kept);
+}
+
+/* resolve
+ * tells position q that one of its moves, to a position resolved at
+ * distance d-1, is won or lost. Returns 1 if that resolves q
+ */
+static int
+resolve(uint32_t* word, int won, uint32_t d)
+{
+  uint32_t old, next;
+
+  old=__atomic_load_n(word, __ATOMIC_RELAXED);
+  do
+  {
+    if (old & RETRO_RESOLVED)
+      return(0);
+    if (!won)
+      next=RETRO_RESOLVED | RETRO_WON | d; // a move to a lost position
+    else if (old==1)
+      next=RETRO_RESOLVED | d; // the last of its moves, so every one is won
+    else
+      next=old-1;
+  } while (!__atomic_compare_exchange_n(word, &old, next, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+  return((next & RETRO_RESOLVED)!=0);
+}
+
+/* worker
+ * one thread's share of each step, with the others waiting at a
+ * barrier between them. Thread 0 does the steps that can't be shared
+ */
+static void*
+worker(void* arg)
+{
+  worker_t* w=arg;
+  solver_t* s=w->s;
+  uint64_t n=s->game->positions;
+  uint64_t c, p, p_end, e, e_end, slot, count;
+  uint32_t word, d;
+  unsigned i, m;
+
+  // count the moves from each position, and to each
+  for (c=(uint64_t)w->id*CHUNK; c<n; c+=(uint64_t)s->threads*CHUNK)
+  {
+    p_end=(c+CHUNK<n) ? c+CHUNK : n;
+    for (p=c; p<p_end; p++)
+    {
+      m=list_moves(w, p);
+      if (m==0)
+        s->word[p]=RETRO_RESOLVED | (s->game->misere ? RETRO_WON : 0);
+      else
+        s->word[p]=m;
+      for (i=0; i<m; i++)
+        __atomic_fetch_add(&s->start[w->to[i]], 1, __ATOMIC_RELAXED);
+      w->edges+=m;
+    }
+  }
+  pthread_barrier_wait(&s->barrier);
+  if (w->id==0)
+  {
+    for (e=0, p=0; p<=n; p++)
+    {
+      count=s->start[p];
+      s->start[p]=e;
+      e+=count;
+    }
+    s->from=malloc((e ? e : 1)*sizeof(uint32_t));
+    s->failed=(s->from==NULL);
+  }
+  pthread_barrier_wait(&s->barrier);
+  if (s->failed)
+    return(NULL);
+
+  // fill in the lists. Afterwards start[p] is where the list for p+1
+  // began, so p's list is from start[p-1] to start[p]
+  for (c=(uint64_t)w->id*CHUNK; c<n; c+=(uint64_t)s->threads*CHUNK)
+  {
+    p_end=(c+CHUNK<n) ? c+CHUNK : n;
+    for (p=c; p<p_end; p++)
+    {
+      m=list_moves(w, p);
+      for (i=0; i<m; i++)
+      {
+        slot=__atomic_fetch_add(&s->start[w->to[i]], 1, __ATOMIC_RELAXED);
+        s->from[slot]=(uint32_t)p;
+      }
+    }
+  }
+  pthread_barrier_wait(&s->barrier);
+  if (w->id==0)
+    s->t1=now_s();
+
+  // a level at a time, from the positions with no move
+  while (!s->done)
+  {
+    d=s->level;
+    count=0;
+    for (c=(uint64_t)w->id*CHUNK; c<n; c+=(uint64_t)s->threads*CHUNK)
+    {
+      p_end=(c+CHUNK<n) ? c+CHUNK : n;
+      for (p=c; p<p_end; p++)
+      {
+        word=__atomic_load_n(&s->word[p], __ATOMIC_RELAXED);
+        if (((word & RETRO_RESOLVED)==0) || (RETRO_DIST(word)!=d))
+          continue;
+        e=(p==0) ? 0 : s->start[p-1];
+        e_end=s->start[p];
+        for (; e<e_end; e++)
+          count+=resolve(&s->word[s->from[e]], RETRO_IS_WON(word), d+1);
+      }
+    }
+    __atomic_fetch_add(&s->resolved, count, __ATOMIC_RELAXED);
+    pthread_barrier_wait(&s->barrier);
+    if (w->id==0)
+    {
+      s->done=(s->resolved==0);
+      s->resolved=0;
+      s->level++;
+    }
+    pthread_barrier_wait(&s->barrier);
+  }
+  return(NULL);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* retro_solve
+ * solves the game with the given number of threads, into the file at
+ * path. stats may be NULL. Returns 0, or -1 if it fails, with a
+ * message on stderr
+ */
+int
+retro_solve(const retro_game_t* game, const char* path, int threads, retro_stats_t* stats)
+{
+  solver_t s;
+  worker_t w[RETRO_MAX_THREADS];
+  pthread_t tid[RETRO_MAX_THREADS];
+  retro_header_t* header;
+  retro_stats_t st;
+  size_t len;
+  uint64_t p;
+  uint32_t size;
+  char* base;
+  int fd, t, ok=1;
+
+  if ((game->positions==0) || (game->positions>0xffffffffULL))
+  {
+    fprintf(stderr, "%s: %llu positions, the most is 2^32-1\n", game->name,
+            (unsigned long long)game->positions);
+    return(-1);
+  }
+  if (threads<1)
+    threads=1;
+  if (threads>RETRO_MAX_THREADS)
+    threads=RETRO_MAX_THREADS;
+  len=sizeof(retro_header_t)+game->positions*sizeof(uint32_t);
+  fd=open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if ((fd<0) || (ftruncate(fd, (off_t)len)!=0))
+  {
+    perror(path);
+    if (fd>=0)
+      close(fd);
+    return(-1);
+  }
+  base=mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base==MAP_FAILED)
+  {
+    perror(path);
+    return(-1);
+  }
+
+  memset(&s, 0, sizeof(s));
+  s.game=game;
+  s.word=(uint32_t*)(base+sizeof(retro_header_t));
+  s.start=calloc(game->positions+1, sizeof(uint64_t));
+  s.threads=threads;
+  pthread_barrier_init(&s.barrier, NULL, (unsigned)threads);
+  for (size=16; size<2*game->max_moves; size*=2)
+    ;
+  memset(w, 0, sizeof(w));
+  for (t=0; t<threads; t++)
+  {
+    w[t].s=&s;
+    w[t].id=t;
+    w[t].to=malloc((game->max_moves ? game->max_moves : 1)*sizeof(uint64_t));
+    w[t].seen=malloc(size*sizeof(uint64_t));
+    w[t].stamp=calloc(size, sizeof(uint32_t));
+    w[t].mask=size-1;
+    if (!w[t].to || !w[t].seen || !w[t].stamp)
+      ok=0;
+  }
+  if (!s.start || !ok)
+  {
+    fprintf(stderr, "%s: out of memory\n", game->name);
+    s.failed=1;
+  }
+  else
+  {
+    s.t0=now_s();
+    for (t=1; t<threads; t++)
+      pthread_create(&tid[t], NULL, worker, &w[t]);
+    worker(&w[0]);
+    for (t=1; t<threads; t++)
+      pthread_join(tid[t], NULL);
+    s.t2=now_s();
+    if (s.failed)
+      fprintf(stderr, "%s: out of memory for the moves\n", game->name);
+  }
+
+  memset(&st, 0, sizeof(st));
+  if (!s.failed)
+  {
+    for (t=0; t<threads; t++)
+      st.edges+=w[t].edges;
+    for (p=0; p<game->positions; p++)
+    {
+      if ((s.word[p] & RETRO_RESOLVED)==0)
+        st.unresolved++;
+      else if (RETRO_IS_WON(s.word[p]))
+        st.won++;
+      else
+        st.lost++;
+      if ((s.word[p] & RETRO_RESOLVED) && (RETRO_DIST(s.word[p])>st.max_dist))
+        st.max_dist=RETRO_DIST(s.word[p]);
+    }
+    st.build_s=s.t1-s.t0;
+    st.solve_s=s.t2-s.t1;
+    header=(retro_header_t*)base;
+    memcpy(header->magic, RETRO_MAGIC, sizeof(header->magic));
+    strncpy(header->name, game->name, sizeof(header->name)-1);
+    header->positions=game->positions;
+    header->won=st.won;
+    header->max_dist=st.max_dist;
+    header->misere=game->misere;
+    msync(base, len, MS_SYNC);
+  }
+  if (stats)
+    *stats=st;
+  for (t=0; t<threads; t++)
+  {
+    free(w[t].to);
+    free(w[t].seen);
+    free(w[t].stamp);
+  }
+  free(s.start);
+  free(s.from);
+  pthread_barrier_destroy(&s.barrier);
+  munmap(base, len);
+  if (!s.failed && st.unresolved)
+  {
+    // only a game with a loop in it can leave any
+    fprintf(stderr, "%s: %llu positions not resolved\n", game->name, (unsigned long long)st.unresolved);
+    return(-1);
+  }
+  return(s.failed ? -1 : 0);
+}
+
+/* retro_map
+ * maps a file made by retro_solve(), read only. Returns its words, a
+ * word per position, with its header copied to *header and the length
+ * mapped in *len, or NULL if it isn't one
+ */
+const uint32_t*
+retro_map(const char* path, retro_header_t* header, size_t* len)
+{
+  struct stat sb;
+  char* base;
+  int fd;
+
+  fd=open(path, O_RDONLY);
+  if (fd<0)
+    return(NULL);
+  if ((fstat(fd, &sb)!=0) || ((size_t)sb.st_size<sizeof(retro_header_t)))
+  {
+    close(fd);
+    return(NULL);
+  }
+  base=mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base==MAP_FAILED)
+    return(NULL);
+  memcpy(header, base, sizeof(*header));
+  if ((memcmp(header->magic, RETRO_MAGIC, sizeof(header->magic))!=0) ||
+      ((size_t)sb.st_size!=sizeof(retro_header_t)+header->positions*sizeof(uint32_t)))
+  {
+    munmap(base, (size_t)sb.st_size);
+    return(NULL);
+  }
+  *len=(size_t)sb.st_size;
+  return((const uint32_t*)(base+sizeof(retro_header_t)));
+}
+
+/* retro_unmap
+ * unmaps what retro_map() mapped
+ */
+void
+retro_unmap(const uint32_t* words, size_t len)
+{
+  munmap((char*)words-sizeof(retro_header_t), len);
+}
@@ -0,0 +1,89 @@
+/***********************************************************
+ * retro.h
+ * Solves a finite impartial game by retrograde analysis, in
+ * parallel, on the desktop.
+ *
+ * The game is given as a number of positions, indexed from 0, and a
+ * function that lists the positions one move away from each. How the
+ * positions are indexed is up to the game: for Nim, retrobench.c
+ * indexes the rows sorted into order, since swapping two rows makes
+ * no difference to who wins.
+ *
+ * Each position ends up won or lost for the player to move, and the
+ * number of moves to the end of the game with best play: the winner
+ * takes the quickest way to win, and the loser makes the game last
+ * as long as it can. A position with no move is lost at 0, or won at
+ * 0 in misere play where the last move loses.
+ *
+ * solving goes in two steps, each shared out between the threads:
+ *  - every position's moves are listed, and turned round into a list
+ *    of the positions that move to each one
+ *  - starting from the positions with no move, at distance 0, each
+ *    position resolved at distance d resolves those that move to it
+ *    at d+1: any position that moves to a lost one is won, and a
+ *    position is lost once the last of its moves has been found to be
+ *    won. Each position is one 32 bit word, holding the count of its
+ *    moves not yet won until it is resolved, and changed only by
+ *    compare and swap, so no locks are needed
+ * The words are the result: they are kept in a file mapped into
+ * memory (retro_header_t then a word per position), which can be
+ * mapped back with retro_map().
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef RETRO_H_
+#define RETRO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*************** definitions *****************/
+#define RETRO_MAGIC "RETRO1\n"
+#define RETRO_MAX_THREADS 64
+#define RETRO_RESOLVED 0x80000000UL
+#define RETRO_WON 0x40000000UL
+#define RETRO_DIST_MASK 0x3fffffffUL
+
+// reading a resolved word
+#define RETRO_IS_WON(w) (((w) & RETRO_WON)!=0)
+#define RETRO_DIST(w) ((w) & RETRO_DIST_MASK)
+
+/*************** types ***********************/
+typedef struct retro_game
+{
+  const char* name;
+  uint64_t positions;  // below 2^32
+  unsigned max_moves;  // the most moves from any position
+  unsigned char misere; // a position with no move is won
+  // lists the positions one move away from pos into to[], returning
+  // how many. The same one may be listed more than once
+  unsigned (*moves)(const struct retro_game* game, uint64_t pos, uint64_t* to);
+  const void* ctx;     // for the game's own use
+} retro_game_t;
+
+typedef struct
+{
+  char magic[8];
+  char name[48];
+  uint64_t positions;
+  uint64_t won;
+  uint32_t max_dist;
+  uint32_t misere;
+} retro_header_t;
+
+typedef struct
+{
+  uint64_t edges;      // moves, not counting the same one twice
+  uint64_t won, lost, unresolved;
+  uint32_t max_dist;
+  double build_s;      // listing the moves, and turning them round
+  double solve_s;      // the distances
+} retro_stats_t;
+
+/******** function prototypes ***********/
+int retro_solve(const retro_game_t* game, const char* path, int threads, retro_stats_t* stats);
+const uint32_t* retro_map(const char* path, retro_header_t* header, size_t* len);
+void retro_unmap(const uint32_t* words, size_t len);
+
+#endif /* RETRO_H_ */
@@ -0,0 +1,279 @@
+/***********************************************************
+ * retrobench.c
+ * Solves Nim (retronim.c) with the retrograde solver (retro.c),
+ * and checks and times it:
+ *  - the positions are indexed by their rank up to the order of
+ *    the rows (pocket-nim/canon.c), as swapping two rows makes no
+ *    difference, so r rows of up to m sticks take C(m+r, r)
+ *    positions rather than (m+1)^r
+ *  - every position of 4 rows of up to 6 sticks against a search of
+ *    the game tree, both who wins and the number of moves left
+ *  - every position of the large game against nimk_lost(), and the
+ *    winning moves of nimk_choose() (pocket-nim/nimk.c, which plays
+ *    k=1 as computer_play plays Nim) checked to leave a lost
+ *    position, with how many of them are the quickest win
+ *  - the time to solve, with 1, 2, 4.. up to the given number of
+ *    threads, as positions a second and positions a second a thread
+ * Both normal and misere play, taking from up to k rows a turn
+ * (Moore's Nim_k, see nimk.h) with -k.
+ *
+ * usage: retrobench [-n rows] [-m max] [-k k] [-t threads] [-o file]
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "retro.h"
+#include "nimk.h"
+#include "canon.h"
+#include "retronim.h"
+
+/********* definitions *****************/
+#define TREE_ROWS 4
+#define TREE_MAX 6
+#define TREE_SIZE 2401 // (TREE_MAX+1)^TREE_ROWS
+
+/******** global variables **************/
+int rows=8, max_sticks=15, k=1, max_threads;
+const char* out_path="nim.retro";
+signed char tree_won[TREE_SIZE]; // -1 not known yet
+int tree_dist[TREE_SIZE];
+retronim_t small_nim, big_nim;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* tree_solve
+ * solves a position of TREE_ROWS rows by trying every move, into
+ * tree_won and tree_dist
+ */
+static int
+tree_solve(const uint32_t* heaps, int kk, int misere);
+
+/* tree_move
+ * tries every move from row r on, having taken from used rows so far,
+ * keeping the quickest win and the longest loss
+ */
+static void
+tree_move(uint32_t* heaps, int kk, int misere, int r, int used, int* won, int* dist)
+{
+  uint32_t was;
+  int idx;
+
+  if (r==TREE_ROWS)
+  {
+    if (used==0)
+      return;
+    idx=tree_solve(heaps, kk, misere);
+    if (!tree_won[idx] && (!*won || (tree_dist[idx]+1<*dist)))
+      *dist=tree_dist[idx]+1;
+    else if (tree_won[idx] && !*won && (tree_dist[idx]+1>*dist))
+      *dist=tree_dist[idx]+1;
+    *won|=!tree_won[idx];
+    return;
+  }
+  tree_move(heaps, kk, misere, r+1, used, won, dist);
+  if (used==kk)
+    return;
+  was=heaps[r];
+  for (heaps[r]=0; heaps[r]<was; heaps[r]++)
+    tree_move(heaps, kk, misere, r+1, used+1, won, dist);
+  heaps[r]=was;
+}
+
+static int
+tree_solve(const uint32_t* heaps, int kk, int misere)
+{
+  uint32_t copy[TREE_ROWS];
+  int r, idx=0, total=0, won=0, dist=0;
+
+  for (r=0; r<TREE_ROWS; r++)
+  {
+    idx=idx*(TREE_MAX+1)+(int)heaps[r];
+    total+=heaps[r];
+  }
+  if (tree_won[idx]<0)
+  {
+    if (total==0)
+    {
+      won=misere; // the last stick was just taken
+    }
+    else
+    {
+      memcpy(copy, heaps, sizeof(copy));
+      tree_move(copy, kk, misere, 0, 0, &won, &dist);
+    }
+    tree_won[idx]=(signed char)won;
+    tree_dist[idx]=dist;
+  }
+  return(idx);
+}
+
+/* check_tree
+ * solves the small game both ways, and returns the number of positions
+ * they don't agree on
+ */
+static int
+check_tree(int misere)
+{
+  retro_game_t game;
+  retro_header_t header;
+  const uint32_t* word;
+  uint32_t heaps[TREE_ROWS], w;
+  uint64_t pos;
+  size_t len;
+  int idx, r, n, bad=0;
+
+  small_nim.rows=TREE_ROWS;
+  small_nim.max=TREE_MAX;
+  small_nim.k=k;
+  retronim_game(&game, &small_nim, misere);
+  if (retro_solve(&game, out_path, 1, NULL)!=0)
+    return(1);
+  word=retro_map(out_path, &header, &len);
+  if (word==NULL)
+    return(1);
+  memset(tree_won, -1, sizeof(tree_won));
+  for (idx=0; idx<TREE_SIZE; idx++)
+  {
+    for (n=idx, r=TREE_ROWS-1; r>=0; r--, n/=TREE_MAX+1)
+      heaps[r]=(uint32_t)(n%(TREE_MAX+1));
+    tree_solve(heaps, k, misere);
+    pos=retronim_rank(heaps, TREE_ROWS);
+    w=word[pos];
+    if ((RETRO_IS_WON(w)!=tree_won[idx]) || ((int)RETRO_DIST(w)!=tree_dist[idx]))
+      bad++;
+  }
+  retro_unmap(word, len);
+  return(bad);
+}
+
+/* check_big
+ * the large game's result file against nimk.c. Returns the number of
+ * mistakes
+ */
+static int
+check_big(int misere, uint64_t* wins, uint64_t* quickest)
+{
+  retro_header_t header;
+  const uint32_t* word;
+  uint32_t heaps[CANON_MAX_ROWS], after[CANON_MAX_ROWS], w;
+  uint64_t pos, next;
+  size_t len;
+  int bad=0;
+
+  *wins=0;
+  *quickest=0;
+  word=retro_map(out_path, &header, &len);
+  if ((word==NULL) || (header.misere!=(uint32_t)misere))
+    return(1);
+  for (pos=0; pos<header.positions; pos++)
+  {
+    w=word[pos];
+    retronim_unrank(pos, rows, heaps);
+    if (nimk_lost(heaps, (unsigned char)rows, (unsigned char)k, (unsigned char)misere)==RETRO_IS_WON(w))
+      bad++;
+    if (nimk_choose(heaps, (unsigned char)rows, (unsigned char)k, (unsigned char)misere, after))
+    {
+      next=word[retronim_rank(after, rows)];
+      (*wins)++;
+      if (RETRO_IS_WON(next))
+        bad++;
+      else if (RETRO_DIST(next)+1==RETRO_DIST(w))
+        (*quickest)++;
+    }
+  }
+  retro_unmap(word, len);
+  return(bad);
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  retro_game_t game;
+  retro_stats_t st;
+  uint64_t wins, quickest;
+  double all;
+  int c, t, misere, bad, failed=0;
+
+  max_threads=(int)sysconf(_SC_NPROCESSORS_ONLN);
+  while ((c=getopt(argc, argv, "n:m:k:t:o:"))!=-1)
+  {
+    switch(c)
+    {
+      case 'n':
+        rows=atoi(optarg);
+        break;
+      case 'm':
+        max_sticks=atoi(optarg);
+        break;
+      case 'k':
+        k=atoi(optarg);
+        break;
+      case 't':
+        max_threads=atoi(optarg);
+        break;
+      case 'o':
+        out_path=optarg;
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n rows] [-m max] [-k k] [-t threads] [-o file]\n", argv[0]);
+        return(2);
+    }
+  }
+  if ((rows<1) || (rows>CANON_MAX_ROWS))
+    rows=8;
+  if ((max_sticks<1) || !CANON_FITS(rows, max_sticks))
+    max_sticks=CANON_SPAN-1-rows;
+  if (k<1)
+    k=1;
+  if (k>NIMK_MAX_K)
+    k=NIMK_MAX_K;
+  if (k>rows)
+    k=rows;
+  if (max_threads<1)
+    max_threads=1;
+  if (max_threads>RETRO_MAX_THREADS)
+    max_threads=RETRO_MAX_THREADS;
+
+  big_nim.rows=rows;
+  big_nim.max=max_sticks;
+  big_nim.k=k;
+  for (all=1, t=0; t<rows; t++)
+    all*=max_sticks+1;
+  printf("%d rows of up to %d sticks, taking from up to %d a turn: %u sorted positions of %.0f\n",
+         rows, max_sticks, k, canon_count((unsigned char)rows, (unsigned char)max_sticks), all);
+  for (misere=0; misere<2; misere++)
+  {
+    bad=check_tree(misere);
+    printf("%s play: all %d positions of %d rows up to %d against a tree search, %d wrong\n",
+           misere ? "misere" : "normal", TREE_SIZE, TREE_ROWS, TREE_MAX, bad);
+    failed+=(bad!=0);
+    retronim_game(&game, &big_nim, misere);
+    printf("  threads  build s  solve s  positions/s  per thread\n");
+    for (t=1; ; t=(t*2<max_threads) ? t*2 : max_threads)
+    {
+      if (retro_solve(&game, out_path, t, &st)!=0)
+        return(1);
+      printf("  %7d  %7.3f  %7.3f  %11.0f  %10.0f\n", t, st.build_s, st.solve_s,
+             game.positions/(st.build_s+st.solve_s), game.positions/(st.build_s+st.solve_s)/t);
+      if (t==max_threads)
+        break;
+    }
+    bad=check_big(misere, &wins, &quickest);
+    printf("  %llu moves, %llu won and %llu lost, longest game %u moves: %d wrong against nimk.c, "
+           "whose winning moves are the quickest %.1f%% of the time\n",
+           (unsigned long long)st.edges, (unsigned long long)st.won, (unsigned long long)st.lost,
+           st.max_dist, bad, wins ? quickest*100.0/wins : 0.0);
+    failed+=(bad!=0);
+  }
+  return(failed ? 1 : 0);
+}
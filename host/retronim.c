@@ -0,0 +1,127 @@
+/***********************************************************
+ * retronim.c
+ * Nim as a game for the retrograde solver (retro.c), with the
+ * positions ranked up to the order of the rows by canon.c. See
+ * retronim.h.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdint.h>
+#include <string.h>
+#include "retro.h"
+#include "canon.h"
+#include "retronim.h"
+
+/*************** types ***********************/
+typedef struct
+{
+  const retronim_t* nim;
+  uint32_t h[CANON_MAX_ROWS];
+  uint64_t* to;
+  unsigned n;
+} nim_moves_t;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* nim_take
+ * lists the moves that take from row r on, having taken from used rows
+ * so far
+ */
+static void
+nim_take(nim_moves_t* m, int r, int used)
+{
+  uint32_t was;
+
+  if (r==m->nim->rows)
+  {
+    if (used>0)
+      m->to[m->n++]=retronim_rank(m->h, m->nim->rows);
+    return;
+  }
+  nim_take(m, r+1, used);
+  if (used==m->nim->k)
+    return;
+  was=m->h[r];
+  for (m->h[r]=0; m->h[r]<was; m->h[r]++)
+    nim_take(m, r+1, used+1);
+  m->h[r]=was;
+}
+
+/* nim_moves
+ * the move generator given to retro_solve()
+ */
+static unsigned
+nim_moves(const retro_game_t* game, uint64_t pos, uint64_t* to)
+{
+  nim_moves_t m;
+
+  m.nim=game->ctx;
+  m.to=to;
+  m.n=0;
+  retronim_unrank(pos, m.nim->rows, m.h);
+  nim_take(&m, 0, 0);
+  return(m.n);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* retronim_rank
+ * the rank of the rows, whatever their order
+ */
+uint64_t
+retronim_rank(const uint32_t* h, int rows)
+{
+  unsigned char s[CANON_MAX_ROWS];
+  int i;
+
+  for (i=0; i<rows; i++)
+    s[i]=(unsigned char)h[i];
+  return(canon_rank(s, (unsigned char)rows));
+}
+
+/* retronim_unrank
+ * the sorted rows with the given rank
+ */
+void
+retronim_unrank(uint64_t pos, int rows, uint32_t* h)
+{
+  unsigned char s[CANON_MAX_ROWS];
+  int i;
+
+  canon_unrank((uint32_t)pos, (unsigned char)rows, s);
+  for (i=0; i<rows; i++)
+    h[i]=s[i];
+}
+
+/* retronim_game
+ * sets up the game for retro_solve(). The rows and max must fit
+ * canon.c (CANON_FITS)
+ */
+void
+retronim_game(retro_game_t* game, const retronim_t* nim, int misere)
+{
+  uint64_t most=0, ways;
+  int i, j;
+
+  for (j=1; j<=nim->k; j++)
+  {
+    // C(rows, j) ways to pick the rows, and up to max from each
+    for (ways=1, i=0; i<j; i++)
+      ways=ways*(uint64_t)(nim->rows-i)/(uint64_t)(i+1);
+    for (i=0; i<j; i++)
+      ways*=(uint64_t)nim->max;
+    most+=ways;
+  }
+  memset(game, 0, sizeof(*game));
+  game->name=misere ? "misere nim" : "nim";
+  game->positions=canon_count((unsigned char)nim->rows, (unsigned char)nim->max);
+  game->max_moves=(unsigned)most;
+  game->misere=(unsigned char)misere;
+  game->moves=nim_moves;
+  game->ctx=nim;
+}
@@ -0,0 +1,29 @@
+/***********************************************************
+ * retronim.h
+ * Nim as a game for the retrograde solver (retro.c): rows rows of
+ * up to max sticks, a turn taking from up to k of them (k=1 is Nim
+ * itself, more is Moore's Nim_k). A position's index is its rank up
+ * to the order of the rows (see pocket-nim/canon.h), so r rows of up
+ * to m sticks take C(m+r, r) positions rather than (m+1)^r.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef RETRONIM_H_
+#define RETRONIM_H_
+
+#include <stdint.h>
+#include "retro.h"
+
+/*************** types ***********************/
+typedef struct
+{
+  int rows, max, k;
+} retronim_t;
+
+/******** function prototypes ***********/
+uint64_t retronim_rank(const uint32_t* h, int rows);
+void retronim_unrank(uint64_t pos, int rows, uint32_t* h);
+void retronim_game(retro_game_t* game, const retronim_t* nim, int misere);
+
+#endif /* RETRONIM_H_ */
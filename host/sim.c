@@ -0,0 +1,864 @@
+/***********************************************************
+ * sim.c
+ * Host simulation of the pocket-nim firmware.
+ *
+ * The unmodified firmware (pocket-nim/main.c and friends) is
+ * compiled natively against the stand-in DAVE layer in
+ * host/include and host/dave_host.c. Time is virtual: it only
+ * moves on when the firmware waits (IDLE_WAIT, or an I2C
+ * transfer), and the 1 ms SysTick callbacks run at the right
+ * virtual times. Runs are therefore repeatable, and take
+ * a fraction of the real time.
+ *
+ * The buttons are driven by a script and/or an auto-player.
+ * Each script action waits until the firmware is ready for
+ * input (user_play is waiting and no button is still being
+ * debounced). Script tokens, separated by spaces or commas:
+ *   1-5   tap the row button
+ *   c     tap the computer button
+ *   c+N   hold computer and tap N: new game at level N
+ *   wN    wait N ms before the next action
+ *   #     comment to the end of the line
+ *
+ * usage: sim [-s script] [-f scriptfile] [-a games] [-l level]
+ *            [-k think_ms] [-r seed] [-t limit_ms] [-d] [-v]
+ *            [-p prof.bin] [-S pcs.bin] [-F flash.bin] [-W erases]
+ *            [-X n] [-B baud] [-O degrees] [-M moves.bin]
+ *   -a  after the script, play this many games with random
+ *       legal moves
+ *   -k  make the auto-player think this long before each move
+ *   -d  print each new display frame
+ *   -p  write the DO_PROFILE buffer at the end (see profdecode)
+ *   -S  write the DO_PCSAMPLE histogram at the end (see pcdecode)
+ *   -F  keep the flash in this file, so that what the firmware
+ *       stores (the game log and snapshot) carries over to the
+ *       next run. With -t, a run can stop mid-game, like a power cut
+ *   -W  the number of erases a flash page survives
+ *   -X  inject a fault on every nth I2C transfer (see dave_host.c)
+ *   -B  run the I2C bus at this speed, rather than the 400 kHz set
+ *       in i2c_master_conf.c
+ *   -O  draw the board turned 0, 90, 180 or 270 degrees (see plot.h)
+ *   -M  write the moves of every game to this file, as the stream
+ *       of movelog.h (see movereplay)
+ * The run ends when the script (and games) are done and the
+ * firmware is waiting for input again.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <DAVE.h>
+#include "nim.h"
+#include "profile.h"
+#include "pcsample.h"
+#include "latency.h"
+#include "speculate.h"
+#include "gamelog.h"
+#include "snapshot.h"
+#include "keyscan.h"
+#include "i2cq.h"
+#include "display.h"
+#include "anim.h"
+#include "plot.h"
+#include "canon.h"
+#include "movelog.h"
+#include "sim.h"
+
+/********* definitions *****************/
+#define NUM_BUTTONS 6
+#define COMPUTER_BUTTON 5
+#define TAP_MS 50        // how long a tap holds the button down
+#define CHORD_GAP_MS 100 // computer held this long before the row is tapped
+#define MAX_EVENTS 32
+#define MAX_SCRIPT 65536
+#define START_KEYS 15504 // canon_count(MAXROWS, 15): the starting rows up to their order
+#define TOP_STARTS 3
+
+/********* types ***********************/
+typedef struct
+{
+  uint64_t t;   // ns
+  int8_t button;
+  int8_t down;
+} sim_event_t;
+
+typedef struct
+{
+  uint32_t period;  // ticks
+  uint32_t count;
+  SYSTIMER_MODE_t mode;
+  SYSTIMER_CALLBACK_t callback;
+  void* args;
+  uint8_t created;
+  uint8_t running;
+} sim_timer_t;
+
+/******** global variables **************/
+uint64_t sim_now_ns=0;
+int sim_verbose=0;
+int sim_show_display=0;
+int sim_in_isr=0;
+uint32_t sim_primask=0;
+volatile uint32_t g_systick_count=0; // as maintained by the SYSTIMER APP
+
+uint64_t next_tick_ns=SIM_TICK_NS;
+uint64_t limit_ns=600000ULL*1000000ULL;
+uint64_t interactive_ns=0; // when the firmware first took input
+SysTick_Type systick_regs={0x07, (SIM_CPU_HZ/1000U)-1U, 0, 0};
+SCB_Type scb_regs;
+sim_timer_t timers[SYSTIMER_CFG_MAX_TMR];
+
+sim_event_t events[MAX_EVENTS];
+int event_head=0;
+int event_count=0;
+char script[MAX_SCRIPT];
+const char* script_pos=script;
+char auto_buf[128];
+const char* auto_pos=auto_buf;
+uint64_t wait_until=0;
+int finish_pending=0;
+int finish_code=0;
+
+int auto_games=0;
+int auto_level=0;
+int auto_think_ms=0;
+int auto_played=0;
+int auto_user_wins=0;
+int auto_moves=0; // in the games played
+int auto_user_left_one=0;
+uint32_t auto_seed=1;
+uint16_t start_games[MAXROWS+1][START_KEYS]; // the auto-player's games, by how they started
+uint16_t start_wins[MAXROWS+1][START_KEYS];
+
+void (*finish_hooks[SIM_MAX_HOOKS])(void);
+int num_finish_hooks=0;
+struct timespec host_start;
+const char* prof_file=NULL;
+const char* pcsample_file=NULL;
+FILE* moves_fp=NULL;
+const char* moves_file=NULL;
+int moves_games=0;
+long moves_bytes=0;
+int moves_written=0; // the game in gamelog_moves has been written
+
+/***** extern variables *******/
+// these are defined in main.c
+extern unsigned char button_status[NUM_BUTTONS];
+extern unsigned char do_all_button_inhibit;
+// and these in gamelog.c
+extern gamelog_record_t gamelog_game;
+extern movelog_writer_t gamelog_moves;
+
+/******** function prototypes ***********/
+int firmware_main(void);
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static uint32_t
+sim_rand(void)
+{
+  auto_seed=auto_seed*1103515245U+12345U;
+  return(auto_seed>>16);
+}
+
+/* add_event
+ * queues a button change ms milliseconds from now.
+ * Events are always added in time order.
+ */
+static void
+add_event(uint32_t ms, int button, int down)
+{
+  sim_event_t* e;
+  if (event_count>=MAX_EVENTS)
+    return;
+  e=&events[(event_head+event_count) % MAX_EVENTS];
+  e->t=sim_now_ns+(uint64_t)ms*1000000ULL;
+  e->button=button;
+  e->down=down;
+  event_count++;
+}
+
+/* run_events
+ * applies the button changes that are due
+ */
+static void
+run_events(void)
+{
+  sim_event_t* e;
+  while ((event_count>0) && (events[event_head].t<=sim_now_ns))
+  {
+    e=&events[event_head];
+    sim_set_button(e->button, e->down);
+    if (sim_verbose)
+      printf("[%8.3f ms] button %c %s\n", sim_now_ns/1e6,
+             (e->button==COMPUTER_BUTTON) ? 'c' : '1'+e->button, e->down ? "down" : "up");
+    event_head=(event_head+1) % MAX_EVENTS;
+    event_count--;
+  }
+}
+
+/* firmware_ready
+ * the firmware is waiting in user_play and would register a press now
+ */
+static int
+firmware_ready(void)
+{
+  int i;
+  if (!awaiting_input || do_all_button_inhibit)
+    return(0);
+  for (i=0; i<NUM_BUTTONS; i++)
+  {
+    if (button_status[i]!=0)
+      return(0);
+  }
+  return(1);
+}
+
+/* next_token
+ * copies the next script token into tok. Returns 0 at the end.
+ */
+static int
+next_token(const char** pos, char* tok, int len)
+{
+  const char* p=*pos;
+  int n=0;
+
+  while (*p)
+  {
+    if (*p=='#')
+    {
+      while (*p && (*p!='\n'))
+        p++;
+    }
+    else if ((*p==' ') || (*p==',') || (*p=='\t') || (*p=='\n') || (*p=='\r'))
+    {
+      p++;
+    }
+    else
+    {
+      break;
+    }
+  }
+  while (*p && (*p!=' ') && (*p!=',') && (*p!='\t') && (*p!='\n') && (*p!='\r') && (*p!='#'))
+  {
+    if (n<len-1)
+      tok[n++]=*p;
+    p++;
+  }
+  tok[n]=0;
+  *pos=p;
+  return(n>0);
+}
+
+/* auto_move
+ * makes up the next move for the auto-player in auto_buf: a random
+ * number of sticks from a random row (or, on a Nim_k level, from up
+ * to ROWS_PER_MOVE rows, or on the Wythoff level, sometimes from
+ * both), then the computer button. When a game is over it starts
+ * another. Returns 0 when all the games have been played.
+ */
+static int
+auto_move(void)
+{
+  int total=0, taken=0;
+  int i, r, k, m, moves=1;
+  int used=0;
+  char* p=auto_buf;
+
+  for (i=0; i<rows; i++)
+  {
+    total+=numsticks[i];
+  }
+  if (total<=1)
+  {
+    auto_played++;
+    auto_moves+=gamelog_game.moves;
+    if (auto_user_left_one)
+      auto_user_wins++;
+    if ((gamelog_game.rows<=MAXROWS) && (gamelog_game.start<START_KEYS))
+    {
+      start_games[gamelog_game.rows][gamelog_game.start]++;
+      if (auto_user_left_one)
+        start_wins[gamelog_game.rows][gamelog_game.start]++;
+    }
+    auto_user_left_one=0;
+    if (auto_played>=auto_games)
+      return(0);
+    sprintf(auto_buf, "c+%d", auto_level ? auto_level : level);
+    auto_pos=auto_buf;
+    return(1);
+  }
+  if (ROWS_PER_MOVE(level)>1)
+  {
+    moves=1+sim_rand() % ROWS_PER_MOVE(level);
+  }
+  if (auto_think_ms)
+  {
+    p+=sprintf(p, "w%d ", auto_think_ms);
+  }
+  if ((level==WYTHOFF_LEVEL) && (numsticks[0]>0) && (numsticks[1]>0) && (sim_rand() % 3==0))
+  {
+    // the same from both rows
+    k=1+sim_rand() % ((numsticks[0]<numsticks[1]) ? numsticks[0] : numsticks[1]);
+    if (2*k==total)
+      k--;
+    taken=2*k;
+    for (i=0; i<k; i++)
+    {
+      p+=sprintf(p, "%d ", WYTHOFF_BOTH);
+    }
+    moves=(k>0) ? 0 : 1;
+  }
+  for (m=0; m<moves; m++)
+  {
+    for (i=0; i<rows; i++)
+    {
+      if ((numsticks[i]>0) && !(used & (1<<i)))
+        break;
+    }
+    if (i==rows)
+      break; // no other row to take from
+    do
+    {
+      r=sim_rand() % rows;
+    } while ((numsticks[r]==0) || (used & (1<<r)));
+    k=1+sim_rand() % numsticks[r];
+    if (taken+k==total)
+      k--; // taking the last stick loses outright, so don't
+    if (k==0)
+      break;
+    used|=1<<r;
+    taken+=k;
+    for (i=0; i<k; i++)
+    {
+      p+=sprintf(p, "%d ", r+1);
+    }
+  }
+  auto_user_left_one=(total-taken==1);
+  sprintf(p, "c");
+  auto_pos=auto_buf;
+  return(1);
+}
+
+/* script_step
+ * starts the next scripted action once the last one has finished
+ * and the firmware is ready for it
+ */
+static void
+script_step(void)
+{
+  char tok[32];
+  const char* save;
+  const char** pos;
+
+  if ((event_count>0) || (sim_now_ns<wait_until) || finish_pending)
+    return;
+  for (;;)
+  {
+    pos=(*script_pos) ? &script_pos : &auto_pos;
+    save=*pos;
+    if (!next_token(pos, tok, sizeof(tok)))
+    {
+      if ((auto_played>=auto_games) || !firmware_ready())
+        return;
+      if (!auto_move())
+      {
+        finish_pending=1;
+        return;
+      }
+      continue;
+    }
+    break;
+  }
+  if (tok[0]=='w')
+  {
+    wait_until=sim_now_ns+strtoull(tok+1, NULL, 10)*1000000ULL;
+    return;
+  }
+  if (!firmware_ready())
+  {
+    *pos=save; // try again next tick
+    return;
+  }
+  if (strncmp(tok, "c+", 2)==0)
+  {
+    add_event(0, COMPUTER_BUTTON, 1);
+    add_event(CHORD_GAP_MS, atoi(tok+2)-1, 1);
+    add_event(CHORD_GAP_MS+TAP_MS, atoi(tok+2)-1, 0);
+    add_event(CHORD_GAP_MS+2*TAP_MS, COMPUTER_BUTTON, 0);
+  }
+  else if (tok[0]=='c')
+  {
+    add_event(0, COMPUTER_BUTTON, 1);
+    add_event(TAP_MS, COMPUTER_BUTTON, 0);
+  }
+  else if ((tok[0]>='1') && (tok[0]<='5'))
+  {
+    add_event(0, tok[0]-'1', 1);
+    add_event(TAP_MS, tok[0]-'1', 0);
+  }
+  else
+  {
+    fprintf(stderr, "sim: unknown script token '%s'\n", tok);
+  }
+}
+
+/* record_moves
+ * writes out each game from gamelog_moves once it has ended
+ */
+static void
+record_moves(void)
+{
+  if (moves_fp==NULL)
+    return;
+  if (!gamelog_moves.ended)
+  {
+    moves_written=0;
+    return;
+  }
+  if (moves_written)
+    return;
+  fwrite(gamelog_moves.buf, 1, gamelog_moves.len, moves_fp);
+  moves_games++;
+  moves_bytes+=gamelog_moves.len;
+  moves_written=1;
+}
+
+/* sim_tick
+ * one SysTick: button changes that are due, then the SYSTIMER
+ * callbacks in interrupt context, then the script
+ */
+static void
+sim_tick(void)
+{
+  uint32_t i;
+  sim_timer_t* t;
+
+  g_systick_count++;
+  if ((interactive_ns==0) && firmware_ready())
+  {
+    interactive_ns=sim_now_ns; // time to interactive
+  }
+  run_events();
+  ht16k33_sim_tick();
+  sim_in_isr=1;
+  for (i=0; i<SYSTIMER_CFG_MAX_TMR; i++)
+  {
+    t=&timers[i];
+    if (!t->running)
+      continue;
+    if (--t->count==0)
+    {
+      if (t->mode==SYSTIMER_MODE_PERIODIC)
+        t->count=t->period;
+      else
+        t->running=0;
+      t->callback(t->args);
+    }
+  }
+  sim_in_isr=0;
+  record_moves();
+  if (!finish_pending)
+  {
+    if (*script_pos || (auto_played<auto_games))
+    {
+      script_step();
+    }
+    else if ((event_count==0) && (sim_now_ns>=wait_until) && firmware_ready())
+    {
+      finish_pending=1;
+    }
+  }
+  if (sim_now_ns>=limit_ns)
+  {
+    finish_pending=1;
+    finish_code=1;
+  }
+}
+
+/* starts_report
+ * the auto-player's games by their starting rows, taken up to their
+ * order from the game log's record of each game
+ */
+static void
+starts_report(void)
+{
+  unsigned char sticks[MAXROWS];
+  int top_r[TOP_STARTS], top_k[TOP_STARTS];
+  int r, key, i, j, n, starts=0;
+
+  for (i=0; i<TOP_STARTS; i++)
+    top_k[i]=-1;
+  for (r=0; r<=MAXROWS; r++)
+  {
+    for (key=0; key<START_KEYS; key++)
+    {
+      n=start_games[r][key];
+      if (n==0)
+        continue;
+      starts++;
+      for (i=0; (i<TOP_STARTS) && (top_k[i]>=0) && (start_games[top_r[i]][top_k[i]]>=n); i++)
+        ;
+      if (i==TOP_STARTS)
+        continue;
+      for (j=TOP_STARTS-1; j>i; j--)
+      {
+        top_r[j]=top_r[j-1];
+        top_k[j]=top_k[j-1];
+      }
+      top_r[i]=r;
+      top_k[i]=key;
+    }
+  }
+  printf("starts: %d different, up to the order of the rows\n", starts);
+  for (i=0; (i<TOP_STARTS) && (top_k[i]>=0); i++)
+  {
+    canon_unrank((uint32_t)top_k[i], (unsigned char)top_r[i], sticks);
+    printf("  rows");
+    for (j=0; j<top_r[i]; j++)
+      printf(" %d", sticks[j]);
+    n=start_games[top_r[i]][top_k[i]];
+    printf(": %d game%s, %.0f%% won by the player\n", n, (n==1) ? "" : "s",
+           start_wins[top_r[i]][top_k[i]]*100.0/n);
+  }
+}
+
+static void
+sim_report(void)
+{
+  struct timespec now;
+  double host_s;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  host_s=(now.tv_sec-host_start.tv_sec)+(now.tv_nsec-host_start.tv_nsec)/1e9;
+  printf("\nsim: %.3f s virtual (%u ticks) in %.3f s host%s\n", sim_now_ns/1e9,
+         g_systick_count, host_s, finish_code ? ", stopped at the time limit" : "");
+  printf("boot: ready for input %.1f ms after reset\n", interactive_ns/1e6);
+  if (auto_games)
+  {
+    printf("games: %d played, %d won by the player, %d by the computer, %.1f moves each\n",
+           auto_played, auto_user_wins, auto_played-auto_user_wins,
+           auto_played ? (double)auto_moves/auto_played : 0.0);
+    starts_report();
+  }
+}
+
+#ifdef DO_PROFILE
+static void
+write_prof(void)
+{
+  FILE* fp;
+  if (prof_file==NULL)
+    return;
+  fp=fopen(prof_file, "wb");
+  if (fp==NULL)
+  {
+    perror(prof_file);
+    return;
+  }
+  fwrite(&prof_buffer, sizeof(prof_buffer), 1, fp);
+  fclose(fp);
+  printf("profile: %u records written to %s\n", prof_buffer.count, prof_file);
+}
+#endif
+
+static void
+moves_report(void)
+{
+  if (moves_fp==NULL)
+    return;
+  fclose(moves_fp);
+  printf("moves: %d games in %ld bytes written to %s\n", moves_games, moves_bytes, moves_file);
+}
+
+static void
+load_script(const char* path)
+{
+  FILE* fp=fopen(path, "r");
+  size_t len=strlen(script);
+  if (fp==NULL)
+  {
+    perror(path);
+    exit(2);
+  }
+  len+=fread(script+len, 1, MAX_SCRIPT-len-2, fp);
+  script[len++]='\n';
+  script[len]=0;
+  fclose(fp);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* sim_advance_to
+ * moves virtual time on to t_ns, running any SysTicks and I2C
+ * callbacks on the way. Called from an interrupt, time moves but
+ * the interrupts wait.
+ */
+void
+sim_advance_to(uint64_t t_ns)
+{
+  uint64_t ev;
+
+  while (!sim_in_isr)
+  {
+    ev=i2c_sim_event_due();
+    if ((ev!=0) && (ev<=t_ns) && (ev<next_tick_ns))
+    {
+      if (ev>sim_now_ns)
+        sim_now_ns=ev;
+      sim_in_isr=1;
+      i2c_sim_event();
+      sim_in_isr=0;
+      continue;
+    }
+    if (next_tick_ns>t_ns)
+      break;
+    sim_now_ns=next_tick_ns;
+    next_tick_ns+=SIM_TICK_NS;
+    sim_tick();
+  }
+  if (t_ns>sim_now_ns)
+    sim_now_ns=t_ns;
+}
+
+void
+sim_advance(uint64_t ns)
+{
+  sim_advance_to(sim_now_ns+ns);
+}
+
+/* sim_stall
+ * the CPU is stalled for ns by the flash, and the interrupts with it,
+ * as their handlers and the data they read are in flash. SysTick only
+ * holds one tick pending, so that one runs late, when the stall is
+ * over, and any others that fell in it are lost.
+ */
+void
+sim_stall(uint64_t ns)
+{
+  sim_now_ns+=ns;
+  if ((next_tick_ns>sim_now_ns) || sim_in_isr)
+    return;
+  next_tick_ns+=((sim_now_ns-next_tick_ns)/SIM_TICK_NS+1)*SIM_TICK_NS;
+  sim_tick();
+}
+
+/* sim_idle
+ * the firmware has nothing to do until the next interrupt: the
+ * SysTick, or the end of an I2C transfer
+ */
+void
+sim_idle(void)
+{
+  uint64_t ev=i2c_sim_event_due();
+
+  sim_advance_to(((ev!=0) && (ev<next_tick_ns)) ? ev : next_tick_ns);
+  if (finish_pending)
+    sim_finish(finish_code);
+}
+
+/* sim_at_finish
+ * registers a report to print (or file to write) at the end of the run
+ */
+void
+sim_at_finish(void (*fn)(void))
+{
+  if (num_finish_hooks<SIM_MAX_HOOKS)
+    finish_hooks[num_finish_hooks++]=fn;
+}
+
+void
+sim_finish(int code)
+{
+  int i;
+  for (i=0; i<num_finish_hooks; i++)
+  {
+    finish_hooks[i]();
+  }
+  fflush(stdout);
+  exit(code);
+}
+
+/*************** CMSIS / SYSTIMER ***************/
+SysTick_Type*
+sim_systick(void)
+{
+  uint64_t into_tick=sim_now_ns-(next_tick_ns-SIM_TICK_NS);
+  systick_regs.VAL=systick_regs.LOAD-(uint32_t)(into_tick*(SIM_CPU_HZ/1000000U)/1000U);
+  return(&systick_regs);
+}
+
+SCB_Type*
+sim_scb(void)
+{
+  scb_regs.ICSR=0; // ticks are never left pending
+  return(&scb_regs);
+}
+
+uint32_t
+SYSTIMER_CreateTimer(uint32_t period, SYSTIMER_MODE_t mode, SYSTIMER_CALLBACK_t callback, void *args)
+{
+  uint32_t i;
+  for (i=0; i<SYSTIMER_CFG_MAX_TMR; i++)
+  {
+    if (!timers[i].created)
+    {
+      timers[i].created=1;
+      timers[i].running=0;
+      timers[i].period=(period+SYSTIMER_TICK_PERIOD_US-1)/SYSTIMER_TICK_PERIOD_US;
+      timers[i].count=timers[i].period;
+      timers[i].mode=mode;
+      timers[i].callback=callback;
+      timers[i].args=args;
+      return(i+1);
+    }
+  }
+  return(0);
+}
+
+SYSTIMER_STATUS_t
+SYSTIMER_StartTimer(uint32_t id)
+{
+  if ((id==0) || (id>SYSTIMER_CFG_MAX_TMR) || !timers[id-1].created)
+    return(SYSTIMER_STATUS_FAILURE);
+  timers[id-1].running=1;
+  return(SYSTIMER_STATUS_SUCCESS);
+}
+
+SYSTIMER_STATUS_t
+SYSTIMER_StopTimer(uint32_t id)
+{
+  if ((id==0) || (id>SYSTIMER_CFG_MAX_TMR))
+    return(SYSTIMER_STATUS_FAILURE);
+  timers[id-1].running=0;
+  return(SYSTIMER_STATUS_SUCCESS);
+}
+
+SYSTIMER_STATUS_t
+SYSTIMER_RestartTimer(uint32_t id, uint32_t microsec)
+{
+  if ((id==0) || (id>SYSTIMER_CFG_MAX_TMR))
+    return(SYSTIMER_STATUS_FAILURE);
+  timers[id-1].period=(microsec+SYSTIMER_TICK_PERIOD_US-1)/SYSTIMER_TICK_PERIOD_US;
+  timers[id-1].count=timers[id-1].period;
+  timers[id-1].running=1;
+  return(SYSTIMER_STATUS_SUCCESS);
+}
+
+uint32_t
+SYSTIMER_GetTime(void)
+{
+  return(g_systick_count*SYSTIMER_TICK_PERIOD_US);
+}
+
+uint32_t
+SYSTIMER_GetTickCount(void)
+{
+  return(g_systick_count);
+}
+
+int
+main(int argc, char** argv)
+{
+  int c;
+
+  while ((c=getopt(argc, argv, "s:f:a:l:k:r:t:dvp:S:F:W:X:B:O:M:"))!=-1)
+  {
+    switch(c)
+    {
+      case 's':
+        strncat(script, optarg, MAX_SCRIPT-strlen(script)-2);
+        strcat(script, "\n");
+        break;
+      case 'f':
+        load_script(optarg);
+        break;
+      case 'a':
+        auto_games=atoi(optarg);
+        break;
+      case 'l':
+        auto_level=atoi(optarg);
+        break;
+      case 'k':
+        auto_think_ms=atoi(optarg);
+        break;
+      case 'r':
+        auto_seed=strtoul(optarg, NULL, 0);
+        break;
+      case 't':
+        limit_ns=strtoull(optarg, NULL, 10)*1000000ULL;
+        break;
+      case 'd':
+        sim_show_display=1;
+        break;
+      case 'v':
+        sim_verbose=1;
+        break;
+      case 'p':
+        prof_file=optarg;
+        break;
+      case 'S':
+        pcsample_file=optarg;
+        break;
+      case 'F':
+        flash_sim_load(optarg);
+        break;
+      case 'W':
+        flash_endurance=strtoul(optarg, NULL, 10);
+        break;
+      case 'X':
+        i2c_fault_every=strtoul(optarg, NULL, 10);
+        break;
+      case 'B':
+        i2c_bus.baudrate=strtoul(optarg, NULL, 10);
+        break;
+      case 'O':
+        display_orientation=(unsigned char)(atoi(optarg)/90);
+        break;
+      case 'M':
+        moves_file=optarg;
+        moves_fp=fopen(moves_file, "wb");
+        if (moves_fp==NULL)
+        {
+          perror(moves_file);
+          return(1);
+        }
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-s script] [-f scriptfile] [-a games] [-l level] [-k think_ms] [-r seed]\n"
+                        "       [-t limit_ms] [-d] [-v] [-p prof.bin] [-S pcs.bin]\n"
+                        "       [-F flash.bin] [-W erases] [-X n] [-B baud] [-O degrees] [-M moves.bin]\n", argv[0]);
+        return(2);
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &host_start);
+  sim_at_finish(sim_report);
+  sim_at_finish(dave_host_report);
+  sim_at_finish(ht16k33_sim_report);
+  sim_at_finish(i2cq_report);
+  sim_at_finish(display_report);
+  sim_at_finish(anim_report);
+#ifdef DO_KEYSCAN
+  sim_at_finish(ht16k33_sim_key_report);
+  sim_at_finish(keyscan_report);
+#endif
+  sim_at_finish(latency_boot_report);
+  sim_at_finish(latency_report);
+  sim_at_finish(speculate_report);
+  sim_at_finish(gamelog_report);
+  sim_at_finish(snapshot_report);
+  sim_at_finish(flash_sim_report);
+  sim_at_finish(moves_report);
+#ifdef DO_PROFILE
+  sim_at_finish(write_prof);
+#endif
+  return(firmware_main());
+}
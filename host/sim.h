@@ -0,0 +1,58 @@
+/***********************************************************
+ * sim.h
+ * Interfaces between the parts of the pocket-nim host
+ * simulation: the virtual clock and button script (sim.c),
+ * the DAVE APP stand-ins (dave_host.c) and the HT16K33
+ * display model (ht16k33_sim.c).
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdint.h>
+
+/*************** definitions *****************/
+#define SIM_TICK_NS 1000000ULL // SysTick period
+#define SIM_CPU_HZ 32000000UL  // MCLK, used to convert to cycles
+#define SIM_MAX_HOOKS 24
+
+/******** global variables **************/
+extern uint64_t sim_now_ns;  // virtual time since reset
+extern int sim_verbose;      // -v, print events as they happen
+extern int sim_show_display; // -d, print each display frame
+
+/******** function prototypes ***********/
+// sim.c
+void sim_advance_to(uint64_t t_ns);
+void sim_advance(uint64_t ns);
+void sim_stall(uint64_t ns);
+void sim_at_finish(void (*fn)(void));
+void sim_finish(int code);
+
+// dave_host.c
+extern unsigned long i2c_fault_every;
+uint64_t i2c_sim_event_due(void);
+void i2c_sim_event(void);
+void sim_set_button(int idx, int down);
+void sim_set_int(int high);
+void dave_host_report(void);
+
+// flash_sim.c
+extern uint32_t flash_endurance;
+void flash_sim_load(const char* path);
+void flash_sim_report(void);
+
+// ht16k33_sim.c
+extern unsigned long ht16k33_frames;
+int ht16k33_sim_start(uint8_t addr7, int read);
+void ht16k33_sim_write(uint8_t byte);
+uint8_t ht16k33_sim_read(void);
+void ht16k33_sim_stop(void);
+void ht16k33_sim_report(void);
+void ht16k33_sim_key(int n, int down);
+void ht16k33_sim_tick(void);
+void ht16k33_sim_key_report(void);
+
+#endif /* SIM_H_ */
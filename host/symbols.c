@@ -0,0 +1,246 @@
+/***********************************************************
+ * symbols.c
+ * Function symbol table for the host side tools, loaded
+ * from either pocket-nim.elf, the linker map file, or the
+ * host simulation binary.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <elf.h>
+#include "symbols.h"
+
+/********* definitions *****************/
+#define MAXLINE 512
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* add_symbol
+ * appends a symbol to the table, growing it as needed
+ */
+static void
+add_symbol(symtab_t* tab, uint32_t addr, uint32_t size, const char* name)
+{
+  symbol_t* s;
+  if ((tab->count & 255)==0)
+  {
+    tab->sym=realloc(tab->sym, (tab->count+256)*sizeof(symbol_t));
+  }
+  s=&tab->sym[tab->count++];
+  s->addr=addr & ~1U; // clear the Thumb bit
+  s->size=size;
+  strncpy(s->name, name, SYM_NAMELEN-1);
+  s->name[SYM_NAMELEN-1]=0;
+}
+
+static int
+compare_addr(const void* a, const void* b)
+{
+  const symbol_t* sa=a;
+  const symbol_t* sb=b;
+  if (sa->addr<sb->addr)
+    return(-1);
+  return(sa->addr>sb->addr);
+}
+
+/* load_elf
+ * reads the STT_FUNC entries of the ELF symbol table
+ */
+static int
+load_elf(symtab_t* tab, const unsigned char* img, long len)
+{
+  const Elf32_Ehdr* eh=(const Elf32_Ehdr*)img;
+  const Elf32_Shdr* sh;
+  const Elf32_Sym* sym;
+  const char* strtab;
+  int i, j, nsyms;
+
+  if ((len<(long)sizeof(Elf32_Ehdr)) || (eh->e_ident[EI_CLASS]!=ELFCLASS32))
+    return(-1);
+  sh=(const Elf32_Shdr*)(img+eh->e_shoff);
+  for (i=0; i<eh->e_shnum; i++)
+  {
+    if (sh[i].sh_type!=SHT_SYMTAB)
+      continue;
+    sym=(const Elf32_Sym*)(img+sh[i].sh_offset);
+    strtab=(const char*)(img+sh[sh[i].sh_link].sh_offset);
+    nsyms=sh[i].sh_size/sizeof(Elf32_Sym);
+    for (j=0; j<nsyms; j++)
+    {
+      if ((ELF32_ST_TYPE(sym[j].st_info)==STT_FUNC) && (sym[j].st_value!=0))
+      {
+        add_symbol(tab, sym[j].st_value, sym[j].st_size, strtab+sym[j].st_name);
+      }
+    }
+  }
+  return(0);
+}
+
+/* load_elf64
+ * as load_elf, for the host simulation binary. It is linked
+ * without PIE, so its code addresses fit in 32 bits.
+ */
+static int
+load_elf64(symtab_t* tab, const unsigned char* img, long len)
+{
+  const Elf64_Ehdr* eh=(const Elf64_Ehdr*)img;
+  const Elf64_Shdr* sh;
+  const Elf64_Sym* sym;
+  const char* strtab;
+  int i, j, nsyms;
+
+  if ((len<(long)sizeof(Elf64_Ehdr)) || (eh->e_ident[EI_CLASS]!=ELFCLASS64))
+    return(-1);
+  sh=(const Elf64_Shdr*)(img+eh->e_shoff);
+  for (i=0; i<eh->e_shnum; i++)
+  {
+    if (sh[i].sh_type!=SHT_SYMTAB)
+      continue;
+    sym=(const Elf64_Sym*)(img+sh[i].sh_offset);
+    strtab=(const char*)(img+sh[sh[i].sh_link].sh_offset);
+    nsyms=sh[i].sh_size/sizeof(Elf64_Sym);
+    for (j=0; j<nsyms; j++)
+    {
+      if ((ELF64_ST_TYPE(sym[j].st_info)==STT_FUNC) && (sym[j].st_value!=0) &&
+          (sym[j].st_value<0x100000000ULL))
+      {
+        add_symbol(tab, (uint32_t)sym[j].st_value, (uint32_t)sym[j].st_size, strtab+sym[j].st_name);
+      }
+    }
+  }
+  return(0);
+}
+
+/* load_map
+ * reads the "0xaddress   name" symbol lines of a GNU ld map file.
+ * The map doesn't give symbol sizes, so they are taken as the
+ * distance to the next symbol.
+ */
+static int
+load_map(symtab_t* tab, FILE* fp)
+{
+  char line[MAXLINE];
+  char name[MAXLINE];
+  char extra[MAXLINE];
+  unsigned long addr;
+  int in_map=0;
+  int i;
+
+  while (fgets(line, MAXLINE, fp))
+  {
+    if (strncmp(line, "Linker script and memory map", 28)==0)
+      in_map=1;
+    if (!in_map)
+      continue;
+    if (sscanf(line, " 0x%lx %511s %511s", &addr, name, extra)!=2)
+      continue;
+    if (!(isalpha((unsigned char)name[0]) || (name[0]=='_')))
+      continue;
+    // only code addresses; flash is at 0x10000000, SRAM (for .ram_code) at 0x20000000
+    if ((addr<0x10000000UL) || (addr>=0x30000000UL))
+      continue;
+    add_symbol(tab, (uint32_t)addr, 0, name);
+  }
+  qsort(tab->sym, tab->count, sizeof(symbol_t), compare_addr);
+  for (i=0; i+1<tab->count; i++)
+  {
+    tab->sym[i].size=tab->sym[i+1].addr-tab->sym[i].addr;
+  }
+  return(0);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* symtab_load
+ * loads the function symbols from an ELF file, or a map file.
+ * Returns 0 on success.
+ */
+int
+symtab_load(symtab_t* tab, const char* path)
+{
+  FILE* fp;
+  unsigned char* img;
+  long len;
+  int ret;
+
+  tab->sym=NULL;
+  tab->count=0;
+  fp=fopen(path, "rb");
+  if (fp==NULL)
+  {
+    perror(path);
+    return(-1);
+  }
+  fseek(fp, 0, SEEK_END);
+  len=ftell(fp);
+  rewind(fp);
+  img=malloc(len+1);
+  if (fread(img, 1, len, fp)!=(size_t)len)
+  {
+    free(img);
+    fclose(fp);
+    return(-1);
+  }
+  if ((len>4) && (memcmp(img, ELFMAG, SELFMAG)==0))
+  {
+    if (img[EI_CLASS]==ELFCLASS64)
+      ret=load_elf64(tab, img, len);
+    else
+      ret=load_elf(tab, img, len);
+    qsort(tab->sym, tab->count, sizeof(symbol_t), compare_addr);
+  }
+  else
+  {
+    rewind(fp);
+    ret=load_map(tab, fp);
+  }
+  free(img);
+  fclose(fp);
+  return(ret);
+}
+
+/* symtab_lookup
+ * returns the symbol containing addr, or NULL
+ */
+const symbol_t*
+symtab_lookup(const symtab_t* tab, uint32_t addr)
+{
+  int lo=0;
+  int hi=tab->count-1;
+  int mid;
+  const symbol_t* best=NULL;
+
+  addr &= ~1U;
+  while (lo<=hi)
+  {
+    mid=(lo+hi)/2;
+    if (tab->sym[mid].addr<=addr)
+    {
+      best=&tab->sym[mid];
+      lo=mid+1;
+    }
+    else
+    {
+      hi=mid-1;
+    }
+  }
+  if ((best!=NULL) && (best->size!=0) && (addr>=best->addr+best->size))
+    return(NULL);
+  return(best);
+}
+
+void
+symtab_free(symtab_t* tab)
+{
+  free(tab->sym);
+  tab->sym=NULL;
+  tab->count=0;
+}
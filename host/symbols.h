@@ -0,0 +1,36 @@
+/***********************************************************
+ * symbols.h
+ * Function symbol table for the host side tools, loaded
+ * from either pocket-nim.elf or the linker map file.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef SYMBOLS_H_
+#define SYMBOLS_H_
+
+#include <stdint.h>
+
+/********* definitions *****************/
+#define SYM_NAMELEN 64
+
+/********* types ***********************/
+typedef struct
+{
+  uint32_t addr;  // start address, with the Thumb bit cleared
+  uint32_t size;  // size in bytes, or the distance to the next symbol
+  char name[SYM_NAMELEN];
+} symbol_t;
+
+typedef struct
+{
+  symbol_t* sym;  // sorted by address
+  int count;
+} symtab_t;
+
+/******** function prototypes ***********/
+int symtab_load(symtab_t* tab, const char* path);
+const symbol_t* symtab_lookup(const symtab_t* tab, uint32_t addr);
+void symtab_free(symtab_t* tab);
+
+#endif /* SYMBOLS_H_ */
@@ -0,0 +1,136 @@
+/***********************************************************
+ * wythoff64.c
+ * Wythoff's game on the desktop, for piles up to 2^63.
+ * See wythoff64.h.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdint.h>
+#include <math.h>
+#include "wythoff64.h"
+
+/********* types ***********************/
+typedef unsigned __int128 u128;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* isqrt
+ * floor(sqrt(q)), for q below 2^127. A long double square root is
+ * within a few units, and is then put right
+ */
+static uint64_t
+isqrt(u128 q)
+{
+  uint64_t r=(uint64_t)sqrtl((long double)q);
+
+  while ((u128)r*r>q)
+    r--;
+  while ((u128)(r+1)*(r+1)<=q)
+    r++;
+  return(r);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* wythoff_floor_phi
+ * floor(n*phi), exactly, for n up to 2^63. With y = n*sqrt(5)/2,
+ * n*phi = n/2 + y, and floor(y) = isqrt(floor(5n^2/4)), which fits in
+ * 128 bits where 5n^2 wouldn't. For odd n, the half carries if
+ * y's fraction is at least 1/2, that is if y^2 >= t^2+t+1/4
+ */
+uint64_t
+wythoff_floor_phi(uint64_t n)
+{
+  u128 sq=(u128)n*n;
+  u128 q=5*(sq>>2)+((5*(sq & 3))>>2); // floor(5n^2/4)
+  uint64_t t=isqrt(q);
+
+  if ((n & 1)==0)
+    return(n/2+t);
+  return((n-1)/2+t+(q>=(u128)t*t+t)); // 5n^2/4 is q+1/4 here
+}
+
+/* wythoff_partner
+ * the other pile of the cold position that has a pile of v
+ */
+uint64_t
+wythoff_partner(uint64_t v, int misere)
+{
+  uint64_t f, m;
+
+  if (misere && (v<=2))
+    return((v==2) ? 2 : 1-v); // (0, 1) and (2, 2)
+  if (v==0)
+    return(0);
+  f=wythoff_floor_phi(v);
+  m=f-v; // floor(v/phi)
+  if (wythoff_floor_phi(m+1)==v)
+    return(v+m+1); // v is a_(m+1)
+  return(m); // v is b_n with n=v-m, and a_n=v-n
+}
+
+/* wythoff_gap
+ * the smaller pile of the cold position whose piles differ by d
+ */
+uint64_t
+wythoff_gap(uint64_t d, int misere)
+{
+  if (misere && (d<=1))
+    return((d==0) ? 2 : 0); // (2, 2) and (0, 1)
+  return(wythoff_floor_phi(d));
+}
+
+/* wythoff64_cold
+ * returns 1 if the player to move loses
+ */
+int
+wythoff64_cold(uint64_t x, uint64_t y, int misere)
+{
+  if (!misere && (x==0) && (y==0))
+    return(1);
+  return(wythoff_partner(x, misere)==y);
+}
+
+/* wythoff64_choose
+ * works out a move, and returns 1 if it is a winning one. If there
+ * is none, returns 0 with one stick taken from the larger pile, to
+ * make the game last (or nothing, if there are no sticks)
+ */
+int
+wythoff64_choose(uint64_t x, uint64_t y, int misere, uint64_t* nx, uint64_t* ny)
+{
+  uint64_t p, a, lo, hi;
+  int swapped=(x>y);
+
+  lo=swapped ? y : x;
+  hi=swapped ? x : y;
+  p=wythoff_partner(lo, misere);
+  if (wythoff64_cold(lo, hi, misere) || ((lo==0) && (hi==0)))
+  {
+    if (hi>0)
+      hi--; // play for time
+    *nx=swapped ? hi : lo;
+    *ny=swapped ? lo : hi;
+    return(0);
+  }
+  if (p<hi)
+  {
+    hi=p; // take from the larger pile to the partner of the smaller
+  }
+  else
+  {
+    // the partner is above it: take from both, to the cold
+    // position with the same difference
+    a=wythoff_gap(hi-lo, misere);
+    hi-=lo-a;
+    lo=a;
+  }
+  *nx=swapped ? hi : lo;
+  *ny=swapped ? lo : hi;
+  return(1);
+}
@@ -0,0 +1,33 @@
+/***********************************************************
+ * wythoff64.h
+ * Wythoff's game on the desktop, for piles up to 2^63.
+ *
+ * Two piles: a move takes any number from one pile, or the same
+ * number from both. The cold positions (lost for the player to
+ * move) in normal play are (a_n, b_n) with a_n = floor(n*phi) and
+ * b_n = a_n + n, phi being the golden ratio. Every pile size is in
+ * exactly one of them. In misere play, where taking the last stick
+ * loses, (0, 0) and (1, 2) are replaced by (0, 1) and (2, 2), and
+ * the rest are the same.
+ *
+ * floor(n*phi) is worked out exactly in integers, as
+ * (n + isqrt(5n^2)) / 2, with 128 bit arithmetic: a double would
+ * be wrong from about n = 2^26. The firmware does the same from
+ * tables made by mkwythoff (see pocket-nim/wythoff.h).
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef WYTHOFF64_H_
+#define WYTHOFF64_H_
+
+#include <stdint.h>
+
+/******** function prototypes ***********/
+uint64_t wythoff_floor_phi(uint64_t n);
+uint64_t wythoff_partner(uint64_t v, int misere);
+uint64_t wythoff_gap(uint64_t d, int misere);
+int wythoff64_cold(uint64_t x, uint64_t y, int misere);
+int wythoff64_choose(uint64_t x, uint64_t y, int misere, uint64_t* nx, uint64_t* ny);
+
+#endif /* WYTHOFF64_H_ */
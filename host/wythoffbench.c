@@ -0,0 +1,293 @@
+/***********************************************************
+ * wythoffbench.c
+ * Checks and times Wythoff's game: the exact floor(n*phi) and
+ * engine in wythoff64.c, and the firmware's table engine
+ * (pocket-nim/wythoff.c).
+ *  - floor(n*phi) against the cold pairs built one at a time
+ *    (a_n is the least number not used yet, b_n = a_n + n) up to
+ *    n, and at every Fibonacci number below 2^63, where n*phi is
+ *    closest to a whole number. The first n a double gets wrong
+ *    is printed too
+ *  - the time to build the table of floor(n*phi) up to n both
+ *    ways, as mkwythoff would for a larger board
+ *  - every position up to 64 in both rows solved by searching the
+ *    game tree, normal and misere, against wythoff64_choose() and
+ *    (misere, up to the tables) the firmware's wythoff_choose()
+ *  - the time for a move: the firmware's, and wythoff64_choose()
+ *    on random rows of up to 2^63, each checked to be legal and
+ *    to leave a cold position
+ *
+ * usage: wythoffbench [-n table] [-m moves] [-r seed]
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "wythoff64.h"
+#include "wythoff.h"
+#include "wythoff_data.h"
+
+/********* definitions *****************/
+#define TREE_MAX 64
+#define PHI 1.6180339887498948482
+
+/******** global variables **************/
+uint64_t table_len=10000000;
+int num_moves=1000000;
+signed char tree[2][TREE_MAX+1][TREE_MAX+1]; // -1 not known yet, 1 cold
+volatile uint64_t sink;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static double
+now_s(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec+ts.tv_nsec/1e9);
+}
+
+static uint64_t
+rand64(void)
+{
+  return(((uint64_t)rand()<<42) ^ ((uint64_t)rand()<<21) ^ (uint64_t)rand());
+}
+
+/* tree_cold
+ * solves a position by trying every move
+ */
+static int
+tree_cold(int x, int y, int misere)
+{
+  int t;
+
+  if ((x==0) && (y==0))
+    return(!misere); // the last stick was just taken
+  if (tree[misere][x][y]<0)
+  {
+    tree[misere][x][y]=1;
+    for (t=1; (t<=x) && tree[misere][x][y]; t++)
+    {
+      if (tree_cold(x-t, y, misere))
+        tree[misere][x][y]=0;
+    }
+    for (t=1; (t<=y) && tree[misere][x][y]; t++)
+    {
+      if (tree_cold(x, y-t, misere))
+        tree[misere][x][y]=0;
+    }
+    for (t=1; (t<=x) && (t<=y) && tree[misere][x][y]; t++)
+    {
+      if (tree_cold(x-t, y-t, misere))
+        tree[misere][x][y]=0;
+    }
+  }
+  return(tree[misere][x][y]);
+}
+
+/* legal
+ * checks that (nx, ny) is a move from (x, y)
+ */
+static int
+legal(uint64_t x, uint64_t y, uint64_t nx, uint64_t ny)
+{
+  if ((nx>x) || (ny>y) || ((nx==x) && (ny==y)))
+    return(0);
+  return((nx==x) || (ny==y) || (x-nx==y-ny));
+}
+
+/* check_phi
+ * floor(n*phi) against the cold pairs built one at a time, and at the
+ * Fibonacci numbers. Returns the number of mistakes
+ */
+static int
+check_phi(double* exact_s, double* built_s)
+{
+  uint8_t* used;
+  uint64_t n, a=0, f0=1, f1=1, f2, double_wrong=0;
+  uint64_t* exact;
+  int k, bad=0;
+  double t0;
+
+  exact=malloc(table_len*sizeof(uint64_t));
+  used=calloc(2*table_len+2, 1);
+  t0=now_s();
+  for (n=0; n<table_len; n++)
+    exact[n]=wythoff_floor_phi(n);
+  *exact_s=now_s()-t0;
+  t0=now_s();
+  for (n=0; n<table_len; n++)
+  {
+    while (used[a])
+      a++;
+    if (exact[n]!=a)
+      bad++;
+    used[a]=1;
+    if (a+n<2*table_len+2)
+      used[a+n]=1;
+  }
+  *built_s=now_s()-t0;
+  // F_k*phi - F_(k+1) is (-1)^(k+1)/phi^k, so floor(F_k*phi) is F_(k+1),
+  // less 1 for even k
+  for (k=2; f1<=(1ULL<<63); k++)
+  {
+    f2=f0+f1; // f1 is F_k, f2 is F_(k+1)
+    if (wythoff_floor_phi(f1)!=f2-((k & 1)==0))
+      bad++;
+    if (!double_wrong && ((uint64_t)(f1*PHI)!=f2-((k & 1)==0)))
+      double_wrong=f1;
+    if (f2<f1)
+      break;
+    f0=f1;
+    f1=f2;
+  }
+  printf("floor(n*phi) for n below %llu in %.3f s (%.1f ns each), built one pair at a time %.3f s; "
+         "a double is first wrong at n=%llu\n",
+         (unsigned long long)table_len, *exact_s, *exact_s*1e9/table_len, *built_s,
+         (unsigned long long)double_wrong);
+  free(exact);
+  free(used);
+  return(bad);
+}
+
+/* check_tree
+ * every position up to TREE_MAX against the tree search. Returns the
+ * number of mistakes
+ */
+static int
+check_tree(void)
+{
+  uint64_t nx, ny;
+  unsigned char sticks[2], after[2];
+  int x, y, misere, cold, won, bad=0, fw=0;
+
+  memset(tree, -1, sizeof(tree));
+  for (misere=0; misere<2; misere++)
+  {
+    for (x=0; x<=TREE_MAX; x++)
+    {
+      for (y=0; y<=TREE_MAX; y++)
+      {
+        if ((x==0) && (y==0))
+          continue;
+        cold=tree_cold(x, y, misere);
+        won=wythoff64_choose((uint64_t)x, (uint64_t)y, misere, &nx, &ny);
+        if ((wythoff64_cold((uint64_t)x, (uint64_t)y, misere)!=cold) || (won==cold) ||
+            !legal((uint64_t)x, (uint64_t)y, nx, ny) || (won && !tree_cold((int)nx, (int)ny, misere)))
+          bad++;
+        if (misere && (x<=WYTHOFF_MAX_PILE) && (y<=WYTHOFF_MAX_PILE))
+        {
+          sticks[0]=(unsigned char)x;
+          sticks[1]=(unsigned char)y;
+          won=wythoff_choose(sticks, after);
+          if ((wythoff_cold(sticks)!=cold) || (won==cold) || !legal(x, y, after[0], after[1]) ||
+              (won && !tree_cold(after[0], after[1], 1)))
+            bad++;
+          fw++;
+        }
+      }
+    }
+  }
+  printf("all positions up to %d, normal and misere, against a tree search (%d of them by the firmware's "
+         "tables): %d wrong\n", TREE_MAX, fw, bad);
+  return(bad);
+}
+
+/* time_moves
+ * the firmware's moves, and the desktop's on rows up to 2^63. Returns
+ * the number of mistakes
+ */
+static int
+time_moves(void)
+{
+  unsigned char (*small)[2];
+  uint64_t (*big)[2];
+  unsigned char after[2];
+  uint64_t nx, ny;
+  int p, won, bad=0;
+  double t0, fw_ns, desk_ns;
+
+  small=malloc(num_moves*sizeof(*small));
+  big=malloc(num_moves*sizeof(*big));
+  for (p=0; p<num_moves; p++)
+  {
+    small[p][0]=(unsigned char)(rand()%(WYTHOFF_MAX_PILE+1));
+    small[p][1]=(unsigned char)(rand()%(WYTHOFF_MAX_PILE+1));
+    big[p][0]=rand64() & ((1ULL<<63)-1);
+    big[p][1]=rand64() & ((1ULL<<63)-1);
+  }
+  t0=now_s();
+  for (p=0; p<num_moves; p++)
+  {
+    wythoff_choose(small[p], after);
+    sink+=after[0];
+  }
+  fw_ns=(now_s()-t0)*1e9/num_moves;
+  t0=now_s();
+  for (p=0; p<num_moves; p++)
+  {
+    wythoff64_choose(big[p][0], big[p][1], 1, &nx, &ny);
+    sink+=nx;
+  }
+  desk_ns=(now_s()-t0)*1e9/num_moves;
+  for (p=0; p<num_moves; p++)
+  {
+    won=wythoff64_choose(big[p][0], big[p][1], 1, &nx, &ny);
+    if (!legal(big[p][0], big[p][1], nx, ny) || (won!=!wythoff64_cold(big[p][0], big[p][1], 1)) ||
+        (won && !wythoff64_cold(nx, ny, 1)))
+      bad++;
+  }
+  printf("%d moves: the firmware's tables %.1f ns each, exact on rows up to 2^63 %.1f ns each, %d wrong\n",
+         num_moves, fw_ns, desk_ns, bad);
+  free(small);
+  free(big);
+  return(bad);
+}
+
+/****************************************
+ * main
+ ****************************************/
+
+int
+main(int argc, char** argv)
+{
+  int c, failed=0;
+  unsigned long seed=1;
+  double exact_s, built_s;
+
+  while ((c=getopt(argc, argv, "n:m:r:"))!=-1)
+  {
+    switch(c)
+    {
+      case 'n':
+        table_len=strtoull(optarg, NULL, 0);
+        break;
+      case 'm':
+        num_moves=atoi(optarg);
+        break;
+      case 'r':
+        seed=strtoul(optarg, NULL, 0);
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-n table] [-m moves] [-r seed]\n", argv[0]);
+        return(2);
+    }
+  }
+  if (table_len<1)
+    table_len=1;
+  if (num_moves<1)
+    num_moves=1;
+  srand(seed);
+
+  failed+=(check_phi(&exact_s, &built_s)!=0);
+  failed+=(check_tree()!=0);
+  failed+=(time_moves()!=0);
+  return(failed ? 1 : 0);
+}
@@ -92,7 +92,7 @@ void i2c_bus_dma_rx_handler(XMC_DMA_CH_EVENT_t event);
 #endif
 const XMC_I2C_CH_CONFIG_t i2c_bus_channel_config =
 {
-  .baudrate = (uint32_t)(100000U),
+  .baudrate = (uint32_t)(400000U),
   .address  = 0
 };
 
@@ -100,8 +100,8 @@ const I2C_MASTER_CONFIG_t i2c_bus_config =
 {
   .brg_config = &i2c_bus_channel_config,
   .fptr_i2c_config = i2c_bus_init,
-  .tx_cbhandler = NULL,
-  .rx_cbhandler = NULL,
+  .tx_cbhandler = i2cq_tx_done,
+  .rx_cbhandler = i2cq_rx_done,
   .nack_cbhandler = NULL,
   .arbitration_cbhandler = NULL,
   .error_cbhandler = NULL,
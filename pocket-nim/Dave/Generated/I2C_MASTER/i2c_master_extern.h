@@ -65,6 +65,10 @@ extern "C" {
 #define i2c_bus_RX_HANDLER	IRQ_Hdlr_10
 
 extern I2C_MASTER_t i2c_bus;
+
+extern void i2cq_tx_done(void);
+
+extern void i2cq_rx_done(void);
 void I2C_MASTER_ProtocolHandler(I2C_MASTER_t * const handle);
 #ifdef __cplusplus
 }
@@ -4,13 +4,67 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
-../main.c 
+../anim.c \
+../canon.c \
+../classic.c \
+../display.c \
+../distance.c \
+../gamelog.c \
+../i2cq.c \
+../keyscan.c \
+../latency.c \
+../main.c \
+../mistake.c \
+../movelog.c \
+../nimk.c \
+../pcsample.c \
+../plot.c \
+../profile.c \
+../snapshot.c \
+../speculate.c \
+../wythoff.c 
 
 OBJS += \
-./main.o 
+./anim.o \
+./canon.o \
+./classic.o \
+./display.o \
+./distance.o \
+./gamelog.o \
+./i2cq.o \
+./keyscan.o \
+./latency.o \
+./main.o \
+./mistake.o \
+./movelog.o \
+./nimk.o \
+./pcsample.o \
+./plot.o \
+./profile.o \
+./snapshot.o \
+./speculate.o \
+./wythoff.o 
 
 C_DEPS += \
-./main.d 
+./anim.d \
+./canon.d \
+./classic.d \
+./display.d \
+./distance.d \
+./gamelog.d \
+./i2cq.d \
+./keyscan.d \
+./latency.d \
+./main.d \
+./mistake.d \
+./movelog.d \
+./nimk.d \
+./pcsample.d \
+./plot.d \
+./profile.d \
+./snapshot.d \
+./speculate.d \
+./wythoff.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -0,0 +1,229 @@
+/***********************************************************
+ * anim.c
+ * Plays the animations drawn in anim.txt, a frame at a time.
+ * See anim.h for the format.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <DAVE.h>
+#include <stdio.h>
+#include <string.h>
+#include "nim.h"
+#include "profile.h"
+#include "latency.h"
+#include "display.h"
+#include "plot.h"
+#include "anim.h"
+#define ANIM_TABLES
+#include "anim_data.h"
+
+/******** global variables **************/
+unsigned char anim_active=0;
+anim_stats_t anim_stats;
+
+const uint8_t* anim_pos;            // the next frame
+uint8_t anim_canvas[ANIM_LINES];
+uint16_t anim_old[DISPLAY_LINES];   // the board before the move
+uint16_t anim_new[DISPLAY_LINES];   // ..and after it
+unsigned char anim_lead;            // no frame has changed the board yet
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* board_of
+ * draws rows of sticks into board, or blanks it for NULL
+ */
+static void
+board_of(uint16_t* board, const unsigned char* sticks)
+{
+  unsigned char copy[MAXROWS];
+
+  if (sticks==NULL)
+  {
+    memset(board, 0, sizeof(anim_new));
+    return;
+  }
+  memcpy(copy, sticks, sizeof(copy));
+  plot_ram_rows(copy);
+  memcpy(board, display_ram, sizeof(anim_new));
+}
+
+/* decode
+ * applies the changes of the frame at anim_pos to the canvas
+ */
+static void
+decode(uint8_t coding)
+{
+  uint8_t changed, n, v;
+  unsigned char y;
+
+  switch(coding)
+  {
+    case ANIM_DELTA:
+      changed=*anim_pos++;
+      for (y=0; y<ANIM_LINES; y++)
+      {
+        if (changed & (1<<y))
+          anim_canvas[y]=*anim_pos++;
+      }
+      break;
+    case ANIM_RLE:
+      for (y=0; y<ANIM_LINES; )
+      {
+        n=*anim_pos++;
+        v=*anim_pos++;
+        for (; (n>0) && (y<ANIM_LINES); n--)
+          anim_canvas[y++]=v;
+      }
+      break;
+    default: // ANIM_SAME
+      break;
+  }
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* anim_start
+ * sets up animation id (see anim_data.h) to be played a frame at a time
+ * with anim_step. old_rows and new_rows are the sticks before and after
+ * the move it shows, for the frames drawn over the board; either can be
+ * NULL for a blank board.
+ */
+void
+anim_start(unsigned char id, const unsigned char* old_rows, const unsigned char* new_rows)
+{
+  if (id>=ANIM_COUNT)
+    return;
+  if (anim_active)
+    anim_stop();
+  board_of(anim_old, old_rows);
+  board_of(anim_new, new_rows);
+  memset(anim_canvas, 0, sizeof(anim_canvas));
+  anim_pos=anim_list[id].data;
+  anim_lead=(old_rows!=NULL);
+  anim_active=1;
+  anim_stats.started++;
+}
+
+/* anim_step
+ * shows the next frame, and sets display_update_timer for when the one
+ * after is due (see display_due). Returns 0 once the animation is over.
+ * Frames at the start that show the board as it was before the move
+ * (e.g. a wipe that hasn't reached the sticks taken yet) are passed
+ * over, as the board is already showing: the first frame shown is the
+ * first that shows the move.
+ */
+unsigned char
+anim_step(void)
+{
+  uint32_t start, cycles;
+  uint16_t over, took;
+  uint8_t duration, op;
+  unsigned char i;
+
+  if (!anim_active)
+    return(0);
+  do
+  {
+    duration=*anim_pos++;
+    if (duration==0)
+    {
+      anim_active=0;
+      return(0);
+    }
+    PROF_ENTER(anim_step);
+    start=cycles_now();
+    op=*anim_pos++;
+    decode(op & ANIM_CODING_MASK);
+    for (i=0; i<DISPLAY_LINES; i++)
+    {
+      over=(i<ANIM_LINES) ? DISPLAY_BYTE_LINE(anim_canvas[i]) : 0;
+      switch(op & ANIM_MODE_MASK)
+      {
+        case ANIM_NEW:
+          display_ram[i]=anim_new[i] | over;
+          break;
+        case ANIM_OLD:
+          display_ram[i]=anim_old[i] | over;
+          break;
+        case ANIM_WIPE:
+          took=anim_old[i] & (uint16_t)~anim_new[i];
+          display_ram[i]=anim_new[i] | (anim_canvas[i%ANIM_LINES] ? took : 0);
+          break;
+        default: // ANIM_SHOW
+          display_ram[i]=over;
+          break;
+      }
+    }
+    if (anim_lead)
+      anim_lead=(memcmp(display_ram, anim_old, sizeof(anim_old))==0);
+    cycles=cycles_now()-start;
+    anim_stats.frames++;
+    anim_stats.cycles+=cycles;
+    if (cycles>anim_stats.worst)
+      anim_stats.worst=cycles;
+    PROF_LEAVE(anim_step);
+  } while (anim_lead);
+  display_write();
+  display_update_timer=(unsigned int)duration*DISPLAY_FRAME_MS;
+  return(1);
+}
+
+/* anim_stop
+ * cuts the animation short. The caller redraws the board
+ */
+void
+anim_stop(void)
+{
+  if (anim_active)
+  {
+    anim_active=0;
+    anim_stats.cut_short++;
+  }
+}
+
+/* anim_play
+ * plays an animation to the end, see anim_start
+ */
+void
+anim_play(unsigned char id, const unsigned char* old_rows, const unsigned char* new_rows)
+{
+  anim_start(id, old_rows, new_rows);
+  while (anim_step())
+  {
+    while(!display_due()) IDLE_WAIT();
+  }
+}
+
+/* anim_report
+ * prints the flash each animation takes, and the CPU time per frame.
+ * The host simulation leaves the CPU time out, as it is always 0 there
+ */
+void
+anim_report(void)
+{
+  unsigned char i;
+  unsigned long bytes=0;
+
+  printf("anim:");
+  for (i=0; i<ANIM_COUNT; i++)
+  {
+    printf(" %s %u frames %u bytes%s", anim_list[i].name, (unsigned)anim_list[i].frames,
+           (unsigned)anim_list[i].bytes, (i<ANIM_COUNT-1) ? "," : "\n");
+    bytes+=anim_list[i].bytes;
+  }
+  printf("anim: %lu bytes of flash in all, %lu played, %lu cut short, %lu frames",
+         bytes, (unsigned long)anim_stats.started, (unsigned long)anim_stats.cut_short,
+         (unsigned long)anim_stats.frames);
+#ifndef SIM_HOST // the host simulation's code takes no time (see host/include/DAVE.h)
+  printf(" in %lu cycles (%lu a frame, worst %lu)",
+         (unsigned long)anim_stats.cycles,
+         (unsigned long)(anim_stats.frames ? anim_stats.cycles/anim_stats.frames : 0),
+         (unsigned long)anim_stats.worst);
+#endif
+  printf("\n");
+}
@@ -0,0 +1,91 @@
+/***********************************************************
+ * anim.h
+ * Plays the animations drawn in anim.txt: a frame at a time,
+ * in the background, while the game gets on with other things.
+ *
+ * host/mkanim turns anim.txt into anim_data.h (cd host; make
+ * anim). Each animation is a list of frames, kept in flash as
+ * bytes:
+ *   duration  frame periods (DISPLAY_FRAME_MS) to show it for.
+ *             0 ends the animation
+ *   op        the mode in the top 4 bits, the coding in the
+ *             bottom 4
+ *   payload   the changes to the canvas, see the codings
+ * The canvas is 8 lines of 8 pixels (the leftmost in bit 7, line
+ * 0 the bottom), and each frame is coded against the one before
+ * it, whichever way is smallest:
+ *  - ANIM_SAME:  unchanged, no payload
+ *  - ANIM_DELTA: a byte with bit n set for each line n that
+ *                changes, then the new lines, from line 0 up
+ *  - ANIM_RLE:   (count, line) pairs, from line 0 up, for all 8
+ * The mode says how the canvas goes on the board:
+ *  - ANIM_SHOW: on its own, on panel 0
+ *  - ANIM_NEW:  over the board after the move (see anim_start)
+ *  - ANIM_OLD:  over the board before it
+ *  - ANIM_WIPE: the board after the move, with the sticks it
+ *               took still showing on the lines of each panel
+ *               where the canvas has any pixel lit
+ *
+ * anim_start() sets one up and anim_step() shows the next frame,
+ * then sets display_update_timer for when the one after is due
+ * (see display_due in main.c), the same as scroll_step. Frames
+ * at the start that leave the board as it was are passed over,
+ * so the move shows straight away. So an
+ * animation plays out from a wait loop, and a button press can
+ * cut it short (anim_stop). anim_play() plays one to the end.
+ *
+ * The flash each animation takes, and the CPU time to decode
+ * and draw a frame, are in anim_report().
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef ANIM_H_
+#define ANIM_H_
+
+#include <stdint.h>
+
+/*************** definitions *****************/
+#define ANIM_LINES 8 // of the canvas
+
+// op, mode
+#define ANIM_SHOW 0x00
+#define ANIM_NEW 0x10
+#define ANIM_OLD 0x20
+#define ANIM_WIPE 0x30
+#define ANIM_MODE_MASK 0xf0
+// op, coding
+#define ANIM_SAME 0x00
+#define ANIM_DELTA 0x01
+#define ANIM_RLE 0x02
+#define ANIM_CODING_MASK 0x0f
+
+/*************** types ***********************/
+typedef struct
+{
+  const uint8_t* data;
+  uint16_t bytes;      // of flash, with the end byte
+  uint8_t frames;
+  const char* name;
+} anim_t;
+
+typedef struct
+{
+  uint32_t started;
+  uint32_t cut_short;  // by anim_stop
+  uint32_t frames;
+  uint32_t cycles;     // decoding and drawing the frames
+  uint32_t worst;      // cycles for one frame
+} anim_stats_t;
+
+extern unsigned char anim_active;
+extern anim_stats_t anim_stats;
+
+/******** function prototypes ***********/
+void anim_start(unsigned char id, const unsigned char* old_rows, const unsigned char* new_rows);
+unsigned char anim_step(void);
+void anim_stop(void);
+void anim_play(unsigned char id, const unsigned char* old_rows, const unsigned char* new_rows);
+void anim_report(void);
+
+#endif /* ANIM_H_ */
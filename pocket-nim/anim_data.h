@@ -0,0 +1,68 @@
+/***********************************************************
+ * anim_data.h
+ * Made by host/mkanim from anim.txt. Don't edit it,
+ * edit that and run mkanim again (cd host; make anim).
+ * See anim.h for the format. The tables are only for
+ * anim.c, which defines ANIM_TABLES.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef ANIM_DATA_H_
+#define ANIM_DATA_H_
+
+#include "anim.h"
+
+#define ANIM_MOVE 0
+#define ANIM_WIN 1
+#define ANIM_LEVEL1 2
+#define ANIM_LEVEL2 3
+#define ANIM_LEVEL3 4
+#define ANIM_LEVEL4 5
+#define ANIM_LEVEL5 6
+#define ANIM_COUNT 7
+
+#ifdef ANIM_TABLES
+static const uint8_t anim_move_data[43]={
+  0x03, 0x32, 0x08, 0xff, 0x03, 0x31, 0x80, 0x00, 0x03, 0x31, 0x40, 0x00,
+  0x03, 0x31, 0x20, 0x00, 0x03, 0x31, 0x10, 0x00, 0x03, 0x31, 0x08, 0x00,
+  0x03, 0x31, 0x04, 0x00, 0x03, 0x31, 0x02, 0x00, 0x14, 0x11, 0x01, 0x00,
+  0x14, 0x20, 0x14, 0x10, 0x14, 0x20, 0x00,
+};
+static const uint8_t anim_win_data[95]={
+  0x04, 0x01, 0x01, 0x10, 0x04, 0x01, 0x02, 0x10, 0x04, 0x01, 0x05, 0x00,
+  0x10, 0x04, 0x01, 0x0a, 0x00, 0x10, 0x04, 0x01, 0x14, 0x00, 0x10, 0x06,
+  0x01, 0x30, 0x38, 0x10, 0x06, 0x01, 0x7c, 0x44, 0x28, 0x00, 0x28, 0x44,
+  0x06, 0x01, 0xfe, 0x92, 0x00, 0x00, 0x82, 0x00, 0x00, 0x92, 0x08, 0x01,
+  0xdb, 0x10, 0x00, 0x82, 0x10, 0x82, 0x00, 0x08, 0x01, 0x7d, 0x00, 0x82,
+  0x00, 0x00, 0x82, 0x00, 0x08, 0x02, 0x08, 0x00, 0x3c, 0x01, 0xff, 0x7e,
+  0x18, 0x18, 0x3c, 0x7e, 0xbd, 0xbd, 0x7e, 0x0a, 0x02, 0x08, 0x00, 0x3c,
+  0x01, 0xff, 0x7e, 0x18, 0x18, 0x3c, 0x7e, 0xbd, 0xbd, 0x7e, 0x00,
+};
+static const uint8_t anim_level1_data[10]={
+  0x50, 0x01, 0x7d, 0x80, 0xee, 0x84, 0x84, 0x8c, 0x84, 0x00,
+};
+static const uint8_t anim_level2_data[10]={
+  0x50, 0x01, 0x7d, 0xc0, 0xee, 0x88, 0x84, 0x82, 0x8c, 0x00,
+};
+static const uint8_t anim_level3_data[10]={
+  0x50, 0x01, 0x7d, 0xe0, 0xec, 0x82, 0x84, 0x82, 0x8c, 0x00,
+};
+static const uint8_t anim_level4_data[10]={
+  0x50, 0x01, 0x7d, 0xf0, 0xe2, 0x82, 0x8e, 0x8a, 0x8a, 0x00,
+};
+static const uint8_t anim_level5_data[10]={
+  0x50, 0x01, 0x7d, 0xf8, 0xec, 0x82, 0x8c, 0x88, 0x8e, 0x00,
+};
+static const anim_t anim_list[ANIM_COUNT]={
+  {anim_move_data, 43, 12, "move"},
+  {anim_win_data, 95, 14, "win"},
+  {anim_level1_data, 10, 1, "level1"},
+  {anim_level2_data, 10, 1, "level2"},
+  {anim_level3_data, 10, 1, "level3"},
+  {anim_level4_data, 10, 1, "level4"},
+  {anim_level5_data, 10, 1, "level5"},
+};
+#endif /* ANIM_TABLES */
+
+#endif /* ANIM_DATA_H_ */
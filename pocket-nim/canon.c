@@ -0,0 +1,120 @@
+/***********************************************************
+ * canon.c
+ * Ranks a position up to the order of its rows, and back.
+ * See canon.h.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdint.h>
+#include "canon.h"
+
+/*************** definitions *****************/
+// C(n, j) as the product of j numbers down from n, over j!. For n
+// below j one of them is 0
+#define B1(n) (n)
+#define B2(n) ((n)*((n)-1)/2)
+#define B3(n) ((n)*((n)-1)*((n)-2)/6)
+#define B4(n) ((n)*((n)-1)*((n)-2)*((n)-3)/24)
+#define B5(n) ((n)*((n)-1)*((n)-2)*((n)-3)*((n)-4)/120)
+#define B6(n) ((n)*((n)-1)*((n)-2)*((n)-3)*((n)-4)*((n)-5)/720)
+#define B7(n) ((n)*((n)-1)*((n)-2)*((n)-3)*((n)-4)*((n)-5)*((n)-6)/5040)
+#define B8(n) ((n)*((n)-1)*((n)-2)*((n)-3)*((n)-4)*((n)-5)*((n)-6)*((n)-7)/40320)
+#define COLUMN(B) { \
+  B(0ULL), B(1ULL), B(2ULL), B(3ULL), B(4ULL), B(5ULL), B(6ULL), B(7ULL), \
+  B(8ULL), B(9ULL), B(10ULL), B(11ULL), B(12ULL), B(13ULL), B(14ULL), B(15ULL), \
+  B(16ULL), B(17ULL), B(18ULL), B(19ULL), B(20ULL), B(21ULL), B(22ULL), B(23ULL), \
+  B(24ULL), B(25ULL), B(26ULL), B(27ULL), B(28ULL), B(29ULL), B(30ULL), B(31ULL) }
+
+/******** global variables **************/
+// binom[j][n] is C(n, j+1). The largest, C(31, 8), is below 2^31,
+// which canon_unrank() relies on
+const uint32_t canon_binom[CANON_MAX_ROWS][CANON_SPAN]=
+{
+  COLUMN(B1), COLUMN(B2), COLUMN(B3), COLUMN(B4), COLUMN(B5),
+#if CANON_MAX_ROWS>5
+  COLUMN(B6),
+#endif
+#if CANON_MAX_ROWS>6
+  COLUMN(B7),
+#endif
+#if CANON_MAX_ROWS>7
+  COLUMN(B8),
+#endif
+};
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* canon_count
+ * the number of positions of rows rows of up to max sticks, which is
+ * one more than the highest rank
+ */
+uint32_t
+canon_count(unsigned char rows, unsigned char max)
+{
+  if (rows==0)
+    return(1);
+  return(canon_binom[rows-1][rows+max]);
+}
+
+/* canon_rank
+ * the rank of the rows, whatever their order. Each must be short
+ * enough for CANON_FITS
+ */
+uint32_t
+canon_rank(const unsigned char* sticks, unsigned char rows)
+{
+  int32_t s[CANON_MAX_ROWS], d;
+  uint32_t rank=0;
+  unsigned char i, j;
+
+  for (i=0; i<rows; i++)
+  {
+    s[i]=sticks[i];
+  }
+  // rows passes of exchanges between neighbours, odd and even pairs
+  // in turn, which sorts any order
+  for (i=0; i<rows; i++)
+  {
+    for (j=i & 1; j+1<rows; j+=2)
+    {
+      d=s[j+1]-s[j];
+      d&=d>>31; // the difference if they are the wrong way round, or 0
+      s[j]+=d;
+      s[j+1]-=d;
+    }
+  }
+  for (i=0; i<rows; i++)
+  {
+    rank+=canon_binom[i][s[i]+i];
+  }
+  return(rank);
+}
+
+/* canon_unrank
+ * the rows with the given rank, into sticks, shortest first
+ */
+void
+canon_unrank(uint32_t rank, unsigned char rows, unsigned char* sticks)
+{
+  const uint32_t* col;
+  uint32_t c, step, le;
+  int i;
+
+  for (i=rows-1; i>=0; i--)
+  {
+    col=canon_binom[i];
+    c=0;
+    for (step=CANON_SPAN/2; step>0; step>>=1)
+    {
+      // 1 if col[c+step] is not above the rank: the subtraction only
+      // borrows, setting the top bit, if it is
+      le=1-((rank-col[c+step])>>31);
+      c|=step & (0-le);
+    }
+    rank-=col[c];
+    sticks[i]=(unsigned char)(c-(uint32_t)i);
+  }
+}
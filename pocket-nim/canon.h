@@ -0,0 +1,47 @@
+/***********************************************************
+ * canon.h
+ * A position's rank among all the positions that are the same
+ * up to the order of the rows.
+ *
+ * Swapping two rows makes no difference to the game, but
+ * numsticks[] holds them in order, so anything keyed on it holds up
+ * to rows! copies of the same position. canon_rank() sorts the rows,
+ * shortest first, and ranks them with the combinatorial number
+ * system: with c_i = h_i+i, which are all different,
+ *   rank = C(c_0, 1) + C(c_1, 2) + .. + C(c_(r-1), r)
+ * which numbers the C(m+r, r) ways of r rows of up to m sticks
+ * from 0 with no gaps. canon_unrank() goes back: c_(r-1) is the
+ * largest c with C(c, r) not above the rank, and so on down.
+ *
+ * Both are branch-light, to take the same time whatever the rows:
+ * the sort is an odd-even transposition network whose exchanges are
+ * done with a sign mask, not a compare and branch, and the unrank
+ * is a binary search of a fixed 5 steps, each adding in its step
+ * with a mask made from the borrow of a subtraction.
+ *
+ * C(n, j) comes from a table in flash, n up to CANON_SPAN-1, so
+ * rows+max must be below CANON_SPAN (CANON_FITS).
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef CANON_H_
+#define CANON_H_
+
+#include <stdint.h>
+
+/*************** definitions *****************/
+// rows ranked at most. The host tools build with 8
+#ifndef CANON_MAX_ROWS
+#define CANON_MAX_ROWS 5
+#endif
+#define CANON_SPAN 32
+
+#define CANON_FITS(rows, max) (((rows)<=CANON_MAX_ROWS) && ((rows)+(max)<CANON_SPAN))
+
+/******** function prototypes ***********/
+uint32_t canon_count(unsigned char rows, unsigned char max);
+uint32_t canon_rank(const unsigned char* sticks, unsigned char rows);
+void canon_unrank(uint32_t rank, unsigned char rows, unsigned char* sticks);
+
+#endif /* CANON_H_ */
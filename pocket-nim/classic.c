@@ -0,0 +1,200 @@
+/***********************************************************
+ * classic.c
+ * The computer's move at Nim, taking from one row a turn, as the
+ * firmware has always played it. See classic.h.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include "nim.h"
+#include "classic.h"
+
+// the firmware's traces (xmc_common.h), which no build turns on
+#ifndef XMC_DEBUG
+#define XMC_DEBUG(...)
+#endif
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* count_ones
+ * this function counts up how many binary digits are 1
+ */
+unsigned char
+count_ones(unsigned char value)
+{
+  char i;
+  char sum=0;
+
+  for (i=0; i<8; i++)
+  {
+    if ((value & (1<<i)) != 0)
+      sum++;
+  }
+  return(sum);
+}
+
+/* classic_choose
+ * This function is the computer's algorithm, to try to beat the user.
+ * It works out a move for the position in sticks, of rows rows,
+ * without making it: the move is to leave *move_left sticks in row
+ * *move_row. If there is no stick left to take, *move_row is set to
+ * NO_MOVE.
+ */
+void
+classic_choose(const unsigned char* sticks, unsigned char rows, unsigned char* move_row, unsigned char* move_left)
+{
+  unsigned char x=sticks[0]; // x is the variable X in the Wikipedia article for Nim
+  unsigned char interim_xor[MAXROWS]; // this array holds "the nim-sum of X and heap-size" for each row (see Wikipedia article for Nim)
+  unsigned char playable_rows_bitmap=0;
+  unsigned char num_playable_rows=0;
+  unsigned char candidate[MAXROWS]; // this array holds an idea for the the number of sticks to leave remaining in a row.
+  unsigned char quality[MAXROWS]; // a quality value (higher is better) for how good the candidate idea is
+  unsigned char peak_quality=0;
+  unsigned char peak_candidate=0;
+  unsigned char unitychecknotneeded=0; // we need to check how many rows have only one stick remaining, as part of the algorithm. This variable helps with the algorithm.
+
+  int i;
+  char j, temp;
+  char unityheaps=0;
+
+  *move_row=NO_MOVE;
+
+  for (i=0; i<MAXROWS; i++)
+  {
+    quality[i]=0; // initialize the quality array
+  }
+
+  // find the best possible move, using the sum of
+  // powers of two method, which is basically a
+  // lot of XORing
+  for (i=1; i<rows; i++)
+  {
+    x=x^sticks[i];
+  }
+  XMC_DEBUG("x=%d\n", x);
+  if (x>0)
+  {
+    for (i=0; i<rows; i++)
+    {
+      interim_xor[i]=x^sticks[i];
+      if (interim_xor[i]<sticks[i])
+      {
+        playable_rows_bitmap |= 1<<i;
+      }
+    }
+    XMC_DEBUG("interim_xor are %d, %d, %d, %d\n", interim_xor[0], interim_xor[1], interim_xor[2], interim_xor[3]);
+    num_playable_rows=count_ones(playable_rows_bitmap);
+    XMC_DEBUG("num_playable_rows=%d\n", num_playable_rows);
+    if (num_playable_rows>=1)
+    {
+      // overall strategy: find some possible moves, and give them a weight
+      // and then we'll pick the best of the lot.
+      for (i=rows-1; i>=0; i--)
+      {
+        if ((playable_rows_bitmap & (1<<i)) != 0) // i is a playable row
+        {
+          unitychecknotneeded=0;
+          XMC_DEBUG("testing candidate %d\n", i);
+          temp=interim_xor[i]; // reduce size of heap to XOR of its original size with x
+          // if we make the temp move real, will it leave only heaps with size 1?
+
+          if (temp==1)
+            unityheaps++;
+          for (j=0; j<rows; j++)
+          {
+            if (j!=i)
+            {
+              if (sticks[(unsigned char)j]==1)
+              {
+                unityheaps++;
+              }
+              else if (sticks[(unsigned char)j]>1)
+              {
+                unitychecknotneeded=1;
+              }
+            }
+          }
+          if ((temp<=1) && (unitychecknotneeded==0))
+          {
+            // is unityheaps odd? We want that..
+            if ((unityheaps & 1) != 0)
+            {
+              // make the move permanent
+              candidate[i]=temp;
+              quality[i]+=10;
+            } // unityheaps would be even with that move. so take different action.
+            else if (temp==1)
+            {
+              // we can reduce to zero.
+              candidate[i]=0;
+              quality[i]+=5; // this move should be good too
+            }
+            else
+            {
+              if (temp==0)
+              {
+                if (sticks[i]>1)
+                {
+                  // we can leave one stick, to make it odd again
+                  candidate[i]=1;
+                  quality[i]+=9; // this move should be good
+                }
+              }
+              else
+              {
+                // this won't be a nice move to make. But it is a valid move.
+                candidate[i]=temp;
+                quality[i]+=1;
+              }
+            }
+          }
+          else
+          {
+            // this action won't result in all heaps containing 1
+            // it could be a good move.
+            candidate[i]=temp;
+            quality[i]+=9;
+
+          }
+          XMC_DEBUG("candidate %d quality is %d\n", i, quality[i]);
+
+        } // end of if ((playable_rows_bitmap & 1<<i) != 0)
+        // loop to get another candidate
+      } // end of for (i=rows-1; i>=0; i--)
+      // ok we have at least one playable move. Find the highest quality move.
+      XMC_DEBUG("quality table: %d %d %d %d\n", quality[0], quality[1], quality[2], quality[3]);
+      XMC_DEBUG("finding highest quality move\n");
+      for (i=0; i<rows; i++)
+      {
+        if (quality[i]>=peak_quality)
+        {
+          peak_quality=quality[i];
+          peak_candidate=i;
+          XMC_DEBUG("best so far is candidate %d\n", i);
+        }
+      }
+      // none of the candidates may have panned out (e.g. with only rows
+      // of one stick left), and then candidate[] holds nothing
+      if (peak_quality>0)
+      {
+        *move_row=peak_candidate;
+        *move_left=candidate[peak_candidate];
+      }
+    } // end of if (num_playable_rows>=1)
+  } // end of if (x>0)
+  if (*move_row==NO_MOVE)
+  {
+    // no strategy any more. play any row we can..
+    for (i=0; i<rows; i++)
+    {
+      if (sticks[i]>0)
+      {
+        *move_row=i;
+        *move_left=sticks[i]-1;
+        i=rows;
+      }
+    }
+  }
+}
@@ -0,0 +1,25 @@
+/***********************************************************
+ * classic.h
+ * The computer's move at classic Nim (one row a turn, and taking
+ * the last stick loses), by weighing up a candidate move for each
+ * row that the nim-sum says can be played, with care at the end
+ * when only rows of one stick are left. It finds a winning move
+ * whenever there is one; from a lost position it takes a stick from
+ * the first row that has any.
+ *
+ * computer_choose() in main.c plays it below DISTANCE_LEVEL, or
+ * where the distance table doesn't fit. It is kept apart from main.c
+ * so that the host tools (mkmistake, nimserver) play the very same
+ * moves.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef CLASSIC_H_
+#define CLASSIC_H_
+
+/******** function prototypes ***********/
+unsigned char count_ones(unsigned char value);
+void classic_choose(const unsigned char* sticks, unsigned char rows, unsigned char* move_row, unsigned char* move_left);
+
+#endif /* CLASSIC_H_ */
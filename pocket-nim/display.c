@@ -0,0 +1,170 @@
+/***********************************************************
+ * display.c
+ * The LED matrix display: one or more HT16K33s on i2c_bus,
+ * treated as one larger framebuffer.
+ * See display.h for the layout and how frames are sent.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <DAVE.h>
+#include <stdio.h>
+#include <string.h>
+#include "nim.h"
+#include "profile.h"
+#include "latency.h"
+#include "i2cq.h"
+#include "display.h"
+
+/*************** definitions *****************/
+#define PANEL_BYTES 16
+// byte i of panel p's RAM, from an array of lines
+#define PANEL_BYTE(ram, p, i) ((uint8_t)(((i) & 1) ? ((ram)[(p)*8+(i)/2]>>8) : ((ram)[(p)*8+(i)/2] & 0xff)))
+
+/****** const variables *****************/
+const uint8_t display_init_data[3]={0x21, 0x81, 0xef}; // system osc. on, display on, max brightness
+
+/******** global variables **************/
+uint16_t display_ram[DISPLAY_LINES];
+display_stats_t display_stats;
+
+uint16_t display_sent[DISPLAY_LINES]; // what display_write last queued
+uint32_t display_failed;              // i2cq_stats.failed, as last seen
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* display_init
+ * initializes the display chips. With several panels there are more
+ * commands than the queue holds, so it waits for room.
+ */
+void
+display_init(void)
+{
+  unsigned char i, p;
+  for (p=0; p<DISPLAY_PANELS; p++)
+  {
+    for (i=0; i<3; i++)
+    {
+      while (!i2cq_write(DISPLAY_ADDRESS(p), &display_init_data[i], 1, 0)) IDLE_WAIT();
+    }
+  }
+  // the chips' RAM isn't cleared at power up, so the first frame sends all of it
+  display_failed=i2cq_stats.failed-1;
+}
+
+/* display_write
+ * sends the display ram data to the display. Each panel that has
+ * changed is queued (see i2cq.h) as one transfer, of the bytes from
+ * the first that changed to the last, and they go out on the bus in
+ * the background. Not for use from an interrupt.
+ */
+void
+display_write(void)
+{
+  uint8_t frame[I2CQ_MAX_BYTES];
+  uint8_t p, i, first, last;
+  unsigned char refresh, whole;
+  unsigned char queued=0;
+
+  PROF_ENTER(display_write);
+  display_stats.frames++;
+  // a transfer that failed has left a panel showing something else,
+  // so send all of every panel again
+  refresh=(i2cq_stats.failed!=display_failed);
+  if (refresh)
+  {
+    display_failed=i2cq_stats.failed;
+    display_stats.refreshes++;
+  }
+  // a frame still waiting is replaced by this one (see i2cq.h), so
+  // what it would have sent has to be sent here too
+  whole=refresh || i2cq_frame_pending();
+  for (p=0; p<DISPLAY_PANELS; p++)
+  {
+    first=PANEL_BYTES;
+    last=0;
+    for (i=0; i<PANEL_BYTES; i++)
+    {
+      if (refresh || (PANEL_BYTE(display_ram, p, i)!=PANEL_BYTE(display_sent, p, i)))
+      {
+        if (first==PANEL_BYTES)
+          first=i;
+        last=i;
+      }
+    }
+    if (first==PANEL_BYTES)
+      continue; // this panel hasn't changed
+    if (whole)
+    {
+      first=0;
+      last=PANEL_BYTES-1;
+    }
+    frame[0]=first; // display address pointer
+    for (i=first; i<=last; i++)
+    {
+      frame[1+i-first]=PANEL_BYTE(display_ram, p, i);
+    }
+    // the queue only fills up with commands queued ahead (display_init),
+    // and they are done or given up on within their deadlines
+    while (!i2cq_write(DISPLAY_ADDRESS(p), frame, (uint8_t)(last-first+2), I2CQ_FRAME)) IDLE_WAIT();
+    memcpy(&display_sent[p*8], &display_ram[p*8], 8*sizeof(display_ram[0]));
+    display_stats.transfers++;
+    display_stats.bytes+=last-first+1;
+    queued=1;
+  }
+  if ((!queued) && (!i2cq_frame_pending()))
+  {
+    display_stats.unchanged++;
+    latency_frame_shown(0); // it is already showing
+  }
+  PROF_LEAVE(display_write);
+}
+
+/************* display ram related functions ***********/
+
+// these functions make modifications to the local ram representation
+// of the display. Nothing is actually updated on the display, until
+// display_write is called.
+
+/* display_ram_blank
+ * sets the display ram to all blank.
+ * Doesn't update to the display, call display_write to do that.
+ */
+void
+display_ram_blank(void)
+{
+  unsigned char i;
+  for (i=0; i<DISPLAY_LINES; i++)
+  {
+    display_ram[i]=0;
+  }
+}
+
+/* plot_ram_pixel
+ * sets pixel (x, y) of the board in the display ram, x from the left
+ * and y from the bottom. Pixels off the board are ignored.
+ * Doesn't update the display, call display_write to do that.
+ */
+void
+plot_ram_pixel(int x, int y)
+{
+  if ((x<0) || (x>=DISPLAY_WIDTH) || (y<0) || (y>=DISPLAY_HEIGHT))
+    return;
+  display_ram[DISPLAY_LINE(x, y)] |= (uint16_t)(1U<<DISPLAY_BIT(x)); // place the pixel into the local display ram
+}
+
+/* display_report
+ * prints the display traffic
+ */
+void
+display_report(void)
+{
+  printf("display: %u panel(s) of %ux8, %lu frames, %lu unchanged, %lu panel writes, %lu bytes (%lu if sent whole), %lu full refreshes\n",
+         (unsigned)DISPLAY_PANELS, (unsigned)DISPLAY_PANEL_COLS,
+         (unsigned long)display_stats.frames, (unsigned long)display_stats.unchanged,
+         (unsigned long)display_stats.transfers, (unsigned long)display_stats.bytes,
+         (unsigned long)(display_stats.frames*DISPLAY_PANELS*PANEL_BYTES),
+         (unsigned long)display_stats.refreshes);
+}
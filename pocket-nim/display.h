@@ -0,0 +1,104 @@
+/***********************************************************
+ * display.h
+ * The LED matrix display: one or more HT16K33s on i2c_bus,
+ * treated as one larger framebuffer.
+ *
+ * Each HT16K33 drives a panel of DISPLAY_PANEL_COLS x 8 LEDs.
+ * Its RAM is 16x8 bits: a 16 bit line for each COM (0-7, the
+ * panel's rows, bottom to top), a bit for each ROW pin (the
+ * panel's columns). The panels supported are:
+ *  - 8:  the 8x8 module. Only ROW0-7 are used, and they are
+ *        wired with an odd rotation, see DISPLAY_BIT
+ *  - 16: a 16x8 module. ROW15 is the leftmost column, and
+ *        ROW0 the rightmost
+ * The panels are laid out in a grid, DISPLAY_PANELS_X wide by
+ * DISPLAY_PANELS_Y high. Panel 0 is at the bottom left, and
+ * the numbers go left to right, then up. Panel p has its
+ * address jumpers (A0-A2) set to p, so it is at DISPLAY_ADDRESS(p).
+ *
+ * display_ram holds the RAM of each panel in turn, 8 lines per
+ * panel. display_write() compares it with what was last sent, and
+ * only queues (see i2cq.h) the panels that have changed, each as a
+ * single transfer of the bytes from the first that changed to the
+ * last. The transfers for a frame are queued together and go out
+ * back to back, so a move that changes one row of sticks costs a
+ * few bytes on the bus however large the board is.
+ *
+ * The game is drawn with row n of sticks in column 2n, the first
+ * stick at the bottom. A single 8x8 panel shows 4 rows of up to
+ * 8 sticks; a board 9 or more columns wide shows the 5 rows of
+ * level 5, and one 9 or more high shows a row of 9. Text scrolls
+ * across panel 0.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef DISPLAY_H_
+#define DISPLAY_H_
+
+#include <stdint.h>
+
+/*************** definitions *****************/
+// # the board, see above. The default is the single 8x8 module
+#ifndef DISPLAY_PANEL_COLS
+#define DISPLAY_PANEL_COLS 8
+#endif
+#ifndef DISPLAY_PANELS_X
+#define DISPLAY_PANELS_X 1
+#endif
+#ifndef DISPLAY_PANELS_Y
+#define DISPLAY_PANELS_Y 1
+#endif
+
+#define DISPLAY_PANELS (DISPLAY_PANELS_X*DISPLAY_PANELS_Y)
+#define DISPLAY_WIDTH (DISPLAY_PANEL_COLS*DISPLAY_PANELS_X)
+#define DISPLAY_HEIGHT (8*DISPLAY_PANELS_Y)
+#define DISPLAY_LINES (8*DISPLAY_PANELS)
+#define DISPLAY_ADDRESS(p) (0xe0+2*(p)) // 8 bit form
+
+// # animations are paced in frames of DISPLAY_FRAME_MS. A frame period
+// only ends once the frame has gone out on the bus (see display_due
+// in main.c)
+#ifndef DISPLAY_FRAME_MS
+#define DISPLAY_FRAME_MS 10
+#endif
+
+// where pixel (x, y) of the board is in display_ram
+#define DISPLAY_PANEL(x, y) (((y)/8)*DISPLAY_PANELS_X+(x)/DISPLAY_PANEL_COLS)
+#define DISPLAY_LINE(x, y) (DISPLAY_PANEL(x, y)*8+(y)%8)
+#if DISPLAY_PANEL_COLS==8
+#define DISPLAY_BIT(x) ((8-((x)%8)-1+7)%8) // the 8x8 module's mapping
+// a line of panel 0 from a byte of 8 pixels, the leftmost in bit 7
+#define DISPLAY_BYTE_LINE(b) ((uint16_t)((((b)>>1) | ((b)<<7)) & 0xff))
+#elif DISPLAY_PANEL_COLS==16
+#define DISPLAY_BIT(x) (15-((x)%16))
+#define DISPLAY_BYTE_LINE(b) ((uint16_t)((b)<<8))
+#else
+#error "DISPLAY_PANEL_COLS must be 8 or 16"
+#endif
+
+#if DISPLAY_PANELS>8
+#error "the HT16K33 has 8 addresses"
+#endif
+
+/*************** types ***********************/
+typedef struct
+{
+  uint32_t frames;       // display_write calls
+  uint32_t unchanged;    // ..that had nothing to send
+  uint32_t transfers;    // panel writes queued
+  uint32_t bytes;        // display RAM bytes in them
+  uint32_t refreshes;    // full rewrites: the first frame, and after a transfer failed
+} display_stats_t;
+
+extern uint16_t display_ram[DISPLAY_LINES];
+extern display_stats_t display_stats;
+
+/******** function prototypes ***********/
+void display_init(void);
+void display_write(void);
+void display_ram_blank(void);
+void plot_ram_pixel(int x, int y);
+void display_report(void);
+
+#endif /* DISPLAY_H_ */
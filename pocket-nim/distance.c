@@ -0,0 +1,113 @@
+/***********************************************************
+ * distance.c
+ * Nim from the distance to the end of the game, looked up in
+ * distance_data.h. See distance.h for how it works.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdint.h>
+#include "nim.h"
+#include "canon.h"
+#include "distance.h"
+#define DISTANCE_TABLES
+#include "distance_data.h"
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* lookup
+ * the distance of a position of DISTANCE_ROWS rows
+ */
+static unsigned char
+lookup(const unsigned char* pos)
+{
+  return(distance_table[canon_rank(pos, DISTANCE_ROWS)]);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* distance_fits
+ * returns 1 if the table covers the position
+ */
+unsigned char
+distance_fits(const unsigned char* sticks, unsigned char rows)
+{
+  unsigned char i;
+
+  if (rows>DISTANCE_ROWS)
+    return(0);
+  for (i=0; i<rows; i++)
+  {
+    if (sticks[i]>DISTANCE_MAX)
+      return(0);
+  }
+  return(1);
+}
+
+/* distance_to_end
+ * the number of moves left with best play. Even if the player to
+ * move wins
+ */
+unsigned char
+distance_to_end(const unsigned char* sticks, unsigned char rows)
+{
+  unsigned char pos[DISTANCE_ROWS]={0};
+  unsigned char i;
+
+  for (i=0; i<rows; i++)
+  {
+    pos[i]=sticks[i];
+  }
+  return(lookup(pos));
+}
+
+/* distance_choose
+ * works out a move for a position that distance_fits(), as for
+ * computer_choose(): leave *move_left sticks in row *move_row, or
+ * NO_MOVE if there are no sticks. Returns 1 if it is a winning move
+ */
+unsigned char
+distance_choose(const unsigned char* sticks, unsigned char rows, unsigned char* move_row,
+                unsigned char* move_left)
+{
+  unsigned char pos[DISTANCE_ROWS]={0};
+  unsigned char r, was, d, best=0, wins=0;
+
+  *move_row=NO_MOVE;
+  for (r=0; r<rows; r++)
+  {
+    pos[r]=sticks[r];
+  }
+  for (r=0; r<rows; r++)
+  {
+    was=pos[r];
+    for (pos[r]=0; pos[r]<was; pos[r]++)
+    {
+      d=lookup(pos);
+      if (d & 1)
+      {
+        // lost for the user: the nearest the end
+        if (!wins || (d<best))
+        {
+          wins=1;
+          best=d;
+          *move_row=r;
+          *move_left=pos[r];
+        }
+      }
+      else if (!wins && ((*move_row==NO_MOVE) || (d>best)))
+      {
+        // won for the user: the furthest from the end
+        best=d;
+        *move_row=r;
+        *move_left=pos[r];
+      }
+    }
+    pos[r]=was;
+  }
+  return(wins);
+}
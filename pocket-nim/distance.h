@@ -0,0 +1,39 @@
+/***********************************************************
+ * distance.h
+ * Nim from a table of the number of moves left with best play,
+ * so that the computer wins as quickly as it can, and when it
+ * can't win, makes the game last as long as it can.
+ *
+ * Any move to a lost position wins, and computer_choose() takes
+ * whichever of them it rates last, so a game it has won can drag on,
+ * and one it has lost ends as soon as the user likes. The table has
+ * the distance to the end of the game of every position up to
+ * DISTANCE_ROWS rows of DISTANCE_MAX sticks, the winner taking the
+ * quickest way to win and the loser the slowest way to lose. It is
+ * worked out by host/mkdistance with the retrograde solver (see
+ * host/retro.h), into distance_data.h.
+ *
+ * A byte per position, indexed by its rank up to the order of the
+ * rows (see canon.h), so it takes C(max+rows, rows) bytes rather
+ * than (max+1)^rows. Fewer rows are looked up with the rest at 0.
+ * As the last stick loses, a position with no sticks is won, at 0,
+ * and so a position is won just when its distance is even.
+ *
+ * distance_choose() tries every move and keeps the one to a lost
+ * position nearest the end, or else to the won position furthest
+ * from it. From level DISTANCE_LEVEL up (see nim.h),
+ * computer_choose() plays from it when the position fits.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef DISTANCE_H_
+#define DISTANCE_H_
+
+/******** function prototypes ***********/
+unsigned char distance_fits(const unsigned char* sticks, unsigned char rows);
+unsigned char distance_to_end(const unsigned char* sticks, unsigned char rows);
+unsigned char distance_choose(const unsigned char* sticks, unsigned char rows, unsigned char* move_row,
+                              unsigned char* move_left);
+
+#endif /* DISTANCE_H_ */
@@ -0,0 +1,148 @@
+/***********************************************************
+ * distance_data.h
+ * Made by host/mkdistance. Don't edit it, run mkdistance again
+ * (cd host; make distance). See distance.h for what the table
+ * is. It is only for distance.c, which defines DISTANCE_TABLES.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef DISTANCE_DATA_H_
+#define DISTANCE_DATA_H_
+
+#define DISTANCE_ROWS 5
+#define DISTANCE_MAX 9
+#define DISTANCE_POSITIONS 2002
+
+#ifdef DISTANCE_TABLES
+static const uint8_t distance_table[DISTANCE_POSITIONS]={
+   0,  1,  2,  3,  4,  5,  2,  2,  4,  4,  6,  3,  4,  5,  6,  4,
+   6,  6,  7,  8,  8,  2,  2,  4,  4,  6,  4,  5,  6,  7,  4,  6,
+   6,  8,  9,  8,  5,  6,  7,  8,  6,  6,  8,  9, 10, 10,  6,  8,
+   8, 10, 11, 10, 11, 12, 12, 12,  2,  2,  4,  4,  6,  4,  6,  6,
+   8,  4,  6,  6,  8, 10,  8,  6,  6,  8,  8,  6,  6,  8, 10, 10,
+  10,  6,  8,  8, 10, 12, 10, 12, 12, 12, 12,  7,  8,  9, 10,  8,
+  10, 10, 11, 12, 12,  8, 10, 10, 12, 13, 12, 13, 14, 14, 14,  8,
+  10, 10, 12, 14, 12, 14, 14, 14, 14, 15, 16, 16, 16, 16,  2,  2,
+   4,  4,  6,  4,  6,  6,  8,  4,  6,  6,  8, 10,  8,  6,  6,  8,
+   8,  6,  6,  8, 10, 10, 10,  6,  8,  8, 10, 12, 10, 12, 12, 12,
+  12,  8,  9, 10, 11, 10, 10, 12, 12, 13, 14, 10, 10, 12, 13, 14,
+  14, 14, 15, 14, 16,  8, 10, 10, 12, 14, 12, 14, 14, 14, 14, 16,
+  17, 18, 18, 16,  9, 10, 11, 12, 10, 12, 12, 13, 14, 14, 10, 12,
+  12, 14, 15, 14, 15, 16, 16, 16, 10, 10, 12, 14, 14, 14, 14, 16,
+  14, 16, 17, 18, 18, 18, 18, 10, 12, 12, 14, 16, 14, 16, 16, 16,
+  16, 18, 19, 20, 20, 18, 19, 20, 20, 20, 20, 20,  2,  2,  4,  4,
+   6,  4,  6,  6,  8,  4,  6,  6,  8, 10,  8,  6,  6,  8,  8,  6,
+   6,  8, 10, 10, 10,  6,  8,  8, 10, 12, 10, 12, 12, 12, 12,  8,
+  10, 10, 12, 11, 12, 13, 12, 14, 15, 12, 13, 14, 12, 14, 16, 14,
+  14, 17, 18,  8, 10, 10, 12, 14, 12, 14, 14, 14, 14, 16, 18, 19,
+  20, 16, 10, 10, 12, 12, 12, 13, 14, 14, 14, 16, 13, 14, 15, 14,
+  14, 17, 14, 16, 18, 19, 10, 10, 12, 12, 14, 14, 14, 14, 14, 16,
+  18, 18, 20, 21, 18, 10, 12, 12, 14, 14, 14, 14, 16, 16, 16, 18,
+  20, 21, 22, 18, 20, 20, 22, 23, 20, 20, 11, 12, 13, 14, 12, 14,
+  14, 15, 16, 16, 12, 14, 14, 16, 17, 16, 17, 18, 18, 18, 12, 14,
+  14, 12, 14, 16, 14, 14, 18, 18, 19, 20, 20, 20, 20, 12, 14, 14,
+  14, 14, 16, 14, 16, 18, 18, 20, 21, 22, 22, 20, 21, 22, 22, 22,
+  22, 22, 12, 14, 14, 16, 18, 16, 18, 18, 18, 18, 20, 22, 23, 24,
+  20, 22, 22, 24, 25, 22, 22, 23, 24, 24, 24, 24, 24, 24,  2,  2,
+   4,  4,  6,  4,  6,  6,  8,  4,  6,  6,  8, 10,  8,  6,  6,  8,
+   8,  6,  6,  8, 10, 10, 10,  6,  8,  8, 10, 12, 10, 12, 12, 12,
+  12,  8, 10, 10, 12, 12, 13, 14, 12, 14, 16, 13, 14, 15, 14, 14,
+  17, 14, 16, 18, 19,  8, 10, 10, 12, 14, 12, 14, 14, 14, 14, 16,
+  18, 20, 21, 16, 10, 10, 12, 12, 13, 14, 15, 14, 14, 17, 14, 15,
+  16, 14, 16, 18, 16, 16, 19, 20, 10, 10, 12, 14, 14, 14, 14, 16,
+  14, 16, 18, 18, 21, 22, 18, 10, 12, 12, 14, 16, 14, 16, 16, 16,
+  16, 18, 20, 22, 23, 18, 20, 20, 23, 24, 20, 20, 12, 13, 14, 15,
+  12, 14, 14, 16, 17, 16, 14, 14, 16, 17, 18, 18, 18, 19, 18, 20,
+  12, 14, 14, 12, 14, 16, 14, 14, 18, 18, 20, 21, 20, 22, 20, 14,
+  14, 16, 14, 14, 18, 14, 16, 18, 20, 21, 22, 22, 22, 22, 22, 23,
+  22, 24, 22, 24, 12, 14, 14, 16, 18, 16, 18, 18, 18, 18, 20, 22,
+  24, 25, 20, 22, 22, 25, 26, 22, 22, 24, 25, 24, 26, 24, 26, 24,
+  13, 14, 15, 16, 14, 14, 16, 17, 18, 18, 14, 16, 16, 18, 19, 18,
+  19, 20, 20, 20, 14, 14, 16, 14, 14, 18, 14, 16, 18, 20, 21, 22,
+  22, 22, 22, 14, 16, 16, 14, 16, 18, 16, 16, 20, 20, 22, 23, 22,
+  24, 22, 23, 24, 24, 24, 24, 24, 14, 14, 16, 18, 18, 18, 18, 20,
+  18, 20, 22, 22, 25, 26, 22, 22, 24, 26, 27, 22, 24, 25, 26, 26,
+  26, 26, 26, 26, 14, 16, 16, 18, 20, 18, 20, 20, 20, 20, 22, 24,
+  26, 27, 22, 24, 24, 27, 28, 24, 24, 26, 27, 26, 28, 26, 28, 26,
+  27, 28, 28, 28, 28, 28, 28, 28,  2,  2,  4,  4,  6,  4,  6,  6,
+   8,  4,  6,  6,  8, 10,  8,  6,  6,  8,  8,  6,  6,  8, 10, 10,
+  10,  6,  8,  8, 10, 12, 10, 12, 12, 12, 12,  8, 10, 10, 12, 12,
+  14, 14, 12, 14, 16, 14, 14, 16, 14, 14, 18, 14, 16, 18, 20,  8,
+  10, 10, 12, 14, 12, 14, 14, 14, 14, 16, 18, 20, 22, 16, 10, 10,
+  12, 12, 14, 14, 16, 14, 14, 18, 14, 16, 16, 14, 16, 18, 16, 16,
+  20, 20, 10, 10, 12, 14, 14, 14, 14, 16, 14, 16, 18, 18, 22, 22,
+  18, 10, 12, 12, 14, 16, 14, 16, 16, 16, 16, 18, 20, 22, 24, 18,
+  20, 20, 24, 24, 20, 20, 12, 14, 14, 16, 12, 14, 14, 16, 18, 16,
+  14, 14, 16, 18, 18, 18, 18, 20, 18, 20, 12, 14, 14, 12, 14, 16,
+  14, 14, 18, 18, 20, 22, 20, 22, 20, 14, 14, 16, 14, 14, 18, 14,
+  16, 18, 20, 22, 22, 22, 22, 22, 22, 24, 22, 24, 22, 24, 12, 14,
+  14, 16, 18, 16, 18, 18, 18, 18, 20, 22, 24, 26, 20, 22, 22, 26,
+  26, 22, 22, 24, 26, 24, 26, 24, 26, 24, 14, 14, 16, 16, 14, 14,
+  16, 18, 18, 18, 14, 16, 16, 18, 20, 18, 20, 20, 20, 20, 14, 14,
+  16, 14, 14, 18, 14, 16, 18, 20, 22, 22, 22, 22, 22, 14, 16, 16,
+  14, 16, 18, 16, 16, 20, 20, 22, 24, 22, 24, 22, 24, 24, 24, 24,
+  24, 24, 14, 14, 16, 18, 18, 18, 18, 20, 18, 20, 22, 22, 26, 26,
+  22, 22, 24, 26, 28, 22, 24, 26, 26, 26, 26, 26, 26, 26, 14, 16,
+  16, 18, 20, 18, 20, 20, 20, 20, 22, 24, 26, 28, 22, 24, 24, 28,
+  28, 24, 24, 26, 28, 26, 28, 26, 28, 26, 28, 28, 28, 28, 28, 28,
+  28, 28, 15, 16, 17, 18, 16, 18, 18, 19, 20, 20, 16, 18, 18, 20,
+  21, 20, 21, 22, 22, 22, 16, 18, 18, 20, 22, 20, 22, 22, 22, 22,
+  23, 24, 24, 24, 24, 16, 18, 18, 20, 22, 20, 22, 22, 22, 22, 24,
+  25, 26, 26, 24, 25, 26, 26, 26, 26, 26, 16, 18, 18, 20, 22, 20,
+  22, 22, 22, 22, 24, 26, 27, 28, 24, 26, 26, 28, 29, 26, 26, 27,
+  28, 28, 28, 28, 28, 28, 16, 18, 18, 20, 22, 20, 22, 22, 22, 22,
+  24, 26, 28, 29, 24, 26, 26, 29, 30, 26, 26, 28, 29, 28, 30, 28,
+  30, 28, 29, 30, 30, 30, 30, 30, 30, 30, 16, 18, 18, 20, 22, 20,
+  22, 22, 22, 22, 24, 26, 28, 30, 24, 26, 26, 30, 30, 26, 26, 28,
+  30, 28, 30, 28, 30, 28, 30, 30, 30, 30, 30, 30, 30, 30, 31, 32,
+  32, 32, 32, 32, 32, 32, 32,  2,  2,  4,  4,  6,  4,  6,  6,  8,
+   4,  6,  6,  8, 10,  8,  6,  6,  8,  8,  6,  6,  8, 10, 10, 10,
+   6,  8,  8, 10, 12, 10, 12, 12, 12, 12,  8, 10, 10, 12, 12, 14,
+  14, 12, 14, 16, 14, 14, 16, 14, 14, 18, 14, 16, 18, 20,  8, 10,
+  10, 12, 14, 12, 14, 14, 14, 14, 16, 18, 20, 22, 16, 10, 10, 12,
+  12, 14, 14, 16, 14, 14, 18, 14, 16, 16, 14, 16, 18, 16, 16, 20,
+  20, 10, 10, 12, 14, 14, 14, 14, 16, 14, 16, 18, 18, 22, 22, 18,
+  10, 12, 12, 14, 16, 14, 16, 16, 16, 16, 18, 20, 22, 24, 18, 20,
+  20, 24, 24, 20, 20, 12, 14, 14, 16, 12, 14, 14, 16, 18, 16, 14,
+  14, 16, 18, 18, 18, 18, 20, 18, 20, 12, 14, 14, 12, 14, 16, 14,
+  14, 18, 18, 20, 22, 20, 22, 20, 14, 14, 16, 14, 14, 18, 14, 16,
+  18, 20, 22, 22, 22, 22, 22, 22, 24, 22, 24, 22, 24, 12, 14, 14,
+  16, 18, 16, 18, 18, 18, 18, 20, 22, 24, 26, 20, 22, 22, 26, 26,
+  22, 22, 24, 26, 24, 26, 24, 26, 24, 14, 14, 16, 16, 14, 14, 16,
+  18, 18, 18, 14, 16, 16, 18, 20, 18, 20, 20, 20, 20, 14, 14, 16,
+  14, 14, 18, 14, 16, 18, 20, 22, 22, 22, 22, 22, 14, 16, 16, 14,
+  16, 18, 16, 16, 20, 20, 22, 24, 22, 24, 22, 24, 24, 24, 24, 24,
+  24, 14, 14, 16, 18, 18, 18, 18, 20, 18, 20, 22, 22, 26, 26, 22,
+  22, 24, 26, 28, 22, 24, 26, 26, 26, 26, 26, 26, 26, 14, 16, 16,
+  18, 20, 18, 20, 20, 20, 20, 22, 24, 26, 28, 22, 24, 24, 28, 28,
+  24, 24, 26, 28, 26, 28, 26, 28, 26, 28, 28, 28, 28, 28, 28, 28,
+  28, 16, 17, 18, 19, 18, 18, 20, 20, 21, 22, 18, 18, 20, 21, 22,
+  22, 22, 23, 22, 24, 18, 18, 20, 22, 22, 22, 22, 24, 22, 24, 24,
+  25, 26, 26, 26, 18, 18, 20, 22, 22, 22, 22, 24, 22, 24, 25, 26,
+  26, 26, 26, 26, 27, 28, 28, 26, 28, 18, 18, 20, 22, 22, 22, 22,
+  24, 22, 24, 26, 26, 28, 29, 26, 26, 28, 29, 30, 26, 28, 28, 29,
+  30, 30, 30, 30, 30, 18, 18, 20, 22, 22, 22, 22, 24, 22, 24, 26,
+  26, 29, 30, 26, 26, 28, 30, 31, 26, 28, 29, 30, 30, 30, 30, 30,
+  30, 30, 31, 30, 32, 30, 32, 30, 32, 16, 18, 18, 20, 22, 20, 22,
+  22, 22, 22, 24, 26, 28, 30, 24, 26, 26, 30, 30, 26, 26, 28, 30,
+  28, 30, 28, 30, 28, 30, 30, 30, 30, 30, 30, 30, 30, 32, 33, 34,
+  34, 34, 34, 34, 34, 32, 17, 18, 19, 20, 18, 20, 20, 21, 22, 22,
+  18, 20, 20, 22, 23, 22, 23, 24, 24, 24, 18, 20, 20, 22, 24, 22,
+  24, 24, 24, 24, 25, 26, 26, 26, 26, 18, 20, 20, 22, 24, 22, 24,
+  24, 24, 24, 26, 27, 28, 28, 26, 27, 28, 28, 28, 28, 28, 18, 20,
+  20, 22, 24, 22, 24, 24, 24, 24, 26, 28, 29, 30, 26, 28, 28, 30,
+  31, 28, 28, 29, 30, 30, 30, 30, 30, 30, 18, 20, 20, 22, 24, 22,
+  24, 24, 24, 24, 26, 28, 30, 31, 26, 28, 28, 31, 32, 28, 28, 30,
+  31, 30, 32, 30, 32, 30, 31, 32, 32, 32, 32, 32, 32, 32, 18, 18,
+  20, 22, 22, 22, 22, 24, 22, 24, 26, 26, 30, 30, 26, 26, 28, 30,
+  32, 26, 28, 30, 30, 30, 30, 30, 30, 30, 30, 32, 30, 32, 30, 32,
+  30, 32, 33, 34, 34, 34, 34, 34, 34, 34, 34, 18, 20, 20, 22, 24,
+  22, 24, 24, 24, 24, 26, 28, 30, 32, 26, 28, 28, 32, 32, 28, 28,
+  30, 32, 30, 32, 30, 32, 30, 32, 32, 32, 32, 32, 32, 32, 32, 34,
+  35, 36, 36, 36, 36, 36, 36, 34, 35, 36, 36, 36, 36, 36, 36, 36,
+  36, 36
+};
+#endif /* DISTANCE_TABLES */
+
+#endif /* DISTANCE_DATA_H_ */
@@ -0,0 +1,58 @@
+/***********************************************************
+ * font.h
+ * The 5x7 font used to scroll messages.
+ *
+ * The glyphs are drawn in font5x7.txt, and host/mkfont packs
+ * them into font_data.h (cd host; make font). Each glyph is
+ * 35 bits in font_bits: 7 rows of 5 bits, bottom row first,
+ * with the leftmost pixel of a row in its bit 4. Glyph g starts
+ * at bit 35*g, and the bits run on from one byte to the next,
+ * LSB first, so a row is always within two bytes. FONT_ROW
+ * gets one out with a 16 bit load and a shift, rather than a
+ * loop over the pixels.
+ *
+ * The characters a glyph is for are in font_ranges: a run of
+ * consecutive codes, and the glyph for the first of them. So
+ * the codes can have gaps, and a lookup (font_glyph in main.c)
+ * only steps through the few runs. A code with no glyph is
+ * shown as FONT_MISSING.
+ *
+ * Besides ASCII 0x20-0x7e (now with lowercase) there are game
+ * icons, for use in messages as "\x80" and so on.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef FONT_H_
+#define FONT_H_
+
+#include <stdint.h>
+
+/*************** definitions *****************/
+#define FONT_WIDTH 5
+#define FONT_HEIGHT 7
+#define FONT_BITS (FONT_WIDTH*FONT_HEIGHT)
+#define FONT_MISSING '?'
+
+// the game icons
+#define FONT_SMILE "\x80"
+#define FONT_FROWN "\x81"
+#define FONT_CUP "\x82"
+#define FONT_HEART "\x83"
+#define FONT_STICK "\x84"
+#define FONT_ARROW "\x85"
+
+// row y (0 is the bottom) of the glyph starting at bit b of font_bits
+#define FONT_ROW(b, y) ((uint8_t)(((uint16_t)(font_bits[((b)+FONT_WIDTH*(y))>>3] | \
+                        (font_bits[(((b)+FONT_WIDTH*(y))>>3)+1]<<8)) >> \
+                        (((b)+FONT_WIDTH*(y)) & 7)) & 0x1f))
+
+/*************** types ***********************/
+typedef struct
+{
+  uint8_t first;  // the first code of the run
+  uint8_t last;
+  uint8_t glyph;  // the glyph for first
+} font_range_t;
+
+#endif /* FONT_H_ */
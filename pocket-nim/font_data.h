@@ -0,0 +1,63 @@
+/***********************************************************
+ * font_data.h
+ * Made by host/mkfont from font5x7.txt. Don't edit it,
+ * edit that and run mkfont again (cd host; make font).
+ * See font.h for the format.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef FONT_DATA_H_
+#define FONT_DATA_H_
+
+#include "font.h"
+
+#define FONT_GLYPHS 101
+
+static const font_range_t font_ranges[]={
+  {0x20, 0x7e, 0},
+  {0x80, 0x85, 95},
+};
+#define FONT_RANGES 2
+
+static const uint8_t font_bits[443]={
+  0x00, 0x00, 0x00, 0x00, 0x20, 0x80, 0x10, 0x42, 0x08, 0x00, 0x00, 0x28,
+  0xa5, 0x94, 0xfa, 0xea, 0x2b, 0x45, 0x7c, 0x71, 0xf4, 0x91, 0x31, 0x11,
+  0x11, 0x19, 0x37, 0x59, 0x11, 0x95, 0x0c, 0x00, 0x00, 0x00, 0x21, 0x82,
+  0x20, 0x84, 0x88, 0x40, 0x44, 0x08, 0x41, 0x10, 0x20, 0xd5, 0x55, 0x02,
+  0x00, 0x21, 0x9f, 0x10, 0x80, 0x08, 0x03, 0x00, 0x00, 0x00, 0xc0, 0x07,
+  0x00, 0x30, 0x06, 0x00, 0x00, 0x00, 0x40, 0x44, 0x44, 0x00, 0x2e, 0xc6,
+  0x18, 0xa3, 0x73, 0x84, 0x10, 0xc2, 0xc8, 0x87, 0xc8, 0x84, 0xe8, 0x5c,
+  0x0c, 0x26, 0x44, 0x27, 0xc4, 0x97, 0xca, 0x08, 0x17, 0x43, 0xf0, 0xf0,
+  0xbb, 0x18, 0x3d, 0x44, 0x06, 0x21, 0x44, 0x44, 0xf8, 0x2e, 0x46, 0x17,
+  0xa3, 0x63, 0x22, 0xbc, 0x18, 0x1d, 0x60, 0x0c, 0x30, 0x06, 0x10, 0x61,
+  0x80, 0x31, 0x20, 0x08, 0x82, 0x88, 0x08, 0x00, 0x3e, 0xf8, 0x00, 0x20,
+  0x22, 0x82, 0x20, 0x88, 0x00, 0x22, 0x42, 0x74, 0xae, 0xd6, 0x16, 0xa2,
+  0x8b, 0xf1, 0xc7, 0xa8, 0x88, 0x4f, 0xc9, 0xa5, 0xe4, 0x5d, 0x84, 0x10,
+  0x46, 0xe7, 0x53, 0x4a, 0x29, 0xf9, 0x0f, 0xa1, 0x87, 0xf0, 0x43, 0x08,
+  0x3d, 0x84, 0xff, 0xc5, 0x38, 0x61, 0x74, 0x31, 0xc6, 0x1f, 0x63, 0x74,
+  0x84, 0x10, 0x42, 0x1c, 0x93, 0x42, 0x08, 0x71, 0xa2, 0xa4, 0x98, 0xca,
+  0xf8, 0x21, 0x84, 0x10, 0xc2, 0x18, 0x63, 0xad, 0x3b, 0xc6, 0x38, 0x6b,
+  0x8e, 0xd1, 0xc5, 0x18, 0x63, 0x74, 0x10, 0x42, 0x1f, 0xa3, 0x6f, 0xb2,
+  0xc6, 0x18, 0x5d, 0x94, 0xd4, 0xc7, 0xe8, 0x5d, 0x0c, 0x0e, 0x46, 0x47,
+  0x08, 0x21, 0x84, 0x7c, 0x17, 0x63, 0x8c, 0x31, 0x12, 0x15, 0x63, 0x8c,
+  0x51, 0xd5, 0x5a, 0x63, 0x8c, 0x31, 0x2a, 0xa2, 0x62, 0x24, 0x84, 0xa8,
+  0x18, 0xe3, 0x87, 0x88, 0x88, 0xf0, 0x1d, 0x42, 0x08, 0x21, 0x07, 0x82,
+  0x20, 0x08, 0x02, 0x27, 0x84, 0x10, 0xc2, 0x01, 0x00, 0x40, 0x54, 0xe4,
+  0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x7a, 0xf1, 0x05, 0x07,
+  0x80, 0x8f, 0x31, 0x5b, 0x08, 0x5d, 0x84, 0xd0, 0x01, 0xf0, 0x62, 0x9c,
+  0x2d, 0x04, 0x07, 0x7f, 0x74, 0x00, 0x20, 0x84, 0x38, 0x4a, 0xc6, 0x85,
+  0x17, 0xe3, 0x03, 0x31, 0xc6, 0x6c, 0x21, 0x74, 0x84, 0x10, 0x06, 0x08,
+  0x93, 0x42, 0x18, 0x20, 0x24, 0xc5, 0x54, 0x42, 0xe8, 0x08, 0x21, 0x84,
+  0xb0, 0x18, 0x6b, 0xd5, 0x00, 0xc4, 0x18, 0xb3, 0x05, 0xc0, 0xc5, 0x18,
+  0x1d, 0x00, 0x10, 0xfa, 0xe8, 0x01, 0x08, 0xe1, 0xcd, 0x06, 0x00, 0x84,
+  0x30, 0x5b, 0x00, 0x7c, 0x70, 0xd0, 0x01, 0x60, 0x12, 0x42, 0x1c, 0xa1,
+  0x36, 0x63, 0x8c, 0x00, 0x10, 0x15, 0x63, 0x04, 0x40, 0xd5, 0x1a, 0x23,
+  0x00, 0x51, 0x11, 0x15, 0x01, 0x70, 0xe1, 0xc5, 0x08, 0xc0, 0x47, 0x44,
+  0x7c, 0x00, 0x06, 0x21, 0x88, 0x90, 0x41, 0x08, 0x21, 0x84, 0x10, 0x4c,
+  0x88, 0x20, 0x04, 0x03, 0x20, 0x2a, 0x02, 0x00, 0xb8, 0x08, 0x94, 0x02,
+  0x20, 0x3a, 0xa0, 0x14, 0x00, 0x8e, 0x10, 0xf7, 0x3f, 0x20, 0xee, 0x7f,
+  0x05, 0x08, 0x21, 0x84, 0x10, 0x02, 0x00, 0x11, 0x5f, 0x10, 0x00,
+};
+
+#endif /* FONT_DATA_H_ */
@@ -0,0 +1,319 @@
+/***********************************************************
+ * gamelog.c
+ * Append-only log of games, kept in flash across power cycles.
+ * See gamelog.h for the layout and how it is wear levelled.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <DAVE.h>
+#include <xmc_flash.h>
+#include <stdio.h>
+#include <string.h>
+#include "nim.h"
+#include "gamelog.h"
+#include "canon.h"
+#include "movelog.h"
+
+/*************** definitions *****************/
+#define SLOT_ADDRESS(s) ((uint32_t*)(GAMELOG_BASE+(uint32_t)(s)*GAMELOG_RECORD_BYTES))
+#define PAGE_ADDRESS(p) ((uint32_t*)(GAMELOG_BASE+(uint32_t)(p)*GAMELOG_PAGE_BYTES))
+#define NO_PAGE GAMELOG_PAGES
+
+/*************** types ***********************/
+typedef union
+{
+  gamelog_record_t rec;
+  uint32_t words[GAMELOG_RECORD_BYTES/4];
+} gamelog_block_t;
+
+/******** global variables **************/
+gamelog_index_t gamelog_index;
+
+uint16_t gamelog_blank_pages;   // a bit per page, set if the page is fully erased
+gamelog_record_t gamelog_game;  // the game being played
+uint32_t gamelog_game_start_us;
+uint8_t gamelog_move_bytes[MOVELOG_GAME_BYTES];
+movelog_writer_t gamelog_moves; // every move of the game being played
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static unsigned char
+block_is_blank(const gamelog_block_t* b)
+{
+  return((b->words[0] | b->words[1] | b->words[2] | b->words[3])==0);
+}
+
+static unsigned char
+block_is_record(const gamelog_block_t* b)
+{
+  return((b->rec.magic==GAMELOG_MAGIC) && (b->rec.check==crc8((const uint8_t*)&b->rec, GAMELOG_RECORD_BYTES-1)));
+}
+
+/* count_record
+ * adds a record held in page to the totals
+ */
+static void
+count_record(const gamelog_record_t* rec, uint8_t page)
+{
+  gamelog_index.records++;
+  gamelog_index.page_records[page]++;
+  if (rec->type!=GAMELOG_GAME)
+    return;
+  gamelog_index.games++;
+  gamelog_index.page_games[page]++;
+  if (rec->winner==GAMELOG_PLAYER)
+  {
+    gamelog_index.player_wins++;
+    gamelog_index.page_wins[page]++;
+  }
+}
+
+/* erase_page
+ * erases one page of the log, dropping its records from the totals.
+ * The CPU is stalled for the length of the erase, and the interrupts
+ * with it, since their handlers and data are in flash.
+ */
+static void
+erase_page(uint8_t page)
+{
+  XMC_FLASH_ErasePages(PAGE_ADDRESS(page), 1);
+  gamelog_index.records-=gamelog_index.page_records[page];
+  gamelog_index.games-=gamelog_index.page_games[page];
+  gamelog_index.player_wins-=gamelog_index.page_wins[page];
+  gamelog_index.page_records[page]=0;
+  gamelog_index.page_games[page]=0;
+  gamelog_index.page_wins[page]=0;
+  gamelog_blank_pages|=(uint16_t)(1U<<page);
+}
+
+/* plan_erase
+ * picks the page for gamelog_idle() to erase next: the page after the
+ * one being written, so that it is ready when the head gets there
+ */
+static void
+plan_erase(void)
+{
+  uint8_t page=(uint8_t)(((gamelog_index.head/GAMELOG_PAGE_RECORDS)+1) % GAMELOG_PAGES);
+
+  if (gamelog_blank_pages & (1U<<page))
+    gamelog_index.erase_page=NO_PAGE;
+  else
+    gamelog_index.erase_page=page;
+}
+
+/* append
+ * writes a record at the head of the log. Slots that aren't blank,
+ * or that fail to verify, are skipped over. Gives up after a page
+ * worth of tries, so that worn out flash isn't erased over and over.
+ */
+static void
+append(gamelog_record_t* rec)
+{
+  gamelog_block_t b;
+  uint16_t tries;
+  uint8_t page;
+
+  rec->magic=GAMELOG_MAGIC;
+  rec->seq=gamelog_index.next_seq++;
+  rec->reserved=0;
+  rec->check=crc8((const uint8_t*)rec, GAMELOG_RECORD_BYTES-1);
+
+  for (tries=0; tries<GAMELOG_PAGE_RECORDS; tries++)
+  {
+    page=(uint8_t)(gamelog_index.head/GAMELOG_PAGE_RECORDS);
+    if (((gamelog_index.head % GAMELOG_PAGE_RECORDS)==0) && !(gamelog_blank_pages & (1U<<page)))
+    {
+      // gamelog_idle() didn't get the chance to erase it
+      erase_page(page);
+    }
+    gamelog_blank_pages&=(uint16_t)~(1U<<page);
+    XMC_FLASH_ReadBlocks(SLOT_ADDRESS(gamelog_index.head), b.words, 1);
+    if (block_is_blank(&b))
+    {
+      memcpy(&b.rec, rec, sizeof(b.rec));
+      XMC_FLASH_ClearStatus();
+      XMC_FLASH_WriteBlocks(SLOT_ADDRESS(gamelog_index.head), b.words, 1, true);
+      if ((XMC_FLASH_GetStatus() & XMC_FLASH_STATUS_VERIFY_ERROR)==0)
+      {
+        count_record(rec, page);
+        gamelog_index.level=rec->level;
+        gamelog_index.head=(uint16_t)((gamelog_index.head+1) % GAMELOG_SLOTS);
+        break;
+      }
+      gamelog_index.write_errors++;
+    }
+    gamelog_index.head=(uint16_t)((gamelog_index.head+1) % GAMELOG_SLOTS);
+  }
+  plan_erase();
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* crc8
+ * CRC-8 (polynomial 0x07) of len bytes. Also used by snapshot.c
+ */
+uint8_t
+crc8(const uint8_t* p, uint8_t len)
+{
+  uint8_t crc=0;
+  uint8_t i, bit;
+
+  for (i=0; i<len; i++)
+  {
+    crc^=p[i];
+    for (bit=0; bit<8; bit++)
+    {
+      crc=(crc & 0x80) ? (uint8_t)((crc<<1)^0x07) : (uint8_t)(crc<<1);
+    }
+  }
+  return(crc);
+}
+
+/* gamelog_init
+ * scans the log and rebuilds the RAM index.
+ * Returns the level in the newest record, or 0 if there is none.
+ */
+unsigned char
+gamelog_init(void)
+{
+  gamelog_block_t b;
+  uint16_t slot;
+  uint8_t page;
+  uint32_t newest_seq=0;
+  unsigned char found=0;
+
+  memset(&gamelog_index, 0, sizeof(gamelog_index));
+  gamelog_blank_pages=0;
+  for (page=0; page<GAMELOG_PAGES; page++)
+  {
+    gamelog_blank_pages|=(uint16_t)(1U<<page);
+    for (slot=(uint16_t)(page*GAMELOG_PAGE_RECORDS); slot<(page+1)*GAMELOG_PAGE_RECORDS; slot++)
+    {
+      XMC_FLASH_ReadBlocks(SLOT_ADDRESS(slot), b.words, 1);
+      if (block_is_blank(&b))
+        continue;
+      gamelog_blank_pages&=(uint16_t)~(1U<<page);
+      if (!block_is_record(&b))
+        continue; // a torn write, or worn out
+      count_record(&b.rec, page);
+      if ((!found) || ((int32_t)(b.rec.seq-newest_seq)>0))
+      {
+        found=1;
+        newest_seq=b.rec.seq;
+        gamelog_index.level=b.rec.level;
+        gamelog_index.head=(uint16_t)((slot+1) % GAMELOG_SLOTS);
+      }
+    }
+  }
+  gamelog_index.next_seq=found ? newest_seq+1 : 1;
+  plan_erase();
+  return(gamelog_index.level);
+}
+
+/* gamelog_idle
+ * called while waiting for the user, when nothing is under way that
+ * the erase would hold up (flash_quiet in main.c). Erases the page
+ * ahead of the head of the log, if it needs it.
+ */
+void
+gamelog_idle(void)
+{
+  if (gamelog_index.erase_page==NO_PAGE)
+    return;
+  erase_page(gamelog_index.erase_page);
+  gamelog_index.erase_page=NO_PAGE;
+}
+
+/* gamelog_game_start
+ * notes the starting position of a new game
+ */
+void
+gamelog_game_start(void)
+{
+  memset(&gamelog_game, 0, sizeof(gamelog_game));
+  gamelog_game.type=GAMELOG_GAME;
+  gamelog_game.level=level;
+  gamelog_game.start=(uint16_t)canon_rank(numsticks, rows);
+  gamelog_game.rows=rows;
+  gamelog_game_start_us=SYSTIMER_GetTime();
+  movelog_open(&gamelog_moves, gamelog_move_bytes, sizeof(gamelog_move_bytes), NULL);
+  movelog_start(&gamelog_moves, level, randreg,
+                (level==WYTHOFF_LEVEL) ? MOVELOG_WYTHOFF : ROWS_PER_MOVE(level), numsticks, rows);
+}
+
+/* gamelog_move
+ * counts a move by either side, and logs it
+ */
+void
+gamelog_move(void)
+{
+  if (gamelog_game.type!=GAMELOG_GAME)
+    return; // a resumed game, see gamelog_game_end
+  if (gamelog_game.moves<0xff)
+    gamelog_game.moves++;
+  movelog_move(&gamelog_moves, numsticks);
+}
+
+/* gamelog_pass
+ * logs the user's turn when they leave the computer to move without
+ * taking any sticks
+ */
+void
+gamelog_pass(void)
+{
+  if (gamelog_game.type!=GAMELOG_GAME)
+    return;
+  movelog_move(&gamelog_moves, numsticks);
+}
+
+/* gamelog_game_end
+ * writes a record of the game that has just finished, if it was
+ * started with gamelog_game_start()
+ */
+void
+gamelog_game_end(unsigned char winner)
+{
+  uint32_t ds=(SYSTIMER_GetTime()-gamelog_game_start_us)/100000UL;
+
+  // a game resumed after a power cut wasn't started with
+  // gamelog_game_start(), as how it started is lost, and isn't logged
+  if (gamelog_game.type!=GAMELOG_GAME)
+    return;
+  gamelog_game.winner=winner;
+  gamelog_game.duration_ds=(ds>0xffff) ? 0xffff : (uint16_t)ds;
+  append(&gamelog_game);
+  movelog_end(&gamelog_moves, winner);
+  gamelog_game.type=0; // until the next gamelog_game_start()
+}
+
+/* gamelog_level
+ * writes a record of a change of level
+ */
+void
+gamelog_level(unsigned char new_level)
+{
+  gamelog_record_t rec;
+
+  memset(&rec, 0, sizeof(rec));
+  rec.type=GAMELOG_LEVEL;
+  rec.level=new_level;
+  append(&rec);
+}
+
+/* gamelog_report
+ * prints the state of the log
+ */
+void
+gamelog_report(void)
+{
+  printf("gamelog: %u records (%u games, %u won by the player), head %u, next seq %lu, "
+         "level %u, %u write errors\n",
+         gamelog_index.records, gamelog_index.games, gamelog_index.player_wins,
+         gamelog_index.head, (unsigned long)gamelog_index.next_seq,
+         gamelog_index.level, gamelog_index.write_errors);
+}
@@ -0,0 +1,112 @@
+/***********************************************************
+ * gamelog.h
+ * Append-only log of games, kept in flash across power cycles.
+ *
+ * The last 4 kbytes of flash (16 pages of 256 bytes, reserved in
+ * linker_script.ld) are used as a circular log of 16 byte records,
+ * one flash block each. A record is written for every game result,
+ * and whenever a Computer+Row chord changes the level. A game resumed
+ * after a power cut (see snapshot.h) has no gamelog_game_start(), as
+ * how it started is lost, so its result isn't logged.
+ *
+ * Records are only ever appended, going round the pages in turn,
+ * so every page is erased equally often (wear levelling). The page
+ * after the one being written is kept erased, so an append never
+ * has to wait for an erase. Erasing that page, which stalls the CPU
+ * and the interrupts for several ms, is left to gamelog_idle(),
+ * called while the game waits for a button and no button is held or
+ * being debounced.
+ *
+ * At boot gamelog_init() reads every block once and rebuilds the RAM
+ * index: where to write next, the newest level, and totals over the
+ * records held. Blocks that don't check out (e.g. a write cut short
+ * by power loss) are skipped.
+ *
+ * A game's starting rows are kept as their rank among the positions
+ * that are the same up to the order of the rows (canon_rank()), so
+ * the same start laid out in a different order gives the same
+ * record, and canon_unrank() gets the rows back, shortest first.
+ *
+ * Every move of the game being played, or the last one, is kept in
+ * RAM in gamelog_moves (see movelog.h). A resumed game's moves
+ * aren't, as the log of them would have no start.
+ *
+ * The log can be read out from gdb with
+ *   dump binary memory log.bin 0x10010000 0x10011000
+ * and the moves with
+ *   dump binary memory moves.bin gamelog_move_bytes gamelog_move_bytes+gamelog_moves.len
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef GAMELOG_H_
+#define GAMELOG_H_
+
+#include <stdint.h>
+
+/*************** definitions *****************/
+#define GAMELOG_BASE 0x10010000UL // must match linker_script.ld
+#define GAMELOG_PAGES 16
+#define GAMELOG_PAGE_BYTES 256
+#define GAMELOG_RECORD_BYTES 16
+#define GAMELOG_PAGE_RECORDS (GAMELOG_PAGE_BYTES/GAMELOG_RECORD_BYTES)
+#define GAMELOG_SLOTS (GAMELOG_PAGES*GAMELOG_PAGE_RECORDS)
+#define GAMELOG_MAGIC 0xa5
+
+// record types
+#define GAMELOG_GAME 1
+#define GAMELOG_LEVEL 2
+
+// winners in a GAMELOG_GAME record
+#define GAMELOG_ABANDONED 0
+#define GAMELOG_PLAYER 1
+#define GAMELOG_COMPUTER 2
+
+/*************** types ***********************/
+// one flash block. Erased flash reads as all zeroes, which
+// fails the magic and check bytes.
+typedef struct
+{
+  uint8_t magic;
+  uint8_t type;
+  uint8_t level;
+  uint8_t winner;
+  uint32_t seq;         // increments with every record written
+  uint16_t start;       // the rows at the start, as their rank up to order (see canon.h)
+  uint8_t rows;
+  uint8_t moves;        // moves made by both sides
+  uint16_t duration_ds; // game length in tenths of a second
+  uint8_t reserved;
+  uint8_t check;        // CRC-8 of the bytes before it
+} gamelog_record_t;
+
+// the RAM index, rebuilt from flash at boot
+typedef struct
+{
+  uint16_t head;        // slot for the next record
+  uint16_t records;     // valid records held
+  uint32_t next_seq;
+  uint8_t level;        // level in the newest record, 0 if none
+  uint8_t erase_page;   // page waiting for gamelog_idle() to erase it, or GAMELOG_PAGES
+  uint16_t games;       // totals over the records held
+  uint16_t player_wins;
+  uint8_t page_records[GAMELOG_PAGES];
+  uint8_t page_games[GAMELOG_PAGES];
+  uint8_t page_wins[GAMELOG_PAGES];
+  uint16_t write_errors;
+} gamelog_index_t;
+
+extern gamelog_index_t gamelog_index;
+
+/******** function prototypes ***********/
+uint8_t crc8(const uint8_t* p, uint8_t len);
+unsigned char gamelog_init(void);
+void gamelog_idle(void);
+void gamelog_game_start(void);
+void gamelog_move(void);
+void gamelog_pass(void);
+void gamelog_game_end(unsigned char winner);
+void gamelog_level(unsigned char new_level);
+void gamelog_report(void);
+
+#endif /* GAMELOG_H_ */
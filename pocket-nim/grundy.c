@@ -0,0 +1,317 @@
+/***********************************************************
+ * grundy.c
+ * Sprague-Grundy values for octal games played on rows of
+ * sticks. See grundy.h for how it works.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdint.h>
+#include <string.h>
+#include "grundy.h"
+
+/*************** definitions *****************/
+#define LEAVES_NONE 1
+#define LEAVES_ONE 2
+#define LEAVES_TWO 4
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* mex_of
+ * works out g(n) from the values of the positions a move can
+ * leave: the least value none of them has
+ */
+static uint8_t
+mex_of(const grundy_game_t* game, uint32_t n)
+{
+  uint32_t seen[8]; // a bit for each value 0-255
+  uint32_t k, m, a;
+  uint8_t d, v;
+
+  memset(seen, 0, sizeof(seen));
+  for (k=1; (k<=game->take) && (k<=n); k++)
+  {
+    d=game->digit[k];
+    m=n-k;
+    if ((d & LEAVES_NONE) && (m==0))
+      seen[0]|=1;
+    if ((d & LEAVES_ONE) && (m>0))
+      seen[game->g[m]>>5]|=1UL<<(game->g[m] & 31);
+    if ((d & LEAVES_TWO) && (m>=2))
+    {
+      for (a=1; a<=m/2; a++)
+      {
+        v=game->g[a]^game->g[m-a];
+        seen[v>>5]|=1UL<<(v & 31);
+      }
+    }
+  }
+  for (v=0; v<GRUNDY_UNKNOWN; v++)
+  {
+    if ((seen[v>>5] & (1UL<<(v & 31)))==0)
+      break;
+  }
+  return(v);
+}
+
+/* find_period
+ * records where g(n)=g(n-p) fails for each period p, now that g(n)
+ * is known, then looks for the shortest period the periodicity
+ * theorem says holds from here on
+ */
+static void
+find_period(grundy_game_t* game, uint32_t n)
+{
+  uint32_t p, n0;
+
+  for (p=1; (p<=game->max_period) && (p<=n); p++)
+  {
+    if (game->g[n]!=game->g[n-p])
+      game->last_break[p]=n;
+  }
+  for (p=1; (p<=game->max_period) && (p<=n); p++)
+  {
+    n0=game->last_break[p]+1-p; // g(m+p)=g(m) for every m from n0
+    if ((n0==0) && game->splits)
+      n0=1;
+    if (n+1>=2*n0+2*p+game->take)
+    {
+      game->period=p;
+      game->preperiod=n0;
+      return;
+    }
+  }
+}
+
+/* split_limit
+ * the longest left part worth trying when splitting m sticks. Once
+ * the values repeat, a split further along is worth the same as one
+ * a period nearer the start
+ */
+static uint32_t
+split_limit(const grundy_game_t* game, uint32_t m)
+{
+  uint32_t lim=m/2;
+
+  if ((game->period!=0) && (lim>game->preperiod+2*game->period))
+    lim=game->preperiod+2*game->period;
+  return(lim);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* grundy_init
+ * sets up a game from its rule: an octal code such as "0.77", or a
+ * subtraction set such as "{1,2,3}". g is the memo table, size values
+ * long, and last_break has room for max_period+1 entries (max_period
+ * can be 0, to not look for a period). Returns 0 if the rule can't be
+ * read.
+ */
+unsigned char
+grundy_init(grundy_game_t* game, const char* rule, uint8_t* g, uint32_t size,
+            uint32_t* last_break, uint32_t max_period)
+{
+  uint32_t p, k;
+
+  memset(game, 0, sizeof(*game));
+  if ((rule[0]=='0') && (rule[1]=='.'))
+  {
+    for (k=1; rule[k+1]!='\0'; k++)
+    {
+      if ((k>GRUNDY_MAX_TAKE) || (rule[k+1]<'0') || (rule[k+1]>'7'))
+        return(0);
+      game->digit[k]=(uint8_t)(rule[k+1]-'0');
+      if (game->digit[k]!=0)
+        game->take=(uint8_t)k;
+    }
+  }
+  else if (rule[0]=='{')
+  {
+    for (rule++; *rule!='}'; )
+    {
+      for (k=0; (*rule>='0') && (*rule<='9'); rule++)
+        k=k*10+(uint32_t)(*rule-'0');
+      if ((k<1) || (k>GRUNDY_MAX_TAKE))
+        return(0);
+      game->digit[k]=LEAVES_NONE | LEAVES_ONE;
+      if (k>game->take)
+        game->take=(uint8_t)k;
+      if (*rule==',')
+        rule++;
+      else if (*rule!='}')
+        return(0);
+    }
+  }
+  if ((game->take==0) || (size<1))
+    return(0);
+  for (k=1; k<=game->take; k++)
+  {
+    if (game->digit[k] & LEAVES_TWO)
+      game->splits=1;
+  }
+  game->g=g;
+  game->size=size;
+  game->last_break=last_break;
+  game->max_period=(last_break!=NULL) ? max_period : 0;
+  for (p=1; p<=game->max_period; p++)
+  {
+    last_break[p]=p-1; // nothing to compare before g(p)
+  }
+  return(1);
+}
+
+/* grundy_extend
+ * fills the memo table up to g(n), or as far as it goes. Returns how
+ * many values are known
+ */
+uint32_t
+grundy_extend(grundy_game_t* game, uint32_t n)
+{
+  uint8_t v;
+
+  while ((game->known<=n) && (game->known<game->size))
+  {
+    if (game->period!=0)
+    {
+      game->g[game->known]=game->g[game->known-game->period];
+    }
+    else
+    {
+      v=mex_of(game, game->known);
+      if (v==GRUNDY_UNKNOWN)
+      {
+        game->size=game->known; // too large to keep, so stop here
+        break;
+      }
+      game->g[game->known]=v;
+      game->computed++;
+      find_period(game, game->known);
+    }
+    game->known++;
+  }
+  return(game->known);
+}
+
+/* grundy_value
+ * g(n), the value of a row of n sticks. Once the period is known,
+ * any n is a lookup; until then the table is extended as far as n,
+ * and GRUNDY_UNKNOWN returned if it won't reach
+ */
+uint8_t
+grundy_value(grundy_game_t* game, uint32_t n)
+{
+  if (n<game->known)
+    return(game->g[n]);
+  if ((game->period!=0) && (n>=game->preperiod))
+    return(game->g[game->preperiod+(n-game->preperiod)%game->period]);
+  grundy_extend(game, n);
+  if (n<game->known)
+    return(game->g[n]);
+  if ((game->period!=0) && (n>=game->preperiod))
+    return(game->g[game->preperiod+(n-game->preperiod)%game->period]);
+  return(GRUNDY_UNKNOWN);
+}
+
+/* grundy_sum
+ * the value of a position: the XOR of the values of its rows
+ */
+uint8_t
+grundy_sum(grundy_game_t* game, const uint32_t* heaps, unsigned char rows)
+{
+  uint8_t x=0, v;
+  unsigned char i;
+
+  for (i=0; i<rows; i++)
+  {
+    v=grundy_value(game, heaps[i]);
+    if (v==GRUNDY_UNKNOWN)
+      return(GRUNDY_UNKNOWN);
+    x^=v;
+  }
+  return(x);
+}
+
+/* grundy_choose
+ * finds a move that leaves the position worth 0, and returns 1. If
+ * there isn't one, returns 0 with the move that takes the fewest
+ * sticks from the longest row that has a move, to make the game last;
+ * or with move->take 0 if there is no move at all.
+ */
+unsigned char
+grundy_choose(grundy_game_t* game, const uint32_t* heaps, unsigned char rows, grundy_move_t* move)
+{
+  uint32_t k, m, a, lim, longest=0;
+  uint8_t x, v, target, d;
+  unsigned char i;
+
+  memset(move, 0, sizeof(*move));
+  x=grundy_sum(game, heaps, rows);
+  if ((x!=0) && (x!=GRUNDY_UNKNOWN))
+  {
+    for (i=0; i<rows; i++)
+    {
+      v=grundy_value(game, heaps[i]);
+      target=x^v;
+      if (target>=v) // only a smaller value is sure to be reachable from this row
+        continue;
+      move->row=i;
+      for (k=1; (k<=game->take) && (k<=heaps[i]); k++)
+      {
+        d=game->digit[k];
+        m=heaps[i]-k;
+        move->take=(uint8_t)k;
+        if ((d & LEAVES_NONE) && (m==0) && (target==0))
+          return(1);
+        if ((d & LEAVES_ONE) && (m>0) && (grundy_value(game, m)==target))
+        {
+          move->left=m;
+          return(1);
+        }
+        if ((d & LEAVES_TWO) && (m>=2))
+        {
+          lim=split_limit(game, m);
+          for (a=1; a<=lim; a++)
+          {
+            if ((grundy_value(game, a)^grundy_value(game, m-a))==target)
+            {
+              move->left=a;
+              move->right=m-a;
+              return(1);
+            }
+          }
+        }
+      }
+    }
+  }
+  // no winning move: play for time
+  memset(move, 0, sizeof(*move));
+  for (i=0; i<rows; i++)
+  {
+    if (heaps[i]<=longest)
+      continue;
+    for (k=1; (k<=game->take) && (k<=heaps[i]); k++)
+    {
+      d=game->digit[k];
+      m=heaps[i]-k;
+      if (((d & LEAVES_NONE) && (m==0)) || ((d & LEAVES_ONE) && (m>0)) ||
+          ((d & LEAVES_TWO) && (m>=2)))
+      {
+        longest=heaps[i];
+        move->row=i;
+        move->take=(uint8_t)k;
+        move->left=m;
+        if (((d & LEAVES_ONE)==0) && (m>0))
+        {
+          move->left=1; // it can only split
+          move->right=m-1;
+        }
+        break;
+      }
+    }
+  }
+  return(0);
+}
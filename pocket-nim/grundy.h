@@ -0,0 +1,78 @@
+/***********************************************************
+ * grundy.h
+ * Sprague-Grundy values for other impartial games played on
+ * rows of sticks: subtraction games, Kayles, Dawson's chess,
+ * and the rest of the finite octal games.
+ *
+ * A game is described by its octal code, as in Winning Ways:
+ * "0.d1d2d3..", where digit dk says what taking k sticks from a
+ * row may leave of it: add 1 if it may leave nothing, 2 if it
+ * may leave one row, 4 if it may leave two rows (the rest split
+ * in two, either side of the sticks taken). So
+ *  - Kayles is 0.77: knock down one pin or two adjacent ones
+ *  - Dawson's chess is 0.137
+ *  - the subtraction game with set {1, 2, 3} is 0.333, which can
+ *    also be written as the set, "{1,2,3}"
+ * It is the normal play rule: whoever can't move loses.
+ *
+ * The value of a row of n sticks, g(n), is kept in a memo table
+ * that the caller provides, and is worked out when it is first
+ * needed, a row length at a time (grundy_value). As each value
+ * is added, every period p up to max_period is checked for where
+ * g(n)=g(n-p) last failed, and once the values repeat for long
+ * enough the octal game periodicity theorem says they always
+ * will: if g(n+p)=g(n) for n0 <= n < 2n0+p+t, with t the most
+ * that can be taken, it holds for every n >= n0 (and n0 must be
+ * at least 1 if a move can split a row, since a split leaves two
+ * rows that aren't empty). From then on the table extends by
+ * copying, and g of any length is a lookup.
+ *
+ * A position of several rows is worth the XOR of the values of
+ * its rows, as for Nim's nim-sum. grundy_choose() finds a row,
+ * and a move in it, that leaves a position worth 0.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef GRUNDY_H_
+#define GRUNDY_H_
+
+#include <stdint.h>
+
+/*************** definitions *****************/
+#define GRUNDY_MAX_TAKE 16     // digits of the octal code
+#define GRUNDY_UNKNOWN 0xff    // g is past the table, or too large to keep
+
+/*************** types ***********************/
+typedef struct
+{
+  uint8_t digit[GRUNDY_MAX_TAKE+1]; // digit[k] for taking k
+  uint8_t take;                     // the highest k with a digit
+  uint8_t splits;                   // some move leaves two rows
+  uint8_t* g;                       // the memo table
+  uint32_t size;                    // ..its length
+  uint32_t known;                   // g[0..known-1] are worked out
+  uint32_t* last_break;             // for each period, where it last failed
+  uint32_t max_period;
+  uint32_t period;                  // 0 until found
+  uint32_t preperiod;
+  uint32_t computed;                // values worked out from the moves
+} grundy_game_t;
+
+typedef struct
+{
+  uint8_t row;     // the row taken from
+  uint8_t take;    // how many sticks
+  uint32_t left;   // sticks left before the gap..
+  uint32_t right;  // ..and after it, 0 if the row isn't split
+} grundy_move_t;
+
+/******** function prototypes ***********/
+unsigned char grundy_init(grundy_game_t* game, const char* rule, uint8_t* g, uint32_t size,
+                          uint32_t* last_break, uint32_t max_period);
+uint8_t grundy_value(grundy_game_t* game, uint32_t n);
+uint32_t grundy_extend(grundy_game_t* game, uint32_t n);
+uint8_t grundy_sum(grundy_game_t* game, const uint32_t* heaps, unsigned char rows);
+unsigned char grundy_choose(grundy_game_t* game, const uint32_t* heaps, unsigned char rows, grundy_move_t* move);
+
+#endif /* GRUNDY_H_ */
@@ -0,0 +1,402 @@
+/***********************************************************
+ * i2cq.c
+ * A queue of I2C transfers for i2c_bus, with a deadline on
+ * each one and recovery of a hung bus.
+ * See i2cq.h for how it works.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <DAVE.h>
+#include <stdio.h>
+#include <string.h>
+#include "latency.h"
+#include "i2cq.h"
+
+/*************** definitions *****************/
+#define PHASE_IDLE 0   // the transfer at the head hasn't started
+#define PHASE_WRITE 1
+#define PHASE_READ 2
+
+#define ERROR_FLAGS ((uint32_t)XMC_I2C_CH_STATUS_FLAG_NACK_RECEIVED | \
+                     (uint32_t)XMC_I2C_CH_STATUS_FLAG_ARBITRATION_LOST | \
+                     (uint32_t)XMC_I2C_CH_STATUS_FLAG_ERROR | \
+                     (uint32_t)XMC_I2C_CH_STATUS_FLAG_WRONG_TDF_CODE_FOUND)
+
+#define RECOVERY_CLOCKS 9
+#define HALF_BIT_LOOPS 40 // about 5 us at 32 MHz, for 100 kHz recovery clocks
+#define CYCLES_PER_US (SYSTIMER_SYSTICK_CLOCK/1000000U)
+
+/*************** types ***********************/
+typedef struct
+{
+  uint8_t address;
+  uint8_t flags;
+  uint8_t len;          // bytes to write. A read writes data[0], the register pointer
+  uint8_t rx_len;
+  uint8_t* rx_data;
+  volatile uint8_t* status;
+  uint32_t queued;       // cycles_now() when it was queued
+  uint8_t data[I2CQ_MAX_BYTES];
+} i2cq_entry_t;
+
+/******** global variables **************/
+i2cq_stats_t i2cq_stats;
+
+i2cq_entry_t i2cq_queue[I2CQ_DEPTH];
+uint8_t i2cq_head;
+uint8_t i2cq_count;
+uint8_t i2cq_frames;       // display frames in the queue
+uint8_t i2cq_phase;
+uint8_t i2cq_phase_error;  // the head transfer couldn't be started
+uint8_t i2cq_attempts;
+uint32_t i2cq_phase_tick;  // when the current phase started
+uint32_t i2cq_timer_id;
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static void
+half_bit(void)
+{
+  volatile uint8_t i;
+
+  for (i=0; i<HALF_BIT_LOOPS; i++)
+  {
+    __NOP();
+  }
+}
+
+/* bus_recover
+ * aborts the transfer, clocks a stuck slave off SDA, sends a stop
+ * and starts the USIC afresh
+ */
+static void
+bus_recover(void)
+{
+  uint8_t i;
+
+  I2C_MASTER_AbortTransmit(&i2c_bus);
+  I2C_MASTER_AbortReceive(&i2c_bus);
+
+  // take the pins over as open drain outputs, both released
+  XMC_GPIO_SetOutputHigh(I2CQ_PORT, I2CQ_SDA_PIN);
+  XMC_GPIO_SetOutputHigh(I2CQ_PORT, I2CQ_SCL_PIN);
+  XMC_GPIO_SetMode(I2CQ_PORT, I2CQ_SDA_PIN, XMC_GPIO_MODE_OUTPUT_OPEN_DRAIN);
+  XMC_GPIO_SetMode(I2CQ_PORT, I2CQ_SCL_PIN, XMC_GPIO_MODE_OUTPUT_OPEN_DRAIN);
+  half_bit();
+  if (XMC_GPIO_GetInput(I2CQ_PORT, I2CQ_SDA_PIN)==0)
+    i2cq_stats.stuck++;
+  for (i=0; (i<RECOVERY_CLOCKS) && (XMC_GPIO_GetInput(I2CQ_PORT, I2CQ_SDA_PIN)==0); i++)
+  {
+    XMC_GPIO_SetOutputLow(I2CQ_PORT, I2CQ_SCL_PIN);
+    half_bit();
+    XMC_GPIO_SetOutputHigh(I2CQ_PORT, I2CQ_SCL_PIN);
+    half_bit();
+  }
+  // stop condition: SDA goes high while SCL is high
+  XMC_GPIO_SetOutputLow(I2CQ_PORT, I2CQ_SCL_PIN);
+  half_bit();
+  XMC_GPIO_SetOutputLow(I2CQ_PORT, I2CQ_SDA_PIN);
+  half_bit();
+  XMC_GPIO_SetOutputHigh(I2CQ_PORT, I2CQ_SCL_PIN);
+  half_bit();
+  XMC_GPIO_SetOutputHigh(I2CQ_PORT, I2CQ_SDA_PIN);
+  half_bit();
+
+  I2C_MASTER_Init(&i2c_bus); // the pins go back to the USIC
+  I2C_MASTER_ClearFlag(&i2c_bus, ERROR_FLAGS);
+}
+
+/* start_phase
+ * starts the write, or the read that follows it, of the transfer e
+ */
+static void
+start_phase(i2cq_entry_t* e, uint8_t phase)
+{
+  I2C_MASTER_STATUS_t status;
+
+  if (phase==PHASE_WRITE)
+  {
+    // a read leaves the bus for the repeated start
+    status=I2C_MASTER_Transmit(&i2c_bus, true, e->address, e->data, e->len, (e->flags & I2CQ_READ)==0);
+  }
+  else
+  {
+    status=I2C_MASTER_Receive(&i2c_bus, true, e->address, e->rx_data, e->rx_len, true, true);
+  }
+  i2cq_phase=phase;
+  i2cq_phase_error=(status!=I2C_MASTER_STATUS_SUCCESS);
+  i2cq_phase_tick=SYSTIMER_GetTickCount();
+}
+
+/* finish
+ * takes the transfer at the head off the queue
+ */
+static void
+finish(i2cq_entry_t* e, uint8_t status)
+{
+  uint32_t us;
+
+  if (status==I2CQ_DONE)
+  {
+    i2cq_stats.done++;
+    us=(cycles_now()-e->queued)/CYCLES_PER_US;
+    if (us>i2cq_stats.max_us)
+      i2cq_stats.max_us=us;
+  }
+  else
+  {
+    i2cq_stats.failed++;
+  }
+  if (e->flags & I2CQ_FRAME)
+  {
+    i2cq_frames--;
+    // a frame can be several transfers, one for each panel
+    if ((status==I2CQ_DONE) && (i2cq_frames==0))
+      latency_frame_shown(1);
+  }
+  if (e->status!=NULL)
+    *e->status=status;
+  i2cq_head=(uint8_t)((i2cq_head+1) % I2CQ_DEPTH);
+  i2cq_count--;
+  i2cq_phase=PHASE_IDLE;
+  i2cq_attempts=0;
+}
+
+/* pump
+ * moves the queue along: finishes the transfer at the head if it is
+ * done, recovers the bus if it has failed, and starts the next one.
+ * Called with interrupts disabled.
+ */
+static void
+pump(void)
+{
+  i2cq_entry_t* e;
+  unsigned char error;
+
+  while (i2cq_count>0)
+  {
+    e=&i2cq_queue[i2cq_head];
+    if (i2cq_phase==PHASE_IDLE)
+    {
+      start_phase(e, PHASE_WRITE);
+      return;
+    }
+    error=i2cq_phase_error || (I2C_MASTER_GetFlagStatus(&i2c_bus, ERROR_FLAGS)!=0);
+    if (!error && !I2C_MASTER_IsTxBusy(&i2c_bus) && !I2C_MASTER_IsRxBusy(&i2c_bus))
+    {
+      if ((i2cq_phase==PHASE_WRITE) && (e->flags & I2CQ_READ))
+      {
+        start_phase(e, PHASE_READ);
+        return;
+      }
+      finish(e, I2CQ_DONE);
+      continue;
+    }
+    if (!error && ((SYSTIMER_GetTickCount()-i2cq_phase_tick)<I2CQ_DEADLINE_MS))
+      return; // still going
+    if (error)
+      i2cq_stats.errors++;
+    else
+      i2cq_stats.timeouts++;
+    bus_recover();
+    i2cq_attempts++;
+    if (i2cq_attempts>I2CQ_RETRIES)
+    {
+      finish(e, I2CQ_FAILED);
+      continue;
+    }
+    i2cq_stats.retries++;
+    i2cq_phase=PHASE_IDLE;
+  }
+}
+
+/* pump_now
+ * pump, from an interrupt that another may preempt
+ */
+static void
+pump_now(void)
+{
+  uint32_t primask;
+
+  primask=__get_PRIMASK();
+  __disable_irq();
+  pump();
+  __set_PRIMASK(primask);
+}
+
+/* i2cq_tick
+ * SYSTIMER callback, every millisecond, for the deadlines
+ */
+static void
+i2cq_tick(void* args)
+{
+  (void)args;
+  pump_now();
+}
+
+/* add
+ * puts a transfer on the end of the queue, or replaces a frame that
+ * is still waiting. Returns it, or NULL if the queue is full.
+ * Called with interrupts disabled.
+ */
+static i2cq_entry_t*
+add(uint8_t address, uint8_t flags)
+{
+  i2cq_entry_t* e;
+  uint8_t i;
+
+  if (flags & I2CQ_FRAME)
+  {
+    // the head may already be on the bus, so leave it be
+    for (i=(i2cq_phase==PHASE_IDLE) ? 0 : 1; i<i2cq_count; i++)
+    {
+      e=&i2cq_queue[(i2cq_head+i) % I2CQ_DEPTH];
+      if ((e->flags & I2CQ_FRAME) && (e->address==address))
+      {
+        i2cq_stats.merged++;
+        return(e);
+      }
+    }
+  }
+  if (i2cq_count>=I2CQ_DEPTH)
+  {
+    i2cq_stats.full++;
+    return(NULL);
+  }
+  e=&i2cq_queue[(i2cq_head+i2cq_count) % I2CQ_DEPTH];
+  i2cq_count++;
+  if (flags & I2CQ_FRAME)
+    i2cq_frames++;
+  i2cq_stats.queued++;
+  e->address=address;
+  e->flags=flags;
+  e->rx_len=0;
+  e->rx_data=NULL;
+  e->status=NULL;
+  e->queued=cycles_now();
+  return(e);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* i2cq_init
+ * starts the tick that checks the deadlines. i2c_bus has been set up by
+ * DAVE_Init
+ */
+void
+i2cq_init(void)
+{
+  i2cq_timer_id=(uint32_t)SYSTIMER_CreateTimer(1000, SYSTIMER_MODE_PERIODIC, i2cq_tick, NULL);
+  SYSTIMER_StartTimer(i2cq_timer_id);
+}
+
+/* i2cq_write
+ * queues len bytes to be written to address (the 8 bit form).
+ * Returns 0 if the queue is full.
+ */
+unsigned char
+i2cq_write(uint8_t address, const uint8_t* data, uint8_t len, uint8_t flags)
+{
+  i2cq_entry_t* e;
+  uint32_t primask;
+
+  if (len>I2CQ_MAX_BYTES)
+    return(0);
+  primask=__get_PRIMASK();
+  __disable_irq();
+  e=add(address, flags & I2CQ_FRAME);
+  if (e!=NULL)
+  {
+    memcpy(e->data, data, len);
+    e->len=len;
+    pump();
+  }
+  __set_PRIMASK(primask);
+  return(e!=NULL);
+}
+
+/* i2cq_read
+ * queues a read of len bytes from register pointer of address.
+ * *status is I2CQ_PENDING until the data is in, then I2CQ_DONE, or
+ * I2CQ_FAILED. Returns 0 if the queue is full.
+ */
+unsigned char
+i2cq_read(uint8_t address, uint8_t pointer, uint8_t* data, uint8_t len, volatile uint8_t* status)
+{
+  i2cq_entry_t* e;
+  uint32_t primask;
+
+  primask=__get_PRIMASK();
+  __disable_irq();
+  e=add(address, I2CQ_READ);
+  if (e!=NULL)
+  {
+    e->data[0]=pointer;
+    e->len=1;
+    e->rx_data=data;
+    e->rx_len=len;
+    e->status=status;
+    *status=I2CQ_PENDING;
+    pump();
+  }
+  __set_PRIMASK(primask);
+  return(e!=NULL);
+}
+
+/* i2cq_busy
+ * returns 1 while there are transfers still to finish
+ */
+unsigned char
+i2cq_busy(void)
+{
+  return(i2cq_count>0);
+}
+
+/* i2cq_frame_pending
+ * returns 1 until the last display frame queued has been sent (or
+ * given up on)
+ */
+unsigned char
+i2cq_frame_pending(void)
+{
+  return(i2cq_frames>0);
+}
+
+/* i2cq_tx_done
+ * I2C_MASTER end of transmit callback
+ */
+void
+i2cq_tx_done(void)
+{
+  pump_now();
+}
+
+/* i2cq_rx_done
+ * I2C_MASTER end of receive callback
+ */
+void
+i2cq_rx_done(void)
+{
+  pump_now();
+}
+
+/* i2cq_report
+ * prints the bus traffic and what went wrong with it
+ */
+void
+i2cq_report(void)
+{
+  printf("i2cq: %lu transfers queued, %lu frames replaced, %lu turned away, %lu done, %lu failed\n",
+         (unsigned long)i2cq_stats.queued, (unsigned long)i2cq_stats.merged,
+         (unsigned long)i2cq_stats.full, (unsigned long)i2cq_stats.done,
+         (unsigned long)i2cq_stats.failed);
+  printf("i2cq: %lu errors, %lu timeouts, %lu retries, %lu with SDA stuck, worst queued to done %lu us\n",
+         (unsigned long)i2cq_stats.errors, (unsigned long)i2cq_stats.timeouts,
+         (unsigned long)i2cq_stats.retries, (unsigned long)i2cq_stats.stuck,
+         (unsigned long)i2cq_stats.max_us);
+}
@@ -0,0 +1,95 @@
+/***********************************************************
+ * i2cq.h
+ * A queue of I2C transfers for i2c_bus, with a deadline on
+ * each one and recovery of a hung bus.
+ *
+ * Nothing waits on the bus any more. i2cq_write() and
+ * i2cq_read() put a transfer in the queue and return straight
+ * away. The transfer at the head is started with the interrupt
+ * driven I2C_MASTER calls, and the next one is started from the
+ * I2C_MASTER end of transmit/receive callbacks (i2cq_tx_done and
+ * i2cq_rx_done, set in i2c_master_conf.c), so transfers go out
+ * back to back. A 1 ms SYSTIMER callback checks the deadlines.
+ *
+ * A transfer fails if the USIC flags a NACK, lost arbitration or
+ * a bus error, or if it hasn't finished I2CQ_DEADLINE_MS after it
+ * started (a stuck SDA line doesn't flag anything, it just never
+ * finishes). The bus is then recovered:
+ *  - the transfer is aborted
+ *  - SCL and SDA are taken over as open drain GPIOs, and SCL is
+ *    clocked up to 9 times, until a slave that was part way
+ *    through sending a byte lets go of SDA
+ *  - a stop condition is sent, and I2C_MASTER_Init() hands the
+ *    pins back to the USIC and sets it up afresh
+ * and the transfer is tried again, up to I2CQ_RETRIES times
+ * before it is dropped. The recovery takes about 0.2 ms, from
+ * the tick interrupt (or the I2C one, for a flagged error).
+ *
+ * A display frame (I2CQ_FRAME) that is still waiting to go out is
+ * replaced by a newer one for the same address rather than queued
+ * behind it, and latency_frame_shown() is called once the last
+ * frame in the queue has been sent (a frame is a transfer for each
+ * panel that changed, see display.h). So a
+ * frame is on the display, or has been given up on, at most
+ * about I2CQ_DEPTH*(I2CQ_RETRIES+1)*(I2CQ_DEADLINE_MS+1) ms
+ * after display_write(), whatever the bus does.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef I2CQ_H_
+#define I2CQ_H_
+
+#include <stdint.h>
+#include "display.h"
+
+/*************** definitions *****************/
+#define I2CQ_DEPTH (DISPLAY_PANELS+3) // a frame for each panel, and commands or a key read
+#define I2CQ_MAX_BYTES 17     // a panel's frame: address pointer and 16 bytes
+#define I2CQ_DEADLINE_MS 3    // checked on the tick, so 2-3 ms. A frame takes
+                              // 0.4 ms at 400 kHz, 1.6 ms at 100 kHz
+#define I2CQ_RETRIES 2
+
+// flags for i2cq_write
+#define I2CQ_FRAME 0x01       // a display frame, see above
+#define I2CQ_READ 0x02        // used by i2cq_read
+
+// transfer status, for i2cq_read
+#define I2CQ_PENDING 0
+#define I2CQ_DONE 1
+#define I2CQ_FAILED 2
+
+// the i2c_bus pins, for recovery. See i2c_master_conf.c
+#define I2CQ_PORT XMC_GPIO_PORT2
+#define I2CQ_SDA_PIN 10
+#define I2CQ_SCL_PIN 11
+
+/*************** types ***********************/
+typedef struct
+{
+  uint32_t queued;      // transfers queued
+  uint32_t merged;      // frames that replaced one still waiting
+  uint32_t full;        // transfers turned away, the queue was full
+  uint32_t done;
+  uint32_t failed;      // given up on after I2CQ_RETRIES
+  uint32_t errors;      // NACK, arbitration lost or bus error flagged
+  uint32_t timeouts;    // past the deadline
+  uint32_t retries;
+  uint32_t stuck;       // recoveries that found SDA held low
+  uint32_t max_us;      // longest from queued to done
+} i2cq_stats_t;
+
+extern i2cq_stats_t i2cq_stats;
+
+/******** function prototypes ***********/
+void i2cq_init(void);
+unsigned char i2cq_write(uint8_t address, const uint8_t* data, uint8_t len, uint8_t flags);
+unsigned char i2cq_read(uint8_t address, uint8_t pointer, uint8_t* data, uint8_t len,
+                        volatile uint8_t* status);
+unsigned char i2cq_busy(void);
+unsigned char i2cq_frame_pending(void);
+void i2cq_tx_done(void);
+void i2cq_rx_done(void);
+void i2cq_report(void);
+
+#endif /* I2CQ_H_ */
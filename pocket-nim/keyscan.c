@@ -0,0 +1,105 @@
+/***********************************************************
+ * keyscan.c
+ * Opt-in input driver that reads the buttons through the
+ * key matrix of the HT16K33 display driver.
+ * See keyscan.h for the wiring and how it works.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <DAVE.h>
+#include <stdio.h>
+#include "nim.h"
+#include "i2cq.h"
+#include "keyscan.h"
+
+/******** global variables **************/
+uint16_t keyscan_keys[KEYSCAN_LINES]; // keys held, a bit per ROW for each K line
+keyscan_stats_t keyscan_stats;
+uint32_t keyscan_int_ms;              // when INT was last seen asserted
+uint8_t keyscan_data[2*KEYSCAN_LINES];
+volatile uint8_t keyscan_read_status;
+unsigned char keyscan_reading;        // a read of the key data is queued
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* keyscan_init
+ * sets the ROW15/INT pin up as the interrupt output. The key scan
+ * itself runs whenever the oscillator is on (display_init), whose
+ * commands may still fill the queue.
+ */
+void
+keyscan_init(void)
+{
+  uint8_t cmd=KEYSCAN_ROW_INT;
+
+  while (!i2cq_write(KEYSCAN_ADDRESS, &cmd, 1, 0)) IDLE_WAIT();
+}
+
+/* keyscan_service
+ * called while waiting for a button. Queues a read of the key data
+ * if INT is asserted, and picks it up on a later call once it is in.
+ * Returns 1 if the keys held have changed.
+ */
+unsigned char
+keyscan_service(void)
+{
+  uint16_t keys;
+  uint32_t now=SYSTIMER_GetTime()/1000;
+  unsigned char i;
+  unsigned char changed=0;
+
+  if (keyscan_reading)
+  {
+    if (keyscan_read_status==I2CQ_PENDING)
+      return(0);
+    keyscan_reading=0;
+    if (keyscan_read_status!=I2CQ_DONE)
+      return(0); // INT is still asserted, so it is read again next time
+    keyscan_stats.reads++;
+    for (i=0; i<KEYSCAN_LINES; i++)
+    {
+      keys=(uint16_t)(keyscan_data[2*i] | ((keyscan_data[2*i+1] & 0x1f)<<8));
+      if (keys!=keyscan_keys[i])
+      {
+        keyscan_keys[i]=keys;
+        changed=1;
+      }
+    }
+  }
+  else if (DIGITAL_IO_GetInput(&button1)==0)
+  {
+    keyscan_int_ms=now;
+    keyscan_reading=i2cq_read(KEYSCAN_ADDRESS, KEYSCAN_KEY_DATA, keyscan_data, 2*KEYSCAN_LINES,
+                              &keyscan_read_status);
+  }
+  else if ((now-keyscan_int_ms)>=KEYSCAN_RELEASE_MS)
+  {
+    for (i=0; i<KEYSCAN_LINES; i++)
+    {
+      if (keyscan_keys[i]!=0)
+      {
+        keyscan_keys[i]=0;
+        changed=1;
+      }
+    }
+    if (changed)
+      keyscan_stats.releases++;
+  }
+  if (changed)
+    keyscan_stats.changes++;
+  return(changed);
+}
+
+/* keyscan_report
+ * prints the key data traffic
+ */
+void
+keyscan_report(void)
+{
+  printf("keyscan: %lu key data reads, %lu changes, %lu all-released timeouts\n",
+         (unsigned long)keyscan_stats.reads, (unsigned long)keyscan_stats.changes,
+         (unsigned long)keyscan_stats.releases);
+}
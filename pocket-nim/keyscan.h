@@ -0,0 +1,75 @@
+/***********************************************************
+ * keyscan.h
+ * Opt-in input driver that reads the buttons through the
+ * key matrix of the HT16K33 display driver.
+ *
+ * The HT16K33 scans a 13x3 key matrix (ROW0-12 by K1-K3) by
+ * itself, and only sets a key's bit in its key data RAM once it
+ * has been seen pressed on two scans in a row, so it debounces
+ * too. Its ROW15/INT pin is set up as an active low interrupt
+ * output, which is asserted while there is key data to be read.
+ *
+ * With DO_KEYSCAN enabled:
+ *  - the buttons are wired to K1: row button n to ROW(n-1), and
+ *    the computer button to ROW5 (with a diode each, since the
+ *    ROW pins also drive the display)
+ *  - the INT pin is wired to the button 1 input (P0.0 on the
+ *    host simulation), which has the pull-up it needs
+ *  - fast_tick no longer reads or debounces the buttons. Instead,
+ *    whenever the game waits for a button, keyscan_service()
+ *    checks the INT pin and only then queues a read of the key data
+ *    RAM (see i2cq.h), which it picks up on a later call once it is
+ *    in. Reading it clears INT, and the chip sets it again on
+ *    the next scan for as long as a key is held, so when INT stays
+ *    clear for KEYSCAN_RELEASE_MS all the keys have been released.
+ * The key data is passed on to the existing button_status
+ * handling in main.c. All 39 keys are available in keyscan_keys,
+ * a 13 bit mask of ROW0-12 for each of K1-K3.
+ *
+ * A press is only seen once the chip has scanned it twice, so it
+ * takes a little longer to register than a GPIO button.
+ *
+ * INT is polled, not taken as an interrupt: that would need an ERU
+ * event on the pin, which the DAVE project doesn't have. The wait
+ * loops wake on at least every 1 ms tick, so INT is seen up to 1 ms
+ * after it is asserted, and reading the key data (9 bytes on the bus)
+ * takes about 0.85 ms more at 100 kHz. While the game isn't waiting
+ * (a tone, the computer's move, a blocking scroll) INT isn't looked at
+ * and a press is picked up afterwards; the chip holds the key data
+ * until it is read, so it isn't lost.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef KEYSCAN_H_
+#define KEYSCAN_H_
+
+// # uncomment to read the buttons through the HT16K33 key matrix
+//#define DO_KEYSCAN
+
+#include <stdint.h>
+
+/*************** definitions *****************/
+#define KEYSCAN_ADDRESS 0xe0      // the display's HT16K33
+#define KEYSCAN_KEY_DATA 0x40     // key data address pointer
+#define KEYSCAN_ROW_INT 0xa1      // ROW15/INT pin is INT, active low
+#define KEYSCAN_LINES 3           // K1-K3
+#define KEYSCAN_RELEASE_MS 50     // over two key scans
+
+/*************** types ***********************/
+typedef struct
+{
+  uint32_t reads;       // key data RAM reads
+  uint32_t changes;     // reads that changed the keys held
+  uint32_t releases;    // all keys released, by INT staying clear
+} keyscan_stats_t;
+
+extern uint16_t keyscan_keys[KEYSCAN_LINES];
+extern keyscan_stats_t keyscan_stats;
+
+/******** function prototypes ***********/
+void keyscan_init(void);
+unsigned char keyscan_service(void);
+void keyscan_report(void);
+
+#endif /* KEYSCAN_H_ */
@@ -0,0 +1,258 @@
+/***********************************************************
+ * latency.c
+ * Latency histograms for pocket-nim.
+ * See latency.h for what is measured and how to read it.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <DAVE.h>
+#include <stdio.h>
+#include "ram_code.h"
+#include "latency.h"
+
+/*************** definitions *****************/
+#define CYCLES_PER_US (SYSTIMER_SYSTICK_CLOCK/1000000U)
+
+/******** global variables **************/
+latency_hist_t latency_hist[LAT_NUM];
+const char* const latency_name[LAT_NUM]={"input->display", "release->move"};
+uint32_t latency_boot_cycles[BOOT_PHASES];
+uint8_t latency_boot_marked; // a bit per phase
+const char* const latency_boot_name[BOOT_PHASES]={"dave", "inputs", "storage", "display", "shown", "ready"};
+
+/***** extern variables *******/
+extern volatile uint32_t g_systick_count; // maintained by the SYSTIMER APP
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* bucket_of
+ * the bucket for a latency of us microseconds. Below 4us the
+ * buckets are 1us wide, above that each power of two is split
+ * into LAT_SUB_BUCKETS. There is no CLZ on the M0, so shift.
+ * In SRAM, as latency_frame_shown() calls it.
+ */
+static RAM_CODE unsigned int
+bucket_of(uint32_t us)
+{
+  unsigned int msb=2;
+  unsigned int idx;
+
+  if (us<LAT_SUB_BUCKETS)
+    return(us);
+  while ((us>>(msb+1))!=0)
+    msb++;
+  idx=(msb-1)*LAT_SUB_BUCKETS+((us>>(msb-2)) & (LAT_SUB_BUCKETS-1));
+  if (idx>=LAT_BUCKETS)
+    idx=LAT_BUCKETS-1;
+  return(idx);
+}
+
+/* bucket_top
+ * the largest latency in microseconds that falls in bucket idx
+ */
+static uint32_t
+bucket_top(unsigned int idx)
+{
+  unsigned int msb;
+  uint32_t sub;
+
+  if (idx+1<LAT_SUB_BUCKETS)
+    return(idx);
+  idx++; // the bottom of the next bucket, less one
+  msb=idx/LAT_SUB_BUCKETS+1;
+  sub=idx%LAT_SUB_BUCKETS;
+  return(((LAT_SUB_BUCKETS+sub)<<(msb-2))-1);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* cycles_now
+ * a free running CPU cycle count, made from the tick count and
+ * the SysTick current value. It wraps after about two minutes,
+ * which is fine for measuring intervals.
+ */
+uint32_t
+cycles_now(void)
+{
+  uint32_t primask;
+  uint32_t val;
+  uint32_t tick;
+  uint32_t reload;
+
+  primask=__get_PRIMASK();
+  __disable_irq();
+  reload=SysTick->LOAD;
+  val=SysTick->VAL;
+  tick=g_systick_count;
+  if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0)
+  {
+    // the counter has wrapped but the tick interrupt hasn't run yet
+    val=SysTick->VAL;
+    tick++;
+  }
+  __set_PRIMASK(primask);
+  return(tick*(reload+1)+(reload-val));
+}
+
+/* latency_start
+ * an event has happened. Called from the tick interrupt and
+ * from the main loop.
+ */
+void
+latency_start(unsigned char ev)
+{
+  latency_hist[ev].start=cycles_now();
+  latency_hist[ev].pending=1;
+}
+
+/* latency_cancel
+ * the pending event won't be followed by what it measures
+ * (e.g. the computer doesn't move because the user has won)
+ */
+void
+latency_cancel(unsigned char ev)
+{
+  latency_hist[ev].pending=0;
+}
+
+/* latency_frame_shown
+ * display_write has sent a frame, or found the display already
+ * showing it (changed 0). Ends the pending events, but a frame
+ * that changed nothing can't have shown the computer's move, so
+ * LAT_MOVE waits for one that did.
+ */
+void
+latency_frame_shown(unsigned char changed)
+{
+  unsigned char ev;
+  uint32_t now;
+  uint32_t us;
+  uint32_t primask;
+  latency_hist_t* h;
+
+  now=cycles_now();
+  if ((latency_boot_marked & ((1U<<BOOT_DISPLAY) | (1U<<BOOT_SHOWN)))==(1U<<BOOT_DISPLAY))
+  {
+    latency_boot(BOOT_SHOWN); // the first frame since the display was set up
+  }
+  for (ev=0; ev<LAT_NUM; ev++)
+  {
+    if ((ev==LAT_MOVE) && !changed)
+      continue;
+    h=&latency_hist[ev];
+    primask=__get_PRIMASK();
+    __disable_irq();
+    if (!h->pending)
+    {
+      __set_PRIMASK(primask);
+      continue;
+    }
+    h->pending=0;
+    us=(now-h->start)/CYCLES_PER_US;
+    __set_PRIMASK(primask);
+
+    h->count++;
+    if (us>h->max_us)
+      h->max_us=us;
+    if (h->bins[bucket_of(us)]!=0xffff)
+      h->bins[bucket_of(us)]++;
+  }
+}
+
+/* latency_percentile
+ * returns the latency in microseconds that pct percent of the events
+ * came in under, to the resolution of a bucket. 0 if there were none.
+ */
+uint32_t
+latency_percentile(unsigned char ev, unsigned int pct)
+{
+  latency_hist_t* h=&latency_hist[ev];
+  uint32_t rank;
+  uint32_t seen=0;
+  unsigned int i;
+
+  if (h->count==0)
+    return(0);
+  rank=(h->count*pct+99)/100; // ceil, so that p100 is the last event
+  if (rank==0)
+    rank=1;
+  for (i=0; i<LAT_BUCKETS; i++)
+  {
+    seen+=h->bins[i];
+    if (seen>=rank)
+      break;
+  }
+  if ((i>=LAT_BUCKETS) || (bucket_top(i)>h->max_us))
+    return(h->max_us);
+  return(bucket_top(i));
+}
+
+/* latency_report
+ * prints count, p50, p99 and max for each latency
+ */
+void
+latency_report(void)
+{
+  unsigned char ev;
+  for (ev=0; ev<LAT_NUM; ev++)
+  {
+    printf("latency %-15s n=%lu p50=%luus p99=%luus max=%luus\n", latency_name[ev],
+           (unsigned long)latency_hist[ev].count,
+           (unsigned long)latency_percentile(ev, 50), (unsigned long)latency_percentile(ev, 99),
+           (unsigned long)latency_hist[ev].max_us);
+  }
+}
+
+/* latency_boot
+ * marks the end of a boot phase. Only the first mark counts.
+ */
+void
+latency_boot(unsigned char phase)
+{
+  if (latency_boot_marked & (1U<<phase))
+    return;
+  latency_boot_cycles[phase]=cycles_now();
+  latency_boot_marked|=(uint8_t)(1U<<phase);
+}
+
+/* latency_boot_report
+ * prints when each boot phase ended, in the order they were reached,
+ * and how long after the one before
+ */
+void
+latency_boot_report(void)
+{
+  unsigned char phase, next;
+  uint8_t done=0;
+  uint32_t prev=0;
+
+  for (;;)
+  {
+    // the earliest phase not yet printed
+    next=BOOT_PHASES;
+    for (phase=0; phase<BOOT_PHASES; phase++)
+    {
+      if (!(latency_boot_marked & (1U<<phase)) || (done & (1U<<phase)))
+        continue;
+      if ((next==BOOT_PHASES) || (latency_boot_cycles[phase]<latency_boot_cycles[next]))
+        next=phase;
+    }
+    if (next==BOOT_PHASES)
+      break;
+    done|=(uint8_t)(1U<<next);
+    printf("boot %-8s at %8luus (+%luus)\n", latency_boot_name[next],
+           (unsigned long)(latency_boot_cycles[next]/CYCLES_PER_US),
+           (unsigned long)((latency_boot_cycles[next]-prev)/CYCLES_PER_US));
+    prev=latency_boot_cycles[next];
+  }
+  for (phase=0; phase<BOOT_PHASES; phase++)
+  {
+    if (!(latency_boot_marked & (1U<<phase)))
+      printf("boot %-8s not reached\n", latency_boot_name[phase]);
+  }
+}
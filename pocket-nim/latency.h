@@ -0,0 +1,80 @@
+/***********************************************************
+ * latency.h
+ * Latency histograms for pocket-nim.
+ *
+ * Two latencies are measured on every event:
+ *   LAT_INPUT  row button press registered -> display updated
+ *   LAT_MOVE   computer button released -> computer move shown
+ * An event starts when the press is registered in the tick interrupt,
+ * or when user_play sees the release (latency_start), and ends when
+ * display_write has sent the next frame (latency_frame_shown). For
+ * LAT_MOVE it has to be a frame that changed the display: the move
+ * animation starts on the board as it was.
+ *
+ * Each histogram is a fixed block of log spaced buckets, four per
+ * power of two of microseconds, so a bucket is at most 25% wide and
+ * the range goes up to over two minutes.
+ *
+ * The boot is timed too: main() marks the end of each phase with
+ * latency_boot(), and latency_boot_report() prints when each ended,
+ * in the order they were reached.
+ * The times count from when DAVE_Init started the SysTick, so the
+ * clock set up before that isn't included.
+ *
+ * The histograms can be read over the debug channel: with DO_DEBUG
+ * enabled latency_report() prints them at the start of every game,
+ * or from gdb with
+ *   print latency_hist
+ * The host simulation prints the report at the end of each run.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include <stdint.h>
+#include "ram_code.h"
+
+/*************** definitions *****************/
+#define LAT_INPUT 0
+#define LAT_MOVE 1
+#define LAT_NUM 2
+
+// boot phases. The intro is sent in the background (see main.c), so
+// READY can come before SHOWN
+#define BOOT_DAVE 0     // DAVE APPs initialised
+#define BOOT_INPUTS 1   // buttons being read by the tick
+#define BOOT_STORAGE 2  // game log and snapshot read back
+#define BOOT_DISPLAY 3  // display powered and set up
+#define BOOT_SHOWN 4    // first frame of the intro or board sent
+#define BOOT_READY 5    // waiting for the first button
+#define BOOT_PHASES 6
+
+#define LAT_SUB_BUCKETS 4   // per power of two
+#define LAT_BUCKETS 104     // 1us .. 2^27us (134 s)
+
+/*************** types ***********************/
+typedef struct
+{
+  uint32_t count;    // events measured
+  uint32_t max_us;
+  uint32_t start;    // cycle count when the pending event started
+  uint8_t pending;
+  uint16_t bins[LAT_BUCKETS]; // saturating counts
+} latency_hist_t;
+
+extern latency_hist_t latency_hist[LAT_NUM];
+extern uint32_t latency_boot_cycles[BOOT_PHASES];
+
+/******** function prototypes ***********/
+RAM_CODE uint32_t cycles_now(void);
+RAM_CODE void latency_start(unsigned char ev);
+void latency_cancel(unsigned char ev);
+RAM_CODE void latency_frame_shown(unsigned char changed);
+uint32_t latency_percentile(unsigned char ev, unsigned int pct);
+void latency_report(void);
+RAM_CODE void latency_boot(unsigned char phase);
+void latency_boot_report(void);
+
+#endif /* LATENCY_H_ */
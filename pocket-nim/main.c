@@ -19,24 +19,34 @@
 
 /*************** include files ***************/
 #include <DAVE.h>
+#include "nim.h"
+#include "ram_code.h"
+#include "profile.h"
+#include "pcsample.h"
+#include "latency.h"
+#include "speculate.h"
+#include "gamelog.h"
+#include "snapshot.h"
+#include "keyscan.h"
+#include "i2cq.h"
+#include "display.h"
+#include "plot.h"
+#include "font_data.h"
+#include "anim_data.h"
+#include "nimk.h"
+#include "wythoff.h"
+#include "distance.h"
+#include "mistake.h"
+#include "classic.h"
 #ifdef DO_DEBUG
 #include <stdio.h>
 #endif
 
 /*************** definitions *****************/
-#define led_address 0xe0
-// maximum possible rows containing sticks at the start of a game.
-// limit is 8, due to this code using unsigned chars in places
-#define MAXROWS 5
 #define NUM_BUTTONS 6
 #define COMPUTER_BUTTON NUM_BUTTONS-1
 #define FOREVER 1
 
-// deliberate weakening on the easier levels
-// lower number makes the computer play weaker.
-// 200U is about right it seems. Set to (say) 128U for an easier game
-#define WEAKNESS 200U
-
 // button status definitions
 #define UNPRESSED 0
 #define FIRST_PRESS 1
@@ -48,14 +58,17 @@
 #define RELEASE_TICK_PERIOD 60
 
 // display related
-#define ORIENTATION 0
+#define SCROLL_FRAMES 8   // 80 msec per step of a scrolling message
 
 // debug related
 #define HEARTBEAT_DELAY 500
 
+// reads a button input pin directly, for use in RAM_CODE functions. This is
+// the same as DIGITAL_IO_GetInput but doesn't branch back into flash
+#define BUTTON_INPUT(h) (((h)->gpio_port->IN >> (h)->gpio_pin) & 0x01U)
+
 /****** const variables *****************/
-const uint8_t display_init_data[3]={0x21, 0x81, 0xef}; // system osc. on, display on, max brightness
-// const bitmap for alphabet font is near the end of the file
+// the font is in font_data.h, made from font5x7.txt by host/mkfont
 
 /******** global variables **************/
 unsigned char numsticks[MAXROWS]; // this array holds the number of sticks in each row
@@ -63,6 +76,8 @@ unsigned char level=2; // difficulty, 1-5 with 5 being is hardest. The easier le
 unsigned char rows=4; // number of rows being played. Max is MAXROWS
 unsigned short int randreg=1; // this variable holds a random number
 unsigned char current_selection=0; // this variable stores what button was pressed
+unsigned char rows_taken=0; // a bit for each row the user has taken from this turn
+unsigned char awaiting_input=0; // set while user_play is waiting for a button press
 
 uint32_t timer_id;
 
@@ -73,11 +88,18 @@ unsigned int press_ticks=0; // a counter used primarily for debounce purposes
 unsigned char command_press=0; // A button press after the computer button was held down
 char playing=0; // this variable is set to 1 when a game is being played
 
-uint16_t display_ram[8];
 unsigned int general_timer=0;  // used for debug
-unsigned int display_update_timer=0; // used to allow the display some time after updates
+unsigned int display_update_timer=0; // used to pace the display, and for delays
 unsigned int heartbeat_timer=HEARTBEAT_DELAY; // used to flash an LED on the microcontroller board
 
+char* scroll_str; // the text message being scrolled, see scroll_start
+char scroll_len;
+char scroll_all;
+char scroll_i;
+char scroll_xmov;
+unsigned char scroll_active=0;
+unsigned char intro_playing=0; // the intro is scrolling while user_play waits
+
 /***** extern function prototypes *******/
 #ifdef DO_DEBUG
 extern void initialise_monitor_handles(void); // used to allow printf to work
@@ -91,16 +113,18 @@ char user_play(void);
 void computer_play(void);
 
 // button related
-void fast_tick(void);
+RAM_CODE void fast_tick(void);
 char a_button_pressed(void);
+unsigned char flash_quiet(void);
+void read_buttons(void);
 
 // display related
-void display_init(void);
-void display_write(void);
-void display_ram_blank(void);
-void plot_ram_pixel(int x, int y);
-void plot_ram_rows(unsigned char* rows_arr);
+unsigned char display_due(void);
 void scroll_text(char* text, char len, char all);
+void scroll_start(char* text, char len, char all);
+unsigned char scroll_step(void);
+unsigned int font_glyph(char c);
+RAM_CODE void scroll_slice(unsigned int idx_a, unsigned int idx_b, char xmov);
 
 // sound related
 void play_tone(char type);
@@ -118,7 +142,9 @@ int main(void)
   char sel;
   char check_winner;
   char winner_announced;
-  unsigned char oldnumsticks[MAXROWS]; // used to blink the computer move a few times on the display
+  unsigned char resumed;
+  unsigned char celebrate;
+  unsigned char oldnumsticks[MAXROWS]; // used to animate the computer move on the display
 
   status = DAVE_Init();           /* Initialization of DAVE APPs  */
   if(status != DAVE_STATUS_SUCCESS)
@@ -126,58 +152,125 @@ int main(void)
     XMC_DEBUG("DAVE APPs initialization failed\n");
     while(1);
   }
+  latency_boot(BOOT_DAVE);
 
   set_led(1); // turn on the LED on the microcontroller board (LED2) briefly for debug purposes
 
+  // the tick function reads the buttons, so set up their handles first
+  button_handle[0]=(DIGITAL_IO_t*)&button1;
+  button_handle[1]=(DIGITAL_IO_t*)&button2;
+  button_handle[2]=(DIGITAL_IO_t*)&button3;
+  button_handle[3]=(DIGITAL_IO_t*)&button4;
+  button_handle[4]=(DIGITAL_IO_t*)&button5;
+  button_handle[5]=(DIGITAL_IO_t*)&button_computer;
+  for (i=0; i<NUM_BUTTONS; i++)
+  {
+	  button_status[i]=UNPRESSED;
+  }
+
   // create and start up the timer for the periodic tick function
   timer_id=(uint32_t)SYSTIMER_CreateTimer(MILLISEC,
 		   SYSTIMER_MODE_PERIODIC,(void*)fast_tick,NULL);
   SYSTIMER_StartTimer(timer_id);
+  i2cq_init(); // display transfers go through a queue, pumped by its own tick
+  latency_boot(BOOT_INPUTS);
+  PROF_INIT();
+  PCSAMPLE_INIT();
 #ifdef DO_DEBUG
   initialise_monitor_handles();
 #endif
 
-display_update_timer=10;
-while(display_update_timer>0); // delay to allow power to settle
-display_ram_blank();
-display_init();
-display_update_timer=100;
-while(display_update_timer>0); // delay to allow display to be initialised
-set_led(0);
+  // allow the display power to settle, and read back what is kept
+  // in flash in the meantime
+  display_update_timer=10;
+  // carry on at the level that was last played, if the game log has it
+  i=gamelog_init();
+  if (i!=0)
+  {
+    level=i;
+  }
+  // ..or with the game itself, if the power went during one
+  resumed=snapshot_restore();
+  latency_boot(BOOT_STORAGE);
+  while(display_update_timer>0) IDLE_WAIT(); // delay to allow power to settle
+  display_ram_blank();
+  display_init();
+#ifdef DO_KEYSCAN
+  keyscan_init();
+#endif
+  // delay to allow display to be initialised. The oscillator only needs
+  // to have started (1 msec) before the first frame
+  display_update_timer=1;
+  while(display_update_timer>0) IDLE_WAIT();
+  latency_boot(BOOT_DISPLAY);
+  set_led(0);
 
 #ifdef DO_DEBUG
   printf("Hello\n");
 #endif
 
-  scroll_text("HELLO  ", 7, 0); // lowercase is not supported! And pad with 2 spaces at the end.
-
-  button_handle[0]=(DIGITAL_IO_t*)&button1;
-  button_handle[1]=(DIGITAL_IO_t*)&button2;
-  button_handle[2]=(DIGITAL_IO_t*)&button3;
-  button_handle[3]=(DIGITAL_IO_t*)&button4;
-  button_handle[4]=(DIGITAL_IO_t*)&button5;
-  button_handle[5]=(DIGITAL_IO_t*)&button_computer;
-  for (i=0; i<NUM_BUTTONS; i++)
+  if (!resumed)
   {
-	  button_status[i]=UNPRESSED;
+    // the intro scrolls while user_play waits, and the first button press
+    // cuts it short
+    scroll_start("HELLO  ", 7, 0); // pad with 2 spaces at the end.
+    scroll_step();
+    intro_playing=1;
   }
 
   while(FOREVER)
   {
-    setup_game();
+#ifdef DO_DEBUG
+    latency_boot_report();
+    latency_report();
+    speculate_report();
+    gamelog_report();
+    snapshot_report();
+    i2cq_report();
+    display_report();
+    anim_report();
+#ifdef DO_KEYSCAN
+    keyscan_report();
+#endif
+#endif
+    if (resumed)
+    {
+      // carry on with the restored game. How it started was lost with
+      // the power, so it isn't logged
+      resumed=0;
+    }
+    else
+    {
+      setup_game();
+      gamelog_game_start();
+    }
+    snapshot_live(1);
+    snapshot_save();
     winner_announced=0; // no-one has won this new game yet
-    show_status();
+    if (!intro_playing && !anim_active)
+    {
+      show_status();
+    }
     // wait in case a button is pressed, for it to be released
-    while(a_button_pressed());
+    while(a_button_pressed()) IDLE_WAIT();
     playing=1;
     while(playing)
     {
        sel=user_play();
        if (sel==9) // a selection of 9 means the user has pressed the Computer button
        {
+         if ((current_selection!=0) && (winner_announced==0))
+         {
+           gamelog_move(); // the user has finished their move
+         }
+         else if (winner_announced==0)
+         {
+           gamelog_pass(); // the user has taken none
+         }
          // time for the computer to play. But first check, has the
          // user actually won?
          check_winner=0;
+         celebrate=0;
          for (i=0; i<rows; i++)
          {
            check_winner+=numsticks[i];
@@ -186,11 +279,16 @@ set_led(0);
          {
            if (winner_announced==0)
            {
+             latency_cancel(LAT_MOVE); // the computer won't be moving
              display_update_timer=1000;
-             while(display_update_timer); // wait a bit. Because the computer is a sore loser
+             while(display_update_timer) IDLE_WAIT(); // wait a bit. Because the computer is a sore loser
              play_tone(1); // play rising tone
-             scroll_text("YOU WIN  ", 9, 0);
+             scroll_text("YOU WIN " FONT_CUP "  ", 11, 0);
+             celebrate=1;
              winner_announced=1;
+             snapshot_live(0);
+             snapshot_save();
+             gamelog_game_end(GAMELOG_PLAYER);
            }
          }
          else
@@ -198,7 +296,7 @@ set_led(0);
            check_winner=0;
          }
          // make a backup of the number of sticks before the computer plays
-         // so we can do a blinking animation of the computer move
+         // so we can animate the computer move
          for (i=0; i<rows; i++)
          {
            oldnumsticks[i]=numsticks[i];
@@ -206,18 +304,8 @@ set_led(0);
          if (winner_announced==0)
          {
            computer_play();
-         }
-         // lets blink the computer played move a few times
-         for (i=0; i<2; i++)
-         {
-           plot_ram_rows(numsticks);
-           display_write();
-           display_update_timer=200;
-           while(display_update_timer);
-           plot_ram_rows(oldnumsticks);
-           display_write();
-           display_update_timer=200;
-           while(display_update_timer);
+           gamelog_move();
+           snapshot_save(); // the turn is over, so keep it however quick it was
          }
          // has computer won?
          if ((check_winner==0) && (winner_announced==0)) // computer has not lost yet..
@@ -226,25 +314,58 @@ set_led(0);
            {
              check_winner+=numsticks[i];
            }
-           if (check_winner==1) // computer won
-           {
-             show_status();
-             display_update_timer=1000;
-             while(display_update_timer);
-             play_tone(0); // play falling tone
-             scroll_text("LOSER  ", 7, 0);
-             winner_announced=1;
-           }
+         }
+         else
+         {
+           check_winner=0;
+         }
+         // the animations play out while the player thinks (see user_play),
+         // unless the game is over
+         if (celebrate)
+         {
+           anim_start(ANIM_WIN, NULL, NULL);
+           anim_step();
+         }
+         else if (check_winner!=1)
+         {
+           anim_start(ANIM_MOVE, oldnumsticks, numsticks);
+           anim_step();
+         }
+         else // computer won
+         {
+           anim_play(ANIM_MOVE, oldnumsticks, numsticks);
+           show_status();
+           display_update_timer=1000;
+           while(display_update_timer) IDLE_WAIT();
+           play_tone(0); // play falling tone
+           scroll_text("LOSER " FONT_FROWN "  ", 9, 0);
+           winner_announced=1;
+           snapshot_live(0);
+           snapshot_save();
+           gamelog_game_end(GAMELOG_COMPUTER);
          }
        }
        else if (sel>100) // this signifies that a command has arrived (Computer button was held down and another button pressed)
        {
          // start a new game, at the level selected in the command
+         if (winner_announced==0)
+         {
+           gamelog_game_end(GAMELOG_ABANDONED);
+         }
+         if (level!=sel-100)
+         {
+           gamelog_level(sel-100);
+         }
          level=sel-100;
          playing=0;
          command_press=0;
+         anim_start(ANIM_LEVEL1+level-1, NULL, NULL); // the board follows, see user_play
+         anim_step();
+       }
+       if (!anim_active)
+       {
+         show_status();
        }
-       show_status();
     }
   }
 
@@ -265,6 +386,7 @@ a_button_pressed(void)
 {
   char status=0; // assume no button is pressed
   unsigned char i;
+  read_buttons();
   for (i=0; i<NUM_BUTTONS; i++)
   {
     if (button_status[i]!=UNPRESSED)
@@ -282,6 +404,79 @@ a_button_pressed(void)
   return(status);
 }
 
+/* flash_quiet
+ * returns 1 if nothing is under way that a flash erase would hold up.
+ * The erase stalls the CPU for several ms, and the interrupts with it,
+ * as their handlers and the data they read (e.g. the button handles)
+ * are in flash. So no button may be held or being debounced by
+ * fast_tick, and no display transfer may be in the i2cq queue, which is
+ * pumped from the tick. A tone is only played in between the waits
+ * that call this, but the intro and the animations must not be
+ * playing, or they would stutter.
+ */
+unsigned char
+flash_quiet(void)
+{
+  unsigned char i;
+
+  for (i=0; i<NUM_BUTTONS; i++)
+  {
+    if (button_status[i]!=UNPRESSED)
+      return(0);
+  }
+  return((do_all_button_inhibit==0) && !intro_playing && !anim_active && !i2cq_busy());
+}
+
+/* read_buttons
+ * with DO_KEYSCAN, the buttons are read from the HT16K33 key matrix
+ * (see keyscan.h) whenever the game waits for them. Otherwise
+ * fast_tick reads them, and there is nothing to do.
+ */
+void
+read_buttons(void)
+{
+#ifdef DO_KEYSCAN
+  unsigned char i;
+  unsigned char pressed=0;
+  unsigned char already_recorded_press=0;
+  uint16_t keys;
+
+  if (!keyscan_service())
+    return;
+  keys=keyscan_keys[0]; // K1
+  // the same rules as fast_tick: a press only registers if no other
+  // button is held, apart from the Computer+Row command
+  for (i=0; i<NUM_BUTTONS; i++)
+  {
+    if (button_status[i]==UNPRESSED)
+    {
+      if ((keys & (1U<<i)) && (pressed==0))
+        pressed=i+1;
+    }
+    else if ((keys & (1U<<i))==0)
+    {
+      button_status[i]=UNPRESSED; // released. The chip has debounced it
+    }
+    else
+    {
+      already_recorded_press=i+1;
+    }
+  }
+  if ((button_status[COMPUTER_BUTTON]!=UNPRESSED) && (pressed>0) && (pressed<NUM_BUTTONS) && playing)
+  {
+    command_press=pressed;
+  }
+  if ((already_recorded_press==0) && (pressed>0))
+  {
+    button_status[pressed-1]=FIRST_PRESS;
+    if (pressed-1<COMPUTER_BUTTON)
+    {
+      latency_start(LAT_INPUT);
+    }
+  }
+#endif
+}
+
 /* fast_tick
  * occurs every millisecond
  * we use this single timer to do several things,
@@ -290,10 +485,13 @@ a_button_pressed(void)
 void
 fast_tick(void)
 {
+#ifndef DO_KEYSCAN
 	unsigned char pressed=0;
 	unsigned char i;
 	unsigned char already_recorded_press=0;
+#endif
 
+	PROF_ENTER(fast_tick);
 	randreg++; // this acts like a seed to the random number generator
 
 	// some timers that can be set and read from the application
@@ -307,11 +505,11 @@ fast_tick(void)
 	  DIGITAL_IO_ToggleOutput(&led2);
 	}
 
-	// this timer is important for giving the display time to do its thing.
-	// otherwise the display can hang.
+	// this timer paces the display animations
 	if (display_update_timer>0)
 	  display_update_timer--;
 
+#ifndef DO_KEYSCAN // otherwise the HT16K33 does the scanning and debouncing
 	// Handle button presses. The strategy is that on each tick, the
 	// buttons are checked, and if one is pressed then it is registered
 	// as FIRST_PRESS in the button_status array. But if the array
@@ -331,7 +529,7 @@ fast_tick(void)
 		{
 			if (button_status[i]==UNPRESSED)
 			{
-				if (DIGITAL_IO_GetInput(button_handle[i])!=1)
+				if (BUTTON_INPUT(button_handle[i])!=1)
 				{
 					pressed=i+1;
 				}
@@ -359,6 +557,10 @@ fast_tick(void)
 		if ((already_recorded_press==0) && (pressed>0))
 		{
 			button_status[pressed-1]=FIRST_PRESS;
+			if (pressed-1<COMPUTER_BUTTON)
+			{
+				latency_start(LAT_INPUT);
+			}
 #ifdef DO_DEBUG
 			printf("pressed: %d\n", pressed-1);
 #endif
@@ -374,7 +576,7 @@ fast_tick(void)
 			}
 			else
 			{
-				if (DIGITAL_IO_GetInput(button_handle[already_recorded_press-1])!=1)
+				if (BUTTON_INPUT(button_handle[already_recorded_press-1])!=1)
 				{
 					// the button is still pressed.
 				}
@@ -402,6 +604,8 @@ fast_tick(void)
 			press_ticks=0;
 		}
 	}
+#endif
+	PROF_LEAVE(fast_tick);
 }
 
 /* random_num
@@ -429,19 +633,33 @@ void
 setup_game(void)
 {
   unsigned char i;
+  if (level==WYTHOFF_LEVEL)
+  {
+    // Wythoff's game, on two rows of 1 to 8 sticks
+    rows=2;
+    for (i=0; i<rows; i++)
+    {
+      numsticks[i]=random_num() & 0x07;
+      numsticks[i]++;
+    }
+    return;
+  }
   switch(level)
   {
     case 5: // hardest. Random number of sticks in each row.
-      // Note: the 8x8 LED matrix implementation will only have 4 rows
-      // and 4 buttons, so this level selection will not be possible.
+      // Note: a single 8x8 LED matrix only has room for 4 rows, so the
+      // 5th row needs a board at least 9 columns wide (see display.h)
       rows=5;
       for (i=0; i<rows; i++)
       {
         numsticks[i]=random_num() & 0x07;
         numsticks[i]++; // value is between 1 and 8
       }
-      //numsticks[0]++; // one row can have up to 9 (not possible with this display)
+#if DISPLAY_HEIGHT>8
+      numsticks[0]++; // one row can have up to 9, if the display is high enough
+#endif
       break;
+    // on levels 4 and 5, a turn can take from up to NIM_K rows (see nim.h)
     case 4: // hard. Random number of sticks in each row.
       rows=4;
       for (i=0; i<rows; i++)
@@ -483,8 +701,11 @@ user_play(void)
   int selection=0;
   unsigned char i;
 
+  awaiting_input=1;
+  latency_boot(BOOT_READY);
   while(waiting_for_press)
   {
+    read_buttons();
     for (i=0; i<NUM_BUTTONS; i++)
     {
       if (button_status[i]==FIRST_PRESS)
@@ -493,6 +714,13 @@ user_play(void)
     	  selection=i+1;
         button_status[i]=PRESS_ACTIONED;
         waiting_for_press=0;
+        if (intro_playing)
+        {
+          // cut the intro short. The board is shown once this press is actioned
+          intro_playing=0;
+          scroll_active=0;
+        }
+        anim_stop(); // ..and any animation
     	  if (i==COMPUTER_BUTTON)
     	  {
     	    selection=9; // arbitrarily use 9 to represent the computer move button
@@ -504,6 +732,12 @@ user_play(void)
     	    {
     	      if (command_press)
     	        break;
+    	      IDLE_WAIT();
+    	      read_buttons();
+    	    }
+    	    if (!command_press)
+    	    {
+    	      latency_start(LAT_MOVE); // released, the computer is up
     	    }
     	  }
     	  break;
@@ -517,246 +751,153 @@ user_play(void)
       // we use the number 100 to encode that this game command has been invoked.
       selection=100+command_press;
       current_selection=0; // reset, because we're starting a new game soon..
+      rows_taken=0;
+    }
+    if (waiting_for_press)
+    {
+      if (intro_playing && display_due() && !scroll_step())
+      {
+        // the intro has finished, show the game
+        intro_playing=0;
+        show_status();
+      }
+      if (anim_active && display_due() && !anim_step())
+      {
+        show_status(); // the animation has finished
+      }
+      speculate_step(); // use the wait to work out the computer's reply
+      // ..and to save the game, or erase flash ahead of the game log,
+      // when nothing is under way that the flash would hold up
+      if (flash_quiet() && !snapshot_idle())
+      {
+        gamelog_idle();
+      }
+      IDLE_WAIT();
     }
   }
+  awaiting_input=0;
 
 #ifdef DO_DEBUG
   XMC_DEBUG("row to decrement? [1-%d] or [9]computer move: ", rows);
   printf("selection is %d", selection);
   //TODO //scanf("%d", &selection);
 #endif
-  if ((selection<=rows) && (selection>0)) // a row button was pressed
+  if ((level==WYTHOFF_LEVEL) && (selection==WYTHOFF_BOTH))
+  {
+    // Wythoff's game: the button after the last row takes a stick from
+    // both rows, and then the user has to stick with it
+    if ((rows_taken==0) || (current_selection==selection))
+    {
+      if ((numsticks[0]>0) && (numsticks[1]>0))
+      {
+        numsticks[0]--;
+        numsticks[1]--;
+        current_selection=selection;
+        rows_taken=(unsigned char)(1<<(selection-1));
+      }
+    }
+  }
+  else if ((selection<=rows) && (selection>0)) // a row button was pressed
   {
     // check that the user isn't trying to take sticks from other rows!
-    // once they have chosen a row, they have to stick with that row
-    if ((current_selection==0) || (current_selection==selection))
+    // once they have chosen a row, they have to stick with that row (or,
+    // on the Nim_k levels, with the first few rows they chose)
+    if ((rows_taken & (1<<(selection-1))) || (count_ones(rows_taken)<ROWS_PER_MOVE(level)))
     {
       if (numsticks[selection-1]>0)
       {
         numsticks[selection-1]--;
         current_selection=selection;
+        rows_taken|=(unsigned char)(1<<(selection-1));
       }
     }
   }
   return(selection);
 }
 
-/* count_ones
- * this function counts up how many binary digits are 1
- */
-unsigned char
-count_ones(unsigned char value)
-{
-  char i;
-  char sum=0;
-
-  for (i=0; i<8; i++)
-  {
-    if ((value & (1<<i)) != 0)
-      sum++;
-  }
-  return(sum);
-}
-
-
 /* computer_play
- * This function is the computer's algorithm, to try to beat the user.
+ * makes the computer's move. Usually it has already been worked out
+ * while the user was deciding (see speculate.c), otherwise it is
+ * worked out now.
  */
 void
 computer_play(void)
 {
-  unsigned char x=numsticks[0]; // x is the variable X in the Wikipedia article for Nim
-  unsigned char interim_xor[MAXROWS]; // this array holds "the nim-sum of X and heap-size" for each row (see Wikipedia article for Nim)
-  unsigned char playable_rows_bitmap=0;
-  unsigned char num_playable_rows=0;
-  unsigned char candidate[MAXROWS]; // this array holds an idea for the the number of sticks to leave remaining in a row.
-  unsigned char quality[MAXROWS]; // a quality value (higher is better) for how good the candidate idea is
-  unsigned char peak_quality=0;
-  unsigned char peak_candidate=0;
-  unsigned char unitychecknotneeded=0; // we need to check how many rows have only one stick remaining, as part of the algorithm. This variable helps with the algorithm.
-
-  int i;
-  char j, temp;
-  char unityheaps=0;
-
-  // now the computer is playing. Reset the button selection for the user,
-  // so that when it is their turn, they will be free to choose any row.
-  current_selection=0;
-
-  for (i=0; i<MAXROWS; i++)
-  {
-    quality[i]=0; // initialize the quality array
-  }
+  unsigned char row, left;
+  unsigned char i;
+  uint32_t heaps[MAXROWS], after[MAXROWS];
+  unsigned char pair[2];
+  unsigned char threshold; // of a mistake, out of 256
+  uint32_t start;
 
-  // find the best possible move, using the sum of
-  // powers of two method, which is basically a
-  // lot of XORing
-  for (i=1; i<rows; i++)
+  PROF_ENTER(computer_play);
+  if (level==WYTHOFF_LEVEL)
   {
-    x=x^numsticks[i];
+    // Wythoff's game, from the cold pair tables
+    wythoff_choose(numsticks, pair);
+    numsticks[0]=pair[0];
+    numsticks[1]=pair[1];
   }
-  XMC_DEBUG("x=%d\n", x);
-  if (x>0)
+  else if (ROWS_PER_MOVE(level)>1)
   {
+    // Moore's Nim_k. It is quick enough to work out on demand
     for (i=0; i<rows; i++)
     {
-      interim_xor[i]=x^numsticks[i];
-      if (interim_xor[i]<numsticks[i])
-      {
-        playable_rows_bitmap |= 1<<i;
-      }
+      heaps[i]=numsticks[i];
     }
-    XMC_DEBUG("interim_xor are %d, %d, %d, %d\n", interim_xor[0], interim_xor[1], interim_xor[2], interim_xor[3]);
-    num_playable_rows=count_ones(playable_rows_bitmap);
-    XMC_DEBUG("num_playable_rows=%d\n", num_playable_rows);
-    if (num_playable_rows>=1)
-    {
-      // overall strategy: find some possible moves, and give them a weight
-      // and then we'll pick the best of the lot.
-      for (i=rows-1; i>=0; i--)
-      {
-        if ((playable_rows_bitmap & (1<<i)) != 0) // i is a playable row
-        {
-          unitychecknotneeded=0;
-          XMC_DEBUG("testing candidate %d\n", i);
-          temp=interim_xor[i]; // reduce size of heap to XOR of its original size with x
-          // if we make the temp move real, will it leave only heaps with size 1?
-
-          if (temp==1)
-            unityheaps++;
-          for (j=0; j<rows; j++)
-          {
-            if (j!=i)
-            {
-              if (numsticks[(unsigned char)j]==1)
-              {
-                unityheaps++;
-              }
-              else if (numsticks[(unsigned char)j]>1)
-              {
-                unitychecknotneeded=1;
-              }
-            }
-          }
-          if ((temp<=1) && (unitychecknotneeded==0))
-          {
-            // is unityheaps odd? We want that..
-            if ((unityheaps & 1) != 0)
-            {
-              // make the move permanent
-              candidate[i]=temp;
-              quality[i]+=10;
-            } // unityheaps would be even with that move. so take different action.
-            else if (temp==1)
-            {
-              // we can reduce to zero.
-              candidate[i]=0;
-              quality[i]+=5; // this move should be good too
-            }
-            else
-            {
-              if (temp==0)
-              {
-                if (numsticks[i]>1)
-                {
-                  // we can leave one stick, to make it odd again
-                  candidate[i]=1;
-                  quality[i]+=9; // this move should be good
-                }
-              }
-              else
-              {
-                // this won't be a nice move to make. But it is a valid move.
-                candidate[i]=temp;
-                quality[i]+=1;
-              }
-            }
-          }
-          else
-          {
-            // this action won't result in all heaps containing 1
-            // it could be a good move.
-            candidate[i]=temp;
-            quality[i]+=9;
-
-          }
-          XMC_DEBUG("candidate %d quality is %d\n", i, quality[i]);
-
-        } // end of if ((playable_rows_bitmap & 1<<i) != 0)
-        // loop to get another candidate
-      } // end of for (i=rows-1; i>=0; i--)
-      // ok we have at least one playable move. Find the highest quality move.
-      XMC_DEBUG("quality table: %d %d %d %d\n", quality[0], quality[1], quality[2], quality[3]);
-      XMC_DEBUG("finding highest quality move\n");
-      for (i=0; i<rows; i++)
-      {
-        if (quality[i]>=peak_quality)
-        {
-          peak_quality=quality[i];
-          peak_candidate=i;
-          XMC_DEBUG("best so far is candidate %d\n", i);
-        }
-      }
-      // change the quality values to make the computer play weaker
-      // depending on level.
-      if ((level==1) || (level==2))
-      {
-        for (i=0; i<rows; i++)
-        {
-          if (numsticks[i]>1)
-          {
-            if (random_num()>WEAKNESS)
-            {
-              candidate[i]=numsticks[i]-1;
-              quality[i]=peak_quality+1;
-              if (random_num()>128U)
-              {
-                quality[i]++;
-              }
-            }
-          }
-        }
-        // now find peak candidate again
-        peak_quality=0;
-        for (i=0; i<rows; i++)
-        {
-          if (quality[i]>=peak_quality)
-          {
-            peak_quality=quality[i];
-            peak_candidate=i;
-            XMC_DEBUG("weakened best candidate so far %d\n", i);
-          }
-        }
-
-      }
-      numsticks[peak_candidate]=candidate[peak_candidate];
-    } // end of if (num_playable_rows>=1)
-    else
+    nimk_choose(heaps, rows, ROWS_PER_MOVE(level), 1, after);
+    for (i=0; i<rows; i++)
     {
-      // we don't have a playable row in the bitmap!
-      // play any row we can..
-      for (i=0; i<rows; i++)
-      {
-        if (numsticks[i]>0)
-        {
-          numsticks[i]--;
-          i=rows;
-        }
-      }
+      numsticks[i]=(unsigned char)after[i];
     }
-  } // end of if (x>0)
+  }
   else
   {
-    // no strategy any more. play any row we can..
-    for (i=0; i<rows; i++)
+    if (!speculate_take(&row, &left))
     {
-      if (numsticks[i]>0)
-      {
-        numsticks[i]--;
-        i=rows;
-      }
+      start=cycles_now();
+      computer_choose(numsticks, &row, &left);
+      speculate_missed(cycles_now()-start);
+    }
+    // deliberate weakening on the easier levels (see mistake.h). It is
+    // drawn here, once a move, and not in computer_choose(), which
+    // speculate_step() calls for every count the row might be left at
+    threshold=mistake_threshold(level);
+    if (threshold>0)
+    {
+      mistake_make(numsticks, rows, random_num(), threshold, &row, &left);
+    }
+    if (row!=NO_MOVE)
+    {
+      numsticks[row]=left;
     }
   }
+  // now the computer is playing. Reset the button selection for the user,
+  // so that when it is their turn, they will be free to choose any row.
+  current_selection=0;
+  rows_taken=0;
+  PROF_LEAVE(computer_play);
+}
+
+/* computer_choose
+ * This function is the computer's algorithm, to try to beat the user.
+ * It works out a move for the position in sticks, without making it:
+ * the move is to leave *move_left sticks in row *move_row. If there
+ * is no stick left to take, *move_row is set to NO_MOVE.
+ * From DISTANCE_LEVEL up the move comes from the distance table
+ * (see distance.h), if the position is in it, and otherwise from
+ * classic_choose() (see classic.h).
+ */
+void
+computer_choose(const unsigned char* sticks, unsigned char* move_row, unsigned char* move_left)
+{
+  if ((level>=DISTANCE_LEVEL) && distance_fits(sticks, rows))
+  {
+    // the quickest win, or the slowest loss
+    distance_choose(sticks, rows, move_row, move_left);
+    return;
+  }
+  classic_choose(sticks, rows, move_row, move_left);
 }
 
 void
@@ -808,6 +949,7 @@ void
 play_tone(char type)
 {
   unsigned int i;
+  PROF_ENTER(play_tone);
   PWM_CCU4_Start(&pwm1);
   for (i=0; i<50; i++)
   {
@@ -820,265 +962,163 @@ play_tone(char type)
       PWM_CCU4_SetFreq(&pwm1, 500+(i*20));
     }
     general_timer=50;
-    while(general_timer);
+    while(general_timer) IDLE_WAIT();
   }
   PWM_CCU4_Stop(&pwm1);
+  PROF_LEAVE(play_tone);
 }
 
-/************** 8x8 LED Matrix display handling functions ************/
+/************** LED Matrix display pacing functions ************/
 
-/* display_init
- * initializes the display chip
+// the display itself is driven by display.c
+
+/* display_due
+ * returns 1 once the frame period set by scroll_step (or anim_step,
+ * or a delay) is over and the last frame has gone out. If the bus
+ * is slower than the frame period, the animation slows down to suit
+ * rather than frames being lost.
  */
-void
-display_init(void)
+unsigned char
+display_due(void)
 {
-  unsigned char i;
-  for (i=0; i<3; i++)
-  {
-    I2C_MASTER_Transmit(&i2c_bus, true, led_address, (uint8_t*)(&display_init_data[i]), 1, true);
-    while(I2C_MASTER_IsTxBusy(&i2c_bus));
-  }
+  return((display_update_timer==0) && !i2cq_frame_pending());
 }
 
-/* display_write
- * sends the display ram data to the display
+/* scroll_text
+ * This function will display a text message.
+ * It doesn't use any C library features, so
+ * it is limited. To fully scroll off a
+ * message, ensure there are two spaces at the end
+ * of the text array (and len increased by 2 to
+ * reflect that). The variable all, if set to 1,
+ * will wipe the bottom row of the display.
+ * If set to zero, it will leave the final
+ * stick at the bottom of the display.
  */
 void
-display_write(void)
+scroll_text(char* text, char len, char all)
 {
-  unsigned char i;
-
-  I2C_MASTER_SendStart(&i2c_bus, led_address, XMC_I2C_CH_CMD_WRITE);
-  //while(I2C_MASTER_GetFlagStatus(&i2c_bus, XMC_I2C_CH_STATUS_FLAG_ACK_RECEIVED) == 0U);
-  //I2C_MASTER_ClearFlag(&i2c_bus, XMC_I2C_CH_STATUS_FLAG_ACK_RECEIVED);
-
-  I2C_MASTER_TransmitByte(&i2c_bus, 0x00); // select display address 0x00
-  while(I2C_MASTER_IsTxBusy(&i2c_bus));
-
-  // now write out 128 bits, of which 64 correspond to the LEDs on an 8x8 module
-  for (i=0; i<8; i++)
+  PROF_ENTER(scroll_text);
+  scroll_start(text, len, all);
+  while (scroll_step())
   {
-    I2C_MASTER_TransmitByte(&i2c_bus, display_ram[i] & 0xff);
-    while(I2C_MASTER_IsTxBusy(&i2c_bus));
-    I2C_MASTER_TransmitByte(&i2c_bus, 0); // display IC has 16x8 bits RAM but display is 8x8 bits
-    while(I2C_MASTER_IsTxBusy(&i2c_bus));
+    while(!display_due()) IDLE_WAIT();
   }
-  I2C_MASTER_SendStop(&i2c_bus);
-
-  display_update_timer=10;
-  while(display_update_timer);
-
+  PROF_LEAVE(scroll_text);
 }
 
-/************* display ram related functions ***********/
-
-// all of these functions make modifications to the local ram representation
-// of the display. Nothing is actually updated on the display, until
-// display_write is called.
-
-/* display_ram_blank
- * sets the display ram to all blank.
- * Doesn't update to the display, call display_write to do that.
+/* scroll_start
+ * sets up a text message to be scrolled a step at a time with
+ * scroll_step, so that it can run in the background. scroll_text
+ * describes the arguments.
  */
 void
-display_ram_blank(void)
+scroll_start(char* text, char len, char all)
 {
   unsigned char i;
-  for (i=0; i<8; i++)
+
+  scroll_str=text;
+  scroll_len=len;
+  scroll_all=all;
+  scroll_i=0;
+  scroll_xmov=0; // the very first character starts off the display
+  scroll_active=(len>1);
+  for (i=8; i<DISPLAY_LINES; i++)
   {
-    display_ram[i]=0;
+    display_ram[i]=0; // the text is on panel 0, blank the rest of the board
   }
 }
 
-/* plot_ram_pixel
- * sets a pixel in the display ram.
- * Doesn't update the display, call display_write to do that.
+/* scroll_step
+ * displays the next step of the scroll, and sets display_update_timer
+ * for when the one after is due (see display_due). Returns 0 once the
+ * scroll is over.
  */
-void
-plot_ram_pixel(int x, int y)
+unsigned char
+scroll_step(void)
 {
-  switch(ORIENTATION) // for future use if the display orientation ever changes
+  char a, b; // two partial characters can be scrolled on the 8-wide display since each character is 5 bits wide
+  unsigned int idx_a, idx_b;
+
+  if (!scroll_active)
+    return(0);
+  // this algorithm revolves around reducing the problem to scrolling only
+  // two characters. At the appropriate point in the animation, a becomes
+  // the previous b, and the next character gets placed in b.
+  a=scroll_str[(unsigned char)scroll_i];
+  b=scroll_str[(unsigned char)(scroll_i+1)];
+  idx_a=font_glyph(a); // get an index into the font bitmap
+  idx_b=font_glyph(b); //
+
+  if (scroll_all)
   {
-  case 0:
-    x=8-x-1;
-    break;
-  default:
-    break;
+    display_ram[0]=0; // bottom row is blank
   }
-  x = x+7; // fixes an unusual mapping in the 8x8 display matrix
-  x = x%8; //
+  scroll_slice(idx_a, idx_b, scroll_xmov);
+  // display the ram
+  display_write();
+  display_update_timer=SCROLL_FRAMES*DISPLAY_FRAME_MS;
 
-  display_ram[y] |= 1<<x; // place the pixel into the local display ram
+  scroll_xmov++;
+  if (scroll_xmov>=11) // done scrolling these two characters
+  {
+    scroll_xmov=6;     // subsequent characters are placed at the correct point in the animation
+    scroll_i++;
+    if (scroll_i>=scroll_len-1)
+      scroll_active=0;
+  }
+  return(1);
 }
 
-/* plot_ram_rows
- * puts each row content into the local display ram. Use display_write to
- * then send it to the display module.
+/* font_glyph
+ * returns where the glyph for c starts in font_bits (see font.h), or
+ * that of FONT_MISSING if the font doesn't have c
  */
-void
-plot_ram_rows(unsigned char* rows_arr)
+unsigned int
+font_glyph(char c)
 {
-  unsigned char i, j;
-  display_ram_blank();
-  for (i=0; i<rows; i++)
+  unsigned char code=(unsigned char)c;
+  unsigned char i;
+
+  for (;;)
   {
-    if (rows_arr[i]>0)
+    for (i=0; i<FONT_RANGES; i++)
     {
-      for (j=0; j<rows_arr[i]; j++)
-      {
-        plot_ram_pixel((int)i*2, (int)j);
-      }
+      if ((code>=font_ranges[i].first) && (code<=font_ranges[i].last))
+        return((unsigned int)(font_ranges[i].glyph+code-font_ranges[i].first)*FONT_BITS);
     }
+    if (code==(unsigned char)FONT_MISSING)
+      return(0);
+    code=(unsigned char)FONT_MISSING;
   }
 }
 
-// a portion of the ASCII table as a 5x7 bitmap
-// stored as row bitmaps (i.e 7 values per character)
-// to make it a bit easier to map to the 8x8 LED display,
-// at the expense of a bit more ROM usage than storing
-// column bitmaps.
-// Also characters are reflected: the rightmost part of each character is the
-// LSB in this bitmap, just to map easier to the 8x8 display.
-// There may be visual errors in some of these bitmaps that may need
-// correction, since it was hand-coded, not automated, and not fully
-// checked yet.
-const unsigned char alpha_bitmap[]={
-0, 0, 0, 0, 0, 0, 0,         /*   */
-4, 0, 4, 4, 4, 4, 4,         /* ! */
-0, 0, 0, 0, 10, 10, 10,      /* " */
-10, 10, 31, 10, 31, 10, 10,  /* # */
-4, 30, 5, 14, 20, 15, 4,     /* $ */
-3, 19, 8, 4, 2, 25, 24,      /* % */
-13, 18, 21, 8, 20, 18, 12,   /* & */
-0, 0, 0, 0, 0, 4, 4,         /* ' */
-2, 3, 8, 8, 8, 4, 2,         /* ( */
-8, 4, 2, 2, 2, 4, 8,         /* ) */
-0, 4, 21, 14, 21, 4, 0,      /* * */
-0, 4, 4, 31, 4, 4, 0,        /* + */
-8, 4, 12, 0, 0, 0, 0,        /* , */
-0, 0, 0, 31, 0, 0, 0,        /* - */
-12, 12, 0, 0, 0, 0, 0,       /* . */
-0, 16, 8, 4, 2, 1, 0,        /* / */
-14, 17, 17, 17, 17, 17, 14,  /* 0 */
-14, 4, 4, 4, 4, 12, 4,       /* 1 */
-31, 16, 8, 6, 1, 17, 14,     /* 2 */
-14, 17, 1, 6, 1, 17, 14,     /* 3 */
-2, 2, 31, 18, 10, 6, 2,      /* 4 */
-14, 17, 1, 1, 30, 16, 31,    /* 5 */
-14, 17, 17, 30, 16, 8, 6,    /* 6 */
-8, 8, 8, 4, 2, 1, 31,        /* 7 */
-14, 17, 17, 14, 17, 17, 14,  /* 8 */
-12, 2, 1, 15, 17, 17, 14,    /* 9 */
-0, 12, 12, 0, 12, 12, 0,     /* : */
-8, 4, 12, 0, 12, 12, 0,      /* ; */
-2, 4, 8, 16, 8, 4, 2,        /* < */
-0, 0, 31, 0, 31, 0, 0,       /* = */
-8, 4, 2, 1, 2, 4, 8,         /* > */
-4, 0, 4, 2, 1, 17, 14,       /* ? */
-14, 21, 21, 13, 1, 17, 14,   /* @ */
-17, 17, 31, 17, 17, 10, 4,   /* A */
-30, 9, 9, 14, 9, 9, 30,      /* B */
-14, 17, 16, 16, 16, 17, 14,  /* C */
-30, 9, 9, 9, 9, 9, 30,       /* D */
-31, 16, 16, 30, 16, 16, 31,  /* E */
-16, 16, 16, 30, 16, 16, 31,  /* F */
-15, 17, 17, 19, 16, 17, 14,  /* G */
-17, 17, 17, 31, 17, 17, 17,  /* H */
-14, 4, 4, 4, 4, 4, 14,       /* I */
-12, 18, 2, 2, 2, 2, 7,       /* J */
-17, 18, 20, 24, 20, 18, 17,  /* K */
-31, 16, 16, 16, 16, 16, 16,  /* L */
-17, 17, 17, 21, 21, 27, 17,  /* M */
-17, 17, 19, 21, 25, 17, 17,  /* N */
-14, 17, 17, 17, 17, 17, 14,  /* O */
-16, 16, 16, 30, 17, 17, 30 , /* P */
-13, 18, 21, 17, 17, 17, 14,  /* Q */
-17, 18, 20, 30, 17, 17, 30,  /* R */
-14, 17, 1, 14, 16, 17, 14,   /* S */
-4, 4, 4, 4, 4, 4, 31,        /* T */
-14, 17, 17, 17, 17, 17, 17,  /* U */
-4, 10, 17, 17, 17, 17, 17,   /* V */
-10, 21, 21, 21, 17, 17, 17,  /* W */
-17, 17, 10, 4, 10, 17, 17,   /* X */
-4, 4, 4, 10, 17, 17, 17,     /* Y */
-31, 16, 8, 4, 2, 1, 31,      /* Z */
-};
-
-/* scroll_text
- * This function will display a text message.
- * It doesn't use any C library features, so
- * it is limited. To fully scroll off a
- * message, ensure there are two spaces at the end
- * of the text array (and len increased by 2 to
- * reflect that). The variable all, if set to 1,
- * will wipe the bottom row of the display.
- * If set to zero, it will leave the final
- * stick at the bottom of the display.
+/* scroll_slice
+ * the inner loop of scroll_text. Renders one step of the scroll animation
+ * for the two characters at idx_a and idx_b (bit offsets into font_bits,
+ * see font_glyph) into rows 1-7 of the display ram. Each row of a glyph
+ * comes out whole with FONT_ROW, a load and a shift.
  */
 void
-scroll_text(char* text, char len, char all)
+scroll_slice(unsigned int idx_a, unsigned int idx_b, char xmov)
 {
-  char first=1;
-  char i, xmov, y, startx;
-  char a, b; // two partial characters can be scrolled on the 8-wide display since each character is 5 bits wide
-  unsigned int idx_a, idx_b;
+  char y;
   unsigned short int ab_slice; // this variable stores a bitmap of a row, for two characters
-  for (i=0; i<len-1; i++)
+  for (y=0; y<7; y++)
   {
-    // this algorithm revolves around reducing the problem to scrolling only
-    // two characters. At the appropriate point in the animation, the for loop
-    // is used to update the a and b variables to make a become the previous b, and
-    // and the next character gets placed in b.
-    a=text[(unsigned char)i];
-    b=text[(unsigned char)(i+1)];
-    idx_a=(unsigned int)(a-' '); // get an index into the alphabet bitmap
-    idx_a=idx_a*7;               //
-
-    idx_b=(unsigned int)(b-' '); // get an index into the alphabet bitmap
-    idx_b=idx_b*7;               //
-
-    if (all)
-    {
-      display_ram[0]=0; // bottom row is blank
-    }
-    if (first)
-      startx=0;
-    else
-      startx=6;         // after the very first character, subsequent characters are placed at the correct point in the animation
-    for (xmov=startx; xmov<11; xmov++) // step through to scroll two characters
+    // the left byte of ab_slice will ultimately get displayed.
+    // the left character (a) is put into ab_slice so that only the leftmost part of the character will appear in the rightmost part of the display
+    ab_slice=((unsigned short int)FONT_ROW(idx_a, y))<<(xmov+4);
+    if (xmov>5)
     {
-      for (y=0; y<7; y++)
-      {
-        // the left byte of ab_slice will ultimately get displayed.
-        // the left character (a) is put into ab_slice so that only the leftmost part of the character will appear in the rightmost part of the display
-        ab_slice=((unsigned short int)(alpha_bitmap[idx_a+y]))<<(xmov+4);
-        if (xmov>5)
-        {
-          // the next character (b) needs to start showing on the display.
-          // // the b character is butted next to a, with a space of a single bit
-          ab_slice |= (((unsigned short int)((alpha_bitmap[idx_b+y])))<<(xmov-2));
-        }
-        // now shift it all to the right, so that the part to be displayed is in the
-        // lower 8 bits
-        display_ram[y+1]=(((unsigned short int)(ab_slice))>>8);
-        // the 8x8 display module has weird mapping. we need to fix in software
-        if (display_ram[y+1] & 0x01)
-        {
-          display_ram[y+1]=display_ram[y+1]>>1;
-          display_ram[y+1]|=0x80;
-        }
-        else
-        {
-          display_ram[y+1]=display_ram[y+1]>>1;
-        }
-      }
-      // display the ram
-      display_write();
-      display_update_timer=70; // 70msec scrolling delay
-      while(display_update_timer);
+      // the next character (b) needs to start showing on the display.
+      // // the b character is butted next to a, with a space of a single bit
+      ab_slice |= (((unsigned short int)FONT_ROW(idx_b, y))<<(xmov-2));
     }
-    first=0;
+    // now shift it all to the right, so that the part to be displayed is in the
+    // lower 8 bits
+    // and map it onto the display module, which has weird mapping
+    display_ram[y+1]=DISPLAY_BYTE_LINE((unsigned short int)(ab_slice>>8));
   }
 }
 
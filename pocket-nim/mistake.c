@@ -0,0 +1,60 @@
+/***********************************************************
+ * mistake.c
+ * The computer's mistakes on the easier levels. See mistake.h.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdint.h>
+#include "mistake.h"
+#define MISTAKE_TABLES
+#include "mistake_data.h"
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* mistake_threshold
+ * the chance of a mistake on a level, out of 256
+ */
+unsigned char
+mistake_threshold(unsigned char lvl)
+{
+  if (lvl>MISTAKE_LEVELS)
+    return(0);
+  return(mistake_thresholds[lvl]);
+}
+
+/* mistake_make
+ * given a random draw, works out whether to make a mistake, and if
+ * so which. Returns 1 with the move in *move_row and *move_left, or 0
+ * to play properly, leaving them as they were
+ */
+unsigned char
+mistake_make(const unsigned char* sticks, unsigned char rows, unsigned char draw,
+             unsigned char threshold, unsigned char* move_row, unsigned char* move_left)
+{
+  unsigned char i, n=0, pick;
+
+  if (draw>=threshold)
+    return(0);
+  for (i=0; i<rows; i++)
+  {
+    n+=(sticks[i]>1);
+  }
+  if (n==0)
+    return(0);
+  // the draw is spread evenly below the threshold, so scale it to the rows.
+  // A divide, but only on a mistake
+  pick=(unsigned char)(((unsigned int)draw*n)/threshold);
+  for (i=0; i<rows; i++)
+  {
+    if ((sticks[i]>1) && (pick--==0))
+    {
+      *move_row=i;
+      *move_left=(unsigned char)(sticks[i]-1);
+      return(1);
+    }
+  }
+  return(0);
+}
@@ -0,0 +1,30 @@
+/***********************************************************
+ * mistake.h
+ * How often the computer makes a mistake on each level, so that
+ * the easier levels can be beaten.
+ *
+ * A mistake is to take one stick from a row of more than one,
+ * rather than play the engine's move. Each level has the chance
+ * of one as a fixed point threshold out of 256: a move is a
+ * mistake if a byte from random_num() is below it, and the same
+ * byte then picks the row, so there is one draw a move (and none
+ * on a level with no mistakes). computer_play() makes the draw,
+ * after the engine's move, so speculating makes none; it is only
+ * for classic Nim, not Wythoff's game or Nim_k.
+ *
+ * The thresholds are tuned by host/mkmistake, by self-play against
+ * a model player, to give each level a target win rate for the
+ * player. They are made into mistake_data.h.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef MISTAKE_H_
+#define MISTAKE_H_
+
+/******** function prototypes ***********/
+unsigned char mistake_threshold(unsigned char lvl);
+unsigned char mistake_make(const unsigned char* sticks, unsigned char rows, unsigned char draw,
+                           unsigned char threshold, unsigned char* move_row, unsigned char* move_left);
+
+#endif /* MISTAKE_H_ */
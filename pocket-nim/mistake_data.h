@@ -0,0 +1,28 @@
+/***********************************************************
+ * mistake_data.h
+ * Made by host/mkmistake. Don't edit it, run mkmistake again
+ * (cd host; make mistake). See mistake.h for what the table
+ * is. It is only for mistake.c, which defines MISTAKE_TABLES.
+ *
+ * Tuned over 20000 games a level, with a model player who finds
+ * the winning move 50% of the time:
+ *   level 1: wins 60.3% (target 60%, 19.5% with no mistakes)
+ *   level 2: wins 40.1% (target 40%,  0.0% with no mistakes)
+ *   level 3: wins  0.0% (target 0%,  0.0% with no mistakes)
+ *   level 4: wins  6.6% (target 0%,  6.6% with no mistakes)
+ *   level 5: wins  2.8% (target 0%,  2.8% with no mistakes)
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef MISTAKE_DATA_H_
+#define MISTAKE_DATA_H_
+
+#define MISTAKE_LEVELS 5
+
+#ifdef MISTAKE_TABLES
+// out of 256, by level
+static const uint8_t mistake_thresholds[MISTAKE_LEVELS+1]={0, 193, 120, 0, 0, 0};
+#endif /* MISTAKE_TABLES */
+
+#endif /* MISTAKE_DATA_H_ */
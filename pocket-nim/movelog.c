@@ -0,0 +1,126 @@
+/***********************************************************
+ * movelog.c
+ * Writes games as a stream of a byte a move. See movelog.h for the
+ * format.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdint.h>
+#include <string.h>
+#include "movelog.h"
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* put
+ * streams out a byte
+ */
+static void
+put(movelog_writer_t* w, uint8_t b)
+{
+  if (w->len==w->size)
+  {
+    if (w->flush==NULL)
+    {
+      w->dropped++;
+      return;
+    }
+    movelog_flush(w);
+  }
+  w->buf[w->len++]=b;
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* movelog_open
+ * sets up a writer on a buffer of size bytes. flush is given the
+ * buffer when it fills, or NULL to keep what fits
+ */
+void
+movelog_open(movelog_writer_t* w, uint8_t* buf, uint16_t size,
+             void (*flush)(const uint8_t* buf, uint16_t len))
+{
+  memset(w, 0, sizeof(*w));
+  w->buf=buf;
+  w->size=size;
+  w->flush=flush;
+}
+
+/* movelog_start
+ * writes the header of a new game, of up to MOVELOG_MAX_ROWS rows
+ */
+void
+movelog_start(movelog_writer_t* w, uint8_t level, uint16_t seed, uint8_t rules,
+              const unsigned char* sticks, uint8_t rows)
+{
+  uint8_t nibbles[MOVELOG_MAX_ROWS]={0};
+  uint8_t i;
+
+  if (rows>MOVELOG_MAX_ROWS)
+    rows=MOVELOG_MAX_ROWS;
+  for (i=0; i<rows; i++)
+  {
+    nibbles[i]=sticks[i] & 0x0f;
+  }
+  put(w, MOVELOG_MAGIC);
+  put(w, level);
+  put(w, (uint8_t)seed);
+  put(w, (uint8_t)(seed>>8));
+  put(w, (uint8_t)(rows | (rules<<4)));
+  for (i=0; i<MOVELOG_MAX_ROWS; i+=2)
+  {
+    put(w, (uint8_t)(nibbles[i] | (nibbles[i+1]<<4)));
+  }
+  memcpy(w->last, nibbles, sizeof(w->last));
+  w->rows=rows;
+  w->ended=0;
+}
+
+/* movelog_move
+ * writes the turn that has left the rows in sticks: the sticks taken
+ * from each row that has changed, or MOVELOG_PASS if none has
+ */
+void
+movelog_move(movelog_writer_t* w, const unsigned char* sticks)
+{
+  uint8_t i, pending=0, b=MOVELOG_PASS;
+
+  for (i=0; i<w->rows; i++)
+  {
+    if (sticks[i]==w->last[i])
+      continue;
+    if (pending)
+      put(w, b | MOVELOG_MORE);
+    b=(uint8_t)((i<<4) | ((w->last[i]-sticks[i]) & 0x0f));
+    pending=1;
+    w->last[i]=sticks[i];
+  }
+  put(w, b);
+}
+
+/* movelog_end
+ * finishes the game, won by winner (see gamelog.h)
+ */
+void
+movelog_end(movelog_writer_t* w, uint8_t winner)
+{
+  put(w, MOVELOG_END(winner));
+  w->ended=1;
+}
+
+/* movelog_flush
+ * hands what is in the buffer to the flush function
+ */
+void
+movelog_flush(movelog_writer_t* w)
+{
+  if ((w->flush==NULL) || (w->len==0))
+    return;
+  w->flush(w->buf, w->len);
+  w->flushed+=w->len;
+  w->len=0;
+}
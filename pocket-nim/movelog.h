@@ -0,0 +1,81 @@
+/***********************************************************
+ * movelog.h
+ * A compact record of every move of a game, as a stream of bytes,
+ * for telemetry from the device and for a corpus of real games to
+ * replay on the desktop (host/movereplay).
+ *
+ * A game is a MOVELOG_HEADER_BYTES header:
+ *   0    MOVELOG_MAGIC
+ *   1    level
+ *   2-3  seed: randreg as the game starts, low byte first
+ *   4    rows in the low nibble, and the rules in the high one: the
+ *        rows a move may take from (ROWS_PER_MOVE), or
+ *        MOVELOG_WYTHOFF for Wythoff's game
+ *   5-7  the sticks in each row at the start, a nibble a row, row 0
+ *        in the low nibble of byte 5
+ * then a byte a turn, the user's first, taking turns:
+ *   bit 7     MOVELOG_MORE: the move also takes from the row in the
+ *             next byte (Nim_k, or both rows in Wythoff's game)
+ *   bits 6-4  the row
+ *   bits 3-0  the sticks taken from it, 1 to 15
+ * A byte that takes no sticks is a marker: MOVELOG_PASS when the
+ * user presses Computer without taking any, and MOVELOG_END(winner)
+ * (GAMELOG_ABANDONED, GAMELOG_PLAYER or GAMELOG_COMPUTER) to finish.
+ * Games follow each other with nothing in between.
+ *
+ * Every byte takes at least a stick, or is the user's pass before a
+ * computer move that does, so a game of up to MAXROWS rows of 9
+ * sticks (the most that are dealt) fits in MOVELOG_GAME_BYTES.
+ *
+ * The writer works out each move from the rows before and after it,
+ * and streams the bytes into a buffer. When the buffer fills it is
+ * handed to a flush function, e.g. one that writes flash blocks,
+ * and then reused. With no flush function the bytes that don't fit
+ * are just counted. gamelog.c keeps the game being played in RAM,
+ * in gamelog_moves.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef MOVELOG_H_
+#define MOVELOG_H_
+
+#include <stdint.h>
+
+/*************** definitions *****************/
+#define MOVELOG_MAGIC 0x4d
+#define MOVELOG_HEADER_BYTES 8
+#define MOVELOG_MAX_ROWS 6 // in the header's nibbles
+#define MOVELOG_WYTHOFF 0  // rules
+#define MOVELOG_MORE 0x80
+#define MOVELOG_ROW(b) (((b)>>4) & 0x07)
+#define MOVELOG_TAKEN(b) ((b) & 0x0f)
+#define MOVELOG_PASS 0x00
+#define MOVELOG_END(winner) ((uint8_t)(((winner)+1)<<4))
+#define MOVELOG_WINNER(b) (((b)>>4)-1) // of an end marker
+#define MOVELOG_GAME_BYTES (MOVELOG_HEADER_BYTES+2*MAXROWS*9+1)
+
+/*************** types ***********************/
+typedef struct
+{
+  uint8_t* buf;
+  uint16_t size;
+  uint16_t len;          // bytes in buf
+  uint32_t flushed;      // bytes handed to flush
+  uint16_t dropped;      // bytes that didn't fit, with no flush
+  void (*flush)(const uint8_t* buf, uint16_t len);
+  uint8_t rows;
+  uint8_t ended;         // MOVELOG_END has been written
+  uint8_t last[MOVELOG_MAX_ROWS]; // the rows after the last move
+} movelog_writer_t;
+
+/******** function prototypes ***********/
+void movelog_open(movelog_writer_t* w, uint8_t* buf, uint16_t size,
+                  void (*flush)(const uint8_t* buf, uint16_t len));
+void movelog_start(movelog_writer_t* w, uint8_t level, uint16_t seed, uint8_t rules,
+                   const unsigned char* sticks, uint8_t rows);
+void movelog_move(movelog_writer_t* w, const unsigned char* sticks);
+void movelog_end(movelog_writer_t* w, uint8_t winner);
+void movelog_flush(movelog_writer_t* w);
+
+#endif /* MOVELOG_H_ */
@@ -0,0 +1,67 @@
+/***********************************************************
+ * nim.h
+ * Definitions shared between the pocket-nim source files.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef NIM_H_
+#define NIM_H_
+
+/*************** definitions *****************/
+// maximum possible rows containing sticks at the start of a game.
+// limit is 8, due to this code using unsigned chars in places
+#define MAXROWS 5
+
+// computer_choose sets the row to this when there is no move to make
+#define NO_MOVE 0xff
+
+// Moore's Nim_k (see nimk.h): with NIM_K above 1, a turn on the levels
+// with random rows (4 and 5) can take sticks from up to NIM_K rows,
+// rather than just one
+#ifndef NIM_K
+#define NIM_K 1
+#endif
+#define ROWS_PER_MOVE(lvl) ((((lvl)>=4) && ((lvl)!=WYTHOFF_LEVEL)) ? NIM_K : 1)
+
+// Wythoff's game (see wythoff.h): the level that plays it on two rows,
+// instead of Nim, or 0 for none. Row button 3 takes from both rows
+#ifndef WYTHOFF_LEVEL
+#define WYTHOFF_LEVEL 0
+#endif
+#define WYTHOFF_BOTH 3 // current_selection when taking from both rows
+
+// the levels that play plain Nim, one row a turn
+#define CLASSIC_NIM(lvl) ((ROWS_PER_MOVE(lvl)==1) && ((lvl)!=WYTHOFF_LEVEL))
+
+// from this level up, plain Nim is played from the table of distances
+// to the end of the game (see distance.h), to win as quickly as it
+// can and lose as slowly. Above 5 for never
+#ifndef DISTANCE_LEVEL
+#define DISTANCE_LEVEL 3
+#endif
+
+// IDLE_WAIT is the body of every loop that waits on a timer or a button.
+// It does nothing on the microcontroller. The host simulation (see the host
+// folder) defines it to advance virtual time, since nothing else would.
+#ifndef IDLE_WAIT
+#define IDLE_WAIT()
+#endif
+
+/******** global variables **************/
+// these are defined in main.c
+extern unsigned char numsticks[MAXROWS];
+extern unsigned char level;
+extern unsigned char rows;
+extern unsigned short int randreg;
+extern unsigned char current_selection;
+extern unsigned char rows_taken;
+extern unsigned char awaiting_input;
+extern unsigned int display_update_timer;
+
+/******** function prototypes ***********/
+unsigned char random_num(void);
+unsigned char display_due(void);
+void computer_choose(const unsigned char* sticks, unsigned char* move_row, unsigned char* move_left);
+
+#endif /* NIM_H_ */
@@ -0,0 +1,261 @@
+/***********************************************************
+ * nimk.c
+ * Moore's Nim_k, where a turn can take from up to k rows.
+ * See nimk.h for how it works.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdint.h>
+#include <string.h>
+#include "nimk.h"
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* column_count
+ * reads the count of one column back out of the bit planes
+ */
+static unsigned char
+column_count(const uint32_t* plane, unsigned char col)
+{
+  unsigned char i, n=0;
+
+  for (i=0; i<NIMK_PLANES; i++)
+  {
+    n|=(unsigned char)(((plane[i]>>col) & 1UL)<<i);
+  }
+  return(n);
+}
+
+/* count_small
+ * counts the rows of exactly one stick into *ones, and returns how
+ * many rows have more than one
+ */
+static unsigned char
+count_small(const uint32_t* heaps, unsigned char rows, unsigned char* ones)
+{
+  unsigned char r, big=0;
+
+  *ones=0;
+  for (r=0; r<rows; r++)
+  {
+    if (heaps[r]>1)
+      big++;
+    else if (heaps[r]==1)
+      (*ones)++;
+  }
+  return(big);
+}
+
+/* normal_move
+ * finds a move that leaves every column count a multiple of k+1, a
+ * column at a time from the top, and returns 1. Returns 0 if they
+ * already all are, so there is no such move
+ */
+static unsigned char
+normal_move(const uint32_t* heaps, unsigned char rows, unsigned char k, const uint32_t* plane,
+            uint32_t* after)
+{
+  unsigned char cut[NIMK_MAX_K]; // the rows taken from so far
+  unsigned char ncut=0;
+  unsigned char c, r, u, need;
+  uint32_t any=0, bit;
+  int col;
+
+  for (c=0; c<NIMK_PLANES; c++)
+  {
+    any|=plane[c]; // the columns with a 1 in them
+  }
+  for (col=31; col>=0; col--)
+  {
+    bit=1UL<<col;
+    if ((ncut==0) && ((any & bit)==0))
+      continue;
+    // count the 1s in the rows not cut yet. A cut row is already
+    // shorter, so its bits from here down can be anything
+    u=column_count(plane, (unsigned char)col);
+    for (c=0; c<ncut; c++)
+    {
+      if (heaps[cut[c]] & bit)
+        u--;
+      after[cut[c]]&=~bit;
+    }
+    need=u%(k+1);
+    if (need==0)
+      continue;
+    if (need+ncut>=k+1)
+    {
+      // make the column up to the next multiple with the cut rows
+      for (c=0; c<k+1-need; c++)
+        after[cut[c]]|=bit;
+      continue;
+    }
+    // ..or cut as many more rows with a 1 here as there are 1s too many
+    for (r=0; (r<rows) && (need>0); r++)
+    {
+      if ((heaps[r] & bit)==0)
+        continue;
+      for (c=0; (c<ncut) && (cut[c]!=r); c++)
+        ;
+      if (c<ncut)
+        continue;
+      after[r]=heaps[r] & ~(bit | (bit-1));
+      cut[ncut++]=r;
+      need--;
+    }
+  }
+  return(ncut>0);
+}
+
+/* misere_small_move
+ * for misere play, where the move found by normal_move would leave
+ * no row longer than 1: instead cut every longer row to 0 or 1, and
+ * take some of the single sticks, to leave 1 more than a multiple of
+ * k+1 rows. Returns 0 if it can't be done within k rows
+ */
+static unsigned char
+misere_small_move(const uint32_t* heaps, unsigned char rows, unsigned char k, uint32_t* after)
+{
+  unsigned char big, ones, keep, take, r;
+
+  big=count_small(heaps, rows, &ones);
+  for (keep=0; keep<=big; keep++) // long rows cut to 1 rather than 0
+  {
+    for (take=0; (take<=ones) && (big+take<=k); take++) // single sticks taken
+    {
+      if ((ones-take+keep)%(k+1)!=1)
+        continue;
+      for (r=0; r<rows; r++)
+      {
+        after[r]=heaps[r];
+        if (heaps[r]>1)
+        {
+          after[r]=(keep>0) ? 1 : 0;
+          if (keep>0)
+            keep--;
+        }
+        else if ((heaps[r]==1) && (take>0))
+        {
+          after[r]=0;
+          take--;
+        }
+      }
+      return(1);
+    }
+  }
+  return(0);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* nimk_columns
+ * counts the 1s in each binary column of the row lengths, into
+ * NIMK_PLANES bit planes: bit c of plane[i] is bit i of the count of
+ * column c
+ */
+void
+nimk_columns(const uint32_t* heaps, unsigned char rows, uint32_t* plane)
+{
+  uint32_t carry, t;
+  unsigned char r, i, depth=1;
+
+  memset(plane, 0, NIMK_PLANES*sizeof(plane[0]));
+  for (r=0; r<rows; r++)
+  {
+    // the counts are at most r+1 after this row, so the carry can't
+    // go further than its bits. A fixed depth is quicker than
+    // stopping when the carry runs out, which is hard to predict
+    if ((r+1)>>depth)
+      depth++;
+    // add the row into every column's count at once
+    carry=heaps[r];
+    for (i=0; i<depth; i++)
+    {
+      t=plane[i] & carry;
+      plane[i]^=carry;
+      carry=t;
+    }
+  }
+}
+
+/* nimk_lost
+ * returns 1 if the player to move loses against best play
+ */
+unsigned char
+nimk_lost(const uint32_t* heaps, unsigned char rows, unsigned char k, unsigned char misere)
+{
+  uint32_t plane[NIMK_PLANES];
+  unsigned char ones, col;
+
+  if (misere && (count_small(heaps, rows, &ones)==0))
+    return((ones%(k+1))==1);
+  nimk_columns(heaps, rows, plane);
+  for (col=0; col<32; col++)
+  {
+    if (column_count(plane, col)%(k+1)!=0)
+      return(0);
+  }
+  return(1);
+}
+
+/* nimk_choose
+ * works out a move for the position in heaps, taking from up to k
+ * rows, and leaves the position after it in after. Returns 1 if it
+ * is a winning move. If there is none, returns 0 with one stick
+ * taken from the longest row, to make the game last; after is the
+ * same as heaps if there is no stick left to take.
+ */
+unsigned char
+nimk_choose(const uint32_t* heaps, unsigned char rows, unsigned char k, unsigned char misere,
+            uint32_t* after)
+{
+  uint32_t plane[NIMK_PLANES];
+  unsigned char big, ones, take, r, longest=0;
+
+  if (k<1)
+    k=1;
+  if (k>NIMK_MAX_K)
+    k=NIMK_MAX_K;
+  memcpy(after, heaps, rows*sizeof(after[0]));
+  big=count_small(heaps, rows, &ones);
+  if (misere && (big==0))
+  {
+    // only single sticks: leave 1 more than a multiple of k+1
+    take=(ones>0) ? (unsigned char)((ones-1)%(k+1)) : 0;
+    if (take>0)
+    {
+      for (r=0; take>0; r++)
+      {
+        if (heaps[r]==1)
+        {
+          after[r]=0;
+          take--;
+        }
+      }
+      return(1);
+    }
+  }
+  else
+  {
+    nimk_columns(heaps, rows, plane);
+    if (normal_move(heaps, rows, k, plane, after))
+    {
+      if (!misere || (count_small(after, rows, &ones)>0) || misere_small_move(heaps, rows, k, after))
+        return(1);
+    }
+  }
+  // no winning move: play for time
+  memcpy(after, heaps, rows*sizeof(after[0]));
+  for (r=1; r<rows; r++)
+  {
+    if (heaps[r]>heaps[longest])
+      longest=r;
+  }
+  if ((rows>0) && (heaps[longest]>0))
+    after[longest]--;
+  return(0);
+}
@@ -0,0 +1,42 @@
+/***********************************************************
+ * nimk.h
+ * Moore's Nim_k: a turn can take sticks from up to k rows at
+ * once (any number from each), rather than from just one.
+ * Nim itself is Nim_1.
+ *
+ * Write the row lengths in binary, and count the 1s in each
+ * column. In normal play (taking the last stick wins) a position
+ * is lost for the player to move if every column count is a
+ * multiple of k+1. In misere play, as in pocket-nim where taking
+ * the last stick loses, the same holds until no row has more than
+ * one stick; then it is lost if the number of rows left is 1 more
+ * than a multiple of k+1.
+ *
+ * The column counts are kept bit-sliced: plane i holds bit i of
+ * the count of every column at once, so adding a row to them all
+ * is a ripple-carry add of a few word operations, not a loop over
+ * its bits. The winning move is then found a column at a time from
+ * the top (Moore's proof): rows already cut can have their lower
+ * bits set freely, and more rows are cut only when those can't
+ * bring a column to a multiple of k+1.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef NIMK_H_
+#define NIMK_H_
+
+#include <stdint.h>
+
+/*************** definitions *****************/
+#define NIMK_MAX_K 7
+#define NIMK_PLANES 8      // column counts up to 255, so up to 255 rows
+#define NIMK_MAX_ROWS 255
+
+/******** function prototypes ***********/
+void nimk_columns(const uint32_t* heaps, unsigned char rows, uint32_t* plane);
+unsigned char nimk_lost(const uint32_t* heaps, unsigned char rows, unsigned char k, unsigned char misere);
+unsigned char nimk_choose(const uint32_t* heaps, unsigned char rows, unsigned char k, unsigned char misere,
+                          uint32_t* after);
+
+#endif /* NIMK_H_ */
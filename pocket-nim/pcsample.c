@@ -0,0 +1,159 @@
+/***********************************************************
+ * pcsample.c
+ * Opt-in statistical PC-sampling profiler for pocket-nim.
+ * See pcsample.h for how to use it.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <DAVE.h>
+#include "pcsample.h"
+
+#ifdef DO_PCSAMPLE
+
+/*************** definitions *****************/
+#define SAMPLE_SLICE CCU40_CC41
+#define SAMPLE_SLICE_NUMBER 1U
+#define SAMPLE_IRQ CCU40_1_IRQn
+#define SAMPLE_PRIORITY 0U // above SysTick and I2C, so that those get sampled too
+
+/******** global variables **************/
+pcsample_buffer_t pcsample_buffer;
+
+/******** function prototypes ***********/
+void CCU40_1_IRQHandler(void) __attribute__((naked));
+void pcsample_hit(uint32_t* frame);
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* pcsample_init
+ * clears the histogram and starts the sampling timer. GLOBAL_CCU4
+ * has already initialised the CCU40 module and started its prescaler.
+ */
+void
+pcsample_init(void)
+{
+  XMC_CCU4_SLICE_COMPARE_CONFIG_t config={0};
+  uint32_t period;
+  uint8_t prescaler=0;
+  uint32_t i;
+
+  pcsample_buffer.magic=PCSAMPLE_MAGIC;
+  pcsample_buffer.rate_hz=PCSAMPLE_RATE_HZ;
+  pcsample_buffer.bin_shift=PCSAMPLE_BIN_SHIFT;
+  pcsample_buffer.code_base=PCSAMPLE_CODE_BASE;
+  pcsample_buffer.ram_base=PCSAMPLE_RAM_BASE;
+  pcsample_buffer.samples=0;
+  pcsample_buffer.outside=0;
+  for (i=0; i<PCSAMPLE_CODE_BINS; i++)
+    pcsample_buffer.code_bins[i]=0;
+  for (i=0; i<PCSAMPLE_RAM_BINS; i++)
+    pcsample_buffer.ram_bins[i]=0;
+
+  // find the smallest prescaler that lets the period fit in 16 bits
+  period=GLOBAL_CCU4_0.module_frequency/PCSAMPLE_RATE_HZ;
+  while (period>0xffffUL)
+  {
+    period>>=1;
+    prescaler++;
+  }
+
+  config.timer_mode=(uint32_t)XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA;
+  config.monoshot=(uint32_t)XMC_CCU4_SLICE_TIMER_REPEAT_MODE_REPEAT;
+  config.prescaler_initval=prescaler;
+  XMC_CCU4_SLICE_CompareInit(SAMPLE_SLICE, &config);
+  XMC_CCU4_SLICE_SetTimerPeriodMatch(SAMPLE_SLICE, (uint16_t)(period-1));
+  XMC_CCU4_EnableShadowTransfer(CCU40, XMC_CCU4_SHADOW_TRANSFER_SLICE_1);
+
+  XMC_CCU4_SLICE_EnableEvent(SAMPLE_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+  XMC_CCU4_SLICE_SetInterruptNode(SAMPLE_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH, XMC_CCU4_SLICE_SR_ID_1);
+  NVIC_SetPriority(SAMPLE_IRQ, SAMPLE_PRIORITY);
+  NVIC_EnableIRQ(SAMPLE_IRQ);
+
+  XMC_CCU4_EnableClock(CCU40, SAMPLE_SLICE_NUMBER);
+  XMC_CCU4_SLICE_StartTimer(SAMPLE_SLICE);
+}
+
+/* pcsample_stop
+ * stops sampling, so that the histogram can be read out at leisure
+ */
+void
+pcsample_stop(void)
+{
+  XMC_CCU4_SLICE_StopTimer(SAMPLE_SLICE);
+  NVIC_DisableIRQ(SAMPLE_IRQ);
+}
+
+/* pcsample_count
+ * adds one sample at address pc to the histogram.
+ * The counters saturate rather than wrap.
+ */
+void
+pcsample_count(uint32_t pc)
+{
+  uint16_t* bin=0;
+  uint32_t offset;
+
+  pcsample_buffer.samples++;
+  offset=pc-pcsample_buffer.code_base;
+  if (offset<PCSAMPLE_CODE_SIZE)
+  {
+    bin=&pcsample_buffer.code_bins[offset>>PCSAMPLE_BIN_SHIFT];
+  }
+  else
+  {
+    offset=pc-pcsample_buffer.ram_base;
+    if (offset<PCSAMPLE_RAM_SIZE)
+    {
+      bin=&pcsample_buffer.ram_bins[offset>>PCSAMPLE_BIN_SHIFT];
+    }
+  }
+  if (bin==0)
+  {
+    pcsample_buffer.outside++;
+  }
+  else if (*bin!=0xffff)
+  {
+    (*bin)++;
+  }
+}
+
+/* pcsample_hit
+ * called from the interrupt handler with a pointer to the exception
+ * stack frame: r0, r1, r2, r3, r12, lr, pc, xpsr
+ */
+void
+pcsample_hit(uint32_t* frame)
+{
+  XMC_CCU4_SLICE_ClearEvent(SAMPLE_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+  pcsample_count(frame[6]);
+}
+
+/* CCU40_1_IRQHandler
+ * the sample interrupt. This has to be naked so that the stack
+ * pointer still points at the frame the CPU pushed on entry.
+ * Bit 2 of the EXC_RETURN value in lr says which stack was in use.
+ * The handler tail-calls pcsample_hit, which returns from the interrupt.
+ */
+void
+CCU40_1_IRQHandler(void)
+{
+  __asm volatile(
+    "movs r0, #4        \n"
+    "mov  r1, lr        \n"
+    "tst  r0, r1        \n"
+    "beq  1f            \n"
+    "mrs  r0, psp       \n"
+    "b    2f            \n"
+    "1:                 \n"
+    "mrs  r0, msp       \n"
+    "2:                 \n"
+    "ldr  r1, =pcsample_hit \n"
+    "bx   r1            \n"
+    ".ltorg             \n"
+  );
+}
+
+#endif /* DO_PCSAMPLE */
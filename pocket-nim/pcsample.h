@@ -0,0 +1,75 @@
+/***********************************************************
+ * pcsample.h
+ * Opt-in statistical PC-sampling profiler for pocket-nim.
+ *
+ * A spare CCU4 slice (CC41, the tone PWM uses CC40) interrupts
+ * at PCSAMPLE_RATE_HZ. The handler reads the program counter
+ * that the CPU stacked on interrupt entry, and counts it into
+ * a histogram of PCSAMPLE_BIN_BYTES sized address bins covering
+ * flash and SRAM (for .ram_code).
+ *
+ * To read the results, halt the target and dump the buffer
+ * from gdb:
+ *   dump binary value pcs.bin pcsample_buffer
+ * then symbolise it on the host with:
+ *   host/pcdecode pcs.bin pocket-nim/Debug/pocket-nim.map
+ * The host simulation fills in the same buffer using SIGPROF.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef PCSAMPLE_H_
+#define PCSAMPLE_H_
+
+// # uncomment to enable PC sampling
+//#define DO_PCSAMPLE
+
+#include <stdint.h>
+
+/*************** definitions *****************/
+// sample rate. Keep it from being a multiple or divisor of the
+// 1kHz SysTick, otherwise samples will line up with the tick.
+#define PCSAMPLE_RATE_HZ 997
+#define PCSAMPLE_MAGIC 0x53435050 // "PPCS"
+
+// histogram resolution. 64 byte bins need 2.5 kbytes of SRAM
+#define PCSAMPLE_BIN_SHIFT 6
+#define PCSAMPLE_BIN_BYTES (1UL<<PCSAMPLE_BIN_SHIFT)
+#define PCSAMPLE_CODE_BASE 0x10001000UL // flash
+#define PCSAMPLE_CODE_SIZE 0x10000UL
+#define PCSAMPLE_RAM_BASE 0x20000000UL  // SRAM
+#define PCSAMPLE_RAM_SIZE 0x4000UL
+#define PCSAMPLE_CODE_BINS (PCSAMPLE_CODE_SIZE>>PCSAMPLE_BIN_SHIFT)
+#define PCSAMPLE_RAM_BINS (PCSAMPLE_RAM_SIZE>>PCSAMPLE_BIN_SHIFT)
+
+/*************** types ***********************/
+// the layout of this structure is what the host decoder reads.
+// The two address ranges are stored so that the host simulation
+// can use its own.
+typedef struct
+{
+  uint32_t magic;
+  uint32_t rate_hz;
+  uint32_t bin_shift;
+  uint32_t code_base;
+  uint32_t ram_base;
+  uint32_t samples;    // total samples taken
+  uint32_t outside;    // samples outside both ranges
+  uint32_t reserved;
+  uint16_t code_bins[PCSAMPLE_CODE_BINS];
+  uint16_t ram_bins[PCSAMPLE_RAM_BINS];
+} pcsample_buffer_t;
+
+#ifdef DO_PCSAMPLE
+extern pcsample_buffer_t pcsample_buffer;
+
+void pcsample_init(void);
+void pcsample_stop(void);
+void pcsample_count(uint32_t pc);
+
+#define PCSAMPLE_INIT() pcsample_init()
+#else
+#define PCSAMPLE_INIT()
+#endif
+
+#endif /* PCSAMPLE_H_ */
@@ -0,0 +1,117 @@
+/***********************************************************
+ * plot.c
+ * Draws the rows of sticks into the display ram, a whole
+ * row at a time, from a lookup table built by the compiler.
+ * See plot.h for how it works.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdint.h>
+#include "nim.h"
+#include "profile.h"
+#include "display.h"
+#include "plot.h"
+
+/*************** definitions *****************/
+// where stick j of row r is on the board, in orientation o
+#define STICK_X(o, r, j) ((o)==PLOT_0 ? 2*(r) : (o)==PLOT_90 ? (j) : \
+                          (o)==PLOT_180 ? DISPLAY_WIDTH-1-2*(r) : DISPLAY_WIDTH-1-(j))
+#define STICK_Y(o, r, j) ((o)==PLOT_0 ? (j) : (o)==PLOT_90 ? DISPLAY_HEIGHT-1-2*(r) : \
+                          (o)==PLOT_180 ? DISPLAY_HEIGHT-1-(j) : 2*(r))
+#define ON_BOARD(o, r, j) ((STICK_X(o, r, j)>=0) && (STICK_X(o, r, j)<DISPLAY_WIDTH) && \
+                           (STICK_Y(o, r, j)>=0) && (STICK_Y(o, r, j)<DISPLAY_HEIGHT))
+// sticks off the board are drawn as nothing, on line 0
+#define STICK_LINE(o, r, j) (ON_BOARD(o, r, j) ? DISPLAY_LINE(STICK_X(o, r, j), STICK_Y(o, r, j)) : 0)
+#define STICK_BIT(o, r, j) (ON_BOARD(o, r, j) ? (1U<<DISPLAY_BIT(STICK_X(o, r, j))) : 0U)
+
+// in the rotated orientations the sticks of a row run across the board,
+// so they share a line a panel's width at a time
+#define SPAN(j) ((j)-(j)%DISPLAY_PANEL_COLS)
+#define SPAN_START ((uint8_t)~(DISPLAY_PANEL_COLS-1)) // masks stick n down to the first on its line
+#define SPAN_BIT(o, r, j, i) ((((i)<DISPLAY_PANEL_COLS) && (SPAN(j)+(i)<=(j))) ? STICK_BIT(o, r, SPAN(j)+(i)) : 0U)
+#define SPAN_MASK(o, r, j) \
+  (SPAN_BIT(o, r, j, 0) | SPAN_BIT(o, r, j, 1) | SPAN_BIT(o, r, j, 2) | SPAN_BIT(o, r, j, 3) | \
+   SPAN_BIT(o, r, j, 4) | SPAN_BIT(o, r, j, 5) | SPAN_BIT(o, r, j, 6) | SPAN_BIT(o, r, j, 7) | \
+   SPAN_BIT(o, r, j, 8) | SPAN_BIT(o, r, j, 9) | SPAN_BIT(o, r, j, 10) | SPAN_BIT(o, r, j, 11) | \
+   SPAN_BIT(o, r, j, 12) | SPAN_BIT(o, r, j, 13) | SPAN_BIT(o, r, j, 14) | SPAN_BIT(o, r, j, 15))
+
+#define STICK(o, r, j) {(uint16_t)SPAN_MASK(o, r, j), STICK_LINE(o, r, j)}
+#define ROW(o, r) { \
+  STICK(o, r, 0), STICK(o, r, 1), STICK(o, r, 2), STICK(o, r, 3), \
+  STICK(o, r, 4), STICK(o, r, 5), STICK(o, r, 6), STICK(o, r, 7), \
+  STICK(o, r, 8), STICK(o, r, 9), STICK(o, r, 10), STICK(o, r, 11), \
+  STICK(o, r, 12), STICK(o, r, 13), STICK(o, r, 14), STICK(o, r, 15)}
+#define ORIENTATION(o) {ROW(o, 0), ROW(o, 1), ROW(o, 2), ROW(o, 3), ROW(o, 4)}
+
+#if (MAXROWS!=5) || (PLOT_STICKS!=16) || (DISPLAY_PANEL_COLS>16)
+#error "plot_lut is written out for 5 rows of up to 16 sticks"
+#endif
+
+/****** const variables *****************/
+// PLOT_90 and PLOT_270 only. In PLOT_0 and PLOT_180 a row is a column
+// of the board, with a stick to a line, which a loop draws as quickly
+const plot_stick_t plot_lut[2][MAXROWS][PLOT_STICKS]={
+  ORIENTATION(PLOT_90), ORIENTATION(PLOT_270)
+};
+
+/******** global variables **************/
+unsigned char display_orientation=DISPLAY_ORIENTATION;
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* plot_ram_rows
+ * puts each row content into the local display ram. Use display_write to
+ * then send it to the display module.
+ */
+void
+plot_ram_rows(unsigned char* rows_arr)
+{
+  const plot_stick_t* row;
+  uint16_t bit;
+  unsigned int x, y;
+  unsigned char i, j;
+  unsigned char o=display_orientation & 3;
+
+  PROF_ENTER(plot_ram_rows);
+  display_ram_blank();
+  for (i=0; i<rows; i++)
+  {
+    j=rows_arr[i];
+    if (o & 1)
+    {
+      if (j>PLOT_STICKS)
+        j=PLOT_STICKS;
+      row=plot_lut[o>>1][i];
+      // the last stick on a line has the mask for all of them up to it
+      for (; j>0; j=(unsigned char)((j-1) & SPAN_START))
+      {
+        display_ram[row[j-1].line] |= row[j-1].mask;
+      }
+      continue;
+    }
+    // a column, from the bottom up or from the top down
+    if (2U*i>=DISPLAY_WIDTH)
+      break;
+    if (j>DISPLAY_HEIGHT)
+      j=DISPLAY_HEIGHT;
+    if (o==PLOT_0)
+    {
+      x=2U*i;
+      y=0;
+    }
+    else
+    {
+      x=DISPLAY_WIDTH-1-2U*i;
+      y=DISPLAY_HEIGHT-j;
+    }
+    bit=(uint16_t)(1U<<DISPLAY_BIT(x));
+    for (; j>0; j--, y++)
+    {
+      display_ram[DISPLAY_LINE(x, y)] |= bit;
+    }
+  }
+  PROF_LEAVE(plot_ram_rows);
+}
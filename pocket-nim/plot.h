@@ -0,0 +1,62 @@
+/***********************************************************
+ * plot.h
+ * Draws the rows of sticks into the display ram, a whole
+ * row at a time, from a lookup table built by the compiler.
+ *
+ * The board can be drawn in four orientations
+ * (display_orientation):
+ *  - PLOT_0:   row n in column 2n from the left, sticks upward
+ *  - PLOT_90:  turned a quarter clockwise. Row n in line 2n from
+ *              the top, sticks to the right
+ *  - PLOT_180: upside down
+ *  - PLOT_270: turned a quarter anticlockwise
+ * Scrolled text isn't turned.
+ *
+ * In PLOT_0 and PLOT_180 each row is a column of the board, one
+ * stick to a display_ram line, and plot_ram_rows() just loops up
+ * or down it. In PLOT_90 and PLOT_270 the sticks run across the
+ * board, up to a panel's width of them on a line, and plot_lut
+ * has an entry for each stick of each row: the display_ram line
+ * the stick is on, and the mask of it and the sticks before it on
+ * that line. So plot_ram_rows() starts at a row's last stick, and
+ * steps back a line at a time, setting the whole row with one OR
+ * per line. The table is made from the DISPLAY_LINE and
+ * DISPLAY_BIT mappings in display.h, so it fits whatever board is
+ * built for, and changing the orientation at run time costs
+ * nothing.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef PLOT_H_
+#define PLOT_H_
+
+#include <stdint.h>
+
+/*************** definitions *****************/
+#define PLOT_0 0
+#define PLOT_90 1
+#define PLOT_180 2
+#define PLOT_270 3
+#define PLOT_ORIENTATIONS 4
+
+// # the orientation at reset
+#ifndef DISPLAY_ORIENTATION
+#define DISPLAY_ORIENTATION PLOT_0
+#endif
+
+#define PLOT_STICKS 16 // the most sticks drawn in a row
+
+/*************** types ***********************/
+typedef struct
+{
+  uint16_t mask;  // this stick, and the ones before it on the line
+  uint8_t line;   // display_ram line
+} plot_stick_t;
+
+extern unsigned char display_orientation;
+
+/******** function prototypes ***********/
+void plot_ram_rows(unsigned char* rows_arr);
+
+#endif /* PLOT_H_ */
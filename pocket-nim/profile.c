@@ -0,0 +1,85 @@
+/***********************************************************
+ * profile.c
+ * Opt-in function entry/exit profiler for pocket-nim.
+ * See profile.h for how to use it.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <DAVE.h>
+#include "ram_code.h"
+#include "profile.h"
+
+#ifdef DO_PROFILE
+
+#if ((SYSTIMER_SYSTICK_CLOCK / 1000000U) * SYSTIMER_TICK_PERIOD_US) > (PROF_VAL_MASK + 1U)
+#error "SysTick reload value does not fit in the profile record"
+#endif
+
+/******** global variables **************/
+prof_buffer_t prof_buffer;
+
+/***** extern variables *******/
+extern volatile uint32_t g_systick_count; // maintained by the SYSTIMER APP
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* prof_init
+ * clears the ring buffer. Call after the SYSTIMER has been started
+ * so that the SysTick reload value is known.
+ */
+void
+prof_init(void)
+{
+  prof_buffer.magic=PROF_MAGIC;
+  prof_buffer.reload=SysTick->LOAD;
+  prof_buffer.head=0;
+  prof_buffer.count=0;
+}
+
+/* prof_log
+ * stores an entry or exit record for the function fn.
+ * This can be called from both the main loop and interrupts,
+ * so it runs with interrupts disabled for the few cycles it takes.
+ */
+void
+prof_log(void* fn, uint32_t flags)
+{
+  uint32_t primask;
+  uint32_t val;
+  uint32_t tick;
+  prof_record_t* rec;
+
+  primask=__get_PRIMASK();
+  __disable_irq();
+
+  val=SysTick->VAL;
+  tick=g_systick_count;
+  if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0)
+  {
+    // the counter has wrapped but the tick interrupt hasn't run yet.
+    // re-read the value so it is consistent with the incremented tick
+    val=SysTick->VAL;
+    tick++;
+  }
+  if (__get_IPSR() != 0)
+  {
+    val |= PROF_IN_ISR;
+  }
+
+  rec=&prof_buffer.rec[prof_buffer.head];
+  rec->fn=((uint32_t)(uintptr_t)fn & ~PROF_EXIT) | flags;
+  rec->stamp=(tick<<16) | val;
+  prof_buffer.head++;
+  if (prof_buffer.head>=PROF_RECORDS)
+  {
+    prof_buffer.head=0;
+  }
+  prof_buffer.count++;
+
+  __set_PRIMASK(primask);
+}
+
+#endif /* DO_PROFILE */
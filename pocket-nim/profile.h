@@ -0,0 +1,73 @@
+/***********************************************************
+ * profile.h
+ * Opt-in function entry/exit profiler for pocket-nim.
+ *
+ * The Cortex-M0 has no cycle counter, so each record is
+ * time-stamped with the SysTick tick count plus the SysTick
+ * current value register, which counts down once per CPU
+ * clock. Records go into a RAM ring buffer (prof_buffer).
+ *
+ * To read the results, halt the target and dump the buffer
+ * from gdb:
+ *   dump binary value prof.bin prof_buffer
+ * then decode it on the host with:
+ *   host/profdecode prof.bin pocket-nim/Debug/pocket-nim.elf
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+// # uncomment to enable function profiling
+//#define DO_PROFILE
+
+#include <stdint.h>
+#include "ram_code.h"
+
+/*************** definitions *****************/
+// number of records in the ring buffer. Each record is 8 bytes.
+#define PROF_RECORDS 256
+#define PROF_MAGIC 0x464f5250 // "PROF"
+
+// flags in the record fields
+#define PROF_EXIT 0x00000001UL      // in fn: this is an exit record
+#define PROF_IN_ISR 0x00008000UL    // in stamp: recorded in interrupt context
+#define PROF_VAL_MASK 0x00007fffUL  // in stamp: SysTick current value
+
+/*************** types ***********************/
+// fn holds the function address (Thumb bit cleared) with PROF_EXIT in bit 0.
+// stamp holds the low 16 bits of the tick count in the upper half, and
+// the SysTick current value in the lower 15 bits.
+typedef struct
+{
+  uint32_t fn;
+  uint32_t stamp;
+} prof_record_t;
+
+// the layout of this structure is what the host decoder reads
+typedef struct
+{
+  uint32_t magic;
+  uint32_t reload;  // SysTick reload value, i.e. CPU clocks per tick minus one
+  uint32_t head;    // index of the next record to write
+  uint32_t count;   // total records written, may exceed PROF_RECORDS
+  prof_record_t rec[PROF_RECORDS];
+} prof_buffer_t;
+
+#ifdef DO_PROFILE
+extern prof_buffer_t prof_buffer;
+
+void prof_init(void);
+RAM_CODE void prof_log(void* fn, uint32_t flags);
+
+#define PROF_INIT() prof_init()
+#define PROF_ENTER(f) prof_log((void*)(f), 0)
+#define PROF_LEAVE(f) prof_log((void*)(f), PROF_EXIT)
+#else
+#define PROF_INIT()
+#define PROF_ENTER(f)
+#define PROF_LEAVE(f)
+#endif
+
+#endif /* PROFILE_H_ */
@@ -0,0 +1,22 @@
+/***********************************************************
+ * ram_code.h
+ * Code placement for the hot paths of pocket-nim.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef RAM_CODE_H_
+#define RAM_CODE_H_
+
+// Functions marked RAM_CODE are copied from flash into SRAM by the
+// startup code (see the .ram_code section in linker_script.ld) and run from there
+// without flash wait states. SRAM is out of range of a normal branch from flash,
+// so these functions are also called with long calls.
+// The host simulation builds them as ordinary functions.
+#ifdef __arm__
+#define RAM_CODE __attribute__((section(".ram_code"), long_call))
+#else
+#define RAM_CODE
+#endif
+
+#endif /* RAM_CODE_H_ */
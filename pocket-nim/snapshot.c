@@ -0,0 +1,304 @@
+/***********************************************************
+ * snapshot.c
+ * Saves the game in progress to flash, so that it carries on
+ * where it was after a power cut or brown-out.
+ * See snapshot.h for how it is laid out.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <DAVE.h>
+#include <xmc_flash.h>
+#include <stdio.h>
+#include <string.h>
+#include "nim.h"
+#include "gamelog.h"
+#include "snapshot.h"
+
+/*************** definitions *****************/
+#define SLOT_ADDRESS(p, s) ((uint32_t*)(SNAPSHOT_BASE+(uint32_t)(p)*SNAPSHOT_PAGE_BYTES+(uint32_t)(s)*SNAPSHOT_BYTES))
+#define SETTLE_US (SNAPSHOT_SETTLE_MS*1000UL)
+
+/*************** types ***********************/
+typedef union
+{
+  snapshot_t snap;
+  uint32_t words[SNAPSHOT_BYTES/4];
+} snapshot_block_t;
+
+/******** global variables **************/
+snapshot_stats_t snapshot_stats;
+
+uint8_t snap_page;          // the page being written
+uint8_t snap_slot;          // the next block in it, SNAPSHOT_PAGE_SLOTS when full
+uint8_t snap_page_good;     // the page being written holds a good snapshot
+uint8_t snap_other_blank;   // the other page is erased
+uint32_t snap_seq;
+unsigned char snap_is_live;
+snapshot_t snap_saved;      // the position last written
+snapshot_t snap_seen;       // the position last seen by snapshot_idle
+uint32_t snap_seen_us;      // ..and when it was first seen
+
+/****************************************
+ * local functions
+ ****************************************/
+
+static unsigned char
+block_is_blank(const snapshot_block_t* b)
+{
+  return((b->words[0] | b->words[1] | b->words[2] | b->words[3])==0);
+}
+
+static unsigned char
+page_is_blank(uint8_t page)
+{
+  snapshot_block_t b;
+  uint8_t slot;
+
+  for (slot=0; slot<SNAPSHOT_PAGE_SLOTS; slot++)
+  {
+    XMC_FLASH_ReadBlocks(SLOT_ADDRESS(page, slot), b.words, 1);
+    if (!block_is_blank(&b))
+      return(0);
+  }
+  return(1);
+}
+
+/* same_position
+ * compares everything but the random number state, which changes
+ * on every tick
+ */
+static unsigned char
+same_position(const snapshot_t* a, const snapshot_t* b)
+{
+  return((a->rows==b->rows) && (a->level==b->level) && (a->selection==b->selection) &&
+         (memcmp(a->numsticks, b->numsticks, sizeof(a->numsticks))==0));
+}
+
+/* current_position
+ * fills in s from the game variables
+ */
+static void
+current_position(snapshot_t* s)
+{
+  memset(s, 0, sizeof(*s));
+  s->level=level;
+  if (!snap_is_live)
+    return;
+  s->rows=rows;
+  s->selection=(uint8_t)(current_selection | (rows_taken<<SNAPSHOT_TAKEN_SHIFT));
+  memcpy(s->numsticks, numsticks, sizeof(s->numsticks));
+}
+
+/* see_position
+ * takes in the game variables. Returns 1 if the position has changed
+ * since they were last seen, at time t
+ */
+static unsigned char
+see_position(uint32_t t)
+{
+  snapshot_t now;
+
+  current_position(&now);
+  if (same_position(&now, &snap_seen))
+    return(0);
+  memcpy(&snap_seen, &now, sizeof(snap_seen));
+  snap_seen_us=t;
+  snapshot_stats.changes++;
+  return(1);
+}
+
+static void
+erase_other(void)
+{
+  XMC_FLASH_ErasePages(SLOT_ADDRESS(snap_page^1, 0), 1);
+  snapshot_stats.erases++;
+  snap_other_blank=1;
+}
+
+/* write_snapshot
+ * writes s to the next blank block, going on to the other page when
+ * this one is full
+ */
+static void
+write_snapshot(const snapshot_t* s)
+{
+  snapshot_block_t b;
+  uint8_t tries;
+
+  for (tries=0; tries<2*SNAPSHOT_PAGE_SLOTS; tries++)
+  {
+    if (snap_slot>=SNAPSHOT_PAGE_SLOTS)
+    {
+      if (!snap_other_blank)
+        erase_other(); // snapshot_idle didn't get the chance
+      snap_page^=1;
+      snap_slot=0;
+      snap_page_good=0;
+      snap_other_blank=page_is_blank(snap_page^1);
+    }
+    XMC_FLASH_ReadBlocks(SLOT_ADDRESS(snap_page, snap_slot), b.words, 1);
+    if (block_is_blank(&b))
+    {
+      memcpy(&b.snap, s, sizeof(b.snap));
+      b.snap.magic=SNAPSHOT_MAGIC;
+      b.snap.seq=snap_seq++;
+      b.snap.randreg=randreg;
+      b.snap.check=crc8((const uint8_t*)&b.snap, SNAPSHOT_BYTES-1);
+      XMC_FLASH_ClearStatus();
+      XMC_FLASH_WriteBlocks(SLOT_ADDRESS(snap_page, snap_slot), b.words, 1, true);
+      snap_slot++;
+      if ((XMC_FLASH_GetStatus() & XMC_FLASH_STATUS_VERIFY_ERROR)==0)
+      {
+        snapshot_stats.writes++;
+        snap_page_good=1;
+        return;
+      }
+      snapshot_stats.write_errors++;
+    }
+    else
+    {
+      snap_slot++;
+    }
+  }
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* snapshot_restore
+ * finds the newest snapshot. If it has a game in progress, puts the
+ * game variables back as they were and returns 1.
+ */
+unsigned char
+snapshot_restore(void)
+{
+  snapshot_block_t b;
+  snapshot_t newest;
+  uint8_t page, slot, i;
+  unsigned char found=0;
+
+  memset(&newest, 0, sizeof(newest));
+  snap_page=0;
+  snap_slot=0;
+  for (page=0; page<SNAPSHOT_PAGES; page++)
+  {
+    for (slot=0; slot<SNAPSHOT_PAGE_SLOTS; slot++)
+    {
+      XMC_FLASH_ReadBlocks(SLOT_ADDRESS(page, slot), b.words, 1);
+      if ((b.snap.magic!=SNAPSHOT_MAGIC) || (b.snap.check!=crc8((const uint8_t*)&b.snap, SNAPSHOT_BYTES-1)))
+        continue;
+      if ((!found) || ((int32_t)(b.snap.seq-newest.seq)>0))
+      {
+        found=1;
+        memcpy(&newest, &b.snap, sizeof(newest));
+        snap_page=page;
+        snap_slot=slot+1;
+      }
+    }
+  }
+  snap_seq=found ? newest.seq+1 : 1;
+  snap_page_good=found;
+  snap_other_blank=page_is_blank(snap_page^1);
+  if (!found)
+  {
+    // start on page 0 next, as if page 1 had just been filled
+    snap_page=1;
+    snap_slot=SNAPSHOT_PAGE_SLOTS;
+    snap_other_blank=page_is_blank(0);
+  }
+
+  // a sanity check, on top of the CRC
+  if ((newest.rows==0) || (newest.rows>MAXROWS) || (newest.level<1) || (newest.level>5) ||
+      ((newest.selection & ((1<<SNAPSHOT_TAKEN_SHIFT)-1))>
+       ((newest.level==WYTHOFF_LEVEL) ? WYTHOFF_BOTH : newest.rows)))
+  {
+    snap_is_live=0;
+    current_position(&snap_saved);
+    memcpy(&snap_seen, &snap_saved, sizeof(snap_seen));
+    return(0);
+  }
+  for (i=0; i<MAXROWS; i++)
+  {
+    numsticks[i]=newest.numsticks[i];
+  }
+  rows=newest.rows;
+  level=newest.level;
+  current_selection=newest.selection & ((1<<SNAPSHOT_TAKEN_SHIFT)-1);
+  rows_taken=newest.selection>>SNAPSHOT_TAKEN_SHIFT;
+  if ((rows_taken==0) && (current_selection!=0))
+  {
+    rows_taken=(unsigned char)(1<<(current_selection-1)); // saved before there was rows_taken
+  }
+  randreg=newest.randreg;
+  snap_is_live=1;
+  memcpy(&snap_saved, &newest, sizeof(snap_saved));
+  memcpy(&snap_seen, &newest, sizeof(snap_seen));
+  snapshot_stats.restored=1;
+  return(1);
+}
+
+/* snapshot_live
+ * 1 when a game starts, 0 when it is won. Only a live game is restored.
+ */
+void
+snapshot_live(unsigned char live)
+{
+  snap_is_live=live;
+}
+
+/* snapshot_idle
+ * called while waiting for a button. Writes a snapshot once the
+ * position has settled, or else erases the spare page if it needs it.
+ * Returns 1 if it used the flash, which stalls the CPU for a while.
+ */
+unsigned char
+snapshot_idle(void)
+{
+  uint32_t t=SYSTIMER_GetTime();
+
+  if (see_position(t))
+    return(0);
+  if (!same_position(&snap_seen, &snap_saved))
+  {
+    if ((t-snap_seen_us)<SETTLE_US)
+      return(0);
+    write_snapshot(&snap_seen);
+    memcpy(&snap_saved, &snap_seen, sizeof(snap_saved));
+    return(1);
+  }
+  if (snap_page_good && !snap_other_blank)
+  {
+    erase_other();
+    return(1);
+  }
+  return(0);
+}
+
+/* snapshot_save
+ * writes the position straight away, if it isn't the one last
+ * written. Called when a turn is over and when a game starts or ends,
+ * so that play too quick to settle is kept too.
+ */
+void
+snapshot_save(void)
+{
+  see_position(SYSTIMER_GetTime());
+  if (same_position(&snap_seen, &snap_saved))
+    return;
+  write_snapshot(&snap_seen);
+  memcpy(&snap_saved, &snap_seen, sizeof(snap_saved));
+}
+
+/* snapshot_report
+ * prints the flash activity
+ */
+void
+snapshot_report(void)
+{
+  printf("snapshot: %s, %lu changes seen, %lu snapshots written, %lu erases, %lu write errors\n",
+         snapshot_stats.restored ? "game restored at boot" : "nothing to restore",
+         (unsigned long)snapshot_stats.changes, (unsigned long)snapshot_stats.writes,
+         (unsigned long)snapshot_stats.erases, (unsigned long)snapshot_stats.write_errors);
+}
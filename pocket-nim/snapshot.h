@@ -0,0 +1,77 @@
+/***********************************************************
+ * snapshot.h
+ * Saves the game in progress to flash, so that it carries on
+ * where it was after a power cut or brown-out.
+ *
+ * A snapshot is one 16 byte flash block: the sticks in each row,
+ * rows, level, current_selection (and rows_taken, in the same byte)
+ * and the random number state, with a sequence number and a CRC-8.
+ * Two flash pages (reserved in linker_script.ld, just below the
+ * game log) are used in turn as a journal: snapshots are written to
+ * the next blank block of one page until it is full, then to the
+ * other. Whichever valid block has the highest sequence number is the
+ * current snapshot, so a write cut short by power loss just leaves
+ * the one before it in charge. The page not being written is erased
+ * in the background, once the other page holds a good snapshot.
+ *
+ * snapshot_idle() is called while user_play waits for a button. It
+ * only writes once the position has stayed the same for
+ * SNAPSHOT_SETTLE_MS, so taking several sticks in quick succession
+ * costs one write. snapshot_save() writes straight away, once the
+ * computer has moved and when a game starts or ends, so however quick
+ * the play, a turn is only lost if the power goes during it.
+ *
+ * At boot, snapshot_restore() puts back a game that was in progress,
+ * and main() then skips the intro and goes straight to the board.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include <stdint.h>
+
+/*************** definitions *****************/
+#define SNAPSHOT_BASE 0x1000fe00UL // must match linker_script.ld
+#define SNAPSHOT_PAGES 2
+#define SNAPSHOT_PAGE_BYTES 256
+#define SNAPSHOT_BYTES 16
+#define SNAPSHOT_PAGE_SLOTS (SNAPSHOT_PAGE_BYTES/SNAPSHOT_BYTES)
+#define SNAPSHOT_MAGIC 0x5a
+#define SNAPSHOT_SETTLE_MS 300
+#define SNAPSHOT_TAKEN_SHIFT 3      // current_selection is 0..MAXROWS
+
+/*************** types ***********************/
+// one flash block. rows is 0 when there is no game in progress
+typedef struct
+{
+  uint8_t magic;
+  uint8_t rows;
+  uint8_t level;
+  uint8_t selection;    // current_selection, and rows_taken above SNAPSHOT_TAKEN_SHIFT
+  uint32_t seq;
+  uint16_t randreg;
+  uint8_t numsticks[5]; // MAXROWS
+  uint8_t check;        // CRC-8 of the bytes before it
+} snapshot_t;
+
+typedef struct
+{
+  uint32_t changes;     // changes of position seen
+  uint32_t writes;      // snapshots written
+  uint32_t erases;
+  uint32_t write_errors;
+  uint8_t restored;     // a game was restored at boot
+} snapshot_stats_t;
+
+extern snapshot_stats_t snapshot_stats;
+
+/******** function prototypes ***********/
+unsigned char snapshot_restore(void);
+void snapshot_live(unsigned char live);
+unsigned char snapshot_idle(void);
+void snapshot_save(void);
+void snapshot_report(void);
+
+#endif /* SNAPSHOT_H_ */
@@ -0,0 +1,171 @@
+/***********************************************************
+ * speculate.c
+ * Speculative computer moves for pocket-nim.
+ * See speculate.h for how it works.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <DAVE.h>
+#include <stdio.h>
+#include "nim.h"
+#include "latency.h"
+#include "speculate.h"
+
+/*************** definitions *****************/
+#define SPEC_ENTRIES 9 // a row holds at most 8 sticks, so 0..8 left
+#define SPEC_NONE 0xff
+
+/*************** types ***********************/
+typedef struct
+{
+  unsigned char valid;
+  unsigned char row;
+  unsigned char left;
+} spec_move_t;
+
+/******** global variables **************/
+speculate_stats_t speculate_stats;
+
+unsigned char spec_row=SPEC_NONE;     // the row the user is taking from
+unsigned char spec_sticks[MAXROWS];   // the position the cache is for
+unsigned char spec_rows;
+unsigned char spec_level;
+spec_move_t spec_move[SPEC_ENTRIES];  // indexed by sticks left in spec_row
+
+/****************************************
+ * local functions
+ ****************************************/
+
+/* spec_matches
+ * checks that the current position is one the cache covers: the same
+ * game and level, and only the selected row changed, downwards
+ */
+static unsigned char
+spec_matches(unsigned char row)
+{
+  unsigned char i;
+
+  if ((row!=spec_row) || (rows!=spec_rows) || (level!=spec_level))
+    return(0);
+  for (i=0; i<rows; i++)
+  {
+    if ((i!=row) && (numsticks[i]!=spec_sticks[i]))
+      return(0);
+  }
+  return(numsticks[row]<=spec_sticks[row]);
+}
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* speculate_step
+ * called while waiting for a button. Works out at most one move:
+ * the reply to the row being left as it is, then to one fewer, and
+ * so on. Does nothing until the user has picked a row.
+ */
+void
+speculate_step(void)
+{
+  unsigned char row;
+  unsigned char left;
+  unsigned char i;
+  unsigned char sticks[MAXROWS];
+  uint32_t start;
+
+  if ((current_selection==0) || !CLASSIC_NIM(level))
+    return; // nothing to go on yet, or another game, which isn't cached
+  row=current_selection-1;
+  if (numsticks[row]>=SPEC_ENTRIES)
+    return;
+  if (!spec_matches(row))
+  {
+    // a new position. Start a new cache for it
+    spec_row=row;
+    spec_rows=rows;
+    spec_level=level;
+    for (i=0; i<MAXROWS; i++)
+    {
+      spec_sticks[i]=numsticks[i];
+    }
+    for (i=0; i<SPEC_ENTRIES; i++)
+    {
+      spec_move[i].valid=0;
+    }
+  }
+  left=numsticks[row];
+  while (spec_move[left].valid)
+  {
+    if (left==0)
+      return; // all done
+    left--;
+  }
+
+  for (i=0; i<MAXROWS; i++)
+  {
+    sticks[i]=spec_sticks[i];
+  }
+  sticks[row]=left;
+  start=cycles_now();
+  computer_choose(sticks, &spec_move[left].row, &spec_move[left].left);
+  speculate_stats.spec_cycles+=cycles_now()-start;
+  speculate_stats.computed++;
+  spec_move[left].valid=1;
+}
+
+/* speculate_take
+ * looks up the computer's reply to the current position.
+ * Returns 1 and the move if it was in the cache, and in any case
+ * empties the cache, since the position is about to change.
+ */
+unsigned char
+speculate_take(unsigned char* move_row, unsigned char* move_left)
+{
+  unsigned char hit=0;
+  unsigned char row;
+
+  if (current_selection!=0)
+  {
+    row=current_selection-1;
+    if (spec_matches(row) && spec_move[numsticks[row]].valid)
+    {
+      *move_row=spec_move[numsticks[row]].row;
+      *move_left=spec_move[numsticks[row]].left;
+      hit=1;
+      speculate_stats.hits++;
+    }
+  }
+  spec_row=SPEC_NONE;
+  return(hit);
+}
+
+/* speculate_missed
+ * records a move that had to be worked out on demand
+ */
+void
+speculate_missed(uint32_t cycles)
+{
+  speculate_stats.misses++;
+  speculate_stats.miss_cycles+=cycles;
+}
+
+/* speculate_report
+ * prints the hit rate and the cycles spent. The host simulation
+ * leaves the cycles out, as they are always 0 there
+ */
+void
+speculate_report(void)
+{
+  uint32_t moves=speculate_stats.hits+speculate_stats.misses;
+
+  printf("speculate: %lu of %lu moves from the cache (%lu%%), %lu worked out ahead, %lu on demand",
+         (unsigned long)speculate_stats.hits, (unsigned long)moves,
+         moves ? (unsigned long)(speculate_stats.hits*100UL/moves) : 0UL,
+         (unsigned long)speculate_stats.computed, (unsigned long)speculate_stats.misses);
+#ifndef SIM_HOST // the host simulation's code takes no time (see host/include/DAVE.h)
+  printf(", in %lu and %lu cycles", (unsigned long)speculate_stats.spec_cycles,
+         (unsigned long)speculate_stats.miss_cycles);
+#endif
+  printf("\n");
+}
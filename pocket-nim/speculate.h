@@ -0,0 +1,47 @@
+/***********************************************************
+ * speculate.h
+ * Speculative computer moves for pocket-nim.
+ *
+ * Once the user has started taking sticks from a row
+ * (current_selection != 0), the only thing left undecided is how
+ * many more they will take from that row. While user_play waits for
+ * a button, speculate_step works out the computer's reply for each
+ * count that row could be left at, one per call, and caches it.
+ * When the computer button is pressed, computer_play takes the move
+ * from the cache if the position matches.
+ *
+ * The cache holds a copy of the position it was worked out for, and
+ * an entry is only used if the position still matches it, so
+ * anything that changes the position (a new game, a level change,
+ * the computer's own move) invalidates it.
+ *
+ * The hit rate and the cycles spent are kept in speculate_stats, and
+ * printed by speculate_report().
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef SPECULATE_H_
+#define SPECULATE_H_
+
+#include <stdint.h>
+
+/*************** types ***********************/
+typedef struct
+{
+  uint32_t hits;          // computer moves taken from the cache
+  uint32_t misses;        // ..and worked out on demand
+  uint32_t computed;      // speculative moves worked out
+  uint32_t spec_cycles;   // cycles spent on speculative moves
+  uint32_t miss_cycles;   // cycles spent on moves worked out on demand
+} speculate_stats_t;
+
+extern speculate_stats_t speculate_stats;
+
+/******** function prototypes ***********/
+void speculate_step(void);
+unsigned char speculate_take(unsigned char* move_row, unsigned char* move_left);
+void speculate_missed(uint32_t cycles);
+void speculate_report(void);
+
+#endif /* SPECULATE_H_ */
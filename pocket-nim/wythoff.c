@@ -0,0 +1,75 @@
+/***********************************************************
+ * wythoff.c
+ * Wythoff's game on two rows, from the cold pair tables in
+ * wythoff_data.h. See wythoff.h for how it works.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#include <stdint.h>
+#include "wythoff.h"
+#define WYTHOFF_TABLES
+#include "wythoff_data.h"
+
+/****************************************
+ * functions
+ ****************************************/
+
+/* wythoff_cold
+ * returns 1 if the position in sticks[0] and sticks[1] loses for the
+ * player to move
+ */
+unsigned char
+wythoff_cold(const unsigned char* sticks)
+{
+  unsigned char lo=sticks[0], hi=sticks[1];
+
+  if (lo>hi)
+  {
+    lo=sticks[1];
+    hi=sticks[0];
+  }
+  if (lo>WYTHOFF_MAX_PILE)
+    return(0); // past the tables
+  return(wythoff_partner[lo]==hi);
+}
+
+/* wythoff_choose
+ * works out a move for the two rows in sticks, into after. Returns 1
+ * if it is a winning move. If there is none (or the shorter row is
+ * past the tables), returns 0 with one stick taken from the longer
+ * row, to make the game last; after is the same as sticks if there
+ * is no stick left.
+ */
+unsigned char
+wythoff_choose(const unsigned char* sticks, unsigned char* after)
+{
+  unsigned char lo, hi, p;
+  unsigned char s=(sticks[1]>sticks[0]); // the longer row
+
+  lo=sticks[s^1];
+  hi=sticks[s];
+  after[0]=sticks[0];
+  after[1]=sticks[1];
+  if ((lo<=WYTHOFF_MAX_PILE) && (hi>0))
+  {
+    p=wythoff_partner[lo];
+    if (p<hi)
+    {
+      after[s]=p; // take from the longer row
+      return(1);
+    }
+    if (p>hi)
+    {
+      // take from both, to the cold pair with the same difference
+      p=wythoff_gap[hi-lo];
+      after[s]=hi-(lo-p);
+      after[s^1]=p;
+      return(1);
+    }
+  }
+  // cold: play for time
+  if (hi>0)
+    after[s]=hi-1;
+  return(0);
+}
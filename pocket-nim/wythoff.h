@@ -0,0 +1,36 @@
+/***********************************************************
+ * wythoff.h
+ * Wythoff's game, played on two rows: a turn takes any number
+ * of sticks from one row, or the same number from both. As in
+ * the rest of pocket-nim, whoever takes the last stick loses.
+ *
+ * The positions that lose for the player to move are the "cold"
+ * pairs. In normal play they are (a_n, b_n) with a_n=floor(n*phi)
+ * and b_n=a_n+n, phi being the golden ratio: (0,0), (1,2), (3,5),
+ * (4,7), (6,10).. (the Beatty sequences of phi and phi^2). Every
+ * row length is in exactly one pair. The misere game played here
+ * swaps (0,0) and (1,2) for (0,1) and (2,2), and keeps the rest.
+ *
+ * Two tables in flash, made by host/mkwythoff into wythoff_data.h,
+ * make a move O(1):
+ *  - wythoff_partner[v]: the other row of the cold pair with a row
+ *    of v. The position (x, y) is cold if wythoff_partner[x] is y,
+ *    and if it is less than y, taking y down to it wins
+ *  - wythoff_gap[d]: the shorter row of the cold pair whose rows
+ *    differ by d. Otherwise taking from both rows down to it wins
+ * They are a byte each per row length, up to WYTHOFF_MAX_PILE.
+ *
+ * On the device, the level WYTHOFF_LEVEL (see nim.h) plays it:
+ * buttons 1 and 2 take from a row, and button 3 from both.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef WYTHOFF_H_
+#define WYTHOFF_H_
+
+/******** function prototypes ***********/
+unsigned char wythoff_cold(const unsigned char* sticks);
+unsigned char wythoff_choose(const unsigned char* sticks, unsigned char* after);
+
+#endif /* WYTHOFF_H_ */
@@ -0,0 +1,29 @@
+/***********************************************************
+ * wythoff_data.h
+ * Made by host/mkwythoff. Don't edit it, run mkwythoff again
+ * (cd host; make wythoff). See wythoff.h for what the tables
+ * are. They are only for wythoff.c, which defines
+ * WYTHOFF_TABLES.
+ *
+ * Free for all non-commercial use
+ ***********************************************************/
+
+#ifndef WYTHOFF_DATA_H_
+#define WYTHOFF_DATA_H_
+
+#define WYTHOFF_MAX_PILE 32
+
+#ifdef WYTHOFF_TABLES
+static const uint8_t wythoff_partner[WYTHOFF_MAX_PILE+1]={
+    1,   0,   2,   5,   7,   3,  10,   4,  13,  15,   6,  18,
+   20,   8,  23,   9,  26,  28,  11,  31,  12,  34,  36,  14,
+   39,  41,  16,  44,  17,  47,  49,  19,  52
+};
+static const uint8_t wythoff_gap[WYTHOFF_MAX_PILE+1]={
+    2,   0,   3,   4,   6,   8,   9,  11,  12,  14,  16,  17,
+   19,  21,  22,  24,  25,  27,  29,  30,  32,  33,  35,  37,
+   38,  40,  42,  43,  45,  46,  48,  50,  51
+};
+#endif /* WYTHOFF_TABLES */
+
+#endif /* WYTHOFF_DATA_H_ */